@@ -1124,6 +1124,13 @@ void idDeclManagerLocal::RegisterDeclFolder( const char *folder, const char *ext
 		});
 	}
 
+	// read added decl files on I/O threads, while parsing them here in order
+	idFileReadBatch prefetch;
+	for ( i = previouslyLoadedNum; i < loadedFiles.Num(); i++ ) {
+		prefetch.Add( loadedFiles[i]->fileName );
+	}
+	prefetch.Submit();
+
 	// load and parse added decl files
 	for ( i = previouslyLoadedNum; i < loadedFiles.Num(); i++ ) {
 		loadedFiles[i]->LoadAndParse();
@@ -19,6 +19,7 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 
 
 #include <minizip/unzip.h>
+#include "zlib.h"
 #include "minizip/minizip_extra.h"	//unzSeek
 
 /*
@@ -1209,6 +1210,37 @@ idFile_InZip
 =================================================================================
 */
 
+/*
+=================
+idZipMapping::Create
+=================
+*/
+idZipMapping *idZipMapping::Create( const char *osPath ) {
+	size_t size;
+	const void *data = Sys_MapFile( osPath, size );
+	if ( !data ) {
+		return NULL;
+	}
+
+	idZipMapping *mapping = new idZipMapping();
+	mapping->data = ( const byte * )data;
+	mapping->size = size;
+	mapping->refCount.SetValue( 1 );
+	return mapping;
+}
+
+/*
+=================
+idZipMapping::Release
+=================
+*/
+void idZipMapping::Release( void ) {
+	if ( refCount.Decrement() == 0 ) {
+		Sys_UnmapFile( data, size );
+		delete this;
+	}
+}
+
 /*
 =================
 idFile_InZip::idFile_InZip
@@ -1221,6 +1253,11 @@ idFile_InZip::idFile_InZip( void ) {
 	fileSize = 0;
 	memset( &z, 0, sizeof( z ) );
 	domain = FDOM_UNKNOWN;
+	mapping = NULL;
+	mapData = NULL;
+	mapDataSize = 0;
+	mapPos = 0;
+	mapStream = NULL;
 }
 
 /*
@@ -1229,6 +1266,14 @@ idFile_InZip::~idFile_InZip
 =================
 */
 idFile_InZip::~idFile_InZip( void ) {
+	if ( mapping ) {
+		if ( mapStream ) {
+			inflateEnd( mapStream );
+			delete mapStream;
+		}
+		mapping->Release();
+		return;
+	}
 	unzCloseCurrentFile( z );
 	unzClose( z );
 }
@@ -1241,12 +1286,62 @@ Properly handles partial reads
 =================
 */
 int idFile_InZip::Read( void *buffer, int len ) {
-	const int l = unzReadCurrentFile( z, buffer, len );
+	const int l = mapping ? ReadMapped( buffer, len ) : unzReadCurrentFile( z, buffer, len );
 	fileSystem->AddToReadCount( l );
 
 	return l;
 }
 
+/*
+=================
+idFile_InZip::ReadMapped
+
+Stored files are copied straight from the mapping, deflated ones are inflated from it
+=================
+*/
+int idFile_InZip::ReadMapped( void *buffer, int len ) {
+	len = Min( len, fileSize - mapPos );
+	if ( len <= 0 ) {
+		return 0;
+	}
+
+	if ( !compressed ) {
+		memcpy( buffer, mapData + mapPos, len );
+		mapPos += len;
+		return len;
+	}
+
+	if ( !mapStream ) {
+		mapStream = new z_stream;
+		memset( mapStream, 0, sizeof( z_stream ) );
+		// raw deflate data without zlib header, same as minizip does
+		if ( inflateInit2( mapStream, -MAX_WBITS ) != Z_OK ) {
+			delete mapStream;
+			mapStream = NULL;
+			return -1;
+		}
+		mapStream->next_in = ( Bytef * )mapData;
+		mapStream->avail_in = mapDataSize;
+	}
+
+	mapStream->next_out = ( Bytef * )buffer;
+	mapStream->avail_out = len;
+	while ( mapStream->avail_out > 0 ) {
+		int err = inflate( mapStream, Z_SYNC_FLUSH );
+		if ( err == Z_STREAM_END ) {
+			break;
+		}
+		if ( err != Z_OK ) {
+			common->Warning( "idFile_InZip::Read: inflate error %d in %s", err, fullPath.c_str() );
+			break;
+		}
+	}
+
+	const int read = len - mapStream->avail_out;
+	mapPos += read;
+	return read;
+}
+
 /*
 =================
 idFile_InZip::Write
@@ -1281,6 +1376,9 @@ idFile_InZip::Tell
 =================
 */
 int idFile_InZip::Tell( void ) {
+	if ( mapping ) {
+		return mapPos;
+	}
 	return unztell( z );
 }
 
@@ -1330,6 +1428,10 @@ idFile_InZip::Seek
 #define ZIP_SEEK_BUF_SIZE	(1<<15)
 
 int idFile_InZip::Seek( long offset, fsOrigin_t origin ) {
+	if ( mapping ) {
+		return SeekMapped( offset, origin );
+	}
+
 	//stgatilov: try to seek using minizip function
 	//this would work very fast if the file is uncompressed
 	//see issue #4504 (and #4507) for reasoning behind this
@@ -1388,3 +1490,54 @@ int idFile_InZip::Seek( long offset, fsOrigin_t origin ) {
 	}
 	return -1;
 }
+
+/*
+=================
+idFile_InZip::SeekMapped
+
+  returns zero on success and -1 on failure
+=================
+*/
+int idFile_InZip::SeekMapped( long offset, fsOrigin_t origin ) {
+	int target;
+
+	switch( origin ) {
+		case FS_SEEK_END:
+			// same non-standard meaning of offset as in Seek
+			target = fileSize - offset;
+			break;
+		case FS_SEEK_CUR:
+			target = mapPos + offset;
+			break;
+		case FS_SEEK_SET:
+			target = offset;
+			break;
+		default:
+			common->FatalError( "idFile_InZip::Seek: bad origin for %s\n", name.c_str() );
+			return -1;
+	}
+	if ( target < 0 || target > fileSize ) {
+		return -1;
+	}
+
+	if ( !compressed ) {
+		mapPos = target;
+		return 0;
+	}
+
+	if ( target < mapPos && mapStream ) {
+		// restart decompression from the beginning
+		inflateReset( mapStream );
+		mapStream->next_in = ( Bytef * )mapData;
+		mapStream->avail_in = mapDataSize;
+		mapPos = 0;
+	}
+
+	char *buf = (char *) _alloca16( ZIP_SEEK_BUF_SIZE );
+	while ( mapPos < target ) {
+		if ( ReadMapped( buf, Min( target - mapPos, ZIP_SEEK_BUF_SIZE ) ) <= 0 ) {
+			return -1;
+		}
+	}
+	return 0;
+}
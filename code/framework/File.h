@@ -214,6 +214,26 @@ private:
 };
 
 
+// memory mapping of a whole pk4 file
+// it is shared by the pack and all the files opened from it, and unmapped when the last of them releases it
+class idZipMapping {
+public:
+	static idZipMapping *	Create( const char *osPath );		// returns NULL if file cannot be mapped
+
+	void					AddRef( void ) { refCount.Increment(); }
+	void					Release( void );
+
+	const byte *			GetData( void ) const { return data; }
+	size_t					GetSize( void ) const { return size; }
+
+private:
+							idZipMapping( void ) : data( NULL ), size( 0 ) {}
+
+	const byte *			data;
+	size_t					size;
+	idSysInterlockedInteger	refCount;
+};
+
 class idFile_InZip : public idFile {
 	friend class			idFileSystemLocal;
 
@@ -234,6 +254,9 @@ public:
 	virtual int				Seek( long offset, fsOrigin_t origin ) override;
 	virtual bool			IsCompressed( void ) override;
 
+							// true if file is stored uncompressed in memory-mapped pak: reads are copied from the mapping
+	bool					IsMappedStored( void ) const { return mapping != NULL && !compressed; }
+
 private:
 	idStr					name;			// name of the file in the pak
 	idStr					fullPath;		// full file path including pak file name
@@ -242,6 +265,16 @@ private:
 	int						fileSize;		// size of the file
 	void *					z;				// unzip info
 	domainStatus_t			domain;			// stgatilov #5766
+
+	// when pak is memory-mapped, data is taken from the mapping instead of minizip
+	idZipMapping *			mapping;
+	const byte *			mapData;		// raw or deflated data of the file inside the mapping
+	int						mapDataSize;	// size of mapData
+	int						mapPos;			// current uncompressed position
+	struct z_stream_s *		mapStream;		// inflate state for compressed file
+
+	int						ReadMapped( void *buffer, int len );
+	int						SeekMapped( long offset, fsOrigin_t origin );
 };
 
 #endif /* !__FILE_H__ */
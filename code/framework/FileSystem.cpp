@@ -20,6 +20,8 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 
 #include <minizip/unzip.h>
 #include "minizip/minizip_extra.h"	//unzReOpen
+#include <mutex>
+#include <condition_variable>
 //stgatilov: for pk4 repacking
 #include <minizip/zip.h>
 
@@ -125,6 +127,14 @@ in search order, fs_mod > BASE_TDM
 #define MAX_ZIPPED_FILE_NAME	2048
 #define FILE_HASH_SIZE			1024
 
+// number of neighbouring requests from the same pak which one I/O thread reads in a row
+#define FILE_READ_GROUP_SIZE	8
+
+// persistent index of pk4 directories, saved in fs_savepath
+#define PAK_INDEX_FILENAME		"pakindex.dat"
+#define PAK_INDEX_MAGIC			( ( 'X' << 24 ) | ( 'I' << 16 ) | ( 'K' << 8 ) | 'P' )
+#define PAK_INDEX_VERSION		1
+
 typedef struct fileInPack_s {
 	idStr				name;						// name of the file
 	ZPOS64_T			pos;						// file info position in zip
@@ -148,6 +158,8 @@ typedef struct {
 	int					checksum;
 	int					numfiles;
 	int					length;
+	ID_TIME_T			timestamp;					// modification time of pak file
+	bool				fromIndex;					// directory was taken from pak index cache
 	bool				referenced;
 	binaryStatus_t		binary;
 	bool				addon;						// this is an addon pack - addon_search tells if it's 'active'
@@ -156,8 +168,19 @@ typedef struct {
 	bool				isNew;						// for downloaded paks
 	fileInPack_t		*hashTable[FILE_HASH_SIZE];
 	fileInPack_t		*buildBuffer;
+	idZipMapping		*mapping;					// whole pak mapped into memory (if fs_mapPaks)
 } pack_t;
 
+typedef struct {
+	idStr				pakFilename;
+	int					length;
+	ID_TIME_T			timestamp;
+	int					checksum;
+	int					numfiles;
+	int					entriesOffset;				// position of file entries in index file
+	bool				used;
+} pakIndexRecord_t;
+
 typedef struct {
 	idStr				path;						// c:\doom
 	idStr				gamedir;					// base
@@ -199,6 +222,11 @@ private:
 	idStr				extension;
 };
 
+class idFileReadThread : public idSysThread {
+protected:
+	virtual int				Run( void ) override;
+};
+
 class idFileSystemLocal : public idFileSystem {
 public:
 							idFileSystemLocal( void );
@@ -234,6 +262,10 @@ public:
 	virtual idFile *		OpenExplicitFileWrite( const char *OSPath ) override;
 	virtual void			CloseFile( idFile *f ) override;
 	virtual void			BackgroundDownload( backgroundDownload_t *bgl ) override;
+	virtual void			ReadFilesAsync( fileReadRequest_t **requests, int num ) override;
+	virtual void			WaitFileReads( fileReadRequest_t **requests, int num ) override;
+	virtual void			ReleaseFileReads( fileReadRequest_t **requests, int num ) override;
+	void					ProcessFileReads( void );
 	virtual void			ResetReadCount( void ) override { readCount.SetValue(0); }
 	virtual void			AddToReadCount( int c ) override { readCount.Add(c); }
 	virtual int				GetReadCount( void ) const override { return readCount.GetValue(); }
@@ -271,6 +303,14 @@ private:
 
 	searchpath_t			*addonPaks;			// not loaded up, but we saw them
 
+	// pak index cache loaded during startup
+	const void *			pakIndexData;
+	size_t					pakIndexSize;
+	idFile_Memory *			pakIndexFile;
+	idList<pakIndexRecord_t>	pakIndexRecords;
+	idHashIndex				pakIndexHash;
+	bool					pakIndexDirty;		// index file needs to be rewritten
+
 	idDict					mapDict;			// for GetMapDecl
 
 	static idCVar			fs_debug;
@@ -279,6 +319,9 @@ private:
 	static idCVar			fs_devpath;
 	static idCVar			fs_caseSensitiveOS;
 	static idCVar			fs_searchAddons;
+	static idCVar			fs_mapPaks;
+	static idCVar			fs_pakIndex;
+	static idCVar			fs_ioThreads;
 
     // taaaki: fs_game and fs_game_base have been removed as TDM is no longer a mod and these fs cvars were causing
     // confusion due to inconsistent usage. fs_mod has been added to allow for mods of TDM.
@@ -294,6 +337,17 @@ private:
 	backgroundDownload_t	defaultBackgroundDownload;
 	uintptr_t				backgroundThread;
 
+	// asynchronous reads
+	idList<idFileReadThread *>	readThreads;
+	idSysMutex				readQueueMutex;
+	idList<fileReadRequest_t *>	readQueue;			// groups of requests from the same pak go one after another
+	int						readQueueHead;
+	std::mutex				readDoneMutex;		// protects completed and pinCount of requests
+	std::condition_variable	readDoneCondition;	// notified when a request is completed or unpinned
+	idSysMutex				prefetchMutex;
+	idList<fileReadRequest_t *>	prefetchRequests;	// OpenFileRead looks here first
+	idHashIndex				prefetchHash;
+
 	idList<pack_t *>		serverPaks;
 	bool					loadedFileFromDir;		// set to true once a file was loaded from a directory
 	idList<int>				restartChecksums;		// used during a restart to set things in right order
@@ -323,6 +377,14 @@ private:
 
 	int						GetFileListTree( const char *relativePath, const idStrList &extensions, idStrList &list, idHashIndex &hashIndex, const char* gamedir = NULL ) const; //note: thread-unsafe!
 	pack_t *				LoadZipFile( const char *zipfile ); //note: thread-unsafe!
+	void					LoadPakIndex( void );
+	bool					LoadPakFromIndex( pack_t *pack );
+	void					SavePakIndex( void );
+	void					FreePakIndex( void );
+	int						LocateFileInPaks( const char *relativePath, ZPOS64_T &pos );
+	void					ExecuteFileRead( fileReadRequest_t *request );
+	idFile *				OpenPrefetchedFile( const char *relativePath );
+	void					StopReadThreads( void );
 	void					AddGameDirectory( const char *path, const char *dir, domainStatus_t domain ); //note: thread-unsafe!
 	void					SetupGameDirectories( const char *gameName ); //note: thread-unsafe!
 	void					Startup( void ); //note: thread-unsafe!
@@ -333,6 +395,7 @@ private:
 							// searches all the paks
 	pack_t *				FindPakForFileChecksum( const char *relativePath, int fileChecksum, bool bReference ); //note: thread-unsafe!
 	idFile_InZip *			ReadFileFromZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ); //note: thread-unsafe!
+	idFile_InZip *			ReadFileFromMappedZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath );
 	static int				GetFileChecksum( idFile *file );
 	static addonInfo_t *	ParseAddonDef( const char *buf, const int len );
 	void					FollowAddonDependencies( pack_t *pak );
@@ -356,6 +419,15 @@ idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "0", CVAR_SY
 idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "1", CVAR_SYSTEM | CVAR_BOOL, "" );
 #endif
 idCVar	idFileSystemLocal::fs_searchAddons( "fs_searchAddons", "0", CVAR_SYSTEM | CVAR_BOOL, "search all addon pk4s ( disables addon functionality )" );
+idCVar	idFileSystemLocal::fs_ioThreads( "fs_ioThreads", "2", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE, "number of threads serving asynchronous file reads (applied on first use)", 1, 16 );
+idCVar	idFileSystemLocal::fs_pakIndex( "fs_pakIndex", "1", CVAR_SYSTEM | CVAR_BOOL, "cache directories of pk4 files in " PAK_INDEX_FILENAME " to speed up startup" );
+// mapping whole paks needs a lot of address space, so it is only enabled by default on 64-bit
+#if defined( _WIN64 ) || defined( __x86_64__ )
+#define FS_MAP_PAKS_DEFAULT "1"
+#else
+#define FS_MAP_PAKS_DEFAULT "0"
+#endif
+idCVar	idFileSystemLocal::fs_mapPaks( "fs_mapPaks", FS_MAP_PAKS_DEFAULT, CVAR_SYSTEM | CVAR_BOOL, "read files from memory-mapped pk4s instead of reopening them with minizip (applies to newly loaded paks)" );
 
 // greebo: Custom savepath in darkmod/fms/
 idCVar	idFileSystemLocal::fs_modSavePath( "fs_modSavePath", "", CVAR_SYSTEM | CVAR_INIT, "This is where all screenshots and savegames will be written to." );
@@ -379,6 +451,11 @@ idFileSystemLocal::idFileSystemLocal( void ) {
 	restartGamePakChecksum = 0;
 	memset( &backgroundThread, 0, sizeof( backgroundThread ) );
 	addonPaks = NULL;
+	pakIndexData = NULL;
+	pakIndexSize = 0;
+	pakIndexFile = NULL;
+	pakIndexDirty = false;
+	readQueueHead = 0;
 }
 
 /*
@@ -1261,6 +1338,7 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	}
 	fseek( f, 0, SEEK_END );
 	len = ftell( f );
+	ID_TIME_T timestamp = Sys_FileTimeStamp( f );
 	fclose( f );
 
 	fs_numHeaderLongs = 0;
@@ -1288,45 +1366,64 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 	pack->addon_search = false;
 	pack->addon_info = NULL;
 	pack->isNew = false;
+	pack->mapping = NULL;
 
 	pack->length = len;
+	pack->timestamp = timestamp;
+	pack->fromIndex = LoadPakFromIndex( pack );
+
+	if ( !pack->fromIndex ) {
+		pakIndexDirty = true;
+
+		bool needsRepacking = false;
+		unzGoToFirstFile(uf);
+		fs_headerLongs = (int *)Mem_ClearedAlloc( gi.number_entry * sizeof(int) );
+		for ( int i = 0; i < (int)gi.number_entry; i++ ) {
+			err = unzGetCurrentFileInfo64( uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0 );
+			if ( err != UNZ_OK ) {
+				break;
+			}
+			if ( file_info.uncompressed_size > 0 ) {
+				fs_headerLongs[fs_numHeaderLongs++] = LittleInt( file_info.crc );
+			}
+			hash = HashFileName( filename_inzip );
+			buildBuffer[i].name = filename_inzip;
+			buildBuffer[i].name.ToLower();
+			buildBuffer[i].name.BackSlashesToSlashes();
+			// store the file position in the zip
+			buildBuffer[i].pos = unzGetOffset64( uf );
+			// add the file to the hash
+			buildBuffer[i].next = pack->hashTable[hash];
+			pack->hashTable[hash] = &buildBuffer[i];
+			//stgatilov: check if file is compressed but should be uncompressed
+			if (DoNotCompressFile(filename_inzip) && file_info.compression_method != 0)
+				needsRepacking = true;
+			// go to the next file in the zip
+			unzGoToNextFile(uf);
+		}
 
-	bool needsRepacking = false;
-	unzGoToFirstFile(uf);
-	fs_headerLongs = (int *)Mem_ClearedAlloc( gi.number_entry * sizeof(int) );
-	for ( int i = 0; i < (int)gi.number_entry; i++ ) {
-		err = unzGetCurrentFileInfo64( uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0 );
-		if ( err != UNZ_OK ) {
-			break;
+		//stgatilov: repack the whole pk4 if required
+		if (needsRepacking) {
+			Mem_Free(fs_headerLongs);
+			delete pack;
+			delete[] buildBuffer;
+			if (RepackPK4(uf, zipfile))
+				return LoadZipFile(zipfile);
+			else
+				return NULL;	//repacking error
+		}
+
+		pack->checksum = MD4_BlockChecksum( fs_headerLongs, 4 * fs_numHeaderLongs );
+		pack->checksum = LittleInt( pack->checksum );
+
+		Mem_Free( fs_headerLongs );
+	}
+
+	if ( fs_mapPaks.GetBool() ) {
+		pack->mapping = idZipMapping::Create( zipfile );
+		if ( !pack->mapping ) {
+			common->Warning( "Failed to map %s into memory, falling back to regular reading", zipfile );
 		}
-		if ( file_info.uncompressed_size > 0 ) {
-			fs_headerLongs[fs_numHeaderLongs++] = LittleInt( file_info.crc );
-		}
-		hash = HashFileName( filename_inzip );
-		buildBuffer[i].name = filename_inzip;
-		buildBuffer[i].name.ToLower();
-		buildBuffer[i].name.BackSlashesToSlashes();
-		// store the file position in the zip
-		buildBuffer[i].pos = unzGetOffset64( uf );
-		// add the file to the hash
-		buildBuffer[i].next = pack->hashTable[hash];
-		pack->hashTable[hash] = &buildBuffer[i];
-		//stgatilov: check if file is compressed but should be uncompressed
-		if (DoNotCompressFile(filename_inzip) && file_info.compression_method != 0)
-			needsRepacking = true;
-		// go to the next file in the zip
-		unzGoToNextFile(uf);
-	}
-
-	//stgatilov: repack the whole pk4 if required
-	if (needsRepacking) {
-		Mem_Free(fs_headerLongs);
-		delete pack;
-		delete[] buildBuffer;
-		if (RepackPK4(uf, zipfile))
-			return LoadZipFile(zipfile);
-		else
-			return NULL;	//repacking error
 	}
 
 	// check if this is an addon pak
@@ -1351,12 +1448,216 @@ pack_t *idFileSystemLocal::LoadZipFile( const char *zipfile ) {
 		}
 	}
 
-	pack->checksum = MD4_BlockChecksum( fs_headerLongs, 4 * fs_numHeaderLongs );
-	pack->checksum = LittleInt( pack->checksum );
+	return pack;
+}
 
-	Mem_Free( fs_headerLongs );
+/*
+================
+ReadPakIndexString
 
-	return pack;
+Same as idFile::ReadString, but does not trust string length
+================
+*/
+static bool ReadPakIndexString( idFile *f, idStr &string ) {
+	int len = -1;
+	f->ReadInt( len );
+	if ( len < 0 || len > f->Length() - f->Tell() ) {
+		return false;
+	}
+	string.Fill( ' ', len );
+	return f->Read( &string[ 0 ], len ) == len;
+}
+
+/*
+================
+idFileSystemLocal::LoadPakIndex
+
+Maps the pak index saved by previous run.
+Every record describes directory of one pk4 file, which is valid only while size and modification time of pk4 stay the same.
+================
+*/
+void idFileSystemLocal::LoadPakIndex( void ) {
+	FreePakIndex();
+	pakIndexDirty = false;
+
+	if ( !fs_pakIndex.GetBool() ) {
+		return;
+	}
+
+	idStr path = fs_savepath.GetString();
+	path.AppendPath( PAK_INDEX_FILENAME );
+	pakIndexData = Sys_MapFile( path, pakIndexSize );
+	if ( !pakIndexData || pakIndexSize > INT_MAX ) {
+		FreePakIndex();
+		pakIndexDirty = true;
+		return;
+	}
+	pakIndexFile = new idFile_Memory( PAK_INDEX_FILENAME, ( const char * )pakIndexData, ( int )pakIndexSize );
+
+	int magic = 0, version = 0, numPaks = 0;
+	pakIndexFile->ReadInt( magic );
+	pakIndexFile->ReadInt( version );
+	pakIndexFile->ReadInt( numPaks );
+	bool valid = ( magic == PAK_INDEX_MAGIC && version == PAK_INDEX_VERSION && numPaks >= 0 );
+
+	for ( int i = 0; valid && i < numPaks; i++ ) {
+		pakIndexRecord_t rec;
+		int timeLo = 0, timeHi = 0, entriesSize = -1;
+		valid = ReadPakIndexString( pakIndexFile, rec.pakFilename );
+		pakIndexFile->ReadInt( rec.length );
+		pakIndexFile->ReadInt( timeLo );
+		pakIndexFile->ReadInt( timeHi );
+		pakIndexFile->ReadInt( rec.checksum );
+		pakIndexFile->ReadInt( rec.numfiles );
+		pakIndexFile->ReadInt( entriesSize );
+		rec.timestamp = ( ID_TIME_T )( ( ( uint64_t )( uint32_t )timeHi << 32 ) | ( uint32_t )timeLo );
+		rec.entriesOffset = pakIndexFile->Tell();
+		rec.used = false;
+		if ( !valid || rec.numfiles < 0 || entriesSize < 0 || pakIndexFile->Seek( entriesSize, FS_SEEK_CUR ) != 0 ) {
+			valid = false;
+			break;
+		}
+		pakIndexHash.Add( idStr::Hash( rec.pakFilename ), pakIndexRecords.Append( rec ) );
+	}
+
+	if ( !valid ) {
+		common->Printf( "Pak index %s is outdated or damaged, rebuilding\n", path.c_str() );
+		FreePakIndex();
+		pakIndexDirty = true;
+	}
+}
+
+/*
+================
+idFileSystemLocal::LoadPakFromIndex
+
+Fills directory of the pack from the pak index.
+Returns false if the pak is not in the index or has changed since.
+================
+*/
+bool idFileSystemLocal::LoadPakFromIndex( pack_t *pack ) {
+	if ( !pakIndexFile ) {
+		return false;
+	}
+
+	for ( int i = pakIndexHash.First( idStr::Hash( pack->pakFilename ) ); i != -1; i = pakIndexHash.Next( i ) ) {
+		pakIndexRecord_t &rec = pakIndexRecords[i];
+		if ( rec.pakFilename.Cmp( pack->pakFilename ) != 0 ) {
+			continue;
+		}
+		if ( rec.length != pack->length || rec.timestamp != pack->timestamp || rec.numfiles != pack->numfiles ) {
+			return false;
+		}
+
+		pakIndexFile->Seek( rec.entriesOffset, FS_SEEK_SET );
+		for ( int j = 0; j < pack->numfiles; j++ ) {
+			fileInPack_t &entry = pack->buildBuffer[j];
+			int hash = -1, posLo = 0, posHi = 0;
+			bool ok = ReadPakIndexString( pakIndexFile, entry.name );
+			pakIndexFile->ReadInt( hash );
+			pakIndexFile->ReadInt( posLo );
+			pakIndexFile->ReadInt( posHi );
+			if ( !ok || hash < 0 || hash >= FILE_HASH_SIZE ) {
+				common->Warning( "Pak index entry for %s is damaged", pack->pakFilename.c_str() );
+				for ( int k = 0; k < FILE_HASH_SIZE; k++ ) {
+					pack->hashTable[k] = NULL;
+				}
+				return false;
+			}
+			entry.pos = ( ( ZPOS64_T )( uint32_t )posHi << 32 ) | ( uint32_t )posLo;
+			entry.next = pack->hashTable[hash];
+			pack->hashTable[hash] = &entry;
+		}
+
+		pack->checksum = rec.checksum;
+		rec.used = true;
+		return true;
+	}
+
+	return false;
+}
+
+/*
+================
+idFileSystemLocal::SavePakIndex
+
+Writes directories of all loaded paks, if anything has changed since the index was loaded.
+================
+*/
+void idFileSystemLocal::SavePakIndex( void ) {
+	idList<pack_t *> paks;
+	for ( searchpath_t *loop = searchPaths; loop; loop == searchPaths ? loop = addonPaks : loop = NULL ) {
+		for ( searchpath_t *sp = loop; sp; sp = sp->next ) {
+			if ( sp->pack && !sp->pack->isNew ) {
+				paks.Append( sp->pack );
+			}
+		}
+	}
+	for ( int i = 0; i < pakIndexRecords.Num(); i++ ) {
+		if ( !pakIndexRecords[i].used ) {
+			pakIndexDirty = true;	// pak was removed
+		}
+	}
+
+	// index file must be unmapped before overwriting it
+	FreePakIndex();
+
+	if ( !fs_pakIndex.GetBool() || !pakIndexDirty ) {
+		return;
+	}
+	pakIndexDirty = false;
+
+	idStr path = fs_savepath.GetString();
+	path.AppendPath( PAK_INDEX_FILENAME );
+	idFile *f = OpenExplicitFileWrite( path );
+	if ( !f ) {
+		common->Warning( "Failed to write pak index %s", path.c_str() );
+		return;
+	}
+
+	f->WriteInt( PAK_INDEX_MAGIC );
+	f->WriteInt( PAK_INDEX_VERSION );
+	f->WriteInt( paks.Num() );
+	for ( int i = 0; i < paks.Num(); i++ ) {
+		const pack_t *pak = paks[i];
+		uint64_t timestamp = ( uint64_t )pak->timestamp;
+		int entriesSize = 0;
+		for ( int j = 0; j < pak->numfiles; j++ ) {
+			entriesSize += 4 * sizeof( int ) + pak->buildBuffer[j].name.Length();
+		}
+		f->WriteString( pak->pakFilename );
+		f->WriteInt( pak->length );
+		f->WriteInt( ( int )( timestamp & 0xFFFFFFFF ) );
+		f->WriteInt( ( int )( timestamp >> 32 ) );
+		f->WriteInt( pak->checksum );
+		f->WriteInt( pak->numfiles );
+		f->WriteInt( entriesSize );
+		for ( int j = 0; j < pak->numfiles; j++ ) {
+			const fileInPack_t &entry = pak->buildBuffer[j];
+			f->WriteString( entry.name );
+			f->WriteInt( HashFileName( entry.name ) );
+			f->WriteInt( ( int )( entry.pos & 0xFFFFFFFF ) );
+			f->WriteInt( ( int )( entry.pos >> 32 ) );
+		}
+	}
+	CloseFile( f );
+
+	common->Printf( "Saved pak index with %d paks to %s\n", paks.Num(), path.c_str() );
+}
+
+/*
+================
+idFileSystemLocal::FreePakIndex
+================
+*/
+void idFileSystemLocal::FreePakIndex( void ) {
+	delete pakIndexFile;
+	pakIndexFile = NULL;
+	Sys_UnmapFile( pakIndexData, pakIndexSize );
+	pakIndexData = NULL;
+	pakIndexSize = 0;
+	pakIndexRecords.Clear();
+	pakIndexHash.Clear();
 }
 
 /*
@@ -1912,6 +2213,62 @@ void idFileSystemLocal::TestThreads_f( const idCmdArgs& args ) {
 		tOneThread.Milliseconds(), tManyThreads.Milliseconds(), 
 		tOneThread.Milliseconds() / tManyThreads.Milliseconds()
 	);
+
+	// full read of all files: memory-mapped paks vs minizip
+	// the first pass is not reported, it only brings all paks into the page cache
+	// so that neither measured pass profits from the reads of the other one
+	bool oldMapPaks = fs_mapPaks.GetBool();
+	idList<byte> readBuffer;
+	for ( int pass = -1; pass < 2; pass++ ) {
+		fs_mapPaks.SetBool( pass == 1 );
+		idTimer tFullRead;
+		int64_t totalBytes = 0;
+		tFullRead.Start();
+		for ( auto & file: files ) {
+			auto f = fileSystemLocal.OpenFileRead( file );
+			if ( !f ) {
+				continue;
+			}
+			int len = f->Length();
+			readBuffer.SetNum( len + 1, false );
+			if ( f->Read( readBuffer.Ptr(), len ) != len ) {
+				common->Warning( "File read error: %s", file.c_str() );
+			}
+			totalBytes += len;
+			fileSystemLocal.CloseFile( f );
+		}
+		tFullRead.Stop();
+		if ( pass < 0 ) {
+			continue;
+		}
+		double ms = tFullRead.Milliseconds();
+		common->Printf( "Full read (fs_mapPaks %d): %d files, %0.1lf MB in %0.3lf ms (%0.1lf MB/s)\n",
+			pass, files.Num(), totalBytes / ( 1024.0 * 1024.0 ), ms,
+			ms > 0.0 ? totalBytes / ( 1024.0 * 1024.0 ) / ( ms * 0.001 ) : 0.0
+		);
+	}
+	fs_mapPaks.SetBool( oldMapPaks );
+
+	// same files read asynchronously by I/O threads
+	idTimer tAsyncRead;
+	int64_t asyncBytes = 0;
+	tAsyncRead.Start();
+	idFileReadBatch batch;
+	for ( auto & file: files ) {
+		batch.Add( file, false );
+	}
+	batch.Submit();
+	batch.Wait();
+	for ( int i = 0; i < batch.Num(); i++ ) {
+		asyncBytes += Max( batch[i].bytesRead, 0 );
+	}
+	tAsyncRead.Stop();
+	batch.Release();
+	double asyncMs = tAsyncRead.Milliseconds();
+	common->Printf( "Async read (%d threads): %d files, %0.1lf MB in %0.3lf ms (%0.1lf MB/s)\n",
+		fileSystemLocal.readThreads.Num(), files.Num(), asyncBytes / ( 1024.0 * 1024.0 ), asyncMs,
+		asyncMs > 0.0 ? asyncBytes / ( 1024.0 * 1024.0 ) / ( asyncMs * 0.001 ) : 0.0
+	);
 }
 
 /*
@@ -2294,6 +2651,8 @@ void idFileSystemLocal::Startup( void ) {
 		common->Printf( "restarting filesystem with %d addon pak file(s) to include\n", addonChecksums.Num() );
 	}
 
+	LoadPakIndex();
+
     AddGameDirectory( fs_basepath.GetString(), "", FDOM_CORE ); // always add the basepath
 
     // fs_mod override
@@ -2412,6 +2771,8 @@ void idFileSystemLocal::Startup( void ) {
 		}
 	}
 
+	SavePakIndex();
+
 	// add our commands
 	cmdSystem->AddCommand( "dir", Dir_f, CMD_FL_SYSTEM, "lists a folder", idCmdSystem::ArgCompletion_FileName );
 	cmdSystem->AddCommand( "dirtree", DirTree_f, CMD_FL_SYSTEM, "lists a folder with subfolders" );
@@ -2698,6 +3059,10 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 
 			if ( sp->pack ) {
 				unzClose( sp->pack->handle );
+				if ( sp->pack->mapping ) {
+					// files still open keep their own reference
+					sp->pack->mapping->Release();
+				}
 				delete [] sp->pack->buildBuffer;
 				if ( sp->pack->addon_info ) {
 					sp->pack->addon_info->mapDecls.DeleteContents( true );
@@ -2712,6 +3077,10 @@ void idFileSystemLocal::Shutdown( bool reloading ) {
 		}
 	}
 
+	if ( !reloading ) {
+		StopReadThreads();
+	}
+
 	// any FS_ calls will now be an error until reinitialized
 	searchPaths = NULL;
 	addonPaks = NULL;
@@ -2798,6 +3167,12 @@ idFile_InZip * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pa
 	// relativePath == pakFile->name according to FilenameCompare()
 	// pakFile->Pos is position of that file within the zip
 
+	if ( pak->mapping && fs_mapPaks.GetBool() ) {
+		if ( idFile_InZip *file = ReadFileFromMappedZip( pak, pakFile, relativePath ) ) {
+			return file;
+		}
+	}
+
 	// set position in pk4 file to the file (in the zip/pk4) we want a handle on
 	unzSetOffset64( pak->handle, pakFile->pos );
 
@@ -2827,6 +3202,62 @@ idFile_InZip * idFileSystemLocal::ReadFileFromZip( pack_t *pak, fileInPack_t *pa
 	return file;
 }
 
+/*
+===========
+idFileSystemLocal::ReadFileFromMappedZip
+
+Parses zip headers directly from the mapped pak.
+Returns NULL if the file cannot be read this way (encrypted, zip64, unknown method).
+===========
+*/
+idFile_InZip * idFileSystemLocal::ReadFileFromMappedZip( pack_t *pak, fileInPack_t *pakFile, const char *relativePath ) {
+	const byte *base = pak->mapping->GetData();
+	const uint64_t size = pak->mapping->GetSize();
+
+	// central directory file header
+	const uint64_t cdh = pakFile->pos;
+	if ( cdh + 46 > size || LittleInt( *(const int *)( base + cdh ) ) != 0x02014b50 ) {
+		return NULL;
+	}
+	const int flags = LittleShort( *(const short *)( base + cdh + 8 ) ) & 0xFFFF;
+	const int method = LittleShort( *(const short *)( base + cdh + 10 ) ) & 0xFFFF;
+	const uint32_t compSize = LittleInt( *(const int *)( base + cdh + 20 ) );
+	const uint32_t uncompSize = LittleInt( *(const int *)( base + cdh + 24 ) );
+	const uint32_t localOffset = LittleInt( *(const int *)( base + cdh + 42 ) );
+	if ( ( flags & 1 ) || ( method != 0 && method != Z_DEFLATED ) ) {
+		return NULL;
+	}
+	if ( compSize == 0xFFFFFFFF || uncompSize == 0xFFFFFFFF || localOffset == 0xFFFFFFFF || uncompSize > INT_MAX ) {
+		return NULL;	// zip64
+	}
+
+	// local file header
+	const uint64_t lfh = localOffset;
+	if ( lfh + 30 > size || LittleInt( *(const int *)( base + lfh ) ) != 0x04034b50 ) {
+		return NULL;
+	}
+	const int nameLen = LittleShort( *(const short *)( base + lfh + 26 ) ) & 0xFFFF;
+	const int extraLen = LittleShort( *(const short *)( base + lfh + 28 ) ) & 0xFFFF;
+	const uint64_t dataStart = lfh + 30 + nameLen + extraLen;
+	if ( dataStart + compSize > size ) {
+		return NULL;
+	}
+
+	pak->mapping->AddRef();
+	idFile_InZip *file = new idFile_InZip();
+	file->z = NULL;
+	file->name = relativePath;
+	file->compressed = ( method != 0 );
+	file->fullPath = pak->pakFilename + "/" + relativePath;
+	file->zipFilePos = pakFile->pos;
+	file->fileSize = uncompSize;
+	file->mapping = pak->mapping;
+	file->mapData = base + dataStart;
+	file->mapDataSize = compSize;
+
+	return file;
+}
+
 /*
 ===========
 idFileSystemLocal::OpenFileReadFlags
@@ -2998,6 +3429,13 @@ idFileSystemLocal::OpenFileRead
 ===========
 */
 idFile *idFileSystemLocal::OpenFileRead( const char *relativePath, const char* gamedir ) {
+	if ( !gamedir && relativePath ) {
+		// note: must be checked without global lock, since it may wait for I/O thread
+		if ( idFile *f = OpenPrefetchedFile( relativePath ) ) {
+			return f;
+		}
+	}
+
 	idScopedCriticalSection lock(globalMutex);
     return OpenFileReadFlags( relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS, NULL, gamedir );
 }
@@ -3007,6 +3445,11 @@ idFile * idFileSystemLocal::OpenFileReadPrefetch( const char *relativePath, cons
 	if ( f == nullptr ) {
 		return f;
 	}
+	idFile_InZip *zf = dynamic_cast<idFile_InZip *>( f );
+	if ( zf && zf->IsMappedStored() ) {
+		// stored file in mapped pak: reads copy from the mapping and hold no OS handle
+		return f;
+	}
 	ID_TIME_T timestamp = f->Timestamp();
 	int len = f->Length();
 	void *buffer = Mem_Alloc( len );
@@ -3413,6 +3856,334 @@ void idFileSystemLocal::BackgroundDownload( backgroundDownload_t *bgl ) {
 	}
 }
 
+/*
+=================
+idFileReadThread::Run
+=================
+*/
+int idFileReadThread::Run( void ) {
+	fileSystemLocal.ProcessFileReads();
+	return 0;
+}
+
+/*
+=================
+idFileSystemLocal::LocateFileInPaks
+
+Returns ordinal of the pak in search path which contains the file, or -1 if not in any pak.
+=================
+*/
+int idFileSystemLocal::LocateFileInPaks( const char *relativePath, ZPOS64_T &pos ) {
+	const int hash = HashFileName( relativePath );
+	int ordinal = 0;
+	for ( searchpath_t *search = searchPaths; search; search = search->next, ordinal++ ) {
+		if ( !search->pack || !search->pack->hashTable[hash] ) {
+			continue;
+		}
+		for ( fileInPack_t *pakFile = search->pack->hashTable[hash]; pakFile; pakFile = pakFile->next ) {
+			if ( !FilenameCompare( pakFile->name, relativePath ) ) {
+				pos = pakFile->pos;
+				return ordinal;
+			}
+		}
+	}
+	pos = 0;
+	return -1;
+}
+
+/*
+=================
+idFileSystemLocal::ReadFilesAsync
+=================
+*/
+void idFileSystemLocal::ReadFilesAsync( fileReadRequest_t **requests, int num ) {
+	if ( num <= 0 ) {
+		return;
+	}
+
+	if ( readThreads.Num() == 0 ) {
+		const int numThreads = idMath::ClampInt( 1, 16, fs_ioThreads.GetInteger() );
+		for ( int i = 0; i < numThreads; i++ ) {
+			idFileReadThread *thread = new idFileReadThread();
+			thread->StartWorkerThread( va( "FileRead_%d", i ), CORE_ANY );
+			readThreads.Append( thread );
+		}
+	}
+
+	// sort requests by pak and position inside it, so that one thread reads neighbouring entries in order
+	struct sortedRequest_t {
+		fileReadRequest_t *	request;
+		ZPOS64_T			pos;
+	};
+	idList<sortedRequest_t> sorted;
+	sorted.SetNum( num );
+	{
+		idScopedCriticalSection lock( globalMutex );
+		for ( int i = 0; i < num; i++ ) {
+			fileReadRequest_t *r = requests[i];
+			r->buffer = NULL;
+			r->bytesRead = -1;
+			r->timestamp = FILE_NOT_FOUND_TIMESTAMP;
+			r->completed = false;
+			r->pinCount = 0;
+			r->sortKey = LocateFileInPaks( r->relativePath, sorted[i].pos );
+			sorted[i].request = r;
+		}
+	}
+	std::stable_sort( sorted.Ptr(), sorted.Ptr() + num, []( const sortedRequest_t &a, const sortedRequest_t &b ) -> bool {
+		// files not found in paks go last
+		unsigned int ka = a.request->sortKey, kb = b.request->sortKey;
+		if ( ka != kb ) {
+			return ka < kb;
+		}
+		return a.pos < b.pos;
+	});
+
+	prefetchMutex.Lock();
+	for ( int i = 0; i < num; i++ ) {
+		if ( requests[i]->prefetch && requests[i]->offset == 0 && requests[i]->length < 0 ) {
+			prefetchHash.Add( HashFileName( requests[i]->relativePath ), prefetchRequests.Append( requests[i] ) );
+		}
+	}
+	prefetchMutex.Unlock();
+
+	readQueueMutex.Lock();
+	for ( int i = 0; i < num; i++ ) {
+		readQueue.Append( sorted[i].request );
+	}
+	readQueueMutex.Unlock();
+
+	for ( int i = 0; i < readThreads.Num(); i++ ) {
+		readThreads[i]->SignalWork();
+	}
+}
+
+/*
+=================
+idFileSystemLocal::ProcessFileReads
+
+Called on I/O threads: takes groups of requests from the queue until it is empty.
+=================
+*/
+void idFileSystemLocal::ProcessFileReads( void ) {
+	fileReadRequest_t *group[FILE_READ_GROUP_SIZE];
+
+	while ( 1 ) {
+		int num = 0;
+		readQueueMutex.Lock();
+		while ( readQueueHead < readQueue.Num() && num < FILE_READ_GROUP_SIZE ) {
+			fileReadRequest_t *r = readQueue[readQueueHead];
+			if ( num > 0 && r->sortKey != group[0]->sortKey ) {
+				break;
+			}
+			group[num++] = r;
+			readQueueHead++;
+		}
+		if ( readQueueHead == readQueue.Num() ) {
+			readQueue.SetNum( 0, false );
+			readQueueHead = 0;
+		}
+		readQueueMutex.Unlock();
+
+		if ( num == 0 ) {
+			break;
+		}
+		for ( int i = 0; i < num; i++ ) {
+			ExecuteFileRead( group[i] );
+		}
+	}
+}
+
+/*
+=================
+idFileSystemLocal::ExecuteFileRead
+=================
+*/
+void idFileSystemLocal::ExecuteFileRead( fileReadRequest_t *r ) {
+	TRACE_CPU_SCOPE_STR( "Load:AsyncFile", r->relativePath )
+
+	idFile *f;
+	{
+		// bypass prefetch cache: the request itself may be there
+		idScopedCriticalSection lock( globalMutex );
+		f = OpenFileReadFlags( r->relativePath, FSFLAG_SEARCH_DIRS | FSFLAG_SEARCH_PAKS, NULL );
+	}
+
+	if ( f ) {
+		const int len = f->Length();
+		const int start = idMath::ClampInt( 0, len, r->offset );
+		const int count = ( r->length < 0 ? len - start : Min( r->length, len - start ) );
+		r->buffer = ( byte * )Mem_Alloc( count + 1 );
+		if ( start > 0 ) {
+			f->Seek( start, FS_SEEK_SET );
+		}
+		r->bytesRead = Max( f->Read( r->buffer, count ), 0 );
+		r->buffer[r->bytesRead] = 0;
+		r->timestamp = f->Timestamp();
+		CloseFile( f );
+	}
+
+	if ( r->callback ) {
+		r->callback( r );
+	}
+	std::lock_guard<std::mutex> lock( readDoneMutex );
+	r->completed = true;
+	readDoneCondition.notify_all();
+}
+
+/*
+=================
+idFileSystemLocal::WaitFileReads
+=================
+*/
+void idFileSystemLocal::WaitFileReads( fileReadRequest_t **requests, int num ) {
+	std::unique_lock<std::mutex> lock( readDoneMutex );
+	for ( int i = 0; i < num; i++ ) {
+		fileReadRequest_t *r = requests[i];
+		readDoneCondition.wait( lock, [r]() { return r->completed; } );
+	}
+}
+
+/*
+=================
+idFileSystemLocal::ReleaseFileReads
+=================
+*/
+void idFileSystemLocal::ReleaseFileReads( fileReadRequest_t **requests, int num ) {
+	WaitFileReads( requests, num );
+
+	prefetchMutex.Lock();
+	bool removed = false;
+	for ( int i = 0; i < num; i++ ) {
+		int index = prefetchRequests.FindIndex( requests[i] );
+		if ( index >= 0 ) {
+			prefetchRequests.RemoveIndex( index, false );
+			removed = true;
+		}
+	}
+	if ( removed ) {
+		prefetchHash.Clear();
+		for ( int i = 0; i < prefetchRequests.Num(); i++ ) {
+			prefetchHash.Add( HashFileName( prefetchRequests[i]->relativePath ), i );
+		}
+	}
+	prefetchMutex.Unlock();
+
+	{
+		// requests are no longer visible to OpenPrefetchedFile, wait until it is done copying the ones it found
+		std::unique_lock<std::mutex> lock( readDoneMutex );
+		for ( int i = 0; i < num; i++ ) {
+			fileReadRequest_t *r = requests[i];
+			readDoneCondition.wait( lock, [r]() { return r->pinCount == 0; } );
+		}
+	}
+
+	for ( int i = 0; i < num; i++ ) {
+		Mem_Free( requests[i]->buffer );
+		requests[i]->buffer = NULL;
+	}
+}
+
+/*
+=================
+idFileSystemLocal::OpenPrefetchedFile
+
+Returns in-memory file if it was requested with prefetch, waiting for it if necessary.
+The request is pinned while its data is copied, so that ReleaseFileReads cannot free it meanwhile.
+=================
+*/
+idFile *idFileSystemLocal::OpenPrefetchedFile( const char *relativePath ) {
+	fileReadRequest_t *found = NULL;
+	prefetchMutex.Lock();
+	if ( prefetchRequests.Num() > 0 ) {
+		for ( int i = prefetchHash.First( HashFileName( relativePath ) ); i != -1; i = prefetchHash.Next( i ) ) {
+			if ( !FilenameCompare( prefetchRequests[i]->relativePath, relativePath ) ) {
+				found = prefetchRequests[i];
+				std::lock_guard<std::mutex> lock( readDoneMutex );
+				found->pinCount++;
+				break;
+			}
+		}
+	}
+	prefetchMutex.Unlock();
+
+	if ( !found ) {
+		return NULL;
+	}
+	WaitFileReads( &found, 1 );
+
+	idFile_Memory *file = NULL;
+	if ( found->bytesRead >= 0 ) {
+		// the file owns its copy: the request buffer is freed when the owner of the request releases it
+		char *data = ( char * )Mem_Alloc( found->bytesRead + 1 );
+		memcpy( data, found->buffer, found->bytesRead + 1 );
+		file = new idFile_Memory( relativePath, data, found->bytesRead, true );
+		file->SetTimestamp( found->timestamp );
+	}
+
+	std::lock_guard<std::mutex> lock( readDoneMutex );
+	found->pinCount--;
+	readDoneCondition.notify_all();
+	return file;
+}
+
+/*
+=================
+idFileSystemLocal::StopReadThreads
+=================
+*/
+void idFileSystemLocal::StopReadThreads( void ) {
+	for ( int i = 0; i < readThreads.Num(); i++ ) {
+		readThreads[i]->StopThread();
+	}
+	readThreads.DeleteContents( true );
+}
+
+/*
+=================
+idFileReadBatch::Add
+=================
+*/
+fileReadRequest_t &idFileReadBatch::Add( const char *relativePath, bool prefetch ) {
+	fileReadRequest_t *r = new fileReadRequest_t;
+	r->relativePath = relativePath;
+	r->prefetch = prefetch;
+	requests.Append( r );
+	return *r;
+}
+
+/*
+=================
+idFileReadBatch::Submit
+
+Submits all requests added since previous call
+=================
+*/
+void idFileReadBatch::Submit( void ) {
+	fileSystem->ReadFilesAsync( requests.Ptr() + numSubmitted, requests.Num() - numSubmitted );
+	numSubmitted = requests.Num();
+}
+
+/*
+=================
+idFileReadBatch::Wait
+=================
+*/
+void idFileReadBatch::Wait( void ) {
+	fileSystem->WaitFileReads( requests.Ptr(), numSubmitted );
+}
+
+/*
+=================
+idFileReadBatch::Release
+=================
+*/
+void idFileReadBatch::Release( void ) {
+	fileSystem->ReleaseFileReads( requests.Ptr(), numSubmitted );
+	requests.DeleteContents( true );
+	numSubmitted = 0;
+}
+
 /*
 =================
 idFileSystemLocal::FindPakForFileChecksum
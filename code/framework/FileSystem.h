@@ -97,6 +97,31 @@ typedef struct backgroundDownload_s {
 	volatile bool		completed;
 } backgroundDownload_t;
 
+// asynchronous read of a file (or its part), see idFileSystem::ReadFilesAsync
+struct fileReadRequest_t;
+typedef void ( *fileReadCallback_t )( fileReadRequest_t *request );
+
+struct fileReadRequest_t {
+	// set by the caller
+	idStr				relativePath;
+	int					offset;			// start of the range to read
+	int					length;			// -1 means until end of file
+	bool				prefetch;		// OpenFileRead/ReadFile take whole file from this request until it is released
+	fileReadCallback_t	callback;		// called on I/O thread when the request is completed (can be NULL)
+	void *				userData;
+	// set by the fileSystem
+	byte *				buffer;			// data read, zero-terminated (freed on release)
+	int					bytesRead;		// -1 if file was not found
+	ID_TIME_T			timestamp;
+	volatile bool		completed;
+	int					sortKey;		// ordinal of pak containing the file, used to group requests
+	int					pinCount;		// number of OpenFileRead calls copying the data right now
+
+						fileReadRequest_t( void ) :
+							offset( 0 ), length( -1 ), prefetch( false ), callback( NULL ), userData( NULL ),
+							buffer( NULL ), bytesRead( -1 ), timestamp( FILE_NOT_FOUND_TIMESTAMP ), completed( false ), sortKey( 0 ), pinCount( 0 ) {}
+};
+
 // file list for directory listings
 class idFileList {
 	friend class idFileSystemLocal;
@@ -200,6 +225,14 @@ public:
 	virtual void			CloseFile( idFile *f ) = 0;
 							// Returns immediately, performing the read from a background thread.
 	virtual void			BackgroundDownload( backgroundDownload_t *bgl ) = 0;
+							// Returns immediately, reading files on a pool of I/O threads.
+							// Files located next to each other in the same pk4 are read by one thread in order.
+							// Requests must stay alive until released.
+	virtual void			ReadFilesAsync( fileReadRequest_t **requests, int num ) = 0;
+							// Blocks until all the given requests are completed.
+	virtual void			WaitFileReads( fileReadRequest_t **requests, int num ) = 0;
+							// Waits for the requests, frees their data and removes them from prefetch cache.
+	virtual void			ReleaseFileReads( fileReadRequest_t **requests, int num ) = 0;
 							// resets the bytes read counter
 	virtual void			ResetReadCount( void ) = 0;
 							// retrieves the current read count
@@ -243,4 +276,32 @@ public:
 
 extern idFileSystem *		fileSystem;
 
+/*
+===============================================================================
+
+	Convenience wrapper for a batch of asynchronous file reads.
+	With prefetch enabled, loaders can keep using OpenFileRead/ReadFile:
+	they get the data read ahead by I/O threads (or wait for it to arrive).
+
+===============================================================================
+*/
+
+class idFileReadBatch {
+public:
+							idFileReadBatch( void ) : numSubmitted( 0 ) {}
+							~idFileReadBatch( void ) { Release(); }
+
+	fileReadRequest_t &		Add( const char *relativePath, bool prefetch = true );
+	int						Num( void ) const { return requests.Num(); }
+	fileReadRequest_t &		operator[]( int index ) { return *requests[index]; }
+
+	void					Submit( void );
+	void					Wait( void );
+	void					Release( void );
+
+private:
+	idList<fileReadRequest_t *>	requests;
+	int						numSubmitted;
+};
+
 #endif /* !__FILESYSTEM_H__ */
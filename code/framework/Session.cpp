@@ -294,6 +294,8 @@ void idSessionLocal::Clear() {
 	guiActive = NULL;
 	aviCaptureMode = false;
 	timeDemo = TD_NO;
+	benchmarkDemoFile.Clear();
+	benchmarkSkipBackEnd = false;
 	waitingOnBind = false;
 	lastPacifierTime = 0;
 	
@@ -646,6 +648,20 @@ static void Session_TimeDemo_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+================
+Session_BenchmarkDemo_f
+================
+*/
+static void Session_BenchmarkDemo_f( const idCmdArgs &args ) {
+	if ( args.Argc() < 2 ) {
+		common->Printf( "usage: benchmarkDemo <demoName> [outputFile]\n" );
+		common->Printf( "start the game with +set r_headless 1 to run it without a GPU\n" );
+		return;
+	}
+	sessLocal.BenchmarkRenderDemo( va( "demos/%s", args.Argv(1) ), args.Argc() > 2 ? args.Argv(2) : NULL );
+}
+
 /*
 ================
 Session_TimeDemoQuit_f
@@ -828,9 +844,16 @@ void idSessionLocal::StopPlayingRenderDemo() {
 	soundSystem->SetPlayingSoundWorld( menuSoundWorld );
 
 	common->Printf( "stopped playing %s.\n", readDemo->GetName() );
+	idStr demoName = readDemo->GetName();
 	delete readDemo;
 	readDemo = NULL;
 
+	if ( benchmarkDemoFile.Length() ) {
+		tr.EndFrontEndBenchmark( demoName, benchmarkDemoFile );
+		r_skipBackEnd.SetBool( benchmarkSkipBackEnd );
+		benchmarkDemoFile.Clear();
+	}
+
 	if ( timeDemo ) {
 		// report the stats
 		float	demoSeconds = ( timeDemoStopTime - timeDemoStartTime ) * 0.001f;
@@ -958,6 +981,38 @@ void idSessionLocal::TimeRenderDemo( const char *demoName, bool twice ) {
 }
 
 
+/*
+================
+idSessionLocal::BenchmarkRenderDemo
+
+Times a demo through the frontend with the backend skipped, writes the frontend
+statistics of every frame to a file, and quits.
+Start with +set r_headless 1 to run it without a window or GL context.
+================
+*/
+void idSessionLocal::BenchmarkRenderDemo( const char *demoName, const char *outputName ) {
+	idStr output = outputName ? outputName : "";
+	if ( output.IsEmpty() ) {
+		idStr base;
+		idStr( demoName ).ExtractFileBase( base );
+		output = va( "benchmarks/%s.json", base.c_str() );
+	}
+
+	benchmarkSkipBackEnd = r_skipBackEnd.GetBool();
+	r_skipBackEnd.SetBool( true );
+
+	// the first pass loads everything, so only the second one is recorded
+	TimeRenderDemo( demoName, true );
+	if ( !readDemo ) {
+		r_skipBackEnd.SetBool( benchmarkSkipBackEnd );
+		return;
+	}
+
+	timeDemo = TD_YES_THEN_QUIT;
+	benchmarkDemoFile = output;
+	tr.BeginFrontEndBenchmark();
+}
+
 /*
 ================
 idSessionLocal::BeginAVICapture
@@ -3327,6 +3382,7 @@ void idSessionLocal::Init() {
 	cmdSystem->AddCommand( "playDemo", Session_PlayDemo_f, CMD_FL_SYSTEM, "plays back a demo", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "timeDemo", Session_TimeDemo_f, CMD_FL_SYSTEM, "times a demo", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "timeDemoQuit", Session_TimeDemoQuit_f, CMD_FL_SYSTEM, "times a demo and quits", idCmdSystem::ArgCompletion_DemoName );
+	cmdSystem->AddCommand( "benchmarkDemo", Session_BenchmarkDemo_f, CMD_FL_SYSTEM, "times a demo through the frontend only, writes frontend statistics per frame and quits", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "aviDemo", Session_AVIDemo_f, CMD_FL_SYSTEM, "writes AVIs for a demo", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "compressDemo", Session_CompressDemo_f, CMD_FL_SYSTEM, "compresses a demo file", idCmdSystem::ArgCompletion_DemoName );
 
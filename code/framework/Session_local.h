@@ -253,6 +253,8 @@ public:
 	timeDemo_t			timeDemo;
 	int					timeDemoStartTime;
 	int					numDemoFrames;		// for timeDemo and demoShot
+	idStr				benchmarkDemoFile;	// if not empty, frontend statistics of the timed demo are written here
+	bool				benchmarkSkipBackEnd;	// r_skipBackEnd before benchmarkDemo
 	int					demoTimeOffset;
 	renderView_t		currentDemoRenderView;
 	// the next one will be read when 
@@ -318,6 +320,7 @@ public:
 	void				StopPlayingRenderDemo();
 	void				CompressDemoFile( const char *scheme, const char *name );
 	void				TimeRenderDemo( const char *name, bool twice = false );
+	void				BenchmarkRenderDemo( const char *name, const char *outputName );
 	void				AVIRenderDemo( const char *name );
 	void				AVICmdDemo( const char *name );
 	void				AVIGame( const char *name );
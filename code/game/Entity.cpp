@@ -1019,6 +1019,8 @@ idEntity::idEntity()
 	spawnNode.SetOwner( this );
 	activeIdx = -1;
 	lodIdx = -1;
+	islandSolverFrame = -1;
+	islandSolverMoved = false;
 
 	snapshotNode.SetOwner( this );
 	snapshotSequence = -1;
@@ -5403,6 +5405,11 @@ bool idEntity::RunPhysics( void ) {
 		return false;
 	}
 
+	// physics has already been run this frame by the island solver (see idIslandSolver)
+	if ( islandSolverFrame == gameLocal.framenum ) {
+		return islandSolverMoved;
+	}
+
 	// angua: since the AI are not thinking every frame, we need to rescale 
 	// their velocities with the corrected time length to prevent them from dying.
 	if (IsType(idAI::Type))
@@ -257,6 +257,8 @@ public:
 	idLinkList<idEntity>	spawnNode;				// for being linked into spawnedEntities list
 	int						activeIdx;				// for being linked into activeEntities list
 	int						lodIdx;					// for being linked into lodSystem
+	int						islandSolverFrame;		// framenum in which the island solver has already run physics of this entity
+	bool					islandSolverMoved;		// value returned by RunPhysics when it was run by the island solver
 
 	idLinkList<idEntity>	snapshotNode;			// for being linked into snapshotEntities list
 	int						snapshotSequence;		// last snapshot this entity was in
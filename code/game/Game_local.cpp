@@ -711,6 +711,8 @@ void idGameLocal::Shutdown( void ) {
 
 	idAI::FreeObstacleAvoidanceNodes();
 
+	islandSolver.Shutdown();
+
 	// shutdown the model exporter
 	idModelExport::Shutdown();
 
@@ -2482,6 +2484,8 @@ void idGameLocal::MapShutdown( void ) {
 
 	pvs.Shutdown();
 
+	islandSolver.Clear();
+
 	// Remove the grabber entity itself (note that it's safe to pass NULL pointers to delete)
 	delete m_Grabber;
 	m_Grabber = NULL;
@@ -3340,6 +3344,9 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds, int timestepMs,
 			timer_think.Clear();
 			timer_think.Start();
 
+			// run physics of free articulated figures concurrently
+			islandSolver.RunPhysics();
+
 			{ // let entities think
 				TRACE_CPU_SCOPE( "ThinkAllEntities" )
 				num = 0;
@@ -3393,6 +3400,8 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds, int timestepMs,
 			}
 
 			timer_think.Stop();
+
+			islandSolver.UpdateBenchmark( timer_think.Milliseconds() );
 		
 			//DM_LOG(LC_ENTITY, LT_INFO)LOGSTRING("Thinking timer: %lfms\r", timer_think.Milliseconds());
 
@@ -6843,6 +6852,7 @@ idGameLocal::SetPortalState
 */
 void idGameLocal::SetPortalState( qhandle_t portal, int blockingBits ) {
 	gameRenderWorld->SetPortalState( portal, blockingBits );
+	pvs.InvalidateConnectivity();
 }
 
 /*
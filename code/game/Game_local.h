@@ -426,6 +426,7 @@ struct SuspiciousEvent
 #include "SearchManager.h" // grayman #3857 - must follow the definition of "EventType"
 #include "Entity.h"
 #include "EntityList.h"
+#include "physics/IslandSolver.h"
 
 class idDeclEntityDef;
 
@@ -495,6 +496,7 @@ public:
 
 	idClip					clip;					// collision detection
 	idPush					push;					// geometric pushing
+	idIslandSolver			islandSolver;			// concurrent physics of articulated figures
 	idPVS					pvs;					// potential visible set
 
 	idTestModel *			testmodel;				// for development testing of models
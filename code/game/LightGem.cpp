@@ -19,6 +19,7 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 
 
 #include "LightGem.h"
+#include "Grabber.h"
 #include "../renderer/tr_local.h"
 
 //------------------------
@@ -28,6 +29,10 @@ LightGem::LightGem()
 {
 	m_LightgemImgBufferFrontend = (byte*)Mem_Alloc16( DARKMOD_LG_RENDER_WIDTH * DARKMOD_LG_RENDER_WIDTH * DARKMOD_LG_BPP * 4 );
 	m_LightgemImgBufferBackend = (byte*)Mem_Alloc16( DARKMOD_LG_RENDER_WIDTH * DARKMOD_LG_RENDER_WIDTH * DARKMOD_LG_BPP * 4 );
+	m_AnalyticActive = false;
+	memset(m_AnalyticHistory, 0, sizeof(m_AnalyticHistory));
+	m_BenchmarkNumFrames = 0;
+	m_BenchmarkFrames = 0;
 }
 
 LightGem::~LightGem()
@@ -46,6 +51,12 @@ void LightGem::Clear()
 	m_LightgemShotSpot = 0;
 
 	memset(m_LightgemShotValue, 0, sizeof(m_LightgemShotValue));
+
+	// images may be purged between maps
+	m_AnalyticActive = false;
+	memset(m_AnalyticHistory, 0, sizeof(m_AnalyticHistory));
+	m_AnalyticImages.Clear();
+	m_BenchmarkFrames = 0;
 }
 
 void LightGem::SpawnLightGemEntity( idMapFile *	a_mapFile )
@@ -127,15 +138,49 @@ void LightGem::Restore( idRestoreGame & a_savedGame )
 // Calculation
 //----------------------------------------------------
 
+idVec3 LightGem::GetPosition(idPlayer *player) const
+{
+	const idVec3& Cam = player->GetEyePosition();
+	idVec3 LGPos = player->GetPhysics()->GetOrigin();// Set the lightgem position to that of the player
+
+	LGPos.x += (Cam.x - LGPos.x) * 0.3f + cv_lg_oxoffs.GetFloat(); // Move the lightgem out a fraction along the leaning x vector
+	LGPos.y += (Cam.y - LGPos.y) * 0.3f + cv_lg_oyoffs.GetFloat(); // Move the lightgem out a fraction along the leaning y vector
+	
+	// Prevent lightgem from clipping into the floor while crouching
+	if ( player->GetPlayerPhysics()->IsCrouching() ) {
+		LGPos.z += 50.0f + cv_lg_ozoffs.GetFloat() ;
+	} else {
+		LGPos.z = Cam.z + cv_lg_ozoffs.GetFloat(); // Set the lightgem's Z-axis position to that of the player's eyes
+	}
+
+	return LGPos;
+}
+
+bool LightGem::NeedsRenderView() const
+{
+	// the benchmark needs the rendered values to compare against
+	return !cv_lg_analytic.GetBool() || m_BenchmarkFrames > 0;
+}
+
 float LightGem::Calculate(idPlayer *player)
 {
-	// analyze rendered shot from previous frame
-	AnalyzeRenderImage();
-	m_LightgemShotValue[m_LightgemShotSpot] = 0.0f;
-	// Check which of the images has the brightest value, and this is what we will use.
-	for (int l = 0; l < DARKMOD_LG_MAX_IMAGESPLIT; l++) {
-		if (m_fColVal[l] > m_LightgemShotValue[m_LightgemShotSpot]) {
-			m_LightgemShotValue[m_LightgemShotSpot] = m_fColVal[l];
+	const bool analytic = cv_lg_analytic.GetBool();
+
+	if ( NeedsRenderView() ) {
+		const uint64_t analyzeStart = Sys_GetTimeMicroseconds();
+
+		// analyze rendered shot from previous frame
+		AnalyzeRenderImage();
+		m_LightgemShotValue[m_LightgemShotSpot] = 0.0f;
+		// Check which of the images has the brightest value, and this is what we will use.
+		for (int l = 0; l < DARKMOD_LG_MAX_IMAGESPLIT; l++) {
+			if (m_fColVal[l] > m_LightgemShotValue[m_LightgemShotSpot]) {
+				m_LightgemShotValue[m_LightgemShotSpot] = m_fColVal[l];
+			}
+		}
+
+		if ( m_BenchmarkFrames > 0 ) {
+			m_BenchmarkRenderTime += Sys_GetTimeMicroseconds() - analyzeStart;
 		}
 	}
 
@@ -144,25 +189,10 @@ float LightGem::Calculate(idPlayer *player)
 		return 0.0f;
 	}
 	
-	// Get position for lg
 	idEntity* lg = m_LightgemSurface.GetEntity();
 	// duzenko #4408 - this happens at map start if no game tics ran in background yet
 	if (lg->GetModelDefHandle() == -1) 
 		return 0.0f;
-	renderEntity_t* lgent = lg->GetRenderEntity();
-
-	const idVec3& Cam = player->GetEyePosition();
-	idVec3 LGPos = player->GetPhysics()->GetOrigin();// Set the lightgem position to that of the player
-
-	LGPos.x += (Cam.x - LGPos.x) * 0.3f + cv_lg_oxoffs.GetFloat(); // Move the lightgem out a fraction along the leaning x vector
-	LGPos.y += (Cam.y - LGPos.y) * 0.3f + cv_lg_oyoffs.GetFloat(); // Move the lightgem out a fraction along the leaning y vector
-	
-	// Prevent lightgem from clipping into the floor while crouching
-	if ( player->GetPlayerPhysics()->IsCrouching() ) {
-		LGPos.z += 50.0f + cv_lg_ozoffs.GetFloat() ;
-	} else {
-		LGPos.z = Cam.z + cv_lg_ozoffs.GetFloat(); // Set the lightgem's Z-axis position to that of the player's eyes
-	}
 
 	m_LightgemShotSpot = (m_LightgemShotSpot + 1) % DARKMOD_LG_MAX_RENDERPASSES;
 
@@ -174,6 +204,33 @@ float LightGem::Calculate(idPlayer *player)
 		}
 	}
 
+	if ( analytic || m_BenchmarkFrames > 0 ) {
+		const uint64_t analyticStart = Sys_GetTimeMicroseconds();
+		const float estimate = EstimateAnalytic( GetPosition( player ), player );
+		const uint64_t analyticTime = Sys_GetTimeMicroseconds() - analyticStart;
+
+		if ( m_BenchmarkFrames > 0 ) {
+			// compare before the history is updated: the rendered value comes from the views of the previous frames
+			UpdateBenchmark( fRetVal, analyticTime );
+		}
+
+		for (int i = DARKMOD_LG_MAX_RENDERPASSES - 1; i > 0; i--) {
+			m_AnalyticHistory[i] = m_AnalyticHistory[i - 1];
+		}
+		m_AnalyticHistory[0] = estimate;
+
+		if ( analytic ) {
+			fRetVal = estimate * cv_lg_analytic_scale.GetFloat();
+		}
+	}
+
+	if ( m_AnalyticActive && !analytic ) {
+		// the render buffers were not updated while the estimate was used
+		m_LightgemOverrideFrames = DARKMOD_LG_PAUSE;
+		m_LightgemOverrideValue = m_AnalyticHistory[0] * cv_lg_analytic_scale.GetFloat();
+	}
+	m_AnalyticActive = analytic;
+
 	if (m_LightgemOverrideFrames > 0) {
 		// #6088: return old value for now
 		m_LightgemOverrideFrames--;
@@ -242,3 +299,294 @@ void LightGem::AnalyzeRenderImage()
 	m_fColVal[2] *= DARKMOD_LG_TRIRATIO * DARKMOD_LG_SCALE;
 	m_fColVal[3] *= DARKMOD_LG_TRIRATIO * DARKMOD_LG_SCALE;
 }
+
+//----------------------------------------------------
+// Analytic estimate
+//----------------------------------------------------
+
+// normals of the lightgem octahedron: 4 upper faces seen by the first render pass, 4 lower faces seen by the second
+static const idVec3 lgFaceNormals[DARKMOD_LG_ANALYTIC_FACES] = {
+	idVec3(  0.70710678f,  0.0f,  0.70710678f ),
+	idVec3( -0.70710678f,  0.0f,  0.70710678f ),
+	idVec3(  0.0f,  0.70710678f,  0.70710678f ),
+	idVec3(  0.0f, -0.70710678f,  0.70710678f ),
+	idVec3(  0.70710678f,  0.0f, -0.70710678f ),
+	idVec3( -0.70710678f,  0.0f, -0.70710678f ),
+	idVec3(  0.0f,  0.70710678f, -0.70710678f ),
+	idVec3(  0.0f, -0.70710678f, -0.70710678f ),
+};
+
+float LightGem::EstimateAnalytic(const idVec3 &pos, idEntity *ignore)
+{
+	idRenderWorldLocal *world = static_cast<idRenderWorldLocal *>( gameRenderWorld );
+	const int areaNum = world->GetAreaAtPoint( pos );
+	if ( areaNum < 0 ) {
+		return 0.0f;
+	}
+
+	// light shaders are evaluated at the same time as in the lightgem view
+	viewDef_t view;
+	memset( &view, 0, sizeof( view ) );
+	view.renderView.time = gameLocal.GetTime();
+	view.floatTime = MS2SEC( view.renderView.time );
+
+	idVec3 faceLight[DARKMOD_LG_ANALYTIC_FACES];
+	for ( int f = 0; f < DARKMOD_LG_ANALYTIC_FACES; f++ ) {
+		faceLight[f].Zero();
+	}
+
+	const idList<int> &lightRefs = world->portalAreas[areaNum].lightRefs;
+	for ( int i = 0; i < lightRefs.Num(); i++ ) {
+		const idRenderLightLocal *ldef = world->lightDefs[lightRefs[i]];
+		if ( !ldef ) {
+			continue;
+		}
+		const idMaterial *lightShader = ldef->lightShader;
+		if ( lightShader->IsFogLight() || lightShader->IsBlendLight() ) {
+			continue;
+		}
+
+		// same suppression rules as for the lightgem view (see R_PrepareSingleLight)
+		const renderLight_t &parms = ldef->parms;
+		if ( parms.suppressLightInViewID && parms.suppressLightInViewID == VID_LIGHTGEM ) {
+			continue;
+		}
+		if ( parms.allowLightInViewID && parms.allowLightInViewID != VID_LIGHTGEM ) {
+			continue;
+		}
+		if ( parms.suppressInSubview & 1 ) {
+			continue;
+		}
+
+		// light texture coordinates of the lightgem, the same checks as in projFalloffOfNormalLight
+		const float s = ldef->lightProject[0].Distance( pos );
+		const float t = ldef->lightProject[1].Distance( pos );
+		const float q = ldef->lightProject[2].Distance( pos );
+		const float falloff = ldef->lightProject[3].Distance( pos );
+		if ( q <= 0.0f || s < 0.0f || s > q || t < 0.0f || t > q || falloff < 0.0f || falloff > 1.0f ) {
+			continue;
+		}
+
+		m_AnalyticRegisters.SetNum( lightShader->GetNumRegisters(), false );
+		float *lightRegs = m_AnalyticRegisters.Ptr();
+		lightShader->EvaluateRegisters( lightRegs, parms.shaderParms, &view, parms.referenceSound );
+
+		idVec3 lightColor = vec3_zero;
+		for ( int j = 0; j < lightShader->GetNumStages(); j++ ) {
+			const shaderStage_t *stage = lightShader->GetStage( j );
+			if ( !lightRegs[stage->conditionRegister] ) {
+				continue;
+			}
+			const int *registers = stage->color.registers;
+			idVec3 stageColor(
+				Max( lightRegs[registers[0]], 0.0f ),
+				Max( lightRegs[registers[1]], 0.0f ),
+				Max( lightRegs[registers[2]], 0.0f )
+			);
+
+			if ( lightShader->IsCubicLight() ) {
+				// the cubemap is not sampled, only the attenuation of projFalloffOfCubicLight is applied
+				const idVec3 cubeTC( s * 2.0f - 1.0f, t * 2.0f - 1.0f, falloff * 2.0f - 1.0f );
+				const float att = idMath::ClampFloat( 0.0f, 1.0f, 1.0f - cubeTC.Length() );
+				stageColor *= att * att;
+			} else if ( const imageBlock_s *projection = GetCpuImage( stage->texture.image ) ) {
+				const idVec4 texel = projection->Sample( s / q, t / q, TF_LINEAR, TR_CLAMP );
+				stageColor.x *= texel.x;
+				stageColor.y *= texel.y;
+				stageColor.z *= texel.z;
+			}
+			lightColor += stageColor;
+		}
+
+		if ( !lightShader->IsCubicLight() ) {
+			if ( const imageBlock_s *falloffImage = GetCpuImage( ldef->falloffImage ) ) {
+				const idVec4 texel = falloffImage->Sample( falloff, 0.5f, TF_LINEAR, TR_CLAMP );
+				lightColor.x *= texel.x;
+				lightColor.y *= texel.y;
+				lightColor.z *= texel.z;
+			}
+		}
+
+		if ( lightColor.x <= 0.0f && lightColor.y <= 0.0f && lightColor.z <= 0.0f ) {
+			continue;
+		}
+
+		// shadows are only traced for the lights which reach the lightgem
+		if ( !parms.noShadows && lightShader->LightCastsShadows() && !TraceLightVisible( pos, ldef->globalLightOrigin, ignore ) ) {
+			continue;
+		}
+
+		if ( lightShader->IsAmbientLight() ) {
+			// ambient lights do not depend on the orientation of the surface
+			for ( int f = 0; f < DARKMOD_LG_ANALYTIC_FACES; f++ ) {
+				faceLight[f] += lightColor;
+			}
+		} else {
+			idVec3 lightDir = ldef->globalLightOrigin - pos;
+			lightDir.Normalize();
+			for ( int f = 0; f < DARKMOD_LG_ANALYTIC_FACES; f++ ) {
+				const float cosine = lgFaceNormals[f] * lightDir;
+				if ( cosine > 0.0f ) {
+					faceLight[f] += lightColor * cosine;
+				}
+			}
+		}
+	}
+
+	// the render target saturates every channel, and the brightest face is taken
+	float result = 0.0f;
+	for ( int f = 0; f < DARKMOD_LG_ANALYTIC_FACES; f++ ) {
+		const float value = idMath::ClampFloat( 0.0f, 1.0f, faceLight[f].x ) * DARKMOD_LG_RED +
+							idMath::ClampFloat( 0.0f, 1.0f, faceLight[f].y ) * DARKMOD_LG_GREEN +
+							idMath::ClampFloat( 0.0f, 1.0f, faceLight[f].z ) * DARKMOD_LG_BLUE;
+		result = Max( result, value );
+	}
+
+	return result;
+}
+
+bool LightGem::TraceLightVisible(const idVec3 &pos, const idVec3 &lightOrigin, idEntity *ignore) const
+{
+	trace_t trace;
+	idVec3 start = pos;
+	const idEntity *heldEnt = gameLocal.m_Grabber->GetSelected();
+
+	// continue through the entities which don't cast shadows, like darkModLAS::traceLightPath does
+	for ( int i = 0; i < DARKMOD_LG_MAX_OCCLUDERS; i++ ) {
+		gameLocal.clip.TracePoint( trace, start, lightOrigin, CONTENTS_OPAQUE, ignore );
+		if ( trace.fraction >= 1.0f ) {
+			return true;
+		}
+		if ( trace.c.entityNum == ENTITYNUM_WORLD ) {
+			return false;
+		}
+
+		idEntity *ent = ( trace.c.entityNum >= 0 && trace.c.entityNum < MAX_GENTITIES ) ? gameLocal.entities[trace.c.entityNum] : NULL;
+		if ( ent && ent != heldEnt && ent->GetModelDefHandle() != -1 && !ent->GetRenderEntity()->noShadow ) {
+			// the fixture around the light does not shadow it
+			if ( !ent->GetPhysics()->GetAbsBounds().ContainsPoint( lightOrigin ) ) {
+				return false;
+			}
+		}
+
+		start = trace.endpos;
+		ignore = ent;
+	}
+
+	return true;
+}
+
+const imageBlock_s *LightGem::GetCpuImage(const idImage *image)
+{
+	if ( !image ) {
+		return NULL;
+	}
+
+	idImageAsset *cpuImage = NULL;
+	int i;
+	for ( i = 0; i < m_AnalyticImages.Num(); i++ ) {
+		if ( m_AnalyticImages[i].image == image ) {
+			cpuImage = m_AnalyticImages[i].cpuImage;
+			break;
+		}
+	}
+
+	if ( i == m_AnalyticImages.Num() ) {
+		idImageAsset *asset = const_cast<idImage *>( image )->AsAsset();
+		if ( asset && asset->cpuData.IsValid() ) {
+			cpuImage = asset;
+		} else if ( asset && !asset->source.generatorFunction && asset->source.cubeFiles == CF_2D ) {
+			// nearest filtering keeps this copy apart from the texture used for rendering
+			cpuImage = globalImages->ImageFromFile( asset->imgName, TF_NEAREST, false, TR_CLAMP, TD_HIGH_QUALITY, CF_2D, IR_CPU );
+		}
+		cpuImage_t &entry = m_AnalyticImages.Alloc();
+		entry.image = image;
+		entry.cpuImage = cpuImage;
+	}
+
+	// white if the image data is not available
+	if ( !cpuImage || !cpuImage->cpuData.IsValid() || cpuImage->cpuData.IsCubemap() ) {
+		return NULL;
+	}
+	return &cpuImage->cpuData;
+}
+
+//----------------------------------------------------
+// Benchmark
+//----------------------------------------------------
+
+void LightGem::AddRenderTime(uint64_t microseconds)
+{
+	if ( m_BenchmarkFrames > 0 ) {
+		m_BenchmarkRenderTime += microseconds;
+		m_BenchmarkRenderCalls++;
+	}
+}
+
+void LightGem::StartBenchmark(int numFrames)
+{
+	m_BenchmarkNumFrames = numFrames;
+	m_BenchmarkFrames = numFrames;
+	// the render buffers may be stale if the analytic estimate was used
+	m_BenchmarkWarmup = DARKMOD_LG_PAUSE;
+	m_BenchmarkSamples = 0;
+	m_BenchmarkAbsError = 0.0;
+	m_BenchmarkMaxError = 0.0f;
+	m_BenchmarkRenderDotEstimate = 0.0;
+	m_BenchmarkEstimateSqr = 0.0;
+	m_BenchmarkAnalyticTime = 0;
+	m_BenchmarkRenderTime = 0;
+	m_BenchmarkRenderCalls = 0;
+	gameLocal.Printf( "Lightgem benchmark started for %d frames\n", numFrames );
+}
+
+void LightGem::UpdateBenchmark(float rendered, uint64_t analyticTime)
+{
+	m_BenchmarkAnalyticTime += analyticTime;
+
+	if ( m_BenchmarkWarmup > 0 ) {
+		m_BenchmarkWarmup--;
+	} else if ( m_LightgemOverrideFrames == 0 ) {
+		// the rendered value is the brightest of the views issued in the previous frames
+		const float estimate = *std::max_element( m_AnalyticHistory, m_AnalyticHistory + DARKMOD_LG_MAX_RENDERPASSES );
+		const float error = idMath::Fabs( rendered - estimate * cv_lg_analytic_scale.GetFloat() );
+		m_BenchmarkSamples++;
+		m_BenchmarkAbsError += error;
+		m_BenchmarkMaxError = Max( m_BenchmarkMaxError, error );
+		m_BenchmarkRenderDotEstimate += rendered * estimate;
+		m_BenchmarkEstimateSqr += estimate * estimate;
+	}
+
+	if ( --m_BenchmarkFrames > 0 ) {
+		return;
+	}
+
+	const int samples = Max( m_BenchmarkSamples, 1 );
+	gameLocal.Printf( "Lightgem benchmark on %s, %d frames:\n", gameLocal.GetMapName(), m_BenchmarkNumFrames );
+	gameLocal.Printf( "  rendered: %8.1f us/frame (%d views, frontend and image analysis only)\n",
+		(double)m_BenchmarkRenderTime / m_BenchmarkNumFrames, m_BenchmarkRenderCalls );
+	gameLocal.Printf( "  analytic: %8.1f us/frame\n", (double)m_BenchmarkAnalyticTime / m_BenchmarkNumFrames );
+	gameLocal.Printf( "  error:    mean %.4f, max %.4f (%.2f / %.2f lightgem levels) over %d samples\n",
+		m_BenchmarkAbsError / samples, m_BenchmarkMaxError,
+		m_BenchmarkAbsError / samples * DARKMOD_LG_MAX, m_BenchmarkMaxError * DARKMOD_LG_MAX, m_BenchmarkSamples );
+	if ( m_BenchmarkEstimateSqr > 0.0 ) {
+		gameLocal.Printf( "  tdm_lg_analytic_scale %.3f fits best (current %.3f)\n",
+			m_BenchmarkRenderDotEstimate / m_BenchmarkEstimateSqr, cv_lg_analytic_scale.GetFloat() );
+	}
+}
+
+void LightGem::Benchmark_f(const idCmdArgs &args)
+{
+	if ( !gameLocal.GetLocalPlayer() ) {
+		gameLocal.Printf( "benchmarkLightgem: no map running\n" );
+		return;
+	}
+	if ( args.Argc() > 2 ) {
+		gameLocal.Printf( "usage: benchmarkLightgem [frames]\n" );
+		gameLocal.Printf( "  renders the lightgem and computes the analytic estimate, then reports time and error\n" );
+		return;
+	}
+
+	const int numFrames = args.Argc() == 2 ? atoi( args.Argv( 1 ) ) : 600;
+	gameLocal.m_lightGem.StartBenchmark( idMath::Imax( numFrames, 1 ) );
+}
@@ -41,10 +41,18 @@ static const float  DARKMOD_LG_BLUE				= 0.11400f;
 static const float  DARKMOD_LG_SCALE			= 1.0f / 255.0f;		// scaling factor for grayscale value
 static const float  DARKMOD_LG_TRIRATIO			= 1.0f / (DARKMOD_LG_RENDER_WIDTH*DARKMOD_LG_RENDER_WIDTH / 4.0f);
 
+// The analytic estimate evaluates the lights on the 8 faces of the lightgem octahedron,
+// and takes the brightest face (like the rendered lightgem takes the brightest quarter).
+static const int	DARKMOD_LG_ANALYTIC_FACES	= 8;
+static const int	DARKMOD_LG_MAX_OCCLUDERS	= 4; // non-shadowing entities skipped by one shadow trace
+
 //----------------------------------
 // Class Declarations.
 //----------------------------------
 struct emptyCommand_t;
+class idImage;
+class idImageAsset;
+struct imageBlock_s;
 
 class LightGem
 {
@@ -59,6 +67,29 @@ private:
 	int						m_LightgemOverrideFrames;
 	float					m_LightgemOverrideValue;
 
+	// analytic estimate of the lightgem (tdm_lg_analytic)
+	bool					m_AnalyticActive;		// the last value was estimated, the render buffers are stale
+	float					m_AnalyticHistory[DARKMOD_LG_MAX_RENDERPASSES];	// unscaled estimates of the last frames
+	idList<float>			m_AnalyticRegisters;
+	struct cpuImage_t {
+		const idImage *		image;					// image bound by the light material
+		idImageAsset *		cpuImage;				// copy with CPU residency, NULL if it cannot be loaded
+	};
+	idList<cpuImage_t>		m_AnalyticImages;
+
+	// comparison of the analytic estimate against the rendered lightgem (benchmarkLightgem)
+	int						m_BenchmarkNumFrames;
+	int						m_BenchmarkFrames;		// frames left to measure, 0 if not running
+	int						m_BenchmarkWarmup;		// frames to skip until the rendered values are valid again
+	int						m_BenchmarkSamples;
+	double					m_BenchmarkAbsError;
+	float					m_BenchmarkMaxError;
+	double					m_BenchmarkRenderDotEstimate;
+	double					m_BenchmarkEstimateSqr;
+	uint64_t				m_BenchmarkAnalyticTime;	// in microseconds
+	uint64_t				m_BenchmarkRenderTime;
+	int						m_BenchmarkRenderCalls;
+
 public:
 	unsigned char*			m_LightgemImgBufferFrontend;
 	unsigned char*			m_LightgemImgBufferBackend;
@@ -93,9 +124,27 @@ public:
 	// Calculation
 	//---------------------------------
 	float Calculate		( idPlayer *	a_pPlayer );	
+	idVec3 GetPosition	( idPlayer *	a_pPlayer ) const;
+
+	// false if the analytic estimate is used instead of the lightgem view
+	bool NeedsRenderView	() const;
+	// called by the renderer with the frontend time spent on the lightgem view
+	void AddRenderTime		( uint64_t		microseconds );
+
+	//---------------------------------
+	// Benchmark
+	//---------------------------------
+	void StartBenchmark		( int			numFrames );
+	static void Benchmark_f	( const idCmdArgs &args );
 
 private:
 	void AnalyzeRenderImage	( );
+
+	// estimates the lightgem value at the given position from the light definitions around it
+	float EstimateAnalytic	( const idVec3 &	pos, idEntity *	a_pIgnore );
+	bool TraceLightVisible	( const idVec3 &	pos, const idVec3 &	lightOrigin, idEntity *	a_pIgnore ) const;
+	const imageBlock_s *GetCpuImage( const idImage *	image );
+	void UpdateBenchmark	( float			rendered, uint64_t	analyticTime );
 };
 
 #endif // __LIGHTGEM_H__
@@ -1072,6 +1072,9 @@ void idPlayer::Spawn( void )
 	// allow thinking during cinematics
 	cinematic = true;
 
+	// player spawnargs are read every frame by movement and weapon code
+	spawnArgs.EnableParsedCache();
+
 	maxHealth = spawnArgs.GetInt("maxhealth", "100");
 
 	m_immobilization.Clear();
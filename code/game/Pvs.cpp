@@ -22,6 +22,10 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 
 #define MAX_BOUNDS_AREAS	16
 
+#define PVS_FILE_EXT		"pvs"
+#define PVS_FILEID			( ( 'P' << 24 ) | ( 'V' << 16 ) | ( 'S' << 8 ) | 'C' )
+#define PVS_FILEVERSION		1
+
 
 typedef struct pvsPassage_s {
 	byte *				canSee;		// bit set for all portals that can be seen through this passage
@@ -53,6 +57,67 @@ typedef struct pvsStack_s {
 } pvsStack_t;
 
 
+/*
+================
+PVS bit string operations
+
+  area bit strings are 16 byte aligned and their size is a multiple of 16 bytes
+================
+*/
+static ID_INLINE void PVS_Or( byte *dst, const byte *src, const int numBytes ) {
+#ifdef __SSE2__
+	for ( int i = 0; i < numBytes; i += 16 ) {
+		__m128i a = _mm_load_si128( (const __m128i *)( dst + i ) );
+		__m128i b = _mm_load_si128( (const __m128i *)( src + i ) );
+		_mm_store_si128( (__m128i *)( dst + i ), _mm_or_si128( a, b ) );
+	}
+#else
+	int *d = reinterpret_cast<int *>( dst );
+	const int *s = reinterpret_cast<const int *>( src );
+	for ( int i = 0; i < numBytes / 4; i++ ) {
+		d[i] |= s[i];
+	}
+#endif
+}
+
+static ID_INLINE void PVS_Or( byte *dst, const byte *src1, const byte *src2, const int numBytes ) {
+#ifdef __SSE2__
+	for ( int i = 0; i < numBytes; i += 16 ) {
+		__m128i a = _mm_load_si128( (const __m128i *)( src1 + i ) );
+		__m128i b = _mm_load_si128( (const __m128i *)( src2 + i ) );
+		_mm_store_si128( (__m128i *)( dst + i ), _mm_or_si128( a, b ) );
+	}
+#else
+	int *d = reinterpret_cast<int *>( dst );
+	const int *s1 = reinterpret_cast<const int *>( src1 );
+	const int *s2 = reinterpret_cast<const int *>( src2 );
+	for ( int i = 0; i < numBytes / 4; i++ ) {
+		d[i] = s1[i] | s2[i];
+	}
+#endif
+}
+
+static ID_INLINE void PVS_And( byte *dst, const byte *src, const int numBytes ) {
+#ifdef __SSE2__
+	for ( int i = 0; i < numBytes; i += 16 ) {
+		__m128i a = _mm_load_si128( (const __m128i *)( dst + i ) );
+		__m128i b = _mm_load_si128( (const __m128i *)( src + i ) );
+		_mm_store_si128( (__m128i *)( dst + i ), _mm_and_si128( a, b ) );
+	}
+#else
+	int *d = reinterpret_cast<int *>( dst );
+	const int *s = reinterpret_cast<const int *>( src );
+	for ( int i = 0; i < numBytes / 4; i++ ) {
+		d[i] &= s[i];
+	}
+#endif
+}
+
+static ID_INLINE bool PVS_Test( const byte *pvs, const int area ) {
+	return ( pvs[area >> 3] & ( 1 << ( area & 7 ) ) ) != 0;
+}
+
+
 /*
 ================
 idPVS::idPVS
@@ -67,6 +132,10 @@ idPVS::idPVS( void ) {
 	connectedAreas = NULL;
 	areaQueue = NULL;
 	areaPVS = NULL;
+	areaComponent = NULL;
+	componentAreas = NULL;
+	numComponents = 0;
+	connectivityFrame = -1;
 
 	for ( i = 0; i < MAX_CURRENT_PVS; i++ ) {
 		currentPVS[i].handle.i = -1;
@@ -788,13 +857,18 @@ void idPVS::Init( void ) {
 		return;
 	}
 
-	connectedAreas = new bool[numAreas];
-	areaQueue = new int[numAreas];
-
-	areaVisBytes = ( ((numAreas+31)&~31) >> 3);
+	// area bit strings are padded to 16 bytes for SIMD operations
+	areaVisBytes = ( ((numAreas+127)&~127) >> 3);
 	areaVisWords = areaVisBytes / sizeof(int);
 
-	areaPVS = new byte[numAreas * areaVisBytes];
+	connectedAreas = (byte *) Mem_Alloc16( areaVisBytes );
+	areaQueue = new int[numAreas];
+	areaComponent = new int[numAreas];
+	componentAreas = (byte *) Mem_Alloc16( numAreas * areaVisBytes );
+	numComponents = 0;
+	connectivityFrame = -1;
+
+	areaPVS = (byte *) Mem_Alloc16( numAreas * areaVisBytes );
 	memset( areaPVS, 0xFF, numAreas * areaVisBytes );
 
 	numPortals = GetPortalCount();
@@ -805,28 +879,57 @@ void idPVS::Init( void ) {
 	for ( int i = 0; i < MAX_CURRENT_PVS; i++ ) {
 		currentPVS[i].handle.i = -1;
 		currentPVS[i].handle.h = 0;
-		currentPVS[i].pvs = new byte[areaVisBytes];
+		currentPVS[i].pvs = (byte *) Mem_Alloc16( areaVisBytes );
 		memset( currentPVS[i].pvs, 0, areaVisBytes );
 	}
 
 	idTimer timer;
 	timer.Start();
 
-	CreatePVSData();
+	// the PVS only depends on the portal geometry, so it is cached next to the map
+	idStr cacheName;
+	unsigned int mapCRC = 0, portalCRC = 0;
+	bool useCache = g_pvsCache.GetBool() && numPortals > 0 && gameLocal.GetMapFileName().Length() > 0;
+	bool loaded = false;
+	if ( useCache ) {
+		cacheName = gameLocal.GetMapFileName();
+		cacheName.SetFileExtension( PVS_FILE_EXT );
+		mapCRC = gameLocal.GetLevelMap() ? gameLocal.GetLevelMap()->GetGeometryCRC() : 0;
+		portalCRC = GetPortalChecksum();
+		loaded = LoadPVSCache( cacheName, mapCRC, portalCRC );
+	}
+
+	if ( loaded ) {
+		totalVisibleAreas = 0;
+		for ( int i = 0; i < numAreas; i++ ) {
+			const byte *pvs = areaPVS + i * areaVisBytes;
+			for ( int j = 0; j < numAreas; j++ ) {
+				totalVisibleAreas += PVS_Test( pvs, j );
+			}
+		}
+	} else {
+		memset( areaPVS, 0xFF, numAreas * areaVisBytes );
+
+		CreatePVSData();
 
-	FrontPortalPVS();
+		FrontPortalPVS();
 
-	CopyPortalPVSToMightSee();
+		CopyPortalPVSToMightSee();
 
-	PassagePVS();
+		PassagePVS();
 
-	totalVisibleAreas = AreaPVSFromPortalPVS();
+		totalVisibleAreas = AreaPVSFromPortalPVS();
 
-	DestroyPVSData();
+		DestroyPVSData();
+
+		if ( useCache ) {
+			WritePVSCache( cacheName, mapCRC, portalCRC );
+		}
+	}
 
 	timer.Stop();
 
-	gameLocal.Printf( "%5.0f msec to calculate PVS\n", timer.Milliseconds() );
+	gameLocal.Printf( "%5.0f msec to %s PVS\n", timer.Milliseconds(), loaded ? "load cached" : "calculate" );
 	gameLocal.Printf( "%5d areas\n", numAreas );
 	gameLocal.Printf( "%5d portals\n", numPortals );
 	gameLocal.Printf( "%5d areas visible on average\n", totalVisibleAreas / numAreas );
@@ -845,20 +948,30 @@ idPVS::Shutdown
 */
 void idPVS::Shutdown( void ) {
 	if ( connectedAreas ) {
-		delete[] connectedAreas;
+		Mem_Free16( connectedAreas );
 		connectedAreas = NULL;
 	}
 	if ( areaQueue ) {
 		delete[] areaQueue;
 		areaQueue = NULL;
 	}
+	if ( areaComponent ) {
+		delete[] areaComponent;
+		areaComponent = NULL;
+	}
+	if ( componentAreas ) {
+		Mem_Free16( componentAreas );
+		componentAreas = NULL;
+	}
+	numComponents = 0;
+	connectivityFrame = -1;
 	if ( areaPVS ) {
-		delete[] areaPVS;
+		Mem_Free16( areaPVS );
 		areaPVS = NULL;
 	}
 	if ( currentPVS ) {
 		for ( int i = 0; i < MAX_CURRENT_PVS; i++ ) {
-			delete[] currentPVS[i].pvs;
+			Mem_Free16( currentPVS[i].pvs );
 			currentPVS[i].pvs = NULL;
 		}
 	}
@@ -866,42 +979,187 @@ void idPVS::Shutdown( void ) {
 
 /*
 ================
-idPVS::GetConnectedAreas
+idPVS::GetPortalChecksum
 
-  assumes the 'areas' array is initialized to false
+  checksum of the portal geometry the PVS is calculated from
 ================
 */
-void idPVS::GetConnectedAreas( int srcArea, bool *areas ) const {
-	int curArea, nextArea;
-	int queueStart, queueEnd;
-	int i, n;
+unsigned int idPVS::GetPortalChecksum( void ) const {
+	idList<float> data;
 
-	queueStart = -1;
-	queueEnd = 0;
-	areas[srcArea] = true;
+	for ( int i = 0; i < numAreas; i++ ) {
+		int n = gameRenderWorld->NumPortalsInArea( i );
+		data.Append( (float)n );
+		for ( int j = 0; j < n; j++ ) {
+			auto portal = gameRenderWorld->GetPortal( i, j );
+			data.Append( (float)portal.areas[0] );
+			data.Append( (float)portal.areas[1] );
+			for ( int k = 0; k < portal.w.GetNumPoints(); k++ ) {
+				data.Append( portal.w[k].x );
+				data.Append( portal.w[k].y );
+				data.Append( portal.w[k].z );
+			}
+		}
+	}
 
-	for ( curArea = srcArea; queueStart < queueEnd; curArea = areaQueue[++queueStart] ) {
+	return MD5_BlockChecksum( data.Ptr(), data.MemoryUsed() );
+}
 
-		n = gameRenderWorld->NumPortalsInArea( curArea );
+/*
+================
+idPVS::LoadPVSCache
+================
+*/
+bool idPVS::LoadPVSCache( const char *fileName, unsigned int mapCRC, unsigned int portalCRC ) {
+	int fileId, version, fileNumAreas, fileNumPortals, fileAreaVisBytes;
+	unsigned int fileMapCRC, filePortalCRC;
 
-		for ( i = 0; i < n; i++ ) {
-			auto portal = gameRenderWorld->GetPortal( curArea, i );
+	idFile *file = fileSystem->OpenFileRead( fileName );
+	if ( !file ) {
+		return false;
+	}
 
-			if ( portal.blockingBits & PS_BLOCK_VIEW ) {
-				continue;
-			}
+	file->ReadInt( fileId );
+	file->ReadInt( version );
+	file->ReadUnsignedInt( fileMapCRC );
+	file->ReadUnsignedInt( filePortalCRC );
+	file->ReadInt( fileNumAreas );
+	file->ReadInt( fileNumPortals );
+	file->ReadInt( fileAreaVisBytes );
 
-			// area[1] is always the area the portal leads to
-			nextArea = portal.areas[1];
+	bool valid = ( fileId == PVS_FILEID && version == PVS_FILEVERSION &&
+		fileMapCRC == mapCRC && filePortalCRC == portalCRC &&
+		fileNumAreas == numAreas && fileNumPortals == numPortals && fileAreaVisBytes == areaVisBytes );
 
-			// if already visited this area
-			if ( areas[nextArea] ) {
-				continue;
+	if ( valid ) {
+		int size = numAreas * areaVisBytes;
+		valid = ( file->Read( areaPVS, size ) == size );
+	}
+
+	fileSystem->CloseFile( file );
+
+	if ( !valid ) {
+		gameLocal.Printf( "PVS cache %s is out of date\n", fileName );
+	}
+	return valid;
+}
+
+/*
+================
+idPVS::WritePVSCache
+================
+*/
+void idPVS::WritePVSCache( const char *fileName, unsigned int mapCRC, unsigned int portalCRC ) const {
+	idFile *file = fileSystem->OpenFileWrite( fileName );
+	if ( !file ) {
+		gameLocal.Warning( "idPVS::WritePVSCache: Error opening file %s", fileName );
+		return;
+	}
+
+	file->WriteInt( PVS_FILEID );
+	file->WriteInt( PVS_FILEVERSION );
+	file->WriteUnsignedInt( mapCRC );
+	file->WriteUnsignedInt( portalCRC );
+	file->WriteInt( numAreas );
+	file->WriteInt( numPortals );
+	file->WriteInt( areaVisBytes );
+	file->Write( areaPVS, numAreas * areaVisBytes );
+
+	fileSystem->CloseFile( file );
+}
+
+/*
+================
+idPVS::InvalidateConnectivity
+================
+*/
+void idPVS::InvalidateConnectivity( void ) const {
+	connectivityFrame = -1;
+}
+
+/*
+================
+idPVS::UpdateConnectivity
+
+  splits the areas into components connected through portals which do not block view
+  the components are computed at most once per frame unless a portal changes state
+================
+*/
+void idPVS::UpdateConnectivity( void ) const {
+	int i, j, n, curArea, nextArea, queueStart, queueEnd;
+
+	if ( connectivityFrame == gameLocal.framenum ) {
+		return;
+	}
+	connectivityFrame = gameLocal.framenum;
+
+	for ( i = 0; i < numAreas; i++ ) {
+		areaComponent[i] = -1;
+	}
+
+	numComponents = 0;
+	for ( i = 0; i < numAreas; i++ ) {
+		if ( areaComponent[i] >= 0 ) {
+			continue;
+		}
+
+		byte *areas = componentAreas + numComponents * areaVisBytes;
+		memset( areas, 0, areaVisBytes );
+
+		// flood fill the component from this area
+		areaComponent[i] = numComponents;
+		areaQueue[0] = i;
+		queueEnd = 1;
+		for ( queueStart = 0; queueStart < queueEnd; queueStart++ ) {
+			curArea = areaQueue[queueStart];
+			areas[curArea >> 3] |= 1 << ( curArea & 7 );
+
+			n = gameRenderWorld->NumPortalsInArea( curArea );
+			for ( j = 0; j < n; j++ ) {
+				auto portal = gameRenderWorld->GetPortal( curArea, j );
+
+				if ( portal.blockingBits & PS_BLOCK_VIEW ) {
+					continue;
+				}
+
+				// area[1] is always the area the portal leads to
+				nextArea = portal.areas[1];
+				if ( areaComponent[nextArea] >= 0 ) {
+					continue;
+				}
+
+				areaComponent[nextArea] = numComponents;
+				areaQueue[queueEnd++] = nextArea;
 			}
+		}
+
+		numComponents++;
+	}
+}
+
+/*
+================
+idPVS::GetConnectedAreas
+
+  sets the bits of all areas connected to any of the source areas
+================
+*/
+void idPVS::GetConnectedAreas( const int *sourceAreas, int numSourceAreas, byte *areas ) const {
+	int i, j;
 
-			// add area to queue
-			areaQueue[queueEnd++] = nextArea;
-			areas[nextArea] = true;
+	UpdateConnectivity();
+
+	memset( areas, 0, areaVisBytes );
+	for ( i = 0; i < numSourceAreas; i++ ) {
+		int c = areaComponent[sourceAreas[i]];
+		// skip components merged already
+		for ( j = 0; j < i; j++ ) {
+			if ( areaComponent[sourceAreas[j]] == c ) {
+				break;
+			}
+		}
+		if ( j == i ) {
+			PVS_Or( areas, componentAreas + c * areaVisBytes, areaVisBytes );
 		}
 	}
 }
@@ -956,7 +1214,6 @@ idPVS::SetupCurrentPVS
 ================
 */
 pvsHandle_t idPVS::SetupCurrentPVS( const int sourceArea, const pvsType_t type ) const {
-	int i;
 	pvsHandle_t handle;
 
 	handle = AllocCurrentPVS( static_cast<unsigned int>(sourceArea) );
@@ -966,24 +1223,19 @@ pvsHandle_t idPVS::SetupCurrentPVS( const int sourceArea, const pvsType_t type )
 		return handle;
 	}
 
-	if ( type != PVS_CONNECTED_AREAS ) {
-		memcpy( currentPVS[handle.i].pvs, areaPVS + sourceArea * areaVisBytes, areaVisBytes );
-	} else {
-		memset( currentPVS[handle.i].pvs, -1, areaVisBytes );
-	}
-
 	if ( type == PVS_ALL_PORTALS_OPEN ) {
+		memcpy( currentPVS[handle.i].pvs, areaPVS + sourceArea * areaVisBytes, areaVisBytes );
 		return handle;
 	}
 
-	memset( connectedAreas, 0, numAreas * sizeof( *connectedAreas ) );
+	UpdateConnectivity();
 
-	GetConnectedAreas( sourceArea, connectedAreas );
+	const byte *connected = componentAreas + areaComponent[sourceArea] * areaVisBytes;
+	memcpy( currentPVS[handle.i].pvs, connected, areaVisBytes );
 
-	for ( i = 0; i < numAreas; i++ ) {
-		if ( !connectedAreas[i] ) {
-			currentPVS[handle.i].pvs[i>>3] &= ~(1 << (i&7));
-		}
+	if ( type != PVS_CONNECTED_AREAS ) {
+		// remove unconnected areas from the PVS
+		PVS_And( currentPVS[handle.i].pvs, areaPVS + sourceArea * areaVisBytes, areaVisBytes );
 	}
 
 	return handle;
@@ -995,7 +1247,7 @@ idPVS::SetupCurrentPVS
 ================
 */
 pvsHandle_t idPVS::SetupCurrentPVS( const int *sourceAreas, const int numSourceAreas, const pvsType_t type ) const {
-	int i, j;
+	int i;
 	unsigned int h;
 	pvsHandle_t handle;
 
@@ -1010,41 +1262,29 @@ pvsHandle_t idPVS::SetupCurrentPVS( const int *sourceAreas, const int numSourceA
 		return handle;
 	}
 
+	byte *pvs = currentPVS[handle.i].pvs;
+
 	if ( type != PVS_CONNECTED_AREAS ) {
 		// merge PVS of all areas the source is in
-		memcpy( currentPVS[handle.i].pvs, areaPVS + sourceAreas[0] * areaVisBytes, areaVisBytes );
+		memcpy( pvs, areaPVS + sourceAreas[0] * areaVisBytes, areaVisBytes );
 		for ( i = 1; i < numSourceAreas; i++ ) {
-
 			assert( sourceAreas[i] >= 0 && sourceAreas[i] < numAreas );
-
-			int *vis = reinterpret_cast<int*>(areaPVS + sourceAreas[i] * areaVisBytes);
-			int *pvs = reinterpret_cast<int*>(currentPVS[handle.i].pvs);
-			for ( j = 0; j < areaVisWords; j++ ) {
-				*pvs++ |= *vis++;
-			}
+			PVS_Or( pvs, areaPVS + sourceAreas[i] * areaVisBytes, areaVisBytes );
 		}
-	} else {
-		memset( currentPVS[handle.i].pvs, -1, areaVisBytes );
 	}
 
 	if ( type == PVS_ALL_PORTALS_OPEN ) {
 		return handle;
 	}
 
-	memset( connectedAreas, 0, numAreas * sizeof( *connectedAreas ) );
-
 	// get all areas connected to any of the source areas
-	for ( i = 0; i < numSourceAreas; i++ ) {
-		if ( !connectedAreas[sourceAreas[i]] ) {
-			GetConnectedAreas( sourceAreas[i], connectedAreas );
-		}
-	}
+	GetConnectedAreas( sourceAreas, numSourceAreas, connectedAreas );
 
-	// remove unconnected areas from the PVS
-	for ( i = 0; i < numAreas; i++ ) {
-		if ( !connectedAreas[i] ) {
-			currentPVS[handle.i].pvs[i>>3] &= ~(1 << (i&7));
-		}
+	if ( type == PVS_CONNECTED_AREAS ) {
+		memcpy( pvs, connectedAreas, areaVisBytes );
+	} else {
+		// remove unconnected areas from the PVS
+		PVS_And( pvs, connectedAreas, areaVisBytes );
 	}
 
 	return handle;
@@ -1056,7 +1296,6 @@ idPVS::MergeCurrentPVS
 ================
 */
 pvsHandle_t idPVS::MergeCurrentPVS( pvsHandle_t pvs1, pvsHandle_t pvs2 ) const {
-	int i;
 	pvsHandle_t handle;
 
 	if ( pvs1.i < 0 || pvs1.i >= MAX_CURRENT_PVS || pvs1.h != currentPVS[pvs1.i].handle.h ||
@@ -1066,13 +1305,7 @@ pvsHandle_t idPVS::MergeCurrentPVS( pvsHandle_t pvs1, pvsHandle_t pvs2 ) const {
 
 	handle = AllocCurrentPVS( pvs1.h ^ pvs2.h );
 
-	int *ptr = reinterpret_cast<int*>(currentPVS[handle.i].pvs);
-	int *pvs1Ptr = reinterpret_cast<int*>(currentPVS[pvs1.i].pvs);
-	int *pvs2Ptr = reinterpret_cast<int*>(currentPVS[pvs2.i].pvs);
-
-	for ( i = 0; i < areaVisWords; i++ ) {
-		*ptr++ = *pvs1Ptr++ | *pvs2Ptr++;
-	}
+	PVS_Or( currentPVS[handle.i].pvs, currentPVS[pvs1.i].pvs, currentPVS[pvs2.i].pvs, areaVisBytes );
 
 	return handle;
 }
@@ -1210,6 +1443,56 @@ bool idPVS::InCurrentPVS( const pvsHandle_t handle, const int *targetAreas, int
 	return false;
 }
 
+/*
+================
+idPVS::InPVS
+
+  same as SetupCurrentPVS + InCurrentPVS + FreeCurrentPVS,
+  but only tests the bits of the target areas instead of building the whole PVS
+================
+*/
+bool idPVS::InPVS( const int *sourceAreas, int numSourceAreas, const int *targetAreas, int numTargetAreas, const pvsType_t type ) const {
+	int i, j;
+
+	if ( !numSourceAreas || sourceAreas[0] < 0 || sourceAreas[0] >= numAreas ) {
+		return false;
+	}
+
+	if ( type != PVS_ALL_PORTALS_OPEN ) {
+		UpdateConnectivity();
+	}
+
+	for ( i = 0; i < numTargetAreas; i++ ) {
+		int target = targetAreas[i];
+		if ( target < 0 || target >= numAreas ) {
+			continue;
+		}
+
+		if ( type != PVS_ALL_PORTALS_OPEN ) {
+			// the target must be connected to any of the source areas
+			for ( j = 0; j < numSourceAreas; j++ ) {
+				if ( areaComponent[sourceAreas[j]] == areaComponent[target] ) {
+					break;
+				}
+			}
+			if ( j == numSourceAreas ) {
+				continue;
+			}
+			if ( type == PVS_CONNECTED_AREAS ) {
+				return true;
+			}
+		}
+
+		// and visible from any of them
+		for ( j = 0; j < numSourceAreas; j++ ) {
+			if ( PVS_Test( areaPVS + sourceAreas[j] * areaVisBytes, target ) ) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 /*
 ================
 idPVS::DrawPVS
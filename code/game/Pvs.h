@@ -69,6 +69,10 @@ public:
 	bool				InCurrentPVS( const pvsHandle_t handle, const idBounds &target ) const;
 	bool				InCurrentPVS( const pvsHandle_t handle, const int targetArea ) const;
 	bool				InCurrentPVS( const pvsHandle_t handle, const int *targetAreas, int numTargetAreas ) const;
+						// returns true if any of the target areas is within the PVS of the source areas, without allocating a current PVS
+	bool				InPVS( const int *sourceAreas, int numSourceAreas, const int *targetAreas, int numTargetAreas, const pvsType_t type = PVS_NORMAL ) const;
+						// must be called when the state of any portal changes
+	void				InvalidateConnectivity( void ) const;
 						// draw all portals that are within the PVS of the source
 	void				DrawPVS( const idVec3 &source, const pvsType_t type = PVS_NORMAL ) const;
 	void				DrawPVS( const idBounds &source, const pvsType_t type = PVS_NORMAL ) const;
@@ -85,9 +89,14 @@ public:
 private:
 	int				numAreas;
 	int				numPortals;
-	bool *				connectedAreas;
+	byte *				connectedAreas;		// temporary bit string with the areas connected to the source
 	int *				areaQueue;
-	byte *				areaPVS;
+	byte *				areaPVS;			// PVS bit string for each area, 16 byte aligned
+					// connected components of areas through portals which do not block view
+	int *				areaComponent;
+	byte *				componentAreas;		// bit string with the areas of each component
+	mutable int			numComponents;
+	mutable int			connectivityFrame;	// game frame the components were computed in, -1 if invalid
 					// current PVS for a specific source possibly taking portal states (open/closed) into account
 	mutable pvsCurrent_t currentPVS[MAX_CURRENT_PVS];
 					// used to create PVS
@@ -111,7 +120,11 @@ private:
 	void				CreatePassages( void ) const;
 	void				DestroyPassages( void ) const;
 	int				AreaPVSFromPortalPVS( void ) const;
-	void				GetConnectedAreas( int srcArea, bool *connectedAreas ) const;
+	unsigned int		GetPortalChecksum( void ) const;
+	bool				LoadPVSCache( const char *fileName, unsigned int mapCRC, unsigned int portalCRC );
+	void				WritePVSCache( const char *fileName, unsigned int mapCRC, unsigned int portalCRC ) const;
+	void				UpdateConnectivity( void ) const;
+	void				GetConnectedAreas( const int *sourceAreas, int numSourceAreas, byte *areas ) const;
 	pvsHandle_t			AllocCurrentPVS( unsigned int h ) const;
 };
 
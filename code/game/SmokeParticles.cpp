@@ -325,6 +325,7 @@ bool idSmokeParticles::UpdateRenderEntity( renderEntity_s *renderEntity, const r
 		tri->bounds[1][2] = 99999;
 
 		tri->numVerts = 0;
+		idFlexList<idParticleData, 128> parts;
 		for ( singleSmoke_t *last = NULL, *smoke = active->smokes, *next; smoke; smoke = next ) {
 			next = smoke->next;
 
@@ -349,13 +350,13 @@ bool idSmokeParticles::UpdateRenderEntity( renderEntity_s *renderEntity, const r
 
 			part.origin = smoke->origin;
 			part.axis = smoke->axis;
-
-			idDrawVert *ptr = tri->verts + tri->numVerts;
-			idParticle_CreateParticle(*stage, psys, part, ptr);
-			tri->numVerts = ptr - tri->verts;
+			parts.AddGrow(part);
 
 			last = smoke;
 		}
+		idDrawVert *ptr = tri->verts;
+		idParticle_CreateParticles(*stage, psys, parts.Ptr(), parts.Num(), ptr);
+		tri->numVerts = ptr - tri->verts;
 		if ( tri->numVerts > quads * 4 ) {
 			gameLocal.Error( "idSmokeParticles::UpdateRenderEntity: miscounted verts" );
 		}
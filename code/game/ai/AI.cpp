@@ -5343,16 +5343,11 @@ idAI::EntityCanSeePos
 */
 bool idAI::EntityCanSeePos( idActor *actor, const idVec3 &actorOrigin, const idVec3 &pos )
 {
-	pvsHandle_t handle = gameLocal.pvs.SetupCurrentPVS( actor->GetPVSAreas(), actor->GetNumPVSAreas() );
-
-	if ( !gameLocal.pvs.InCurrentPVS( handle, GetPVSAreas(), GetNumPVSAreas() ) )
+	if ( !gameLocal.pvs.InPVS( actor->GetPVSAreas(), actor->GetNumPVSAreas(), GetPVSAreas(), GetNumPVSAreas() ) )
 	{
-		gameLocal.pvs.FreeCurrentPVS( handle );
 		return false;
 	}
 
-	gameLocal.pvs.FreeCurrentPVS( handle );
-
 	idVec3 eye = actorOrigin + actor->EyeOffset();
 
 	idVec3 point = pos;
@@ -248,6 +248,9 @@ private:
 
 	void						Event_SafeRemove( void );
 
+	idLinkList<idEvent>			scheduledEvents;	// pending events posted to this object, see idEvent::Schedule
+	friend class idEvent;
+
 	static bool					initialized;
 	static idList<idTypeInfo *>	types;
 	static idList<idTypeInfo *>	typenums;
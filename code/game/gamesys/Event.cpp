@@ -246,15 +246,69 @@ void idEventDef::SortEventDefs() {
 
 ***********************************************************************/
 
+/*
+Pending events are kept in a hierarchical timer wheel, so that scheduling and
+cancelling an event costs O(1) regardless of how many events are pending.
+
+Level 0 has one slot per millisecond for the 256 ms block containing EventWheelTime.
+Level 1 has one slot per 256 ms for the rest of the current 16384 ms block, and
+level 2 has one slot per 16384 ms for the rest of the current 2^20 ms block.
+Everything further away is kept unsorted in the overflow list. When EventWheelTime
+enters a new block, the events of the corresponding slot of the upper level are
+moved down ("cascaded"). Every list is appended in scheduling order, so events
+with same time are still serviced in the order they were posted.
+
+Events scheduled before EventWheelTime (e.g. posted after events were serviced
+this frame) are kept in a short sorted list, which is serviced first.
+*/
+#define EVENT_WHEEL_SLOTS0			256			// level 0: 1 ms per slot
+#define EVENT_WHEEL_SLOTS			64			// levels 1 and 2
+#define EVENT_WHEEL_SHIFT1			8			// level 1: 256 ms per slot
+#define EVENT_WHEEL_SHIFT2			14			// level 2: 16384 ms per slot
+#define EVENT_WHEEL_SHIFT3			20			// block covered by level 2
+
+enum {
+	EVENT_UNLINKED = -1,
+	EVENT_LEVEL0 = 0,
+	EVENT_LEVEL1,
+	EVENT_LEVEL2,
+	EVENT_OVERFLOW,
+	EVENT_LATE,
+	EVENT_NUM_LEVELS
+};
+
 static idLinkList<idEvent> FreeEvents;
 static int FreeEventsNum = 0;
-static idLinkList<idEvent> EventQueue;
+static idLinkList<idEvent> EventWheel0[ EVENT_WHEEL_SLOTS0 ];
+static idLinkList<idEvent> EventWheel1[ EVENT_WHEEL_SLOTS ];
+static idLinkList<idEvent> EventWheel2[ EVENT_WHEEL_SLOTS ];
+static idLinkList<idEvent> EventOverflow;
+static idLinkList<idEvent> EventLate;
+static int EventWheelNum[ EVENT_NUM_LEVELS ];
+static int EventQueueNum = 0;
+static int EventWheelTime = 0;			// all events before this time were serviced (except late ones)
+static int EventSequence = 0;
 static idEvent EventPool[ MAX_EVENTS ];
 
 bool idEvent::initialized = false;
 
 idDynamicBlockAlloc<byte, 16 * 1024, 256>	idEvent::eventDataAllocator;
 
+/*
+================
+idEvent::idEvent()
+================
+*/
+idEvent::idEvent() {
+	eventdef	= NULL;
+	data		= NULL;
+	time		= 0;
+	object		= NULL;
+	typeinfo	= NULL;
+	sequence	= 0;
+	wheelLevel	= EVENT_UNLINKED;
+}
+
 /*
 ================
 idEvent::~idEvent()
@@ -264,6 +318,208 @@ idEvent::~idEvent() {
 	Free();
 }
 
+/*
+================
+idEvent::Link
+
+Puts scheduled event into the timer wheel
+================
+*/
+void idEvent::Link( void ) {
+	idLinkList<idEvent> *list;
+
+	assert( wheelLevel == EVENT_UNLINKED );
+
+	if ( time < EventWheelTime ) {
+		// keep sorted by time, after all events with same time
+		idEvent *prev = EventLate.Prev();
+		while ( prev && prev->time > time ) {
+			prev = prev->eventNode.Prev();
+		}
+		if ( prev ) {
+			eventNode.InsertAfter( prev->eventNode );
+		} else {
+			eventNode.AddToFront( EventLate );
+		}
+		wheelLevel = EVENT_LATE;
+	} else {
+		if ( ( time >> EVENT_WHEEL_SHIFT1 ) == ( EventWheelTime >> EVENT_WHEEL_SHIFT1 ) ) {
+			list = &EventWheel0[ time & ( EVENT_WHEEL_SLOTS0 - 1 ) ];
+			wheelLevel = EVENT_LEVEL0;
+		} else if ( ( time >> EVENT_WHEEL_SHIFT2 ) == ( EventWheelTime >> EVENT_WHEEL_SHIFT2 ) ) {
+			list = &EventWheel1[ ( time >> EVENT_WHEEL_SHIFT1 ) & ( EVENT_WHEEL_SLOTS - 1 ) ];
+			wheelLevel = EVENT_LEVEL1;
+		} else if ( ( time >> EVENT_WHEEL_SHIFT3 ) == ( EventWheelTime >> EVENT_WHEEL_SHIFT3 ) ) {
+			list = &EventWheel2[ ( time >> EVENT_WHEEL_SHIFT2 ) & ( EVENT_WHEEL_SLOTS - 1 ) ];
+			wheelLevel = EVENT_LEVEL2;
+		} else {
+			list = &EventOverflow;
+			wheelLevel = EVENT_OVERFLOW;
+		}
+		eventNode.AddToEnd( *list );
+	}
+
+	EventWheelNum[ wheelLevel ]++;
+	EventQueueNum++;
+}
+
+/*
+================
+idEvent::Unlink
+
+Removes event from the timer wheel and from the list of its object
+================
+*/
+void idEvent::Unlink( void ) {
+	if ( wheelLevel == EVENT_UNLINKED ) {
+		return;
+	}
+
+	EventWheelNum[ wheelLevel ]--;
+	EventQueueNum--;
+	wheelLevel = EVENT_UNLINKED;
+
+	eventNode.Remove();
+	objectNode.Remove();
+}
+
+/*
+================
+idEvent::Cascade
+
+Relinks all events of the list against the current EventWheelTime
+================
+*/
+void idEvent::Cascade( idLinkList<idEvent> &list ) {
+	// events from overflow list may be put back into it
+	int num = list.Num();
+
+	for ( int i = 0; i < num; i++ ) {
+		idEvent *event = list.Next();
+		event->eventNode.Remove();
+		EventWheelNum[ event->wheelLevel ]--;
+		EventQueueNum--;
+		event->wheelLevel = EVENT_UNLINKED;
+		event->Link();
+	}
+}
+
+/*
+================
+idEvent::AdvanceWheel
+
+Moves EventWheelTime forward, but not past limit.
+Skips over empty blocks, since nothing can be pending there.
+================
+*/
+void idEvent::AdvanceWheel( int limit ) {
+	int target;
+
+	assert( EventWheelTime < limit );
+
+	target = EventWheelTime + 1;
+	if ( EventWheelNum[ EVENT_LEVEL0 ] == 0 ) {
+		target = ( EventWheelTime | ( ( 1 << EVENT_WHEEL_SHIFT1 ) - 1 ) ) + 1;
+		if ( EventWheelNum[ EVENT_LEVEL1 ] == 0 ) {
+			target = ( EventWheelTime | ( ( 1 << EVENT_WHEEL_SHIFT2 ) - 1 ) ) + 1;
+			if ( EventWheelNum[ EVENT_LEVEL2 ] == 0 ) {
+				target = ( EventWheelTime | ( ( 1 << EVENT_WHEEL_SHIFT3 ) - 1 ) ) + 1;
+				if ( EventWheelNum[ EVENT_OVERFLOW ] == 0 ) {
+					target = limit;
+				}
+			}
+		}
+	}
+	EventWheelTime = Min( target, limit );
+
+	// upper levels go first, so that their events can cascade further down
+	if ( ( EventWheelTime & ( ( 1 << EVENT_WHEEL_SHIFT3 ) - 1 ) ) == 0 ) {
+		Cascade( EventOverflow );
+	}
+	if ( ( EventWheelTime & ( ( 1 << EVENT_WHEEL_SHIFT2 ) - 1 ) ) == 0 ) {
+		Cascade( EventWheel2[ ( EventWheelTime >> EVENT_WHEEL_SHIFT2 ) & ( EVENT_WHEEL_SLOTS - 1 ) ] );
+	}
+	if ( ( EventWheelTime & ( ( 1 << EVENT_WHEEL_SHIFT1 ) - 1 ) ) == 0 ) {
+		Cascade( EventWheel1[ ( EventWheelTime >> EVENT_WHEEL_SHIFT1 ) & ( EVENT_WHEEL_SLOTS - 1 ) ] );
+	}
+}
+
+/*
+================
+idEvent::GetPendingEvents
+
+Returns all scheduled events in the order they would be serviced
+================
+*/
+void idEvent::GetPendingEvents( idList<idEvent *> &events ) {
+	int i;
+	idEvent *event;
+
+	events.Clear();
+	events.SetGranularity( 1024 );
+
+	for ( event = EventLate.Next(); event != NULL; event = event->eventNode.Next() ) {
+		events.Append( event );
+	}
+	for ( i = 0; i < EVENT_WHEEL_SLOTS0; i++ ) {
+		for ( event = EventWheel0[ i ].Next(); event != NULL; event = event->eventNode.Next() ) {
+			events.Append( event );
+		}
+	}
+	for ( i = 0; i < EVENT_WHEEL_SLOTS; i++ ) {
+		for ( event = EventWheel1[ i ].Next(); event != NULL; event = event->eventNode.Next() ) {
+			events.Append( event );
+		}
+		for ( event = EventWheel2[ i ].Next(); event != NULL; event = event->eventNode.Next() ) {
+			events.Append( event );
+		}
+	}
+	for ( event = EventOverflow.Next(); event != NULL; event = event->eventNode.Next() ) {
+		events.Append( event );
+	}
+	assert( events.Num() == EventQueueNum );
+
+	events.Sort( []( idEvent * const *a, idEvent * const *b ) -> int {
+		if ( ( *a )->time != ( *b )->time ) {
+			return ( *a )->time < ( *b )->time ? -1 : 1;
+		}
+		return ( *a )->sequence - ( *b )->sequence;
+	} );
+}
+
+/*
+================
+idEvent::RebuildWheel
+
+Puts all pending events back into the wheel starting at given time.
+Needed when game time goes backwards.
+================
+*/
+void idEvent::RebuildWheel( int time ) {
+	idList<idEvent *> events;
+	int i;
+
+	GetPendingEvents( events );
+
+	for ( i = 0; i < events.Num(); i++ ) {
+		events[ i ]->eventNode.Remove();
+		events[ i ]->wheelLevel = EVENT_UNLINKED;
+		events[ i ]->sequence = i;
+	}
+	memset( EventWheelNum, 0, sizeof( EventWheelNum ) );
+	EventQueueNum = 0;
+	EventSequence = events.Num();
+
+	if ( events.Num() > 0 && events[ 0 ]->time < time ) {
+		time = events[ 0 ]->time;
+	}
+	EventWheelTime = time;
+
+	for ( i = 0; i < events.Num(); i++ ) {
+		events[ i ]->Link();
+	}
+}
+
 /*
 ================
 idEvent::Alloc
@@ -282,7 +538,7 @@ idEvent *idEvent::Alloc( const idEventDef *evdef, int numargs, va_list args ) {
 #if _DEBUG
 	//stgatilov: check that free events counter is valid
 	if (nonFreeNum <= 100) {	//avoid wasting too much time
-		int aliveNum = EventQueue.Num();
+		int aliveNum = EventQueueNum;
 		assert(aliveNum == nonFreeNum || aliveNum + 1 == nonFreeNum);
 	}
 #endif
@@ -415,6 +671,8 @@ idEvent::Free
 ================
 */
 void idEvent::Free( void ) {
+	Unlink();
+
 	if ( data ) {
 		eventDataAllocator.Free( data );
 		data = NULL;
@@ -426,6 +684,7 @@ void idEvent::Free( void ) {
 	typeinfo	= NULL;
 
 	eventNode.SetOwner( this );
+	objectNode.SetOwner( this );
 	eventNode.AddToEnd( FreeEvents );
 	FreeEventsNum++;
 }
@@ -436,8 +695,6 @@ idEvent::Schedule
 ================
 */
 void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
-	idEvent *event;
-
 	assert( initialized );
 	if ( !initialized ) {
 		return;
@@ -449,18 +706,12 @@ void idEvent::Schedule( idClass *obj, const idTypeInfo *type, int time ) {
 	// wraps after 24 days...like I care. ;)
 	this->time = gameLocal.time + time;
 
+	Unlink();
 	eventNode.Remove();
 
-	event = EventQueue.Next();
-	while( ( event != NULL ) && ( this->time >= event->time ) ) {
-		event = event->eventNode.Next();
-	}
-
-	if ( event ) {
-		eventNode.InsertBefore( event->eventNode );
-	} else {
-		eventNode.AddToEnd( EventQueue );
-	}
+	sequence = EventSequence++;
+	Link();
+	objectNode.AddToEnd( obj->scheduledEvents );
 }
 
 /*
@@ -472,16 +723,15 @@ void idEvent::CancelEvents( const idClass *obj, const idEventDef *evdef ) {
 	idEvent *event;
 	idEvent *next;
 
-	if ( !initialized ) {
+	if ( !initialized || !obj ) {
 		return;
 	}
 
-	for( event = EventQueue.Next(); event != NULL; event = next ) {
-		next = event->eventNode.Next();
-		if ( event->object == obj ) {
-			if ( !evdef || ( evdef == event->eventdef ) ) {
-				event->Free();
-			}
+	for( event = obj->scheduledEvents.Next(); event != NULL; event = next ) {
+		next = event->objectNode.Next();
+		assert( event->object == obj );
+		if ( !evdef || ( evdef == event->eventdef ) ) {
+			event->Free();
 		}
 	}
 }
@@ -498,13 +748,27 @@ void idEvent::ClearEventList( void ) {
 	// initialize lists
 	//
 	FreeEvents.Clear();
-	EventQueue.Clear();
+	for( i = 0; i < EVENT_WHEEL_SLOTS0; i++ ) {
+		EventWheel0[ i ].Clear();
+	}
+	for( i = 0; i < EVENT_WHEEL_SLOTS; i++ ) {
+		EventWheel1[ i ].Clear();
+		EventWheel2[ i ].Clear();
+	}
+	EventOverflow.Clear();
+	EventLate.Clear();
+	memset( EventWheelNum, 0, sizeof( EventWheelNum ) );
+	EventQueueNum = 0;
+	EventWheelTime = 0;
+	EventSequence = 0;
 	FreeEventsNum = 0;
    
 	// 
 	// add the events to the free list
 	//
 	for( i = 0; i < MAX_EVENTS; i++ ) {
+		EventPool[ i ].wheelLevel = EVENT_UNLINKED;
+		EventPool[ i ].objectNode.Remove();
 		EventPool[ i ].Free();
 	}
 }
@@ -543,14 +807,27 @@ void idEvent::ServiceEvents( void ) {
 
 	TRACE_CPU_SCOPE( "idEvent::ServiceEvents" )
 
-	num = 0;
-	while( !EventQueue.IsListEmpty() ) {
-		event = EventQueue.Next();
-		assert( event );
+	if ( gameLocal.time < EventWheelTime ) {
+		// game time went backwards
+		RebuildWheel( gameLocal.time );
+	}
 
-		if ( event->time > gameLocal.time ) {
-			break;
+	num = 0;
+	while( true ) {
+		if ( !EventLate.IsListEmpty() ) {
+			event = EventLate.Next();
+		} else {
+			idLinkList<idEvent> &slot = EventWheel0[ EventWheelTime & ( EVENT_WHEEL_SLOTS0 - 1 ) ];
+			if ( slot.IsListEmpty() ) {
+				if ( EventWheelTime >= gameLocal.time ) {
+					break;
+				}
+				AdvanceWheel( gameLocal.time );
+				continue;
+			}
+			event = slot.Next();
 		}
+		assert( event && event->time <= gameLocal.time );
 
 		TRACE_CPU_SCOPE_STR ("Service:Event", GetTraceLabel(*event) )
 
@@ -611,7 +888,7 @@ void idEvent::ServiceEvents( void ) {
 
 		// the event is removed from its list so that if then object
 		// is deleted, the event won't be freed twice
-		event->eventNode.Remove();
+		event->Unlink();
 		assert( event->object );
 		event->object->ProcessEventArgPtr( ev, args );
 
@@ -702,11 +979,13 @@ void idEvent::Save( idSaveGame *savefile ) {
 	byte *dataPtr;
 	bool validTrace;
 	const char	*format;
+	idList<idEvent *> events;
 
-	savefile->WriteInt( EventQueue.Num() );
+	GetPendingEvents( events );
+	savefile->WriteInt( events.Num() );
 
-	event = EventQueue.Next();
-	while( event != NULL ) {
+	for ( int k = 0; k < events.Num(); k++ ) {
+		event = events[ k ];
 		savefile->WriteInt( event->time );
 		savefile->WriteString( event->eventdef->GetName() );
 		savefile->WriteString( event->typeinfo->classname );
@@ -758,7 +1037,6 @@ void idEvent::Save( idSaveGame *savefile ) {
 			}
 		}
 		assert( size == event->eventdef->GetArgSize() );
-		event = event->eventNode.Next();
 	}
 }
 
@@ -784,7 +1062,6 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		event = FreeEvents.Next();
 		event->eventNode.Remove();
-		event->eventNode.AddToEnd( EventQueue );
 		FreeEventsNum--;
 
 		savefile->ReadInt( event->time );
@@ -805,6 +1082,13 @@ void idEvent::Restore( idRestoreGame *savefile ) {
 
 		savefile->ReadObject( event->object );
 
+		// saved events are ordered the same way they would be serviced
+		event->sequence = EventSequence++;
+		event->Link();
+		if ( event->object ) {
+			event->objectNode.AddToEnd( event->object->scheduledEvents );
+		}
+
 		// read the args
 		savefile->ReadInt( argsize );
 		if ( argsize != int(event->eventdef->GetArgSize()) ) {
@@ -933,7 +1217,10 @@ void Cmd_EventList_f(const idCmdArgs &args) {
 		limit = atoi(args.Argv(1));
 	}
 
-	int num = EventQueue.Num();
+	idList<idEvent *> events;
+	idEvent::GetPendingEvents(events);
+
+	int num = events.Num();
 	if (limit >= num/2)
 		limit = -1;
 
@@ -948,15 +1235,71 @@ void Cmd_EventList_f(const idCmdArgs &args) {
 			printIds.Set(rnd.RandomInt(num), 0);
 	}
 
-	int idx = 0;
-	for (idLinkList<idEvent> *node = EventQueue.NextNode(); node; node = node->NextNode()) {
+	for (int idx = 0; idx < num; idx++) {
 		if (limit < 0 || printIds.Find(idx))
-			node->Owner()->Print();
-		idx++;
+			events[idx]->Print();
 	}
 	common->Printf("Total: %d/%d events alive\n", num, MAX_EVENTS);
 }
 
+//measures cost of scheduling and cancelling many events
+//all events are posted to temporary objects, so they never run
+void Cmd_EventBenchmark_f(const idCmdArgs &args) {
+	int total = 100000;
+	if (args.Argc() > 1) {
+		total = atoi(args.Argv(1));
+	}
+	if (!idEvent::initialized || !gameLocal.world) {
+		common->Printf("Event benchmark requires a map to be loaded\n");
+		return;
+	}
+
+	//events pool is limited, so schedule and cancel in batches
+	int batch = Min(FreeEventsNum - 1024, 8192);
+	if (batch <= 0 || total <= 0) {
+		common->Printf("Not enough free events to run benchmark\n");
+		return;
+	}
+
+	static const int NUM_OBJECTS = 256;
+	idList<idClass*> objects;
+	for (int i = 0; i < NUM_OBJECTS; i++)
+		objects.Append(new idClass());
+
+	idRandom rnd(0);
+	idTimer scheduleTimer, cancelTimer;
+	for (int done = 0; done < total; done += batch) {
+		int num = Min(batch, total - done);
+
+		scheduleTimer.Start();
+		for (int i = 0; i < num; i++) {
+			//mix of short waits, stim timers and long scripted delays
+			int delay;
+			switch (i & 3) {
+				case 0: delay = rnd.RandomInt(16); break;
+				case 1: delay = rnd.RandomInt(1000); break;
+				case 2: delay = rnd.RandomInt(60000); break;
+				default: delay = rnd.RandomInt(3600000); break;
+			}
+			objects[rnd.RandomInt(NUM_OBJECTS)]->PostEventMS(i & 1 ? &EV_Remove : &EV_SafeRemove, delay);
+		}
+		scheduleTimer.Stop();
+
+		cancelTimer.Start();
+		for (int i = 0; i < NUM_OBJECTS; i += 2)
+			objects[i]->CancelEvents(&EV_SafeRemove);
+		for (int i = 0; i < NUM_OBJECTS; i++)
+			objects[i]->CancelEvents(NULL);
+		cancelTimer.Stop();
+	}
+
+	for (int i = 0; i < NUM_OBJECTS; i++)
+		delete objects[i];
+
+	common->Printf("Scheduled %d events: %.2f ms (%.1f ns per event)\n", total, scheduleTimer.Milliseconds(), scheduleTimer.Milliseconds() * 1e6 / total);
+	common->Printf("Cancelled %d events: %.2f ms (%.1f ns per event)\n", total, cancelTimer.Milliseconds(), cancelTimer.Milliseconds() * 1e6 / total);
+}
+
 
 #ifdef CREATE_EVENT_CODE
 /*
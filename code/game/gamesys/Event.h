@@ -113,14 +113,28 @@ private:
 	idClass						*object;
 	const idTypeInfo			*typeinfo;
 
+	int							sequence;			// breaks ties between events with same time
+	int							wheelLevel;			// list of timer wheel which holds the event
+
 	idLinkList<idEvent>			eventNode;
+	idLinkList<idEvent>			objectNode;			// in list of pending events of the object
 
 	static idDynamicBlockAlloc<byte, 16 * 1024, 256> eventDataAllocator;
 
 	friend idStr GetTraceLabel(const idEvent &evt);
+	friend void Cmd_EventList_f(const idCmdArgs &args);
+
+	void						Link( void );
+	void						Unlink( void );
+	static void					Cascade( idLinkList<idEvent> &list );
+	static void					AdvanceWheel( int limit );
+	static void					RebuildWheel( int time );
+	static void					GetPendingEvents( idList<idEvent *> &events );
+
 public:
 	static bool					initialized;
 
+	idEvent();
 	~idEvent();
 
 	static idEvent				*Alloc( const idEventDef *evdef, int numargs, va_list args );
@@ -147,6 +161,7 @@ public:
 };
 
 void Cmd_EventList_f(const idCmdArgs &args);
+void Cmd_EventBenchmark_f(const idCmdArgs &args);
 
 /*
 ================
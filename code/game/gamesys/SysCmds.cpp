@@ -645,6 +645,80 @@ void Cmd_Script_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+==================
+Cmd_BenchmarkScriptEvents_f
+
+Measures how many script calls of sys and entity events are done per second,
+for events taking no arguments and float, vector, entity and string arguments.
+==================
+*/
+void Cmd_BenchmarkScriptEvents_f( const idCmdArgs &args ) {
+	static const struct {
+		const char *	name;
+		const char *	statement;
+	} cases[] = {
+		{ "no args",		"f = sys.getTime()" },
+		{ "float",			"f = sys.sin( i )" },
+		{ "vector",			"f = sys.vecLength( v )" },
+		{ "string",			"f = sys.strLength( s )" },
+		{ "string, float",	"s2 = sys.strLeft( s, 4 )" },
+		{ "entity",			"f = w.distanceTo( w )" },
+		{ "entity, no args",	"v = w.getOrigin()" },
+	};
+	idStr			text;
+	idStr			funcname;
+	static int		funccount = 0;
+	idThread *		thread;
+	const function_t *func;
+	idTimer			timer;
+	int				iterations;
+
+	if ( !gameLocal.CheatsOk() || !gameLocal.world ) {
+		return;
+	}
+
+	// every iteration is a few statements, keep below the runaway limit
+	iterations = ( args.Argc() > 1 ) ? idMath::ClampInt( 1, 400000, atoi( args.Argv( 1 ) ) ) : 200000;
+
+	for ( int c = 0; c < (int)( sizeof( cases ) / sizeof( cases[0] ) ); c++ ) {
+		sprintf( funcname, "BenchmarkScriptEvents_%d", funccount++ );
+		sprintf( text,
+			"void %s() {\n"
+			"	float i;\n"
+			"	float f;\n"
+			"	vector v = '1 2 3';\n"
+			"	string s = \"benchmark\";\n"
+			"	string s2;\n"
+			"	entity w = sys.getEntity( \"%s\" );\n"
+			"	for ( i = 0; i < %d; i++ ) {\n"
+			"		%s;\n"
+			"	}\n"
+			"}\n", funcname.c_str(), gameLocal.world->GetName(), iterations, cases[c].statement );
+		if ( !gameLocal.program.CompileText( "benchmark", text, true ) ) {
+			return;
+		}
+		func = gameLocal.program.FindFunction( funcname );
+		if ( !func ) {
+			return;
+		}
+
+		thread = new idThread( func );
+		thread->ManualDelete();
+		thread->ManualControl();
+
+		timer.Clear();
+		timer.Start();
+		thread->Execute();
+		timer.Stop();
+
+		delete thread;
+
+		double ms = Max( timer.Milliseconds(), 1e-3 );
+		gameLocal.Printf( "%-16s %-26s %d calls in %.2f ms, %.0f calls/sec\n", cases[c].name, cases[c].statement, iterations, ms, iterations * 1000.0 / ms );
+	}
+}
+
 /*
 ==================
 KillEntities
@@ -3625,6 +3699,7 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "listClasses",			idClass::ListClasses_f,		CMD_FL_GAME,				"lists game classes" );
 	cmdSystem->AddCommand( "listThreads",			idThread::ListThreads_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"lists script threads" );
 	cmdSystem->AddCommand( "listEvents",			Cmd_EventList_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"lists game events currently alive" );
+	cmdSystem->AddCommand( "benchmarkEvents",		Cmd_EventBenchmark_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"measures cost of scheduling and cancelling events" );
 	cmdSystem->AddCommand( "listEntities",			Cmd_EntityList_f,			CMD_FL_GAME | CMD_FL_CHEAT, "lists game entities" );
 	cmdSystem->AddCommand( "countEntities",			Cmd_EntityCount_f,			CMD_FL_GAME | CMD_FL_CHEAT, "counts game entities by class" ); // #3924
 	cmdSystem->AddCommand( "listActiveEntities",	Cmd_ActiveEntityList_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"lists active game entities" );
@@ -3651,6 +3726,8 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "killMonsters",			Cmd_KillMonsters_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"removes all monsters" );
 	cmdSystem->AddCommand( "killMoveables",			Cmd_KillMovables_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"removes all moveables" );
 	cmdSystem->AddCommand( "killRagdolls",			Cmd_KillRagdolls_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"removes all ragdolls" );
+	cmdSystem->AddCommand( "benchmarkRagdolls",		idIslandSolver::Benchmark_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"measures think time with increasing numbers of ragdolls", idCmdSystem::ArgCompletion_Decl<DECL_ENTITYDEF> );
+	cmdSystem->AddCommand( "benchmarkLightgem",		LightGem::Benchmark_f,		CMD_FL_GAME,				"compares the analytic lightgem estimate against the rendered lightgem" );
 	cmdSystem->AddCommand( "addline",				Cmd_AddDebugLine_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"adds a debug line" );
 	cmdSystem->AddCommand( "addarrow",				Cmd_AddDebugLine_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"adds a debug arrow" );
 	cmdSystem->AddCommand( "removeline",			Cmd_RemoveDebugLine_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"removes a debug line" );
@@ -3680,6 +3757,7 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "tdm_lod_bias_changed",		Cmd_LODBiasChanged_f,			CMD_FL_GAME,	"Updates entity visibility according to tdm_lod_bias." );
 
 	cmdSystem->AddCommand( "script",				Cmd_Script_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"executes a line of script" );
+	cmdSystem->AddCommand( "benchmarkScriptEvents",	Cmd_BenchmarkScriptEvents_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"measures script calls of events per second" );
 	cmdSystem->AddCommand( "listCollisionModels",	Cmd_ListCollisionModels_f,	CMD_FL_GAME,				"lists collision models" );
 	cmdSystem->AddCommand( "collisionModelInfo",	Cmd_CollisionModelInfo_f,	CMD_FL_GAME,				"shows collision model info" );
 	cmdSystem->AddCommand( "reexportmodels",		Cmd_ReexportModels_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"reexports models", ArgCompletion_DefFile );
@@ -595,6 +595,8 @@ idCVar cv_lg_interleave("tdm_lg_interleave",	"1",	CVAR_GAME | CVAR_INTEGER | CVA
 // nbohr1more #4369 Dynamic Lightgem Interleave
 idCVar cv_lg_interleave_min("tdm_lg_interleave_min",	"40",	CVAR_GAME | CVAR_INTEGER | CVAR_ARCHIVE,	"The minimum FPS to activate Lightgem Interleave. Defaults to 40FPS" );
 idCVar cv_lg_weak("tdm_lg_weak",			"0",		CVAR_GAME | CVAR_BOOL | CVAR_ARCHIVE,		"Switches to the weaker algorithm, but may be faster." );
+idCVar cv_lg_analytic("tdm_lg_analytic",	"0",	CVAR_GAME | CVAR_BOOL | CVAR_ARCHIVE,		"Estimate the lightgem on the CPU from the lights around the player instead of rendering and reading back a lightgem view." );
+idCVar cv_lg_analytic_scale("tdm_lg_analytic_scale",	"1",	CVAR_GAME | CVAR_FLOAT,	"Calibration factor of the analytic lightgem estimate. benchmarkLightgem reports the value which fits the rendered lightgem best." );
 
 idCVar cv_lg_model("tdm_lg_model",		"models/darkmod/misc/system/lightgem.lwo",	CVAR_GAME | CVAR_ARCHIVE,	"Set the lightgem model file. Map has to be restarted to take effect." );
 idCVar cv_lg_adjust("tdm_lg_adjust",		"0",		CVAR_GAME | CVAR_FLOAT,	"Adds a constant value to the lightgem." );
@@ -733,6 +735,8 @@ idCVar g_timeModifier(				"g_timeModifier",			"1",			CVAR_GAME | CVAR_FLOAT, "Us
 idCVar g_timeentities(				"g_timeEntities",			"0",			CVAR_GAME | CVAR_FLOAT, "when non-zero, shows entities whose think functions exceeded the # of milliseconds specified" );
 
 
+idCVar g_pvsCache(					"g_pvsCache",				"1",			CVAR_GAME | CVAR_BOOL, "store the area PVS of a map in a .pvs file next to it and load it instead of calculating the PVS if the portals did not change" );
+
 idCVar g_enablePortalSky(			"g_enablePortalSky",		"2",			CVAR_GAME | CVAR_INTEGER | CVAR_ARCHIVE, "enables the portal sky: 1 - old method, 2 - new method" );
 
 	
@@ -783,6 +787,7 @@ idCVar af_useLinearTime(			"af_useLinearTime",			"1",			CVAR_GAME | CVAR_BOOL, "
 idCVar af_useImpulseFriction(		"af_useImpulseFriction",	"0",			CVAR_GAME | CVAR_BOOL, "use impulse based contact friction" );
 idCVar af_useJointImpulseFriction(	"af_useJointImpulseFriction","0",			CVAR_GAME | CVAR_BOOL, "use impulse based joint friction" );
 idCVar af_useSymmetry(				"af_useSymmetry",			"1",			CVAR_GAME | CVAR_BOOL, "use constraint matrix symmetry" );
+idCVar af_parallelIslands(			"af_parallelIslands",		"1",			CVAR_GAME | CVAR_BOOL, "solve independent islands of free articulated figures concurrently on job threads" );
 #ifdef MOD_WATERPHYSICS
 
 idCVar af_useBodyDensityBuoyancy(   "af_useBodyDensityBuoyancy","0",            CVAR_GAME | CVAR_BOOL, "uses density of each body to calculate buoyancy"); // MOD_WATERPHYSICS
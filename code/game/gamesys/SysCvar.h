@@ -389,6 +389,8 @@ extern idCVar cv_lg_interleave;
 // nbohr1more #4369 Dynamic Lightgem Interleave
 extern idCVar cv_lg_interleave_min;
 extern idCVar cv_lg_weak;
+extern idCVar cv_lg_analytic;
+extern idCVar cv_lg_analytic_scale;
 extern idCVar cv_lg_model;
 extern idCVar cv_lg_adjust;
 extern idCVar cv_lg_crouch_modifier;
@@ -520,6 +522,7 @@ extern idCVar	g_showEnemies;
 
 extern idCVar	g_frametime;
 extern idCVar	g_timeentities;
+extern idCVar	g_pvsCache;
 
 extern idCVar	g_timeModifier;
 
@@ -567,6 +570,7 @@ extern idCVar	af_useLinearTime;
 extern idCVar	af_useImpulseFriction;
 extern idCVar	af_useJointImpulseFriction;
 extern idCVar	af_useSymmetry;
+extern idCVar	af_parallelIslands;
 extern idCVar	af_skipSelfCollision;
 extern idCVar	af_skipLimits;
 extern idCVar	af_skipFriction;
@@ -0,0 +1,531 @@
+/*****************************************************************************
+The Dark Mod GPL Source Code
+
+This file is part of the The Dark Mod Source Code, originally based
+on the Doom 3 GPL Source Code as published in 2011.
+
+The Dark Mod Source Code is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version. For details, see LICENSE.TXT.
+
+Project: The Dark Mod (http://www.thedarkmod.com/)
+
+******************************************************************************/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+
+
+#include "../Game_local.h"
+
+static const int ISLAND_SOLVER_MAX_JOBS = 1024;
+
+/*
+================
+IslandSolveJob
+
+Solves all figures of one island in fixed order.
+================
+*/
+static void IslandSolveJob( void *data ) {
+	const idIslandSolver::island_t *island = (const idIslandSolver::island_t *)data;
+	for ( int i = 0; i < island->numFigures; i++ ) {
+		island->figures[i]->Solve( true );
+	}
+}
+
+REGISTER_PARALLEL_JOB( IslandSolveJob, "IslandSolveJob" );
+
+/*
+================
+idIslandSolver::idIslandSolver
+================
+*/
+idIslandSolver::idIslandSolver( void ) {
+	jobList = NULL;
+	numIslandsLastFrame = 0;
+	numFiguresLastFrame = 0;
+	benchmarkFrames = 0;
+	benchmarkStage = -1;
+	benchmarkFrame = 0;
+	benchmarkTotalMs = 0.0;
+	benchmarkIslands = 0;
+	benchmarkOldParallel = false;
+}
+
+/*
+================
+idIslandSolver::Shutdown
+================
+*/
+void idIslandSolver::Shutdown( void ) {
+	Clear();
+	if ( jobList ) {
+		parallelJobManager->FreeJobList( jobList );
+		jobList = NULL;
+	}
+}
+
+/*
+================
+idIslandSolver::Clear
+================
+*/
+void idIslandSolver::Clear( void ) {
+	if ( benchmarkStage >= 0 ) {
+		af_parallelIslands.SetBool( benchmarkOldParallel );
+	}
+	benchmarkStage = -1;
+	benchmarkEntities.Clear();
+	entities.Clear();
+	figures.Clear();
+	islands.Clear();
+	islandParent.Clear();
+	islandNode.Clear();
+	numIslandsLastFrame = 0;
+	numFiguresLastFrame = 0;
+}
+
+/*
+================
+idIslandSolver::CanRunEntity
+
+Only entities whose Think starts with running physics are handled here,
+so that running their physics earlier in the frame does not change their behavior.
+================
+*/
+bool idIslandSolver::CanRunEntity( idEntity *ent ) const {
+	if ( !ent->IsType( idAFEntity_Generic::Type ) && !ent->IsType( idAFEntity_WithAttachedHead::Type ) ) {
+		return false;
+	}
+	if ( !( ent->thinkFlags & TH_PHYSICS ) || ent->IsHidden() ) {
+		return false;
+	}
+	if ( gameLocal.inCinematic && g_cinematic.GetBool() && !ent->cinematic ) {
+		return false;
+	}
+	if ( ent->GetTeamMaster() && ent->GetTeamMaster() != ent ) {
+		return false;
+	}
+	for ( idEntity *part = ent->GetNextTeamEntity(); part != NULL; part = part->GetNextTeamEntity() ) {
+		idPhysics *phys = part->GetPhysics();
+		if ( phys->IsType( idPhysics_AF::Type ) || phys->IsType( idPhysics_Parametric::Type ) || phys->IsType( idPhysics_Actor::Type ) ) {
+			return false;
+		}
+	}
+
+	idPhysics *phys = ent->GetPhysics();
+	if ( !phys->IsType( idPhysics_AF::Type ) || phys->IsAtRest() ) {
+		return false;
+	}
+	idPhysics_AF *af = static_cast<idPhysics_AF *>( phys );
+	return af->GetSolveStage() == AF_SOLVE_NONE && af->CanSolveInParallel();
+}
+
+/*
+================
+idIslandSolver::FindIsland
+================
+*/
+int idIslandSolver::FindIsland( int node ) {
+	while ( islandParent[node] != node ) {
+		islandParent[node] = islandParent[islandParent[node]];
+		node = islandParent[node];
+	}
+	return node;
+}
+
+/*
+================
+idIslandSolver::UnionIslands
+
+The smaller node always becomes the root, so that islands are ordered by their first entity.
+================
+*/
+void idIslandSolver::UnionIslands( int a, int b ) {
+	a = FindIsland( a );
+	b = FindIsland( b );
+	if ( a < b ) {
+		islandParent[b] = a;
+	} else if ( b < a ) {
+		islandParent[a] = b;
+	}
+}
+
+/*
+================
+idIslandSolver::GetBridgeNode
+
+Moveables and figures not handled by the island solver can touch several figures,
+they get their own union-find node to join these figures into one island.
+================
+*/
+int idIslandSolver::GetBridgeNode( int entityNum ) {
+	if ( islandNode[entityNum] < 0 ) {
+		islandNode[entityNum] = islandParent.Num();
+		islandParent.Append( islandParent.Num() );
+	}
+	return islandNode[entityNum];
+}
+
+/*
+================
+idIslandSolver::BuildIslands
+================
+*/
+void idIslandSolver::BuildIslands( void ) {
+	TRACE_CPU_SCOPE( "IslandSolver:Build" )
+
+	int i, j;
+
+	islandNode.SetNum( MAX_GENTITIES );
+	memset( islandNode.Ptr(), -1, islandNode.MemoryUsed() );
+	islandParent.SetNum( entities.Num(), false );
+	for ( i = 0; i < entities.Num(); i++ ) {
+		islandParent[i] = i;
+		islandNode[entities[i].GetEntityNum()] = i;
+	}
+
+	// contacts have been evaluated by PrepareSolve
+	for ( i = 0; i < entities.Num(); i++ ) {
+		idPhysics_AF *af = static_cast<idPhysics_AF *>( entities[i].GetEntity()->GetPhysics() );
+		for ( j = 0; j < af->GetNumContacts(); j++ ) {
+			int other = af->GetContact( j ).entityNum;
+			if ( other < 0 || other >= ENTITYNUM_MAX_NORMAL ) {
+				continue;	// world and invalid contacts do not join islands
+			}
+			idEntity *ent = gameLocal.entities[other];
+			if ( !ent || ent == gameLocal.world ) {
+				continue;
+			}
+			idPhysics *phys = ent->GetPhysics();
+			if ( islandNode[other] >= 0 ) {
+				UnionIslands( i, islandNode[other] );
+			} else if ( phys && ( phys->IsType( idPhysics_RigidBody::Type ) || phys->IsType( idPhysics_AF::Type ) ) ) {
+				UnionIslands( i, GetBridgeNode( other ) );
+			}
+		}
+		// a figure bound to another figure moves with it
+		idEntity *master = entities[i].GetEntity()->GetBindMaster();
+		if ( master && islandNode[master->entityNumber] >= 0 ) {
+			UnionIslands( i, islandNode[master->entityNumber] );
+		}
+	}
+
+	// gather the figures which need solving, island by island
+	// the root of every island is its first entity, so islands are ordered by the active entity list
+	idList<int> islandFirst;
+	islandFirst.SetNum( entities.Num() );
+	figures.SetNum( 0, false );
+	islands.SetNum( 0, false );
+	for ( i = 0; i < entities.Num(); i++ ) {
+		islandFirst[i] = -1;
+	}
+	idList<int> figureIsland;
+	for ( i = 0; i < entities.Num(); i++ ) {
+		idPhysics_AF *af = static_cast<idPhysics_AF *>( entities[i].GetEntity()->GetPhysics() );
+		if ( af->GetSolveStage() != AF_SOLVE_PREPARED ) {
+			continue;
+		}
+		// bridge nodes are numbered after entities, so the root is always an entity
+		int root = FindIsland( i );
+		if ( islandFirst[root] < 0 ) {
+			islandFirst[root] = islands.Num();
+			island_t &island = islands.Alloc();
+			island.figures = NULL;
+			island.numFigures = 0;
+		}
+		figureIsland.Append( islandFirst[root] );
+		islands[islandFirst[root]].numFigures++;
+	}
+
+	// sort figures by island with counting sort, keeping entity order within each island
+	idList<int> offsets;
+	offsets.SetNum( islands.Num() );
+	int total = 0;
+	for ( i = 0; i < islands.Num(); i++ ) {
+		offsets[i] = total;
+		total += islands[i].numFigures;
+	}
+	figures.SetNum( total, false );
+	for ( i = 0, j = 0; i < entities.Num(); i++ ) {
+		idPhysics_AF *af = static_cast<idPhysics_AF *>( entities[i].GetEntity()->GetPhysics() );
+		if ( af->GetSolveStage() != AF_SOLVE_PREPARED ) {
+			continue;
+		}
+		figures[offsets[figureIsland[j++]]++] = af;
+	}
+	for ( i = 0, total = 0; i < islands.Num(); i++ ) {
+		islands[i].figures = figures.Ptr() + total;
+		total += islands[i].numFigures;
+	}
+}
+
+/*
+================
+idIslandSolver::SolveIslands
+================
+*/
+void idIslandSolver::SolveIslands( void ) {
+	TRACE_CPU_SCOPE( "IslandSolver:Solve" )
+
+	if ( islands.Num() < 2 ) {
+		// nothing to run concurrently
+		for ( int i = 0; i < figures.Num(); i++ ) {
+			figures[i]->Solve( false );
+		}
+		return;
+	}
+
+	if ( !jobList ) {
+		jobList = parallelJobManager->AllocJobList( JOBLIST_GAME, JOBLIST_PRIORITY_MEDIUM, ISLAND_SOLVER_MAX_JOBS, 0, NULL );
+	}
+
+	int i;
+	for ( i = 0; i < islands.Num() && i < ISLAND_SOLVER_MAX_JOBS; i++ ) {
+		jobList->AddJob( IslandSolveJob, &islands[i] );
+	}
+	jobList->Submit();
+
+	// too many islands for one job list: solve the rest here while the jobs run
+	for ( ; i < islands.Num(); i++ ) {
+		IslandSolveJob( &islands[i] );
+	}
+
+	jobList->Wait();
+}
+
+/*
+================
+idIslandSolver::RunPhysics
+
+Called before entities think.
+Physics of the handled entities is marked as already run for this frame,
+so that idEntity::RunPhysics called from their Think does nothing.
+================
+*/
+void idIslandSolver::RunPhysics( void ) {
+	int i;
+	idEntity *ent, *part;
+
+	if ( !af_parallelIslands.GetBool() ) {
+		return;
+	}
+
+	TRACE_CPU_SCOPE( "IslandSolver" )
+
+	entities.SetNum( 0, false );
+	for ( auto iter = gameLocal.activeEntities.Begin(); iter; gameLocal.activeEntities.Next( iter ) ) {
+		ent = iter.entity;
+		if ( CanRunEntity( ent ) ) {
+			entities.Alloc() = ent;
+		}
+	}
+	if ( entities.Num() == 0 ) {
+		numIslandsLastFrame = numFiguresLastFrame = 0;
+		return;
+	}
+
+	// evaluate contacts of all figures, with team mates disabled for collision like in idEntity::RunPhysics
+	{
+		TRACE_CPU_SCOPE( "IslandSolver:Prepare" )
+		for ( i = 0; i < entities.Num(); i++ ) {
+			ent = entities[i].GetEntity();
+			for ( part = ent; part != NULL; part = part->GetNextTeamEntity() ) {
+				if ( part->GetPhysics() && !part->fl.solidForTeam ) {
+					part->GetPhysics()->DisableClip();
+				}
+			}
+			static_cast<idPhysics_AF *>( ent->GetPhysics() )->PrepareSolve( gameLocal.time - gameLocal.previousTime, gameLocal.time );
+			for ( part = ent; part != NULL; part = part->GetNextTeamEntity() ) {
+				if ( part->GetPhysics() ) {
+					part->GetPhysics()->EnableClip();
+				}
+			}
+		}
+	}
+
+	BuildIslands();
+	SolveIslands();
+
+	numIslandsLastFrame = islands.Num();
+	numFiguresLastFrame = figures.Num();
+
+	// deterministic merge: finish evaluation in the order of the active entity list
+	{
+		TRACE_CPU_SCOPE( "IslandSolver:Finish" )
+		for ( i = 0; i < entities.Num(); i++ ) {
+			ent = entities[i].GetEntity();
+			if ( !ent ) {
+				continue;
+			}
+			ent->islandSolverMoved = ent->RunPhysics();
+			ent->islandSolverFrame = gameLocal.framenum;
+		}
+	}
+
+	TRACE_PLOT_NUMBER( "IslandSolver:islands", (int64)numIslandsLastFrame );
+}
+
+/*
+================
+idIslandSolver::BenchmarkSpawn
+
+Drops ragdolls in a grid in front of the player.
+================
+*/
+void idIslandSolver::BenchmarkSpawn( int count ) {
+	idPlayer *player = gameLocal.GetLocalPlayer();
+	if ( !player ) {
+		return;
+	}
+
+	const float spacing = 48.0f;
+	const int side = idMath::Imax( (int)idMath::Ceil( idMath::Sqrt( (float)count ) ), 1 );
+	float yaw = player->viewAngles.yaw;
+	idVec3 forward = idAngles( 0, yaw, 0 ).ToForward();
+	idVec3 right = idAngles( 0, yaw - 90.0f, 0 ).ToForward();
+	idVec3 center = player->GetEyePosition() + forward * ( 64.0f + side * spacing * 0.5f ) + idVec3( 0, 0, 32.0f );
+
+	for ( int i = 0; i < count; i++ ) {
+		int row = i / side;
+		int column = i % side;
+		idVec3 origin = center + forward * ( ( row - side * 0.5f ) * spacing ) + right * ( ( column - side * 0.5f ) * spacing );
+
+		idDict args;
+		args.Set( "classname", benchmarkDef.c_str() );
+		args.Set( "name", va( "benchmark_ragdoll_%d", i ) );
+		args.Set( "origin", origin.ToString() );
+		args.Set( "angle", va( "%f", yaw + 180.0f ) );
+		args.Set( "sleep", "0" );
+
+		idEntity *ent = NULL;
+		if ( gameLocal.SpawnEntityDef( args, &ent ) && ent ) {
+			benchmarkEntities.Alloc() = ent;
+		}
+	}
+}
+
+/*
+================
+idIslandSolver::BenchmarkRemove
+================
+*/
+void idIslandSolver::BenchmarkRemove( void ) {
+	for ( int i = 0; i < benchmarkEntities.Num(); i++ ) {
+		if ( idEntity *ent = benchmarkEntities[i].GetEntity() ) {
+			ent->PostEventMS( &EV_Remove, 0 );
+		}
+	}
+	benchmarkEntities.Clear();
+}
+
+/*
+================
+idIslandSolver::StartBenchmark
+================
+*/
+void idIslandSolver::StartBenchmark( const char *entityDefName, const idList<int> &counts, int numFrames ) {
+	if ( benchmarkStage >= 0 ) {
+		gameLocal.Printf( "Ragdoll benchmark is already running\n" );
+		return;
+	}
+	benchmarkDef = entityDefName;
+	benchmarkCounts = counts;
+	benchmarkFrames = numFrames;
+	benchmarkStage = 0;
+	benchmarkFrame = 0;
+	benchmarkOldParallel = af_parallelIslands.GetBool();
+	gameLocal.Printf( "Ragdoll benchmark: %s, %d frames per run\n", benchmarkDef.c_str(), benchmarkFrames );
+	gameLocal.Printf( " count |  serial ms/frame | parallel ms/frame | islands\n" );
+}
+
+/*
+================
+idIslandSolver::UpdateBenchmark
+
+Called once per game frame with the time spent in entity think (which includes the island solver).
+Every count is run twice: first with af_parallelIslands disabled, then enabled.
+================
+*/
+void idIslandSolver::UpdateBenchmark( float thinkMilliseconds ) {
+	if ( benchmarkStage < 0 ) {
+		return;
+	}
+
+	int count = benchmarkCounts[benchmarkStage / 2];
+	bool parallel = ( benchmarkStage & 1 ) != 0;
+
+	if ( benchmarkFrame == 0 ) {
+		// spawn the ragdolls, they start simulating on the next frame
+		af_parallelIslands.SetBool( parallel );
+		BenchmarkSpawn( count );
+		benchmarkTotalMs = 0.0;
+		benchmarkIslands = 0;
+		benchmarkFrame++;
+		return;
+	}
+
+	benchmarkTotalMs += thinkMilliseconds;
+	benchmarkIslands += numIslandsLastFrame;
+	if ( benchmarkFrame++ < benchmarkFrames ) {
+		return;
+	}
+
+	double msPerFrame = benchmarkTotalMs / benchmarkFrames;
+	if ( !parallel ) {
+		gameLocal.Printf( " %5d | %16.3f |", count, msPerFrame );
+	} else {
+		gameLocal.Printf( " %17.3f | %7.1f\n", msPerFrame, (float)benchmarkIslands / benchmarkFrames );
+	}
+
+	BenchmarkRemove();
+	benchmarkFrame = 0;
+	if ( ++benchmarkStage >= 2 * benchmarkCounts.Num() ) {
+		af_parallelIslands.SetBool( benchmarkOldParallel );
+		benchmarkStage = -1;
+		gameLocal.Printf( "Ragdoll benchmark finished\n" );
+	}
+}
+
+/*
+================
+idIslandSolver::Benchmark_f
+================
+*/
+void idIslandSolver::Benchmark_f( const idCmdArgs &args ) {
+	if ( !gameLocal.GetLocalPlayer() || !gameLocal.CheatsOk( false ) ) {
+		return;
+	}
+	if ( args.Argc() < 2 ) {
+		gameLocal.Printf( "usage: benchmarkRagdolls <entityDef> [frames] [count1 count2 ...]\n" );
+		gameLocal.Printf( "  drops count ragdolls in front of the player and reports think time per frame\n" );
+		return;
+	}
+
+	const char *defName = args.Argv( 1 );
+	if ( !gameLocal.FindEntityDefDict( defName, false ) ) {
+		gameLocal.Printf( "unknown entityDef '%s'\n", defName );
+		return;
+	}
+
+	int numFrames = args.Argc() >= 3 ? atoi( args.Argv( 2 ) ) : 120;
+	numFrames = idMath::Imax( numFrames, 1 );
+
+	idList<int> counts;
+	for ( int i = 3; i < args.Argc(); i++ ) {
+		int count = atoi( args.Argv( i ) );
+		if ( count > 0 ) {
+			counts.Append( count );
+		}
+	}
+	if ( counts.Num() == 0 ) {
+		for ( int count = 1; count <= 64; count *= 2 ) {
+			counts.Append( count );
+		}
+	}
+
+	gameLocal.islandSolver.StartBenchmark( defName, counts, numFrames );
+}
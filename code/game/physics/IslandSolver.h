@@ -0,0 +1,92 @@
+/*****************************************************************************
+The Dark Mod GPL Source Code
+
+This file is part of the The Dark Mod Source Code, originally based
+on the Doom 3 GPL Source Code as published in 2011.
+
+The Dark Mod Source Code is free software: you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version. For details, see LICENSE.TXT.
+
+Project: The Dark Mod (http://www.thedarkmod.com/)
+
+******************************************************************************/
+
+#ifndef __ISLANDSOLVER_H__
+#define __ISLANDSOLVER_H__
+
+/*
+===============================================================================
+
+  Runs physics of free articulated figures (ragdolls) before entities think.
+
+  Evaluation of every figure is split into three stages (see idPhysics_AF::PrepareSolve).
+  Contacts are evaluated for all figures on the game thread, then the figures are
+  grouped into islands which share no contacts with each other, and the constraint
+  solving of every island is done as a separate job. Finally, the remaining part of
+  the physics is run on the game thread in the order of the active entity list,
+  so the result does not depend on how the jobs were scheduled.
+
+===============================================================================
+*/
+
+class idPhysics_AF;
+
+class idIslandSolver {
+public:
+						idIslandSolver( void );
+
+	void				Shutdown( void );
+	void				Clear( void );
+
+						// run physics of all figures which can be handled by the island solver
+	void				RunPhysics( void );
+
+						// spawn increasing numbers of ragdolls and report think time per frame
+	void				StartBenchmark( const char *entityDefName, const idList<int> &counts, int numFrames );
+	void				UpdateBenchmark( float thinkMilliseconds );
+	bool				IsBenchmarkRunning( void ) const { return benchmarkStage >= 0; }
+
+	static void			Benchmark_f( const idCmdArgs &args );
+
+	struct island_t {
+		idPhysics_AF **	figures;				// figures of the island, in active entity order
+		int				numFigures;
+	};
+
+private:
+
+	idList< idEntityPtr<idEntity> >	entities;	// entities handled this frame, in active entity order
+	idList<idPhysics_AF *>	figures;			// figures which need to be solved, sorted by island
+	idList<island_t>		islands;
+	idList<int>				islandParent;		// union-find over entities and bridging bodies
+	idList<int>				islandNode;			// union-find node for each entity number (-1 if none)
+	idParallelJobList *		jobList;
+
+	int						numIslandsLastFrame;
+	int						numFiguresLastFrame;
+
+	// benchmark state
+	idStr					benchmarkDef;
+	idList<int>				benchmarkCounts;
+	int						benchmarkFrames;
+	int						benchmarkStage;		// index of (count, serial/parallel) pair, -1 if not running
+	int						benchmarkFrame;		// frame within the current stage
+	double					benchmarkTotalMs;
+	int						benchmarkIslands;
+	bool					benchmarkOldParallel;
+	idList< idEntityPtr<idEntity> >	benchmarkEntities;
+
+	bool				CanRunEntity( idEntity *ent ) const;
+	int					FindIsland( int node );
+	void				UnionIslands( int a, int b );
+	int					GetBridgeNode( int entityNum );
+	void				BuildIslands( void );
+	void				SolveIslands( void );
+
+	void				BenchmarkSpawn( int count );
+	void				BenchmarkRemove( void );
+};
+
+#endif /* !__ISLANDSOLVER_H__ */
@@ -5369,7 +5369,9 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 	}
 
 #ifdef AF_TIMINGS
-	timer_lcp.Start();
+	if ( !solveInJob ) {
+		timer_lcp.Start();
+	}
 #endif
 
 	// calculate lagrange multipliers for auxiliary constraints
@@ -5378,7 +5380,9 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 	}
 
 #ifdef AF_TIMINGS
-	timer_lcp.Stop();
+	if ( !solveInJob ) {
+		timer_lcp.Stop();
+	}
 #endif
 
 	// calculate auxiliary constraint forces
@@ -6533,13 +6537,78 @@ const idBounds &idPhysics_AF::GetAbsBounds( int id ) const {
 
 /*
 ================
-idPhysics_AF::Evaluate
+idPhysics_AF::EnableTeamClip
+
+TDM: Enable the clipmodels of all team members for collisions
 ================
 */
-bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec ) 
-{
+void idPhysics_AF::EnableTeamClip( idList<bool> &initClipStates ) const {
+	initClipStates.SetNum( 0, false );
+
+	if ( !static_cast<idAFEntity_Base *>( self )->CollidesWithTeam() ) {
+		return;
+	}
+	for ( idEntity *part = self->GetTeamMaster(); part != NULL; part = part->GetNextTeamEntity() ) {
+		if ( part != self && part->GetPhysics() ) {
+			initClipStates.Append( part->GetPhysics()->GetClipModel()->IsEnabled() );
+			part->GetPhysics()->EnableClip();
+		}
+	}
+}
+
+/*
+================
+idPhysics_AF::RestoreTeamClip
+
+TDM: Disable the clipmodels that were enabled by EnableTeamClip
+================
+*/
+void idPhysics_AF::RestoreTeamClip( const idList<bool> &initClipStates ) const {
+	if ( !static_cast<idAFEntity_Base *>( self )->CollidesWithTeam() ) {
+		return;
+	}
+	int count = 0;
+	for ( idEntity *part = self->GetTeamMaster(); part != NULL; part = part->GetNextTeamEntity() ) {
+		if ( part != self && part->GetPhysics() ) {
+			if ( count < initClipStates.Num() && !initClipStates[count] ) {
+				part->GetPhysics()->DisableClip();
+			}
+			count++;
+		}
+	}
+}
+
+/*
+================
+idPhysics_AF::CanSolveInParallel
+
+Returns true if Solve only touches data owned by this articulated figure.
+Suspension constraints trace against the world while being evaluated.
+================
+*/
+bool idPhysics_AF::CanSolveInParallel( void ) const {
+	for ( int i = 0; i < constraints.Num(); i++ ) {
+		if ( constraints[i]->GetType() == CONSTRAINT_SUSPENSION ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+================
+idPhysics_AF::PrepareSolve
+
+First stage of Evaluate, must run on the game thread:
+gathers forces, updates the master and evaluates contacts with the world.
+Returns false if the figure does not need to be simulated this time.
+================
+*/
+bool idPhysics_AF::PrepareSolve( int timeStepMSec, int endTimeMSec ) {
 	float timeStep;
 
+	assert( solveStage == AF_SOLVE_NONE );
+
 	if ( timeScaleRampStart < MS2SEC( endTimeMSec ) && timeScaleRampEnd > MS2SEC( endTimeMSec ) ) {
 		timeStep = MS2SEC( timeStepMSec ) * ( MS2SEC( endTimeMSec ) - timeScaleRampStart ) / ( timeScaleRampEnd - timeScaleRampStart );
 	} else if ( af_timeScale.GetFloat() != 1.0f ) {
@@ -6586,37 +6655,22 @@ bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec )
 	// if the simulation is suspended because the figure is at rest
 	if ( current.atRest >= 0 || timeStep <= 0.0f ) {
 		DebugDraw();
+		solveStage = AF_SOLVE_SKIPPED;
 		return false;
 	}
 
+	solveStage = AF_SOLVE_PREPARED;
+	solveTimeStep = timeStep;
+	solveEndTimeMSec = endTimeMSec;
+
 	// move the af velocity into the frame of a pusher
 	AddPushVelocity( -current.pushVelocity );
 
-	// TDM: Enable the clipmodels of all team members for collisions
-	idEntity *part = NULL;
-	
-	idList<bool> InitClipStates;
-	bool PartClipState = false;
-
-	if( ((idAFEntity_Base *) self )->CollidesWithTeam() )
-	{
-		for ( part = self->GetTeamMaster(); part != NULL; part = part->GetNextTeamEntity() ) 
-		{
-			if ( part != self && part->GetPhysics() ) 
-			{
-				PartClipState = part->GetPhysics()->GetClipModel()->IsEnabled();
-				InitClipStates.Append( PartClipState );
-
-				part->GetPhysics()->EnableClip();
-			}
-		}
-	}
+	idList<bool> initClipStates;
+	EnableTeamClip( initClipStates );
 
 #ifdef AF_TIMINGS
 	timer_total.Start();
-#endif
-
-#ifdef AF_TIMINGS
 	timer_collision.Start();
 #endif
 
@@ -6628,26 +6682,58 @@ bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec )
 
 #ifdef AF_TIMINGS
 	timer_collision.Stop();
+	timer_total.Stop();
+#endif
+
+	RestoreTeamClip( initClipStates );
+
+	return true;
+}
+
+/*
+================
+idPhysics_AF::Solve
+
+Second stage of Evaluate: evaluates the constraints, runs the LCP solver and evolves the state.
+Only touches bodies and constraints of this figure (see CanSolveInParallel),
+so the island solver may run it on a job thread.
+================
+*/
+void idPhysics_AF::Solve( bool inJob ) {
+	assert( solveStage == AF_SOLVE_PREPARED );
+	float timeStep = solveTimeStep;
+
+	// the timers are shared between all figures, only touch them on the game thread
+	solveInJob = inJob;
+
+#ifdef AF_TIMINGS
+	if ( !solveInJob ) {
+		timer_total.Start();
+	}
 #endif
 
 	// evaluate constraint equations
 	EvaluateConstraints( timeStep );
 
 	// apply friction
-	ApplyFriction( timeStep, endTimeMSec );
+	ApplyFriction( timeStep, solveEndTimeMSec );
 
 	// add frame constraints
 	AddFrameConstraints();
 
 #ifdef AF_TIMINGS
-	int i, numPrimary = 0, numAuxiliary = 0;
+	int i;
+	solveNumPrimary = 0;
+	solveNumAuxiliary = 0;
 	for ( i = 0; i < primaryConstraints.Num(); i++ ) {
-		numPrimary += primaryConstraints[i]->J1.GetNumRows();
+		solveNumPrimary += primaryConstraints[i]->J1.GetNumRows();
 	}
 	for ( i = 0; i < auxiliaryConstraints.Num(); i++ ) {
-		numAuxiliary += auxiliaryConstraints[i]->J1.GetNumRows();
+		solveNumAuxiliary += auxiliaryConstraints[i]->J1.GetNumRows();
+	}
+	if ( !solveInJob ) {
+		timer_pc.Start();
 	}
-	timer_pc.Start();
 #endif
 
 	// factor matrices for primary constraints
@@ -6657,20 +6743,55 @@ bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec )
 	PrimaryForces( timeStep );
 
 #ifdef AF_TIMINGS
-	timer_pc.Stop();
-	timer_ac.Start();
+	if ( !solveInJob ) {
+		timer_pc.Stop();
+		timer_ac.Start();
+	}
 #endif
 
 	// calculate and apply auxiliary constraint forces
 	AuxiliaryForces( timeStep );
 
 #ifdef AF_TIMINGS
-	timer_ac.Stop();
+	if ( !solveInJob ) {
+		timer_ac.Stop();
+	}
 #endif
 
 	// evolve current state to next state
 	Evolve( timeStep );
 
+#ifdef AF_TIMINGS
+	if ( !solveInJob ) {
+		timer_total.Stop();
+	}
+#endif
+
+	solveInJob = false;
+	solveStage = AF_SOLVE_SOLVED;
+}
+
+/*
+================
+idPhysics_AF::FinishSolve
+
+Last stage of Evaluate, must run on the game thread:
+applies contact forces to other entities, handles collisions and rest.
+================
+*/
+bool idPhysics_AF::FinishSolve( void ) {
+	assert( solveStage == AF_SOLVE_SOLVED );
+	float timeStep = solveTimeStep;
+	int endTimeMSec = solveEndTimeMSec;
+	solveStage = AF_SOLVE_NONE;
+
+	idList<bool> initClipStates;
+	EnableTeamClip( initClipStates );
+
+#ifdef AF_TIMINGS
+	timer_total.Start();
+#endif
+
 	// debug graphics
 	DebugDraw();
 
@@ -6744,8 +6865,8 @@ bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec )
 		gameLocal.Printf( "%12s: t %1.4f pc %2d, %1.4f ac %2d %1.4f lcp %1.4f cd %1.4f\n",
 						self->name.c_str(),
 						timer_total.Milliseconds(),
-						numPrimary, timer_pc.Milliseconds(),
-						numAuxiliary, timer_ac.Milliseconds() - timer_lcp.Milliseconds(),
+						solveNumPrimary, timer_pc.Milliseconds(),
+						solveNumAuxiliary, timer_ac.Milliseconds() - timer_lcp.Milliseconds(),
 						timer_lcp.Milliseconds(), timer_collision.Milliseconds() );
 	}
 	else if ( af_showTimings.GetInteger() == 2 ) {
@@ -6754,8 +6875,8 @@ bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec )
 			gameLocal.Printf( "af %d: t %1.4f pc %2d, %1.4f ac %2d %1.4f lcp %1.4f cd %1.4f\n",
 							numArticulatedFigures,
 							timer_total.Milliseconds(),
-							numPrimary, timer_pc.Milliseconds(),
-							numAuxiliary, timer_ac.Milliseconds() - timer_lcp.Milliseconds(),
+							solveNumPrimary, timer_pc.Milliseconds(),
+							solveNumAuxiliary, timer_ac.Milliseconds() - timer_lcp.Milliseconds(),
 							timer_lcp.Milliseconds(), timer_collision.Milliseconds() );
 		}
 	}
@@ -6771,25 +6892,35 @@ bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec )
 	}
 #endif
 
+	RestoreTeamClip( initClipStates );
 
-	// TDM: Disable the clipmodels that we enabled above
-	int count = 0;
+	return true;
+}
 
-	if( ((idAFEntity_Base *) self )->CollidesWithTeam() )
-	{
-		for ( part = self->GetTeamMaster(); part != NULL; part = part->GetNextTeamEntity() )  
-		{
-			if ( part != self && part->GetPhysics() ) 
-			{
-				if( !InitClipStates[count] )
-					part->GetPhysics()->DisableClip();
+/*
+================
+idPhysics_AF::Evaluate
 
-				count++;
-			}
-		}
+If the island solver has already prepared (and possibly solved) this figure
+during the current frame, only the remaining stages are executed here.
+================
+*/
+bool idPhysics_AF::Evaluate( int timeStepMSec, int endTimeMSec ) 
+{
+	if ( solveStage == AF_SOLVE_NONE ) {
+		PrepareSolve( timeStepMSec, endTimeMSec );
+	} else {
+		assert( solveStage == AF_SOLVE_SKIPPED || solveEndTimeMSec == endTimeMSec );
 	}
 
-	return true;
+	if ( solveStage == AF_SOLVE_SKIPPED ) {
+		solveStage = AF_SOLVE_NONE;
+		return false;
+	}
+	if ( solveStage == AF_SOLVE_PREPARED ) {
+		Solve( false );
+	}
+	return FinishSolve();
 }
 
 /*
@@ -6992,6 +7123,13 @@ idPhysics_AF::idPhysics_AF( void ) {
 
 	lcp = idLCP::AllocSymmetric();
 
+	solveStage = AF_SOLVE_NONE;
+	solveTimeStep = 0.0f;
+	solveEndTimeMSec = 0;
+	solveInJob = false;
+	solveNumPrimary = 0;
+	solveNumAuxiliary = 0;
+
 	memset( &current, 0, sizeof( current ) );
 	current.atRest = -1;
 	current.lastTimeStep = USERCMD_MSEC;
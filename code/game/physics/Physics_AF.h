@@ -829,6 +829,14 @@ typedef struct AFCollision_s {
 	idAFBody *				body;
 } AFCollision_t;
 
+// stage of the split evaluation, see idIslandSolver
+typedef enum {
+	AF_SOLVE_NONE,								// not prepared, Evaluate runs all stages
+	AF_SOLVE_SKIPPED,							// prepared, but figure is at rest
+	AF_SOLVE_PREPARED,							// contacts evaluated, constraints not solved yet
+	AF_SOLVE_SOLVED								// next state computed, waiting for FinishSolve
+} afSolveStage_t;
+
 
 class idPhysics_AF : public idPhysics_Base {
 
@@ -1011,6 +1019,15 @@ public:	// common physics interface
 	int						GetNumOrigConstraints( void ) { return m_NumOrigConstraints; };
 	void					SetNumOrigConstraints( int num ) { m_NumOrigConstraints = num; };
 
+							// Evaluate split into stages, so that the island solver can solve many figures concurrently:
+							// PrepareSolve and FinishSolve must be called on the game thread,
+							// Solve may run on a job thread if CanSolveInParallel returns true
+	bool					PrepareSolve( int timeStepMSec, int endTimeMSec );
+	void					Solve( bool inJob );
+	bool					FinishSolve( void );
+	afSolveStage_t			GetSolveStage( void ) const { return solveStage; }
+	bool					CanSolveInParallel( void ) const;
+
 private:
 							// articulated figure
 	idList<idAFTree *>		trees;							// tree structures
@@ -1090,8 +1107,18 @@ private:
 	idAFBody *				masterBody;						// master body
 	idLCP *					lcp;							// linear complementarity problem solver
 
+							// split evaluation state (transient, never saved)
+	afSolveStage_t			solveStage;						// current stage of the split evaluation
+	float					solveTimeStep;					// time step computed by PrepareSolve
+	int						solveEndTimeMSec;				// end time passed to PrepareSolve
+	bool					solveInJob;						// true while Solve runs on a job thread
+	int						solveNumPrimary;				// number of primary constraint rows (af_showTimings)
+	int						solveNumAuxiliary;				// number of auxiliary constraint rows (af_showTimings)
+
 private:
 	bool					IsClosedLoop( const idAFBody *body1, const idAFBody *body2 ) const;
+	void					EnableTeamClip( idList<bool> &initClipStates ) const;
+	void					RestoreTeamClip( const idList<bool> &initClipStates ) const;
 	void					PrimaryFactor( void );
 	void					EvaluateBodies( float timeStep );
 	void					EvaluateConstraints( float timeStep );
@@ -2495,6 +2495,7 @@ void idCompiler::ParseEventDef( idTypeDef *returnType, const char *name ) {
 			func.parmTotal		+= argType->Size();
 			func.parmSize[ i ]	= argType->Size();
 		}
+		func.SetupEventArgs();
 
 		// mark the parms as local
 		func.locals	= func.parmTotal;
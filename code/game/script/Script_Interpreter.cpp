@@ -697,20 +697,78 @@ void idInterpreter::LeaveFunction( idVarDef *returnDef ) {
 	}
 }
 
+/*
+================
+idInterpreter::UnpackEventArgs
+
+Converts event arguments from the local stack into the format of ProcessEventArgPtr.
+Uses the argument layout computed by function_t::SetupEventArgs at compile time.
+Returns false if the thread was terminated because of invalid argument.
+================
+*/
+bool idInterpreter::UnpackEventArgs( const function_t *func, int start, int argsize, intptr_t data[ D_EVENT_MAXARGS ] ) {
+	int 				i;
+	varEval_t			var;
+	const idEventDef	*evdef;
+
+	evdef = func->eventdef;
+	for( i = 0; i < func->numEventArgs; i++ ) {
+		data[i] = 0;	//stgatilov: clear for easier debugging in x64
+		var.intPtr = ( int * )&localstack[ start + func->eventArgOffset[ i ] ];
+		switch( func->eventArgFormat[ i ] ) {
+		case D_EVENT_INTEGER :
+			( *( int * )&data[ i ] ) = int( *var.floatPtr );
+			break;
+
+		case D_EVENT_FLOAT :
+			( *( float * )&data[ i ] ) = *var.floatPtr;
+			break;
+
+		case D_EVENT_VECTOR :
+			( *( idVec3 ** )&data[ i ] ) = var.vectorPtr;
+			break;
+
+		case D_EVENT_STRING :
+			( *( const char ** )&data[ i ] ) = ( char * )var.intPtr;
+			break;
+
+		case D_EVENT_ENTITY :
+			( *( idEntity ** )&data[ i ] ) = GetEntity( *var.entityNumberPtr );
+			if ( !( *( idEntity ** )&data[ i ] ) ) {
+				Warning( "Entity not found for event '%s'. Terminating thread.", evdef->GetName() );
+				threadDying = true;
+				PopParms( argsize );
+				return false;
+			}
+			break;
+
+		case D_EVENT_ENTITY_NULL :
+			( *( idEntity ** )&data[ i ] ) = GetEntity( *var.entityNumberPtr );
+			break;
+
+		case D_EVENT_TRACE :
+			Error( "trace type not supported from script for '%s' event.", evdef->GetName() );
+			break;
+
+		default :
+			Error( "Invalid arg format string for '%s' event.", evdef->GetName() );
+			break;
+		}
+	}
+
+	return true;
+}
+
 /*
 ================
 idInterpreter::CallEvent
 ================
 */
 void idInterpreter::CallEvent( const function_t *func, int argsize ) {
-	int 				i;
-	int					j;
 	varEval_t			var;
-	int 				pos;
 	int 				start;
 	intptr_t			data[ D_EVENT_MAXARGS ];
 	const idEventDef	*evdef;
-	const char			*format;
 
 	if ( !func ) {
 		Error( "NULL function" );
@@ -762,55 +820,8 @@ void idInterpreter::CallEvent( const function_t *func, int argsize ) {
 		return;
 	}
 
-	format = evdef->GetArgFormat();
-	for( j = 0, i = 0, pos = type_object.Size(); ( pos < argsize ) || ( format[ i ] != 0 ); i++ ) {
-		data[i] = 0;	//stgatilov: clear for easier debugging in x64
-		switch( format[ i ] ) {
-		case D_EVENT_INTEGER :
-			var.intPtr = ( int * )&localstack[ start + pos ];
-			( *( int * )&data[ i ] ) = int( *var.floatPtr );
-			break;
-
-		case D_EVENT_FLOAT :
-			var.intPtr = ( int * )&localstack[ start + pos ];
-			( *( float * )&data[ i ] ) = *var.floatPtr;
-			break;
-
-		case D_EVENT_VECTOR :
-			var.intPtr = ( int * )&localstack[ start + pos ];
-			( *( idVec3 ** )&data[ i ] ) = var.vectorPtr;
-			break;
-
-		case D_EVENT_STRING :
-			( *( const char ** )&data[ i ] ) = ( char * )&localstack[ start + pos ];
-			break;
-
-		case D_EVENT_ENTITY :
-			var.intPtr = ( int * )&localstack[ start + pos ];
-			( *( idEntity ** )&data[ i ] ) = GetEntity( *var.entityNumberPtr );
-			if ( !( *( idEntity ** )&data[ i ] ) ) {
-				Warning( "Entity not found for event '%s'. Terminating thread.", evdef->GetName() );
-				threadDying = true;
-				PopParms( argsize );
-				return;
-			}
-			break;
-
-		case D_EVENT_ENTITY_NULL :
-			var.intPtr = ( int * )&localstack[ start + pos ];
-			( *( idEntity ** )&data[ i ] ) = GetEntity( *var.entityNumberPtr );
-			break;
-
-		case D_EVENT_TRACE :
-			Error( "trace type not supported from script for '%s' event.", evdef->GetName() );
-			break;
-
-		default :
-			Error( "Invalid arg format string for '%s' event.", evdef->GetName() );
-			break;
-		}
-
-		pos += func->parmSize[ j++ ];
+	if ( !UnpackEventArgs( func, start + type_object.Size(), argsize, data ) ) {
+		return;
 	}
 
 	popParms = argsize;
@@ -875,14 +886,9 @@ idInterpreter::CallSysEvent
 ================
 */
 void idInterpreter::CallSysEvent( const function_t *func, int argsize ) {
-	int 				i;
-	int					j;
-	varEval_t			source;
-	int 				pos;
 	int 				start;
 	intptr_t			data[ D_EVENT_MAXARGS ];
 	const idEventDef	*evdef;
-	const char			*format;
 
 	if ( !func ) {
 		Error( "NULL function" );
@@ -892,56 +898,8 @@ void idInterpreter::CallSysEvent( const function_t *func, int argsize ) {
 	evdef = func->eventdef;
 
 	start = localstackUsed - argsize;
-
-	format = evdef->GetArgFormat();
-	for( j = 0, i = 0, pos = 0; ( pos < argsize ) || ( format[ i ] != 0 ); i++ ) {
-		data[i] = 0;	//stgatilov: clear for easier debugging in x64
-		switch( format[ i ] ) {
-		case D_EVENT_INTEGER :
-			source.intPtr = ( int * )&localstack[ start + pos ];
-			*( int * )&data[ i ] = int( *source.floatPtr );
-			break;
-
-		case D_EVENT_FLOAT :
-			source.intPtr = ( int * )&localstack[ start + pos ];
-			*( float * )&data[ i ] = *source.floatPtr;
-			break;
-
-		case D_EVENT_VECTOR :
-			source.intPtr = ( int * )&localstack[ start + pos ];
-			*( idVec3 ** )&data[ i ] = source.vectorPtr;
-			break;
-
-		case D_EVENT_STRING :
-			*( const char ** )&data[ i ] = ( char * )&localstack[ start + pos ];
-			break;
-
-		case D_EVENT_ENTITY :
-			source.intPtr = ( int * )&localstack[ start + pos ];
-			*( idEntity ** )&data[ i ] = GetEntity( *source.entityNumberPtr );
-			if ( !*( idEntity ** )&data[ i ] ) {
-				Warning( "Entity not found for event '%s'. Terminating thread.", evdef->GetName() );
-				threadDying = true;
-				PopParms( argsize );
-				return;
-			}
-			break;
-
-		case D_EVENT_ENTITY_NULL :
-			source.intPtr = ( int * )&localstack[ start + pos ];
-			*( idEntity ** )&data[ i ] = GetEntity( *source.entityNumberPtr );
-			break;
-
-		case D_EVENT_TRACE :
-			Error( "trace type not supported from script for '%s' event.", evdef->GetName() );
-			break;
-
-		default :
-			Error( "Invalid arg format string for '%s' event.", evdef->GetName() );
-			break;
-		}
-
-		pos += func->parmSize[ j++ ];
+	if ( !UnpackEventArgs( func, start, argsize, data ) ) {
+		return;
 	}
 
 	popParms = argsize;
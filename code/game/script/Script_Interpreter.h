@@ -68,6 +68,7 @@ private:
 	void				NextInstruction( int position );
 
 	void				LeaveFunction( idVarDef *returnDef );
+	bool				UnpackEventArgs( const function_t *func, int start, int argsize, intptr_t data[ D_EVENT_MAXARGS ] );
 	void				CallEvent( const function_t *func, int argsize );
 	void				CallSysEvent( const function_t *func, int argsize );
 
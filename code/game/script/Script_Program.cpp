@@ -110,10 +110,36 @@ void function_t::Clear( void ) {
 	parmTotal		= 0;
 	locals			= 0;
 	filenum			= 0;
+	numEventArgs	= 0;
 	name.Clear();
 	parmSize.Clear();
 }
 
+/*
+================
+function_t::SetupEventArgs
+
+Computes where the arguments of the event are found on the local stack,
+so that the interpreter doesn't need to walk the format string on every call.
+================
+*/
+void function_t::SetupEventArgs( void ) {
+	const char	*format;
+	int			i;
+	int			pos;
+
+	assert( eventdef );
+	format = eventdef->GetArgFormat();
+	numEventArgs = eventdef->GetNumArgs();
+	assert( numEventArgs == parmSize.Num() );
+
+	for( i = 0, pos = 0; i < numEventArgs; i++ ) {
+		eventArgFormat[ i ] = format[ i ];
+		eventArgOffset[ i ] = pos;
+		pos += parmSize[ i ];
+	}
+}
+
 /***********************************************************************
 
   idTypeDef
@@ -2062,6 +2088,7 @@ void idProgram::RegisterScriptEvents()
 			func.parmTotal += argType->Size();
 			func.parmSize[arg] = argType->Size();
 		}
+		func.SetupEventArgs();
 
 		// mark the parms as local
 		func.locals	= func.parmTotal;
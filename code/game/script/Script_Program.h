@@ -44,6 +44,7 @@ public:
 	void				SetName( const char *name );
 	const char			*Name( void ) const;
 	void				Clear( void );
+	void				SetupEventArgs( void );
 
 private:
 	idStr 				name;
@@ -57,6 +58,11 @@ public:
 	int 				locals; 			// total ints of parms + locals
 	int					filenum; 			// source file defined in
 	idList<int>			parmSize;
+
+	// layout of event arguments on the local stack, prepared at compile time
+	int					numEventArgs;
+	char				eventArgFormat[ D_EVENT_MAXARGS ];
+	int					eventArgOffset[ D_EVENT_MAXARGS ];
 };
 
 typedef union eval_s {
@@ -16,12 +16,167 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 #include "precompiled.h"
 #pragma hdrstop
 
+#include <atomic>
 
 #define MAX_RANDOM_KEYS			2048
 
 idStrPool		idDict::globalKeys;
 idStrPool		idDict::globalValues;
 
+/*
+===============================================================================
+
+Parsed values of a dict, see idDict::EnableParsedCache.
+
+Values are looked up from the game thread and from job threads, so each parsed value
+is published separately: the first thread to claim it writes it and then marks it ready
+with release semantics. Other threads parse it on their own until it is ready.
+The dict itself must not be changed while it is read, so the table is reset without atomics.
+
+===============================================================================
+*/
+
+class idDictParsedCache {
+public:
+	enum {
+		PARSED_FLOAT	= 1,
+		PARSED_INT		= 2,
+		PARSED_VECTOR	= 4
+	};
+
+	struct value_t {
+		std::atomic<int>	ready;		// PARSED_* flags of values which can be read
+		std::atomic<int>	claimed;	// PARSED_* flags of values which are written by some thread
+		float				floatValue;
+		int					intValue;
+		idVec3				vectorValue;
+
+							value_t( void ) : ready( 0 ), claimed( 0 ) {}
+		void				Reset( void ) { ready.store( 0, std::memory_order_relaxed ); claimed.store( 0, std::memory_order_relaxed ); }
+	};
+
+						idDictParsedCache( void ) : values( NULL ), num( 0 ) {}
+						~idDictParsedCache( void ) { delete[] values; }
+
+	void				Reset( int newNum ) {
+							if ( newNum != num ) {
+								delete[] values;
+								values = ( newNum > 0 ? new value_t[newNum] : NULL );
+								num = newNum;
+							} else {
+								for ( int i = 0; i < num; i++ ) {
+									values[i].Reset();
+								}
+							}
+						}
+	size_t				Allocated( void ) const { return num * sizeof( value_t ); }
+
+	value_t *			values;		// one per key/value pair of the dict
+	int					num;
+};
+
+/*
+================
+idDict::EnableParsedCache
+================
+*/
+void idDict::EnableParsedCache( void ) {
+	if ( !parsedCache ) {
+		parsedCache = new idDictParsedCache;
+		parsedCache->Reset( args.Num() );
+	}
+}
+
+/*
+================
+idDict::InvalidateParsedCache
+
+  called after key/value pairs are changed
+================
+*/
+void idDict::InvalidateParsedCache( int index ) {
+	if ( !parsedCache ) {
+		return;
+	}
+	if ( index >= 0 && parsedCache->num == args.Num() ) {
+		parsedCache->values[index].Reset();
+	} else {
+		parsedCache->Reset( args.Num() );
+	}
+}
+
+/*
+================
+idDict::FreeParsedCache
+================
+*/
+void idDict::FreeParsedCache( void ) {
+	delete parsedCache;
+	parsedCache = NULL;
+}
+
+/*
+================
+idDict::ParseFloat
+================
+*/
+float idDict::ParseFloat( const idKeyValue *kv ) const {
+	idDictParsedCache::value_t *cached = ( parsedCache ? &parsedCache->values[kv - args.Ptr()] : NULL );
+	if ( cached && ( cached->ready.load( std::memory_order_acquire ) & idDictParsedCache::PARSED_FLOAT ) ) {
+		return cached->floatValue;
+	}
+
+	const float value = atof( kv->GetValue() );
+
+	if ( cached && !( cached->claimed.fetch_or( idDictParsedCache::PARSED_FLOAT, std::memory_order_relaxed ) & idDictParsedCache::PARSED_FLOAT ) ) {
+		cached->floatValue = value;
+		cached->ready.fetch_or( idDictParsedCache::PARSED_FLOAT, std::memory_order_release );
+	}
+	return value;
+}
+
+/*
+================
+idDict::ParseInt
+================
+*/
+int idDict::ParseInt( const idKeyValue *kv ) const {
+	idDictParsedCache::value_t *cached = ( parsedCache ? &parsedCache->values[kv - args.Ptr()] : NULL );
+	if ( cached && ( cached->ready.load( std::memory_order_acquire ) & idDictParsedCache::PARSED_INT ) ) {
+		return cached->intValue;
+	}
+
+	const int value = atoi( kv->GetValue() );
+
+	if ( cached && !( cached->claimed.fetch_or( idDictParsedCache::PARSED_INT, std::memory_order_relaxed ) & idDictParsedCache::PARSED_INT ) ) {
+		cached->intValue = value;
+		cached->ready.fetch_or( idDictParsedCache::PARSED_INT, std::memory_order_release );
+	}
+	return value;
+}
+
+/*
+================
+idDict::ParseVector
+================
+*/
+idVec3 idDict::ParseVector( const idKeyValue *kv ) const {
+	idDictParsedCache::value_t *cached = ( parsedCache ? &parsedCache->values[kv - args.Ptr()] : NULL );
+	if ( cached && ( cached->ready.load( std::memory_order_acquire ) & idDictParsedCache::PARSED_VECTOR ) ) {
+		return cached->vectorValue;
+	}
+
+	idVec3 value;
+	value.Zero();
+	sscanf( kv->GetValue(), "%f %f %f", &value.x, &value.y, &value.z );
+
+	if ( cached && !( cached->claimed.fetch_or( idDictParsedCache::PARSED_VECTOR, std::memory_order_relaxed ) & idDictParsedCache::PARSED_VECTOR ) ) {
+		cached->vectorValue = value;
+		cached->ready.fetch_or( idDictParsedCache::PARSED_VECTOR, std::memory_order_release );
+	}
+	return value;
+}
+
 /*
 ================
 idDict::operator=
@@ -45,6 +200,7 @@ idDict &idDict::operator=( const idDict &other ) {
 		args[i].key = globalKeys.CopyString( args[i].key );
 		args[i].value = globalValues.CopyString( args[i].value );
 	}
+	InvalidateParsedCache();
 
 	return *this;
 }
@@ -88,6 +244,7 @@ void idDict::Copy( const idDict &other ) {
 			argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
 		}
 	}
+	InvalidateParsedCache();
 }
 
 /*
@@ -120,6 +277,9 @@ void idDict::TransferKeyValues( idDict &other ) {
 
 	other.args.ClearFree();
 	other.argHash.ClearFree();
+
+	InvalidateParsedCache();
+	other.InvalidateParsedCache();
 }
 
 /*
@@ -177,6 +337,7 @@ void idDict::SetDefaults( const idDict *dict ) {
 			argHash.Add( argHash.GenerateKey( newkv.GetKey(), false ), args.Append( newkv ) );
 		}
 	}
+	InvalidateParsedCache();
 }
 
 /*
@@ -205,6 +366,7 @@ void idDict::SetDefaults( const idDict *dict, const idStr &skip ) {
 			argHash.Add( argHash.GenerateKey( newkv.GetKey(), false ), args.Append( newkv ) );
 		}
 	}
+	InvalidateParsedCache();
 }
 
 /*
@@ -221,6 +383,7 @@ void idDict::Clear( void ) {
 
 	args.Clear();
 	argHash.Clear();
+	InvalidateParsedCache();
 }
 
 /*
@@ -237,6 +400,7 @@ void idDict::ClearFree( void ) {
 
 	args.ClearFree();
 	argHash.ClearFree();
+	InvalidateParsedCache();
 }
 
 /*
@@ -266,6 +430,9 @@ size_t idDict::Allocated( void ) const {
 	for ( int i = 0; i < args.Num(); i++ ) {
 		size += args[i].Size();
 	}
+	if ( parsedCache ) {
+		size += sizeof( *parsedCache ) + parsedCache->Allocated();
+	}
 
 	return size;
 }
@@ -288,10 +455,12 @@ void idDict::Set( const char *key, const char *value ) {
 		const idPoolStr *oldValue = args[i].value;
 		args[i].value = globalValues.AllocString( value );
 		globalValues.FreeString( oldValue );
+		InvalidateParsedCache( i );
 	} else {
 		kv.key = globalKeys.AllocString( key );
 		kv.value = globalValues.AllocString( value );
 		argHash.Add( argHash.GenerateKey( kv.GetKey(), false ), args.Append( kv ) );
+		InvalidateParsedCache();
 	}
 }
 
@@ -301,12 +470,13 @@ idDict::GetFloat
 ================
 */
 bool idDict::GetFloat( const char *key, const char *defaultString, float &out ) const {
-	const char	*s;
-	bool		found;
-
-	found = GetString( key, defaultString, &s );
-	out = atof( s );
-	return found;
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ParseFloat( kv );
+		return true;
+	}
+	out = atof( defaultString );
+	return false;
 }
 
 /*
@@ -315,12 +485,13 @@ idDict::GetInt
 ================
 */
 bool idDict::GetInt( const char *key, const char *defaultString, int &out ) const {
-	const char	*s;
-	bool		found;
-
-	found = GetString( key, defaultString, &s );
-	out = atoi( s );
-	return found;
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ParseInt( kv );
+		return true;
+	}
+	out = atoi( defaultString );
+	return false;
 }
 
 /*
@@ -329,12 +500,13 @@ idDict::GetBool
 ================
 */
 bool idDict::GetBool( const char *key, const char *defaultString, bool &out ) const {
-	const char	*s;
-	bool		found;
-
-	found = GetString( key, defaultString, &s );
-	out = ( atoi( s ) != 0 );
-	return found;
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ( ParseInt( kv ) != 0 );
+		return true;
+	}
+	out = ( atoi( defaultString ) != 0 );
+	return false;
 }
 
 /*
@@ -362,17 +534,85 @@ idDict::GetVector
 ================
 */
 bool idDict::GetVector( const char *key, const char *defaultString, idVec3 &out ) const {
-	bool		found;
-	const char	*s;
-	
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ParseVector( kv );
+		return true;
+	}
+
 	if ( !defaultString ) {
 		defaultString = "0 0 0";
 	}
 
-	found = GetString( key, defaultString, &s );
 	out.Zero();
-	sscanf( s, "%f %f %f", &out.x, &out.y, &out.z );
-	return found;
+	sscanf( defaultString, "%f %f %f", &out.x, &out.y, &out.z );
+	return false;
+}
+
+/*
+================
+idDict::GetFloat
+================
+*/
+bool idDict::GetFloat( const idDictKey &key, const char *defaultString, float &out ) const {
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ParseFloat( kv );
+		return true;
+	}
+	out = atof( defaultString );
+	return false;
+}
+
+/*
+================
+idDict::GetInt
+================
+*/
+bool idDict::GetInt( const idDictKey &key, const char *defaultString, int &out ) const {
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ParseInt( kv );
+		return true;
+	}
+	out = atoi( defaultString );
+	return false;
+}
+
+/*
+================
+idDict::GetBool
+================
+*/
+bool idDict::GetBool( const idDictKey &key, const char *defaultString, bool &out ) const {
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ( ParseInt( kv ) != 0 );
+		return true;
+	}
+	out = ( atoi( defaultString ) != 0 );
+	return false;
+}
+
+/*
+================
+idDict::GetVector
+================
+*/
+bool idDict::GetVector( const idDictKey &key, const char *defaultString, idVec3 &out ) const {
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		out = ParseVector( kv );
+		return true;
+	}
+
+	if ( !defaultString ) {
+		defaultString = "0 0 0";
+	}
+
+	out.Zero();
+	sscanf( defaultString, "%f %f %f", &out.x, &out.y, &out.z );
+	return false;
 }
 
 /*
@@ -468,6 +708,34 @@ const idKeyValue *idDict::FindKey( const char *key ) const {
 	return NULL;
 }
 
+/*
+================
+idDict::FindKey
+
+  the key is interned on first use, after that only pool pointers are compared
+================
+*/
+const idKeyValue *idDict::FindKey( const idDictKey &key ) const {
+
+	if ( key.key == NULL ) {
+		if ( key.name == NULL || key.name[0] == '\0' ) {
+			idLib::common->DWarning( "idDict::FindKey: empty key" );
+			return NULL;
+		}
+		key.hash = idStr::IHash( key.name );
+		key.key = globalKeys.AllocString( key.name );
+	}
+
+	// idHashIndex::First masks the full hash with the hash size of this dict
+	for ( int i = argHash.First( key.hash ); i != -1; i = argHash.Next( i ) ) {
+		if ( args[i].key == key.key ) {
+			return &args[i];
+		}
+	}
+
+	return NULL;
+}
+
 /*
 ================
 idDict::FindKeyIndex
@@ -504,6 +772,7 @@ void idDict::Delete( const char *key ) {
 			globalValues.FreeString( args[i].value );
 			args.RemoveIndex( i );
 			argHash.RemoveIndex( hash, i );
+			InvalidateParsedCache();
 			break;
 		}
 	}
@@ -691,3 +960,84 @@ idDict::ListValues_f
 void idDict::ListValues_f( const idCmdArgs &args ) {
 	globalValues.PrintAll("values");
 }
+
+/*
+================
+idDict::Benchmark_f
+
+  measures typed lookups of spawnarg-like keys:
+  parsing the value string on every call, cached parsed values and interned keys
+================
+*/
+void idDict::Benchmark_f( const idCmdArgs &args ) {
+	static const char *keyNames[] = {
+		"health", "speed", "mass", "friction", "bouncyness", "team", "wait", "delay",
+		"random", "volume", "radius", "falloff", "density", "acuity_vis", "acuity_aud", "alert_thresh1",
+		"alert_thresh2", "alert_thresh3", "melee_range", "fov", "turn_rate", "run_speed", "walk_speed", "stamina"
+	};
+	const int numKeys = sizeof( keyNames ) / sizeof( keyNames[0] );
+
+	int numLookups = 1000000;
+	if ( args.Argc() > 1 ) {
+		numLookups = Max( numKeys, atoi( args.Argv( 1 ) ) );
+	}
+
+	// typical entity: the looked up keys among many unrelated ones
+	idDict dict;
+	for ( int i = 0; i < numKeys; i++ ) {
+		dict.SetFloat( keyNames[i], 0.25f * i + 1.0f );
+		dict.Set( va( "model_part%d", i ), va( "models/darkmod/part%d.lwo", i ) );
+		dict.Set( va( "snd_event%d", i ), va( "event_sound_%d", i ) );
+	}
+
+	idDictKey *internedKeys[numKeys];
+	for ( int i = 0; i < numKeys; i++ ) {
+		internedKeys[i] = new idDictKey( keyNames[i] );
+	}
+
+	const double ticksPerSecond = idLib::sys->ClockTicksPerSecond();
+	double start, end;
+	float sums[3];
+
+	// string key, value parsed every time (dict without parsed cache)
+	sums[0] = 0.0f;
+	start = idLib::sys->GetClockTicks();
+	for ( int i = 0; i < numLookups; i++ ) {
+		sums[0] += dict.GetFloat( keyNames[i % numKeys] );
+	}
+	end = idLib::sys->GetClockTicks();
+	const double parseNs = ( end - start ) * 1e9 / ticksPerSecond / numLookups;
+
+	dict.EnableParsedCache();
+
+	// string key, cached value
+	sums[1] = 0.0f;
+	start = idLib::sys->GetClockTicks();
+	for ( int i = 0; i < numLookups; i++ ) {
+		sums[1] += dict.GetFloat( keyNames[i % numKeys] );
+	}
+	end = idLib::sys->GetClockTicks();
+	const double cachedNs = ( end - start ) * 1e9 / ticksPerSecond / numLookups;
+
+	// interned key, cached value
+	sums[2] = 0.0f;
+	start = idLib::sys->GetClockTicks();
+	for ( int i = 0; i < numLookups; i++ ) {
+		sums[2] += dict.GetFloat( *internedKeys[i % numKeys] );
+	}
+	end = idLib::sys->GetClockTicks();
+	const double internedNs = ( end - start ) * 1e9 / ticksPerSecond / numLookups;
+
+	idLib::common->Printf( "%d GetFloat lookups over %d of %d keys:\n", numLookups, numKeys, dict.GetNumKeyVals() );
+	idLib::common->Printf( "  parse every call: %7.1f ns/lookup\n", parseNs );
+	idLib::common->Printf( "  cached value:     %7.1f ns/lookup (%.2fx)\n", cachedNs, parseNs / Max( cachedNs, 1e-3 ) );
+	idLib::common->Printf( "  interned key:     %7.1f ns/lookup (%.2fx)\n", internedNs, parseNs / Max( internedNs, 1e-3 ) );
+	if ( sums[0] != sums[1] || sums[0] != sums[2] ) {
+		idLib::common->Warning( "idDict::Benchmark_f: results differ (%f, %f, %f)", sums[0], sums[1], sums[2] );
+	}
+
+	// interned pool strings stay referenced, only the handles are freed
+	for ( int i = 0; i < numKeys; i++ ) {
+		delete internedKeys[i];
+	}
+}
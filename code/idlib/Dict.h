@@ -31,6 +31,11 @@ Keys are compared case-insensitive.
 
 Does not allocate memory until the first key/value pair is added.
 
+Dicts with frequent typed lookups can opt in to keep numeric and vector values
+parsed on first access until the value is changed, see EnableParsedCache.
+Keys which are looked up often can be interned with idDictKey, which skips
+hashing and comparing the key string.
+
 ===============================================================================
 */
 
@@ -51,6 +56,36 @@ private:
 	const idPoolStr *	value;
 };
 
+class idDictParsedCache;
+
+/*
+===============================================================================
+
+Interned dictionary key.
+
+Resolves the key string into the global key pool on first use and keeps it
+there, so lookups only compare pool pointers. Meant for static instances:
+
+	static const idDictKey KEY_HEALTH( "health" );
+	int health = spawnArgs.GetInt( KEY_HEALTH );
+
+===============================================================================
+*/
+
+class idDictKey {
+	friend class idDict;
+
+public:
+	explicit			idDictKey( const char *name ) : name( name ), key( NULL ), hash( 0 ) {}
+
+	const char *		GetName( void ) const { return name; }
+
+private:
+	const char *		name;
+	mutable const idPoolStr *key;			// interned in idDict::globalKeys, never freed
+	mutable int			hash;				// full case-insensitive hash, masked by each dict
+};
+
 class idDict {
 public:
 						idDict( void );
@@ -79,6 +114,9 @@ public:
 	void				ClearFree( void );
 						// print the dict
 	void				Print() const;
+						// keep values parsed by GetFloat, GetInt, GetBool and GetVector until they are changed
+						// costs memory per key/value pair, so only meant for dicts with frequent typed lookups
+	void				EnableParsedCache( void );
 
 	size_t				Allocated( void ) const;
 	size_t				Size( void ) const { return sizeof( *this ) + Allocated(); }
@@ -115,11 +153,24 @@ public:
 	bool				GetAngles( const char *key, const char *defaultString, idAngles &out ) const;
 	bool				GetMatrix( const char *key, const char *defaultString, idMat3 &out ) const;
 
+						// lookups by interned key
+	const char *		GetString( const idDictKey &key, const char *defaultString = "" ) const;
+	float				GetFloat( const idDictKey &key, const char *defaultString = "0" ) const;
+	int					GetInt( const idDictKey &key, const char *defaultString = "0" ) const;
+	bool				GetBool( const idDictKey &key, const char *defaultString = "0" ) const;
+	idVec3				GetVector( const idDictKey &key, const char *defaultString = NULL ) const;
+
+	bool				GetFloat( const idDictKey &key, const char *defaultString, float &out ) const;
+	bool				GetInt( const idDictKey &key, const char *defaultString, int &out ) const;
+	bool				GetBool( const idDictKey &key, const char *defaultString, bool &out ) const;
+	bool				GetVector( const idDictKey &key, const char *defaultString, idVec3 &out ) const;
+
 	int					GetNumKeyVals( void ) const;
 	const idKeyValue *	GetKeyVal( int index ) const;
 						// returns the key/value pair with the given key
 						// returns NULL if the key/value pair does not exist
 	const idKeyValue *	FindKey( const char *key ) const;
+	const idKeyValue *	FindKey( const idDictKey &key ) const;
 						// returns the index to the key/value pair with the given key
 						// returns -1 if the key/value pair does not exist
 	int					FindKeyIndex( const char *key ) const;
@@ -141,10 +192,18 @@ public:
 	void				PrintMemory( void ) const;
 	static void			ListKeys_f( const idCmdArgs &args );
 	static void			ListValues_f( const idCmdArgs &args );
+	static void			Benchmark_f( const idCmdArgs &args );
 
 private:
 	idList<idKeyValue>	args;
 	idHashIndex			argHash;
+	idDictParsedCache *	parsedCache;		// NULL unless EnableParsedCache was called
+
+	void				InvalidateParsedCache( int index = -1 );	// -1 means all key/value pairs
+	void				FreeParsedCache( void );
+	float				ParseFloat( const idKeyValue *kv ) const;
+	int					ParseInt( const idKeyValue *kv ) const;
+	idVec3				ParseVector( const idKeyValue *kv ) const;
 
 	static idStrPool	globalKeys;
 	static idStrPool	globalValues;
@@ -152,17 +211,20 @@ private:
 
 
 ID_INLINE idDict::idDict( void ) {
+	parsedCache = NULL;
 	args.SetGranularity( 16 );
 	argHash.SetGranularity( 16 );
 	argHash.ClearFree( 128, 16 );
 }
 
 ID_INLINE idDict::idDict( const idDict &other ) {
+	parsedCache = NULL;
 	*this = other;
 }
 
 ID_INLINE idDict::~idDict( void ) {
 	Clear();
+	FreeParsedCache();
 }
 
 ID_INLINE void idDict::SetGranularity( int granularity ) {
@@ -237,15 +299,21 @@ ID_INLINE const char *idDict::GetString( const char *key, const char *defaultStr
 }
 
 ID_INLINE float idDict::GetFloat( const char *key, const char *defaultString ) const {
-	return atof( GetString( key, defaultString ) );
+	float out;
+	GetFloat( key, defaultString, out );
+	return out;
 }
 
 ID_INLINE int idDict::GetInt( const char *key, const char *defaultString ) const {
-	return atoi( GetString( key, defaultString ) );
+	int out;
+	GetInt( key, defaultString, out );
+	return out;
 }
 
 ID_INLINE bool idDict::GetBool( const char *key, const char *defaultString ) const {
-	return ( atoi( GetString( key, defaultString ) ) != 0 );
+	bool out;
+	GetBool( key, defaultString, out );
+	return out;
 }
 
 ID_INLINE idVec3 idDict::GetVector( const char *key, const char *defaultString ) const {
@@ -278,6 +346,38 @@ ID_INLINE idMat3 idDict::GetMatrix( const char *key, const char *defaultString )
 	return out;
 }
 
+ID_INLINE const char *idDict::GetString( const idDictKey &key, const char *defaultString ) const {
+	const idKeyValue *kv = FindKey( key );
+	if ( kv ) {
+		return kv->GetValue();
+	}
+	return defaultString;
+}
+
+ID_INLINE float idDict::GetFloat( const idDictKey &key, const char *defaultString ) const {
+	float out;
+	GetFloat( key, defaultString, out );
+	return out;
+}
+
+ID_INLINE int idDict::GetInt( const idDictKey &key, const char *defaultString ) const {
+	int out;
+	GetInt( key, defaultString, out );
+	return out;
+}
+
+ID_INLINE bool idDict::GetBool( const idDictKey &key, const char *defaultString ) const {
+	bool out;
+	GetBool( key, defaultString, out );
+	return out;
+}
+
+ID_INLINE idVec3 idDict::GetVector( const idDictKey &key, const char *defaultString ) const {
+	idVec3 out;
+	GetVector( key, defaultString, out );
+	return out;
+}
+
 ID_INLINE int idDict::GetNumKeyVals( void ) const {
 	return args.Num();
 }
@@ -260,6 +260,7 @@ template<class T> struct idRaw {
 //#include "hashing/CRC32.h"
 #include "hashing/MD4.h"
 #include "hashing/MD5.h"
+#include "hashing/FNV.h"
 
 // misc
 #include "Dict.h"
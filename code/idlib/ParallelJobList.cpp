@@ -26,6 +26,7 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 const char * jobNames[] = {
 	ASSERT_ENUM_STRING( JOBLIST_RENDERER_FRONTEND,	0 ),
 	ASSERT_ENUM_STRING( JOBLIST_RENDERER_BACKEND,	1 ),
+	ASSERT_ENUM_STRING( JOBLIST_GAME,				2 ),
 	ASSERT_ENUM_STRING( JOBLIST_UTILITY,			9 ),
 };
 
@@ -30,6 +30,7 @@ enum jobSyncType_t {
 enum jobListId_t {
 	JOBLIST_RENDERER_FRONTEND	= 0,
 	JOBLIST_RENDERER_BACKEND	= 1,
+	JOBLIST_GAME				= 2,
 	JOBLIST_UTILITY				= 9,			// won't print over-time warnings
 
 	MAX_JOBLISTS				= 32			// the editor may cause quite a few to be allocated
@@ -4672,6 +4672,71 @@ frustumCull_t idRenderMatrix::CullFrustumCornersToPlane( const frustumCorners_t&
 #endif
 }
 
+/*
+========================
+idRenderMatrix::CullFrustumCornersToPlanes
+
+Same decisions as CullFrustumCornersToPlane for every pair of corners and plane,
+but each plane is broadcast only once for the whole array of corners.
+The corners don't need to be aligned.
+========================
+*/
+void idRenderMatrix::CullFrustumCornersToPlanes( const frustumCorners_t* corners, int numCorners, const idPlane* planes, int numPlanes, bool* culled )
+{
+	memset( culled, 0, numCorners * sizeof( culled[0] ) );
+	
+#if defined(USE_INTRINSICS)
+	
+	for( int j = 0; j < numPlanes; j++ )
+	{
+		__m128 vp = _mm_loadu_ps( planes[j].ToFloatPtr() );
+		
+		__m128 p0 = _mm_splat_ps( vp, 0 );
+		__m128 p1 = _mm_splat_ps( vp, 1 );
+		__m128 p2 = _mm_splat_ps( vp, 2 );
+		__m128 p3 = _mm_splat_ps( vp, 3 );
+		
+		for( int i = 0; i < numCorners; i++ )
+		{
+			if( culled[i] )
+			{
+				continue;
+			}
+			const frustumCorners_t& c = corners[i];
+			
+			__m128 x0 = _mm_loadu_ps( c.x + 0 );
+			__m128 y0 = _mm_loadu_ps( c.y + 0 );
+			__m128 z0 = _mm_loadu_ps( c.z + 0 );
+			
+			__m128 x1 = _mm_loadu_ps( c.x + 4 );
+			__m128 y1 = _mm_loadu_ps( c.y + 4 );
+			__m128 z1 = _mm_loadu_ps( c.z + 4 );
+			
+			__m128 d0 = _mm_madd_ps( x0, p0, _mm_madd_ps( y0, p1, _mm_madd_ps( z0, p2, p3 ) ) );
+			__m128 d1 = _mm_madd_ps( x1, p0, _mm_madd_ps( y1, p1, _mm_madd_ps( z1, p2, p3 ) ) );
+			
+			// FRUSTUM_CULL_FRONT means that no distance has the sign bit set
+			culled[i] = ( _mm_movemask_ps( _mm_or_ps( d0, d1 ) ) == 0 );
+		}
+	}
+	
+#else
+	
+	for( int j = 0; j < numPlanes; j++ )
+	{
+		for( int i = 0; i < numCorners; i++ )
+		{
+			if( !culled[i] )
+			{
+				ALIGNTYPE16 frustumCorners_t c = corners[i];
+				culled[i] = ( CullFrustumCornersToPlane( c, planes[j] ) == FRUSTUM_CULL_FRONT );
+			}
+		}
+	}
+	
+#endif
+}
+
 /*
 ========================
 idRenderMatrix::CullSixPlanes::Prepare
@@ -4822,3 +4887,53 @@ bool idRenderMatrix::CullSixPlanes2::CullSphere( const idPlane frustumPlanes[6],
 	return false;		// no culled
 #endif
 }
+
+
+#include "../tests/testing.h"
+
+TEST_CASE("RenderMatrix:CullFrustumCornersToPlanes") {
+	idRandom rnd;
+
+	static const int RUNS = 1000;
+	static const int MAX_CORNERS = 37;
+	static const int MAX_PLANES = 21;
+
+	for ( int r = 0; r < RUNS; r++ ) {
+		// boxes of random size around random points
+		int numCorners = 1 + rnd.RandomInt( MAX_CORNERS );
+		idList<frustumCorners_t> corners;
+		corners.SetNum( numCorners );
+		for ( int i = 0; i < numCorners; i++ ) {
+			idBounds bounds;
+			bounds[0] = idVec3( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() ) * 100.0f;
+			bounds[1] = bounds[0] + idVec3( rnd.RandomFloat(), rnd.RandomFloat(), rnd.RandomFloat() ) * 30.0f;
+			ALIGNTYPE16 frustumCorners_t c;
+			idRenderMatrix::GetFrustumCorners( c, renderMatrix_identity, bounds );
+			corners[i] = c;
+		}
+
+		// planes through the origin region, as in a portal stack
+		int numPlanes = rnd.RandomInt( MAX_PLANES + 1 );
+		idPlane planes[MAX_PLANES];
+		for ( int j = 0; j < numPlanes; j++ ) {
+			idVec3 normal( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() );
+			normal.Normalize();
+			planes[j].SetNormal( normal );
+			planes[j].SetDist( rnd.CRandomFloat() * 50.0f );
+		}
+
+		bool culled[MAX_CORNERS];
+		idRenderMatrix::CullFrustumCornersToPlanes( corners.Ptr(), numCorners, planes, numPlanes, culled );
+
+		for ( int i = 0; i < numCorners; i++ ) {
+			ALIGNTYPE16 frustumCorners_t c = corners[i];
+			bool expected = false;
+			for ( int j = 0; j < numPlanes; j++ ) {
+				if ( idRenderMatrix::CullFrustumCornersToPlane( c, planes[j] ) == FRUSTUM_CULL_FRONT ) {
+					expected = true;
+				}
+			}
+			CHECK( culled[i] == expected );
+		}
+	}
+}
@@ -156,6 +156,8 @@ public:
 	static void				GetFrustumPlanes( idPlane planes[6], const idRenderMatrix& frustum, bool zeroToOne, bool normalize );
 	static void				GetFrustumCorners( frustumCorners_t& corners, const idRenderMatrix& frustumTransform, const idBounds& frustumBounds );
 	static frustumCull_t	CullFrustumCornersToPlane( const frustumCorners_t& corners, const idPlane& plane );
+	// culled[i] is set if CullFrustumCornersToPlane( corners[i], planes[j] ) returns FRUSTUM_CULL_FRONT for some j
+	static void				CullFrustumCornersToPlanes( const frustumCorners_t* corners, int numCorners, const idPlane* planes, int numPlanes, bool* culled );
 	
 	// stgatilov #5886: This code is similar to CullBoundsToMVPbits, but:
 	//  1) It accepts six inward-looking planes instead of frustum MVP matrix.
@@ -0,0 +1,23 @@
+#ifndef __FNV_H__
+#define __FNV_H__
+
+/*
+===============================================================================
+
+	64-bit FNV-1a hash over raw bytes.
+	Cheap to compute incrementally, used to detect changes of state.
+
+===============================================================================
+*/
+
+const uint64 FNV1A_64_INIT = 14695981039346656037ULL;
+
+ID_INLINE uint64 FNV1a_64( uint64 hash, const void *data, int size ) {
+	const byte *bytes = (const byte *)data;
+	for ( int i = 0; i < size; i++ ) {
+		hash = ( hash ^ bytes[i] ) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+#endif /* !__FNV_H__ */
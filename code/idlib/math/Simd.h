@@ -71,6 +71,7 @@ class idJointQuat;
 class idJointMat;
 class idBounds;
 struct dominantTri_s;
+struct silEdge_s;
 
 const int MIXBUFFER_SAMPLES = 4096;
 
@@ -184,6 +185,8 @@ public:
 	virtual void NormalizeTangents( idDrawVert *verts, const int numVerts ) = 0;
 	virtual int  CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual int  CreateVertexProgramShadowCache( idVec4 *vertexCache, const idDrawVert *verts, const int numVerts ) = 0;
+	// writes a quad for every silhouette edge (faces on its sides differ in facing), returns number of indexes written
+	virtual int  ShadowVolume_CreateSilTriangles( int *shadowIndexes, const byte *facing, const silEdge_s *silEdges, const int numSilEdges ) = 0;
 	virtual void CullByFrustum( idDrawVert *verts, const int numVerts, const idPlane frustum[6], byte *pointCull, float epsilon ) = 0;
 	virtual void CullByFrustum2( idDrawVert *verts, const int numVerts, const idPlane frustum[6], unsigned short *pointCull, float epsilon ) = 0;
 	// stgatilov #5886: makes sense only if you process part of mesh; for full mesh better call CullByFrustum, then combine cull masks from vertices
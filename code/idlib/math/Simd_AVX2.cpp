@@ -17,6 +17,7 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 #pragma hdrstop
 
 #include "Simd_AVX2.h"
+#include "../../tests/testing.h"
 
 
 idSIMD_AVX2::idSIMD_AVX2() {
@@ -494,4 +495,731 @@ void idSIMD_AVX2::NormalizeTangents( idDrawVert *verts, const int numVerts ) {
 	}
 }
 
+/*
+============
+idSIMD_AVX2::CalcTriFacing
+
+  processes eight triangles at once, vertices are gathered straight from idDrawVert array
+============
+*/
+void idSIMD_AVX2::CalcTriFacing( const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes, const idVec3 &lightOrigin, byte *facing ) {
+	const int numTris = numIndexes / 3;
+	const float *base = verts[0].xyz.ToFloatPtr();
+	const __m256i triOffsets = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+	const __m256i vertStride = _mm256_set1_epi32( sizeof( idDrawVert ) / sizeof( float ) );
+	const __m256 orig_x = _mm256_set1_ps( lightOrigin.x );
+	const __m256 orig_y = _mm256_set1_ps( lightOrigin.y );
+	const __m256 orig_z = _mm256_set1_ps( lightOrigin.z );
+	const __m256i one = _mm256_set1_epi32( 1 );
+
+	int i = 0;
+	for ( ; i + 8 <= numTris; i += 8 ) {
+		const int *idx = indexes + 3 * i;
+		#define GATHER(P, k) \
+			__m256i P##_offs = _mm256_mullo_epi32( _mm256_i32gather_epi32( idx + k, triOffsets, 4 ), vertStride ); \
+			__m256 P##_x = _mm256_i32gather_ps( base + 0, P##_offs, 4 ); \
+			__m256 P##_y = _mm256_i32gather_ps( base + 1, P##_offs, 4 ); \
+			__m256 P##_z = _mm256_i32gather_ps( base + 2, P##_offs, 4 );
+		GATHER(A, 0);
+		GATHER(B, 1);
+		GATHER(C, 2);
+		#undef GATHER
+
+		DECL3_P8(AB);
+		AB_x = _mm256_sub_ps( B_x, A_x );
+		AB_y = _mm256_sub_ps( B_y, A_y );
+		AB_z = _mm256_sub_ps( B_z, A_z );
+		DECL3_P8(AC);
+		AC_x = _mm256_sub_ps( C_x, A_x );
+		AC_y = _mm256_sub_ps( C_y, A_y );
+		AC_z = _mm256_sub_ps( C_z, A_z );
+		DECL3_P8(toOrig);
+		toOrig_x = _mm256_sub_ps( orig_x, A_x );
+		toOrig_y = _mm256_sub_ps( orig_y, A_y );
+		toOrig_z = _mm256_sub_ps( orig_z, A_z );
+
+		//same orientation as SSE2 version: normal = AC x AB
+		DECL3_P8(normal);
+		CROSS3_P8(normal, AC, AB);
+		__m256 signedVolume;
+		DOT3_P8(signedVolume, toOrig, normal);
+
+		//facing is 1 when 0 <= volume (NaN goes to 0)
+		__m256 facingMask = _mm256_cmp_ps( _mm256_setzero_ps(), signedVolume, _CMP_LE_OQ );
+		//fused multiply-subtract does not give exact zero for x*y-y*x, so triangles with two equal vertices
+		//would get random facing; make them facing like the other implementations do (their volume is exactly zero)
+		__m256 sameBC = _mm256_and_ps( _mm256_and_ps(
+			_mm256_cmp_ps( AB_x, AC_x, _CMP_EQ_OQ ),
+			_mm256_cmp_ps( AB_y, AC_y, _CMP_EQ_OQ ) ),
+			_mm256_cmp_ps( AB_z, AC_z, _CMP_EQ_OQ )
+		);
+		facingMask = _mm256_or_ps( facingMask, sameBC );
+		//pack eight dwords into eight bytes
+		__m256i isFacing = _mm256_and_si256( _mm256_castps_si256( facingMask ), one );
+		__m128i words = _mm_packs_epi32( _mm256_castsi256_si128( isFacing ), _mm256_extracti128_si256( isFacing, 1 ) );
+		_mm_storel_epi64( (__m128i*)&facing[i], _mm_packus_epi16( words, words ) );
+	}
+	_mm256_zeroupper();
+
+	if ( i < numTris ) {
+		idSIMD_AVX::CalcTriFacing( verts, numVerts, indexes + 3 * i, 3 * ( numTris - i ), lightOrigin, facing + i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::CreateShadowCache
+
+  writes both the near and the projected vertex with a single 256-bit store
+============
+*/
+int idSIMD_AVX2::CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) {
+	const __m128 xyzMask = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+	const __m128 oneW = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+	const __m128 light = _mm_setr_ps( lightOrigin.x, lightOrigin.y, lightOrigin.z, 0.0f );
+	int outVerts = 0;
+
+	int i = 0;
+	for ( ; i + 8 <= numVerts; i += 8 ) {
+		//skip eight vertices at once if all of them are already in the cache
+		__m256i remap = _mm256_loadu_si256( (__m256i*)&vertRemap[i] );
+		int todo = _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( remap, _mm256_setzero_si256() ) ) );
+		for ( int k = i; todo; k++, todo >>= 1 ) {
+			if ( !( todo & 1 ) ) {
+				continue;
+			}
+			__m128 xyz = _mm_and_ps( _mm_loadu_ps( verts[k].xyz.ToFloatPtr() ), xyzMask );
+			__m256 pair = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_or_ps( xyz, oneW ) ), _mm_and_ps( _mm_sub_ps( xyz, light ), xyzMask ), 1 );
+			_mm256_storeu_ps( vertexCache[outVerts].ToFloatPtr(), pair );
+			vertRemap[k] = outVerts;
+			outVerts += 2;
+		}
+	}
+	for ( ; i < numVerts; i++ ) {
+		if ( vertRemap[i] ) {
+			continue;
+		}
+		__m128 xyz = _mm_and_ps( _mm_loadu_ps( verts[i].xyz.ToFloatPtr() ), xyzMask );
+		__m256 pair = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_or_ps( xyz, oneW ) ), _mm_and_ps( _mm_sub_ps( xyz, light ), xyzMask ), 1 );
+		_mm256_storeu_ps( vertexCache[outVerts].ToFloatPtr(), pair );
+		vertRemap[i] = outVerts;
+		outVerts += 2;
+	}
+	_mm256_zeroupper();
+	return outVerts;
+}
+
+/*
+============
+idSIMD_AVX2::CreateVertexProgramShadowCache
+============
+*/
+int idSIMD_AVX2::CreateVertexProgramShadowCache( idVec4 *vertexCache, const idDrawVert *verts, const int numVerts ) {
+	const __m128 xyzMask = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+	const __m128 oneW = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+	for ( int i = 0; i < numVerts; i++ ) {
+		__m128 xyz = _mm_and_ps( _mm_loadu_ps( verts[i].xyz.ToFloatPtr() ), xyzMask );
+		__m256 pair = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_or_ps( xyz, oneW ) ), xyz, 1 );
+		_mm256_storeu_ps( vertexCache[i*2].ToFloatPtr(), pair );
+	}
+	_mm256_zeroupper();
+	return numVerts * 2;
+}
+
+/*
+============
+idSIMD_AVX2::ShadowVolume_CreateSilTriangles
+
+  Checks eight edges at once, so that the edges which are not on the silhouette
+  (which is usually the vast majority) are skipped without branching on each of them.
+  Facing bytes are fetched by gathering the aligned dword which contains them:
+  such a read never crosses a page boundary, so it is safe even at the end of the array.
+============
+*/
+int idSIMD_AVX2::ShadowVolume_CreateSilTriangles( int *shadowIndexes, const byte *facing, const silEdge_s *silEdges, const int numSilEdges ) {
+	static_assert( sizeof( silEdge_s ) == 4 * sizeof( int ), "silEdge_t must consist of four ints" );
+	const int *edgeInts = (const int *)silEdges;
+	const __m256i edgeOffsets = _mm256_setr_epi32( 0, 4, 8, 12, 16, 20, 24, 28 );
+	const int *alignedFacing = (const int *)( (size_t)facing & ~size_t(3) );
+	const __m256i misalign = _mm256_set1_epi32( int( (size_t)facing & 3 ) );
+	const __m256i dwordMask = _mm256_set1_epi32( ~3 );
+	const __m256i byteMask = _mm256_set1_epi32( 0xFF );
+	const __m256i three = _mm256_set1_epi32( 3 );
+	int *si = shadowIndexes;
+
+	int i = 0;
+	for ( ; i + 8 <= numSilEdges; i += 8 ) {
+		#define FETCH_FACING(f, k) \
+			__m256i f##_offs = _mm256_add_epi32( _mm256_i32gather_epi32( edgeInts + 4 * i + k, edgeOffsets, 4 ), misalign ); \
+			__m256i f = _mm256_i32gather_epi32( alignedFacing, _mm256_and_si256( f##_offs, dwordMask ), 1 ); \
+			f = _mm256_and_si256( _mm256_srlv_epi32( f, _mm256_slli_epi32( _mm256_and_si256( f##_offs, three ), 3 ) ), byteMask );
+		FETCH_FACING(f1, 0);
+		FETCH_FACING(f2, 1);
+		#undef FETCH_FACING
+
+		int silMask = ~_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( f1, f2 ) ) ) & 0xFF;
+		if ( !silMask ) {
+			continue;
+		}
+
+		int f1s[8], f2s[8];
+		_mm256_storeu_si256( (__m256i*)f1s, f1 );
+		_mm256_storeu_si256( (__m256i*)f2s, f2 );
+		for ( int k = 0; silMask; k++, silMask >>= 1 ) {
+			if ( !( silMask & 1 ) ) {
+				continue;
+			}
+			const silEdge_s &sil = silEdges[i + k];
+			const int v1 = sil.v1 << 1;
+			const int v2 = sil.v2 << 1;
+			si[0] = v1;
+			si[1] = v2 ^ f1s[k];
+			si[2] = v2 ^ f2s[k];
+			si[3] = v1 ^ f2s[k];
+			si[4] = v1 ^ f1s[k];
+			si[5] = v2 ^ 1;
+			si += 6;
+		}
+	}
+	_mm256_zeroupper();
+
+	if ( i < numSilEdges ) {
+		si += idSIMD_AVX::ShadowVolume_CreateSilTriangles( si, facing, silEdges + i, numSilEdges - i );
+	}
+	return si - shadowIndexes;
+}
+
+// lane masks for loading the last 1..7 floats of an array
+static const int DOT_TAIL_MASK[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+/*
+============
+Dot_AVX2
+
+  dot product of two float arrays of arbitrary length and alignment
+  never reads past the end of the arrays
+============
+*/
+static ALLOW_AVX2 float Dot_AVX2( const float *src1, const float *src2, const int count ) {
+	__m256 sum0 = _mm256_setzero_ps();
+	__m256 sum1 = _mm256_setzero_ps();
+	int i = 0;
+	for ( ; i + 16 <= count; i += 16 ) {
+		sum0 = _mm256_fmadd_ps( _mm256_loadu_ps( src1 + i ), _mm256_loadu_ps( src2 + i ), sum0 );
+		sum1 = _mm256_fmadd_ps( _mm256_loadu_ps( src1 + i + 8 ), _mm256_loadu_ps( src2 + i + 8 ), sum1 );
+	}
+	if ( i + 8 <= count ) {
+		sum0 = _mm256_fmadd_ps( _mm256_loadu_ps( src1 + i ), _mm256_loadu_ps( src2 + i ), sum0 );
+		i += 8;
+	}
+	if ( i < count ) {
+		__m256i mask = _mm256_loadu_si256( (const __m256i *)( DOT_TAIL_MASK + 8 - ( count - i ) ) );
+		sum1 = _mm256_fmadd_ps( _mm256_maskload_ps( src1 + i, mask ), _mm256_maskload_ps( src2 + i, mask ), sum1 );
+	}
+	__m256 sum = _mm256_add_ps( sum0, sum1 );
+	__m128 s = _mm_add_ps( _mm256_castps256_ps128( sum ), _mm256_extractf128_ps( sum, 1 ) );
+	s = _mm_add_ps( s, _mm_movehl_ps( s, s ) );
+	s = _mm_add_ss( s, _mm_shuffle_ps( s, s, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	return _mm_cvtss_f32( s );
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+============
+*/
+void idSIMD_AVX2::Dot( float &dot, const float *src1, const float *src2, const int count ) {
+	if ( count < 8 ) {
+		idSIMD_AVX::Dot( dot, src1, src2, count );
+		return;
+	}
+	dot = Dot_AVX2( src1, src2, count );
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MatX_MultiplyVecX
+
+  the generic code has unrolled cases for narrow matrices, use them
+============
+*/
+void idSIMD_AVX2::MatX_MultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	int numRows = mat.GetNumRows();
+	int numColumns = mat.GetNumColumns();
+
+	if ( numColumns < 8 ) {
+		idSIMD_AVX::MatX_MultiplyVecX( dst, mat, vec );
+		return;
+	}
+
+	assert( vec.GetSize() >= numColumns );
+	assert( dst.GetSize() >= numRows );
+
+	const float *mPtr = mat.ToFloatPtr();
+	const float *vPtr = vec.ToFloatPtr();
+	float *dstPtr = dst.ToFloatPtr();
+	for ( int i = 0; i < numRows; i++ ) {
+		dstPtr[i] = Dot_AVX2( mPtr, vPtr, numColumns );
+		mPtr += numColumns;
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LowerTriangularSolve
+
+  solves x in Lx = b for the n * n sub-matrix of L
+  if skip > 0 the first skip elements of x are assumed to be valid already
+  L has to be a lower triangular matrix with (implicit) ones on the diagonal
+  x == b is allowed
+============
+*/
+void idSIMD_AVX2::MatX_LowerTriangularSolve( const idMatX &L, float *x, const float *b, const int n, int skip ) {
+	if ( n < 8 ) {
+		idSIMD_AVX::MatX_LowerTriangularSolve( L, x, b, n, skip );
+		return;
+	}
+
+	if ( skip >= n ) {
+		return;
+	}
+
+	const float *lptr = L[skip];
+	const int nc = L.GetNumColumns();
+	for ( int i = skip; i < n; i++ ) {
+		x[i] = b[i] - Dot_AVX2( lptr, x, i );
+		lptr += nc;
+	}
+	_mm256_zeroupper();
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LDLTFactor
+
+  in-place factorization LDL' of the n * n sub-matrix of mat
+  the reciprocal of the diagonal elements are stored in invDiag
+============
+*/
+bool idSIMD_AVX2::MatX_LDLTFactor( idMatX &mat, idVecX &invDiag, const int n ) {
+	if ( n < 8 ) {
+		return idSIMD_AVX::MatX_LDLTFactor( mat, invDiag, n );
+	}
+
+	const int nc = mat.GetNumColumns();
+	float *v = (float *) _alloca16( n * sizeof( float ) );
+	float *diag = (float *) _alloca16( n * sizeof( float ) );
+
+	for ( int i = 0; i < n; i++ ) {
+		float *mptr = mat[i];
+
+		// v = D * L[i], the row of L computed by the previous iterations
+		int k = 0;
+		for ( ; k + 8 <= i; k += 8 ) {
+			_mm256_storeu_ps( v + k, _mm256_mul_ps( _mm256_loadu_ps( diag + k ), _mm256_loadu_ps( mptr + k ) ) );
+		}
+		for ( ; k < i; k++ ) {
+			v[k] = diag[k] * mptr[k];
+		}
+
+		float sum = mptr[i] - Dot_AVX2( v, mptr, i );
+		if ( sum == 0.0f ) {
+			_mm256_zeroupper();
+			return false;
+		}
+
+		mptr[i] = sum;
+		diag[i] = sum;
+		float d = 1.0f / sum;
+		invDiag[i] = d;
+
+		if ( i + 1 >= n ) {
+			break;
+		}
+
+		// column i of L below the diagonal
+		mptr = mat[i+1];
+		for ( int j = i + 1; j < n; j++ ) {
+			mptr[i] = ( mptr[i] - Dot_AVX2( mptr, v, i ) ) * d;
+			mptr += nc;
+		}
+	}
+	_mm256_zeroupper();
+	return true;
+}
+
 #endif
+
+
+/*
+============
+MatX tests
+
+  compare the AVX2 matrix kernels with the generic ones on the sizes typical for AF and contact constraint systems
+============
+*/
+
+static void MakeRandomSymmetricMatrix( idMatX &mat, int n, idRandom &rnd ) {
+	idMatX a;
+	a.SetSize( n, n );
+	for ( int i = 0; i < n; i++ ) {
+		for ( int j = 0; j < n; j++ ) {
+			a[i][j] = rnd.CRandomFloat();
+		}
+	}
+	// A * A' + n * I is symmetric positive definite, like the constraint matrices of the LCP
+	mat.SetSize( n, n );
+	for ( int i = 0; i < n; i++ ) {
+		for ( int j = 0; j < n; j++ ) {
+			float sum = ( i == j ? n : 0.0f );
+			for ( int k = 0; k < n; k++ ) {
+				sum += a[i][k] * a[j][k];
+			}
+			mat[i][j] = sum;
+		}
+	}
+}
+
+static void MakeRandomVector( idVecX &vec, int n, idRandom &rnd ) {
+	vec.SetSize( n );
+	for ( int i = 0; i < n; i++ ) {
+		vec[i] = rnd.CRandomFloat();
+	}
+}
+
+static float MaxRelativeError( const float *test, const float *ref, int count ) {
+	float maxRef = 1e-6f, maxDiff = 0.0f;
+	for ( int i = 0; i < count; i++ ) {
+		maxRef = idMath::Fmax( maxRef, idMath::Fabs( ref[i] ) );
+		maxDiff = idMath::Fmax( maxDiff, idMath::Fabs( test[i] - ref[i] ) );
+	}
+	return maxDiff / maxRef;
+}
+
+static const int MATX_TEST_SIZES[] = { 1, 3, 6, 7, 8, 9, 12, 17, 24, 31, 48, 64, 96, 150, 0 };
+
+TEST_CASE("SimdAVX2:MatX") {
+	idSIMDProcessor *avx2 = idSIMD::CreateProcessor( "AVX2" );
+	idSIMDProcessor *generic = idSIMD::CreateProcessor( "generic" );
+	if ( idStr::Cmp( avx2->GetName(), "AVX2" ) != 0 ) {
+		MESSAGE( "AVX2 is not supported, skipping" );
+		delete avx2;
+		delete generic;
+		return;
+	}
+
+	idRandom rnd( 1337 );
+	for ( int s = 0; MATX_TEST_SIZES[s]; s++ ) {
+		int n = MATX_TEST_SIZES[s];
+		CAPTURE( n );
+
+		idMatX mat, matGeneric, matAvx2;
+		idVecX vec, b, resGeneric, resAvx2, invGeneric, invAvx2;
+		MakeRandomSymmetricMatrix( mat, n, rnd );
+		MakeRandomVector( vec, n, rnd );
+		MakeRandomVector( b, n, rnd );
+
+		{	// Dot
+			float dotGeneric, dotAvx2;
+			generic->Dot( dotGeneric, mat[n-1], vec.ToFloatPtr(), n );
+			avx2->Dot( dotAvx2, mat[n-1], vec.ToFloatPtr(), n );
+			CHECK( MaxRelativeError( &dotAvx2, &dotGeneric, 1 ) < 1e-5f );
+		}
+
+		{	// MatX_MultiplyVecX
+			resGeneric.SetSize( n );
+			resAvx2.SetSize( n );
+			generic->MatX_MultiplyVecX( resGeneric, mat, vec );
+			avx2->MatX_MultiplyVecX( resAvx2, mat, vec );
+			CHECK( MaxRelativeError( resAvx2.ToFloatPtr(), resGeneric.ToFloatPtr(), n ) < 1e-5f );
+		}
+
+		{	// MatX_LDLTFactor
+			matGeneric = mat;
+			matAvx2 = mat;
+			invGeneric.SetSize( n );
+			invAvx2.SetSize( n );
+			CHECK( generic->MatX_LDLTFactor( matGeneric, invGeneric, n ) );
+			CHECK( avx2->MatX_LDLTFactor( matAvx2, invAvx2, n ) );
+			CHECK( MaxRelativeError( matAvx2.ToFloatPtr(), matGeneric.ToFloatPtr(), n * n ) < 1e-4f );
+			CHECK( MaxRelativeError( invAvx2.ToFloatPtr(), invGeneric.ToFloatPtr(), n ) < 1e-4f );
+		}
+
+		{	// MatX_LowerTriangularSolve, both from scratch and with some rows already solved
+			for ( int skip = 0; skip <= n; skip += idMath::Imax( n / 3, 1 ) ) {
+				CAPTURE( skip );
+				resGeneric = b;
+				generic->MatX_LowerTriangularSolve( matGeneric, resGeneric.ToFloatPtr(), resGeneric.ToFloatPtr(), n );
+				resAvx2 = b;
+				memcpy( resAvx2.ToFloatPtr(), resGeneric.ToFloatPtr(), skip * sizeof( float ) );
+				avx2->MatX_LowerTriangularSolve( matGeneric, resAvx2.ToFloatPtr(), b.ToFloatPtr(), n, skip );
+				CHECK( MaxRelativeError( resAvx2.ToFloatPtr(), resGeneric.ToFloatPtr(), n ) < 1e-4f );
+			}
+		}
+	}
+
+	delete avx2;
+	delete generic;
+}
+
+TEST_CASE("SimdAVX2:MatXPerformance"
+	* doctest::skip()
+) {
+	idSIMDProcessor *avx2 = idSIMD::CreateProcessor( "AVX2" );
+	idSIMDProcessor *generic = idSIMD::CreateProcessor( "generic" );
+	idSIMDProcessor *processors[2] = { generic, avx2 };
+
+	idRandom rnd( 1337 );
+	for ( int n = 12; n <= 192; n *= 2 ) {
+		idMatX mat, work;
+		idVecX vec, res, invDiag;
+		MakeRandomSymmetricMatrix( mat, n, rnd );
+		MakeRandomVector( vec, n, rnd );
+		res.SetSize( n );
+		invDiag.SetSize( n );
+
+		// keep total work roughly constant over sizes
+		const int TRIES = idMath::Imax( 20000000 / ( n * n * n ), 10 );
+		double ms[2][3];
+		for ( int p = 0; p < 2; p++ ) {
+			idTimer timer;
+			timer.Clear(); timer.Start();
+			for ( int t = 0; t < TRIES; t++ ) {
+				work = mat;
+				processors[p]->MatX_LDLTFactor( work, invDiag, n );
+			}
+			timer.Stop();
+			ms[p][0] = timer.Milliseconds();
+
+			timer.Clear(); timer.Start();
+			for ( int t = 0; t < TRIES; t++ ) {
+				processors[p]->MatX_LowerTriangularSolve( work, res.ToFloatPtr(), vec.ToFloatPtr(), n );
+			}
+			timer.Stop();
+			ms[p][1] = timer.Milliseconds();
+
+			timer.Clear(); timer.Start();
+			for ( int t = 0; t < TRIES; t++ ) {
+				processors[p]->MatX_MultiplyVecX( res, mat, vec );
+			}
+			timer.Stop();
+			ms[p][2] = timer.Milliseconds();
+		}
+		MESSAGE( va( "n = %3d x %6d:  LDLTFactor %7.2lf / %7.2lf ms  LowerTriangularSolve %7.2lf / %7.2lf ms  MultiplyVecX %7.2lf / %7.2lf ms  (%s / %s)",
+			n, TRIES, ms[0][0], ms[1][0], ms[0][1], ms[1][1], ms[0][2], ms[1][2], generic->GetName(), avx2->GetName()
+		) );
+	}
+
+	delete avx2;
+	delete generic;
+}
+
+/*
+============
+Shadow tests
+
+  compare the AVX2 shadow volume kernels with the generic ones on a procedural closed mesh
+============
+*/
+
+struct shadowTestMesh_t {
+	idList<idDrawVert>	verts;
+	idList<int>			indexes;
+	idList<silEdge_t>	silEdges;
+};
+
+// torus with rings x segments quads, each quad split into two triangles
+static void MakeShadowTestTorus( shadowTestMesh_t &mesh, int rings, int segments, idRandom &rnd ) {
+	mesh.verts.SetNum( rings * segments );
+	for ( int i = 0; i < rings; i++ ) {
+		for ( int j = 0; j < segments; j++ ) {
+			float u = idMath::TWO_PI * i / rings;
+			float v = idMath::TWO_PI * j / segments;
+			float r = 64.0f + 24.0f * idMath::Cos( v );
+			idDrawVert &dv = mesh.verts[i * segments + j];
+			dv.Clear();
+			dv.xyz.Set( r * idMath::Cos( u ), r * idMath::Sin( u ), 24.0f * idMath::Sin( v ) );
+			dv.xyz += idVec3( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() ) * 0.5f;
+		}
+	}
+	#define VERT( i, j ) ( ( ( i ) % rings ) * segments + ( ( j ) % segments ) )
+	mesh.indexes.SetNum( rings * segments * 6 );
+	mesh.silEdges.SetNum( rings * segments * 3 );
+	for ( int i = 0; i < rings; i++ ) {
+		for ( int j = 0; j < segments; j++ ) {
+			int q = i * segments + j;
+			int a = VERT( i, j ), b = VERT( i + 1, j ), c = VERT( i + 1, j + 1 ), d = VERT( i, j + 1 );
+			int *tri = &mesh.indexes[q * 6];
+			tri[0] = a; tri[1] = b; tri[2] = c;
+			tri[3] = a; tri[4] = c; tri[5] = d;
+			// diagonal, edge shared with previous quad in segment direction, edge shared with previous quad in ring direction
+			int qPrevSeg = i * segments + ( j + segments - 1 ) % segments;
+			int qPrevRing = ( ( i + rings - 1 ) % rings ) * segments + j;
+			silEdge_t *sil = &mesh.silEdges[q * 3];
+			sil[0].p1 = 2 * q + 0; sil[0].p2 = 2 * q + 1; sil[0].v1 = a; sil[0].v2 = c;
+			sil[1].p1 = 2 * q + 0; sil[1].p2 = 2 * qPrevSeg + 1; sil[1].v1 = b; sil[1].v2 = a;
+			sil[2].p1 = 2 * q + 1; sil[2].p2 = 2 * qPrevRing + 0; sil[2].v1 = a; sil[2].v2 = d;
+		}
+	}
+	#undef VERT
+}
+
+TEST_CASE("SimdAVX2:Shadow") {
+	idSIMDProcessor *avx2 = idSIMD::CreateProcessor( "AVX2" );
+	idSIMDProcessor *generic = idSIMD::CreateProcessor( "generic" );
+	if ( idStr::Cmp( avx2->GetName(), "AVX2" ) != 0 ) {
+		MESSAGE( "AVX2 is not supported, skipping" );
+		delete avx2;
+		delete generic;
+		return;
+	}
+
+	idRandom rnd( 1337 );
+	// odd sizes check the scalar tails
+	static const int SIZES[][2] = { { 3, 3 }, { 3, 5 }, { 4, 7 }, { 16, 9 }, { 64, 33 }, { 0, 0 } };
+	for ( int s = 0; SIZES[s][0]; s++ ) {
+		shadowTestMesh_t mesh;
+		MakeShadowTestTorus( mesh, SIZES[s][0], SIZES[s][1], rnd );
+		const int numVerts = mesh.verts.Num();
+		const int numFaces = mesh.indexes.Num() / 3;
+		CAPTURE( numVerts );
+		// real meshes have some degenerate triangles
+		for ( int f = 0; f < numFaces; f += 7 ) {
+			mesh.indexes[3 * f + 2] = mesh.indexes[3 * f + 1];
+		}
+
+		for ( int l = 0; l < 8; l++ ) {
+			idVec3 lightOrigin( rnd.CRandomFloat() * 200.0f, rnd.CRandomFloat() * 200.0f, rnd.CRandomFloat() * 200.0f );
+			CAPTURE( lightOrigin );
+
+			{	// CalcTriFacing: must match unless the light is on the plane of triangle up to rounding errors
+				idList<byte> facingGeneric, facingAvx2;
+				facingGeneric.SetNum( numFaces );
+				facingAvx2.SetNum( numFaces );
+				generic->CalcTriFacing( mesh.verts.Ptr(), numVerts, mesh.indexes.Ptr(), mesh.indexes.Num(), lightOrigin, facingGeneric.Ptr() );
+				avx2->CalcTriFacing( mesh.verts.Ptr(), numVerts, mesh.indexes.Ptr(), mesh.indexes.Num(), lightOrigin, facingAvx2.Ptr() );
+				int numMismatches = 0, numUnexplained = 0;
+				for ( int f = 0; f < numFaces; f++ ) {
+					if ( facingGeneric[f] == facingAvx2[f] ) {
+						continue;
+					}
+					numMismatches++;
+					const int *tri = &mesh.indexes[3 * f];
+					idPlane plane( mesh.verts[tri[0]].xyz, mesh.verts[tri[1]].xyz, mesh.verts[tri[2]].xyz );
+					if ( idMath::Fabs( plane.Distance( lightOrigin ) ) > 1e-3f ) {
+						numUnexplained++;
+					}
+				}
+				CHECK( numUnexplained == 0 );
+				CHECK( numMismatches <= numFaces / 1000 );
+			}
+
+			{	// ShadowVolume_CreateSilTriangles: integer code, must match exactly
+				idList<byte> facing;
+				facing.SetNum( numFaces + 1 );
+				generic->CalcTriFacing( mesh.verts.Ptr(), numVerts, mesh.indexes.Ptr(), mesh.indexes.Num(), lightOrigin, facing.Ptr() );
+				facing[numFaces] = 1;
+				idList<int> silGeneric, silAvx2;
+				silGeneric.SetNum( mesh.silEdges.Num() * 6 );
+				silAvx2.SetNum( mesh.silEdges.Num() * 6 );
+				int numGeneric = generic->ShadowVolume_CreateSilTriangles( silGeneric.Ptr(), facing.Ptr(), mesh.silEdges.Ptr(), mesh.silEdges.Num() );
+				int numAvx2 = avx2->ShadowVolume_CreateSilTriangles( silAvx2.Ptr(), facing.Ptr(), mesh.silEdges.Ptr(), mesh.silEdges.Num() );
+				REQUIRE( numGeneric == numAvx2 );
+				CHECK( memcmp( silGeneric.Ptr(), silAvx2.Ptr(), numGeneric * sizeof( int ) ) == 0 );
+			}
+
+			{	// CreateShadowCache: some vertices are already in cache
+				idList<int> remapGeneric, remapAvx2;
+				remapGeneric.SetNum( numVerts );
+				for ( int v = 0; v < numVerts; v++ ) {
+					remapGeneric[v] = ( rnd.RandomInt( 4 ) == 0 ? -1 : 0 );
+				}
+				remapAvx2 = remapGeneric;
+				idList<idVec4> cacheGeneric, cacheAvx2;
+				cacheGeneric.SetNum( numVerts * 2 );
+				cacheAvx2.SetNum( numVerts * 2 );
+				int numGeneric = generic->CreateShadowCache( cacheGeneric.Ptr(), remapGeneric.Ptr(), lightOrigin, mesh.verts.Ptr(), numVerts );
+				int numAvx2 = avx2->CreateShadowCache( cacheAvx2.Ptr(), remapAvx2.Ptr(), lightOrigin, mesh.verts.Ptr(), numVerts );
+				REQUIRE( numGeneric == numAvx2 );
+				CHECK( memcmp( cacheGeneric.Ptr(), cacheAvx2.Ptr(), numGeneric * sizeof( idVec4 ) ) == 0 );
+				CHECK( memcmp( remapGeneric.Ptr(), remapAvx2.Ptr(), numVerts * sizeof( int ) ) == 0 );
+			}
+		}
+
+		{	// CreateVertexProgramShadowCache
+			idList<idVec4> cacheGeneric, cacheAvx2;
+			cacheGeneric.SetNum( numVerts * 2 );
+			cacheAvx2.SetNum( numVerts * 2 );
+			CHECK( generic->CreateVertexProgramShadowCache( cacheGeneric.Ptr(), mesh.verts.Ptr(), numVerts ) == numVerts * 2 );
+			CHECK( avx2->CreateVertexProgramShadowCache( cacheAvx2.Ptr(), mesh.verts.Ptr(), numVerts ) == numVerts * 2 );
+			CHECK( memcmp( cacheGeneric.Ptr(), cacheAvx2.Ptr(), numVerts * 2 * sizeof( idVec4 ) ) == 0 );
+		}
+	}
+
+	delete avx2;
+	delete generic;
+}
+
+TEST_CASE("SimdAVX2:ShadowPerformance"
+	* doctest::skip()
+) {
+	idSIMDProcessor *avx2 = idSIMD::CreateProcessor( "AVX2" );
+	idSIMDProcessor *generic = idSIMD::CreateProcessor( "generic" );
+	idSIMDProcessor *processors[2] = { generic, avx2 };
+
+	idRandom rnd( 1337 );
+	// from a typical detailed prop up to a high-poly mesh
+	for ( int rings = 32; rings <= 512; rings *= 4 ) {
+		shadowTestMesh_t mesh;
+		MakeShadowTestTorus( mesh, rings, rings / 2, rnd );
+		const int numVerts = mesh.verts.Num();
+		const int numFaces = mesh.indexes.Num() / 3;
+		idList<byte> facing;
+		facing.SetNum( numFaces + 1 );
+		idList<int> silIndexes, remap;
+		silIndexes.SetNum( mesh.silEdges.Num() * 6 );
+		remap.SetNum( numVerts );
+		idList<idVec4> cache;
+		cache.SetNum( numVerts * 2 );
+		const idVec3 lightOrigin( 150.0f, 40.0f, 60.0f );
+
+		// keep total work roughly constant over sizes
+		const int TRIES = idMath::Imax( 50000000 / numFaces, 10 );
+		double ms[2][3];
+		int numSilIndexes[2];
+		for ( int p = 0; p < 2; p++ ) {
+			idTimer timer;
+			timer.Clear(); timer.Start();
+			for ( int t = 0; t < TRIES; t++ ) {
+				processors[p]->CalcTriFacing( mesh.verts.Ptr(), numVerts, mesh.indexes.Ptr(), mesh.indexes.Num(), lightOrigin, facing.Ptr() );
+			}
+			timer.Stop();
+			ms[p][0] = timer.Milliseconds();
+			facing[numFaces] = 1;
+
+			timer.Clear(); timer.Start();
+			for ( int t = 0; t < TRIES; t++ ) {
+				numSilIndexes[p] = processors[p]->ShadowVolume_CreateSilTriangles( silIndexes.Ptr(), facing.Ptr(), mesh.silEdges.Ptr(), mesh.silEdges.Num() );
+			}
+			timer.Stop();
+			ms[p][1] = timer.Milliseconds();
+
+			timer.Clear(); timer.Start();
+			for ( int t = 0; t < TRIES; t++ ) {
+				memset( remap.Ptr(), 0, numVerts * sizeof( int ) );
+				processors[p]->CreateShadowCache( cache.Ptr(), remap.Ptr(), lightOrigin, mesh.verts.Ptr(), numVerts );
+			}
+			timer.Stop();
+			ms[p][2] = timer.Milliseconds();
+		}
+		CHECK( numSilIndexes[0] == numSilIndexes[1] );
+		MESSAGE( va( "%7d tris x %5d:  CalcTriFacing %7.2lf / %7.2lf ms  CreateSilTriangles %7.2lf / %7.2lf ms (%d sil edges)  CreateShadowCache %7.2lf / %7.2lf ms  (%s / %s)",
+			numFaces, TRIES, ms[0][0], ms[1][0], ms[0][1], ms[1][1], numSilIndexes[1] / 6, ms[0][2], ms[1][2], generic->GetName(), avx2->GetName()
+		) );
+	}
+
+	delete avx2;
+	delete generic;
+}
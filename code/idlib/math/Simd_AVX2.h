@@ -41,5 +41,14 @@ public:
 	virtual void CullByFrustum2( idDrawVert *verts, const int numVerts, const idPlane frustum[6], unsigned short *pointCull, float epsilon ) override ALLOW_AVX2;
 	virtual void DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) override ALLOW_AVX2;
 	virtual void NormalizeTangents( idDrawVert *verts, const int numVerts ) override ALLOW_AVX2;
+	virtual void CalcTriFacing( const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes, const idVec3 &lightOrigin, byte *facing ) override ALLOW_AVX2;
+	virtual int  CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) override ALLOW_AVX2;
+	virtual int  CreateVertexProgramShadowCache( idVec4 *vertexCache, const idDrawVert *verts, const int numVerts ) override ALLOW_AVX2;
+	virtual int  ShadowVolume_CreateSilTriangles( int *shadowIndexes, const byte *facing, const silEdge_s *silEdges, const int numSilEdges ) override ALLOW_AVX2;
+
+	virtual void Dot( float &dot, const float *src1, const float *src2, const int count ) override ALLOW_AVX2;
+	virtual void MatX_MultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) override ALLOW_AVX2;
+	virtual void MatX_LowerTriangularSolve( const idMatX &L, float *x, const float *b, const int n, int skip = 0 ) override ALLOW_AVX2;
+	virtual bool MatX_LDLTFactor( idMatX &mat, idVecX &invDiag, const int n ) override ALLOW_AVX2;
 #endif
 };
@@ -2771,6 +2771,43 @@ int idSIMD_Generic::CreateVertexProgramShadowCache( idVec4 *shadowVerts, const i
 	return numVerts * 2;
 }
 
+/*
+============
+idSIMD_Generic::ShadowVolume_CreateSilTriangles
+
+  facing must contain 0 or 1 for every face referenced by the edges
+============
+*/
+int idSIMD_Generic::ShadowVolume_CreateSilTriangles( int *shadowIndexes, const byte *facing, const silEdge_s *silEdges, const int numSilEdges ) {
+	int *si = shadowIndexes;
+
+	for ( int i = 0; i < numSilEdges; i++ ) {
+		const silEdge_s &sil = silEdges[i];
+
+		const int f1 = facing[sil.p1];
+		const int f2 = facing[sil.p2];
+
+		if ( !( f1 ^ f2 ) ) {
+			continue;
+		}
+
+		const int v1 = sil.v1 << 1;
+		const int v2 = sil.v2 << 1;
+
+		// set the two triangle winding orders based on facing
+		// without using a poorly-predictable branch
+		si[0] = v1;
+		si[1] = v2 ^ f1;
+		si[2] = v2 ^ f2;
+		si[3] = v1 ^ f2;
+		si[4] = v1 ^ f1;
+		si[5] = v2 ^ 1;
+
+		si += 6;
+	}
+	return si - shadowIndexes;
+}
+
 /*
 ============
 idSIMD_Generic::UpSamplePCMTo44kHz
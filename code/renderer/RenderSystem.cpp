@@ -114,12 +114,20 @@ static void R_PerformanceCounters( void ) {
 	}
 
 	if ( r_showInteractions.GetBool() ) {
-		common->Printf( "createInteractions:%i createLightTris:%i createShadowVolumes:%i\n",
-		                tr.pc.c_createInteractions, tr.pc.c_createLightTris, tr.pc.c_createShadowVolumes );
+		int cacheBytes = 0, cacheEntries = 0;
+		for ( int i = 0; i < tr.worlds.Num(); i++ ) {
+			cacheBytes += tr.worlds[i]->interactionGeometryCache.Memory();
+			cacheEntries += tr.worlds[i]->interactionGeometryCache.NumEntries();
+		}
+		common->Printf( "createInteractions:%i createLightTris:%i createShadowVolumes:%i staticRebuilds:%i cacheHits:%i cache:%i/%ikB\n",
+		                tr.pc.c_createInteractions, tr.pc.c_createLightTris, tr.pc.c_createShadowVolumes,
+		                tr.pc.c_interactionRebuilds, tr.pc.c_interactionCacheHits, cacheEntries, cacheBytes >> 10 );
 	}
 	if ( r_showDefs.GetBool() ) {
 		common->Printf( "viewEntities:%i  shadowEntities:%i  viewLights:%i\n", tr.pc.c_visibleViewEntities,
 		                tr.pc.c_shadowViewEntities, tr.pc.c_viewLights );
+		common->Printf( "viewFloods:%i  floodCacheHits:%i  floodAreas:%i\n", tr.pc.c_viewFloods,
+		                tr.pc.c_viewFloodCacheHits, tr.pc.c_viewFloodAreas );
 	}
 	if ( r_showUpdates.GetBool() ) {
 		common->Printf( "entityUpdates:%i  entityRefs:%i  lightUpdates:%i  lightRefs:%i\n",
@@ -135,6 +143,16 @@ static void R_PerformanceCounters( void ) {
 	{ common->Printf( "%c", backEnd.pc.waitedFor ); }
 
 
+	TRACE_PLOT_NUMBER( "Interactions:staticRebuilds", (int64)tr.pc.c_interactionRebuilds );
+	TRACE_PLOT_NUMBER( "Interactions:cacheHits", (int64)tr.pc.c_interactionCacheHits );
+
+	TRACE_PLOT_NUMBER( "Portals:viewFloods", (int64)tr.pc.c_viewFloods );
+	TRACE_PLOT_NUMBER( "Portals:floodCacheHits", (int64)tr.pc.c_viewFloodCacheHits );
+	TRACE_PLOT_NUMBER( "Portals:floodAreas", (int64)tr.pc.c_viewFloodAreas );
+
+	TRACE_PLOT_NUMBER( "GUI:emittedQuads", (int64)( tr.pc.c_guiIndexes / 6 ) );
+	TRACE_PLOT_NUMBER( "GUI:cachedQuads", (int64)( tr.pc.c_guiCachedIndexes / 6 ) );
+
 	memset( &tr.pc, 0, sizeof( tr.pc ) );
 	memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
 }
@@ -247,6 +265,7 @@ void	R_AddDrawViewCmd( viewDef_t &parms ) {
 		lockFrameReserve = frameData->frameMemoryAllocated;
 	}
 	tr.pc.c_numViews++;
+	tr.pc.c_drawSurfs += parms.numDrawSurfs;
 
 	R_ViewStatistics( parms );
 }
@@ -579,7 +598,7 @@ BeginFrame
 void idRenderSystemLocal::BeginFrame( int windowWidth, int windowHeight ) {
 	setBufferCommand_t	*cmd;
 
-	if ( !glConfig.isInitialized ) {
+	if ( !glConfig.isInitialized && !headless ) {
 		return;
 	}
 
@@ -661,7 +680,7 @@ Returns the number of msec spent in the back end
 =============
 */
 void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
-	if ( !glConfig.isInitialized ) {
+	if ( !glConfig.isInitialized && !headless ) {
 		return;
 	}
 
@@ -669,13 +688,20 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 		RB_CopyDebugPrimitivesToBackend();
 		common->SetErrorIndirection( true );
 		session->ActivateFrontend();
-		frameBuffers->BeginFrame();
-		// start the back end up again with the new command list
-		R_IssueRenderCommands( backendFrameData );
-		renderBackend->EndFrame();
+		if ( headless ) {
+			// null backend, the commands of the previous frame are dropped
+			R_ClearCommandChain( backendFrameData );
+		} else {
+			frameBuffers->BeginFrame();
+			// start the back end up again with the new command list
+			R_IssueRenderCommands( backendFrameData );
+			renderBackend->EndFrame();
+		}
 		session->WaitForFrontendCompletion();
 		common->SetErrorIndirection( false );
-		TracingEndFrame();
+		if ( !headless ) {
+			TracingEndFrame();
+		}
 	} catch ( std::shared_ptr<ErrorReportedException> e ) {
 		session->WaitForFrontendCompletion();
 		common->SetErrorIndirection( false );
@@ -687,13 +713,20 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 
 	session->ExecuteDelayedFrameCommands();
 
-	// check for dynamic changes that require some initialization
-	R_CheckCvars();
+	// the frontend has finished its frame, and its frame memory is not reset yet
+	if ( frontEndBenchmark ) {
+		RecordFrontEndBenchmarkFrame();
+	}
+
+	if ( !headless ) {
+		// check for dynamic changes that require some initialization
+		R_CheckCvars();
 
 #ifdef DEBUG
-	// check for errors
-	GL_CheckErrors();
+		// check for errors
+		GL_CheckErrors();
 #endif
+	}
 
 	// use the other buffers next frame, because another CPU
 	// may still be rendering into the current buffers
@@ -722,6 +755,158 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 	R_PerformanceCounters();
 }
 
+/*
+=====================
+BeginFrontEndBenchmark
+=====================
+*/
+void idRenderSystemLocal::BeginFrontEndBenchmark( void ) {
+	frontEndBenchmarkFrames.Clear();
+	frontEndBenchmark = true;
+}
+
+/*
+=====================
+RecordFrontEndBenchmarkFrame
+=====================
+*/
+void idRenderSystemLocal::RecordFrontEndBenchmarkFrame( void ) {
+	frontEndBenchmarkFrame_t &frame = frontEndBenchmarkFrames.Alloc();
+	frame.frontEndMsec = pc.frontEndMsec;
+	memcpy( frame.stageUsec, pc.frontEndStageUsec, sizeof( frame.stageUsec ) );
+	frame.numViews = pc.c_numViews;
+	frame.numDrawSurfs = pc.c_drawSurfs;
+	frame.viewEntities = pc.c_visibleViewEntities;
+	frame.viewLights = pc.c_viewLights;
+	frame.createInteractions = pc.c_createInteractions;
+	frame.createLightTris = pc.c_createLightTris;
+	frame.createShadowVolumes = pc.c_createShadowVolumes;
+	frame.deformedSurfaces = pc.c_deformedSurfaces;
+	frame.staticAllocs = pc.c_alloc;
+	frame.staticFrees = pc.c_free;
+	frame.frameMemory = frameData ? frameData->frameMemoryAllocated.load() : 0;
+}
+
+/*
+=====================
+EndFrontEndBenchmark
+
+Writes the recorded frames as JSON: averages and maxima over the run, then every frame.
+=====================
+*/
+bool idRenderSystemLocal::EndFrontEndBenchmark( const char *demoName, const char *fileName ) {
+	static const char *stageNames[FES_COUNT] = {
+		"setupView", "findViewLightsAndEntities", "addLightSurfaces", "addModelSurfaces", "finishLights", "sortDrawSurfs"
+	};
+	static const struct {
+		const char *name;
+		size_t		offset;
+	} fields[] = {
+		{ "frontEndMsec", offsetof( frontEndBenchmarkFrame_t, frontEndMsec ) },
+		{ "views", offsetof( frontEndBenchmarkFrame_t, numViews ) },
+		{ "drawSurfs", offsetof( frontEndBenchmarkFrame_t, numDrawSurfs ) },
+		{ "viewEntities", offsetof( frontEndBenchmarkFrame_t, viewEntities ) },
+		{ "viewLights", offsetof( frontEndBenchmarkFrame_t, viewLights ) },
+		{ "createInteractions", offsetof( frontEndBenchmarkFrame_t, createInteractions ) },
+		{ "createLightTris", offsetof( frontEndBenchmarkFrame_t, createLightTris ) },
+		{ "createShadowVolumes", offsetof( frontEndBenchmarkFrame_t, createShadowVolumes ) },
+		{ "deformedSurfaces", offsetof( frontEndBenchmarkFrame_t, deformedSurfaces ) },
+		{ "staticAllocs", offsetof( frontEndBenchmarkFrame_t, staticAllocs ) },
+		{ "staticFrees", offsetof( frontEndBenchmarkFrame_t, staticFrees ) },
+		{ "frameMemory", offsetof( frontEndBenchmarkFrame_t, frameMemory ) },	// must be last, see the summary print
+	};
+	static const int numFields = sizeof( fields ) / sizeof( fields[0] );
+	#define FRAME_FIELD( frame, f ) ( *( const int * )( ( const byte * )&( frame ) + fields[f].offset ) )
+
+	frontEndBenchmark = false;
+
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "EndFrontEndBenchmark: couldn't open %s", fileName );
+		frontEndBenchmarkFrames.Clear();
+		return false;
+	}
+
+	const int numFrames = frontEndBenchmarkFrames.Num();
+	double sums[numFields] = { 0 }, stageSums[FES_COUNT] = { 0 };
+	int maxs[numFields] = { 0 };
+	uint64_t stageMaxs[FES_COUNT] = { 0 };
+	for ( int i = 0; i < numFrames; i++ ) {
+		const frontEndBenchmarkFrame_t &frame = frontEndBenchmarkFrames[i];
+		for ( int j = 0; j < numFields; j++ ) {
+			sums[j] += FRAME_FIELD( frame, j );
+			maxs[j] = idMath::Imax( maxs[j], FRAME_FIELD( frame, j ) );
+		}
+		for ( int j = 0; j < FES_COUNT; j++ ) {
+			stageSums[j] += frame.stageUsec[j];
+			stageMaxs[j] = Max( stageMaxs[j], frame.stageUsec[j] );
+		}
+	}
+	const double scale = numFrames ? 1.0 / numFrames : 0.0;
+
+	// the name is written as a JSON string
+	idStr demo;
+	for ( const char *c = demoName; *c; c++ ) {
+		if ( *c == '\\' ) {
+			demo += '/';
+		} else if ( *c == '"' ) {
+			demo += "\\\"";
+		} else if ( ( unsigned char )*c < ' ' ) {
+			demo += va( "\\u%04x", *c );
+		} else {
+			demo += *c;
+		}
+	}
+	f->Printf( "{\n\t\"demo\": \"%s\",\n\t\"numFrames\": %d,\n", demo.c_str(), numFrames );
+	f->Printf( "\t\"stages\": [" );
+	for ( int j = 0; j < FES_COUNT; j++ ) {
+		f->Printf( "%s\"%s\"", j ? ", " : " ", stageNames[j] );
+	}
+	f->Printf( " ],\n" );
+
+	f->Printf( "\t\"average\": {" );
+	for ( int j = 0; j < numFields; j++ ) {
+		f->Printf( " \"%s\": %.3f,", fields[j].name, sums[j] * scale );
+	}
+	f->Printf( " \"stageUsec\": [" );
+	for ( int j = 0; j < FES_COUNT; j++ ) {
+		f->Printf( "%s%.1f", j ? ", " : " ", stageSums[j] * scale );
+	}
+	f->Printf( " ] },\n" );
+
+	f->Printf( "\t\"max\": {" );
+	for ( int j = 0; j < numFields; j++ ) {
+		f->Printf( " \"%s\": %d,", fields[j].name, maxs[j] );
+	}
+	f->Printf( " \"stageUsec\": [" );
+	for ( int j = 0; j < FES_COUNT; j++ ) {
+		f->Printf( "%s%llu", j ? ", " : " ", ( unsigned long long )stageMaxs[j] );
+	}
+	f->Printf( " ] },\n" );
+
+	f->Printf( "\t\"frames\": [\n" );
+	for ( int i = 0; i < numFrames; i++ ) {
+		const frontEndBenchmarkFrame_t &frame = frontEndBenchmarkFrames[i];
+		f->Printf( "\t\t{" );
+		for ( int j = 0; j < numFields; j++ ) {
+			f->Printf( " \"%s\": %d,", fields[j].name, FRAME_FIELD( frame, j ) );
+		}
+		f->Printf( " \"stageUsec\": [" );
+		for ( int j = 0; j < FES_COUNT; j++ ) {
+			f->Printf( "%s%llu", j ? ", " : " ", ( unsigned long long )frame.stageUsec[j] );
+		}
+		f->Printf( " ] }%s\n", i + 1 < numFrames ? "," : "" );
+	}
+	f->Printf( "\t]\n}\n" );
+	#undef FRAME_FIELD
+
+	common->Printf( "frontend benchmark: %d frames, %.3f msec frontend average, %d kB frame memory peak, written to %s\n",
+		numFrames, sums[0] * scale, maxs[numFields - 1] >> 10, f->GetFullPath() );
+	fileSystem->CloseFile( f );
+	frontEndBenchmarkFrames.Clear();
+	return true;
+}
+
 /*
 =====================
 RenderViewToViewport
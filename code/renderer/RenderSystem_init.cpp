@@ -50,6 +50,8 @@ idCVar r_useNodeCommonChildren( "r_useNodeCommonChildren", "1", CVAR_RENDERER |
 idCVar r_useShadowProjectedCull( "r_useShadowProjectedCull", "1", CVAR_RENDERER | CVAR_BOOL, "discard triangles outside light volume before shadowing" );
 idCVar r_useShadowSurfaceScissor( "r_useShadowSurfaceScissor", "1", CVAR_RENDERER | CVAR_BOOL, "scissor shadows by the scissor rect of the interaction surfaces" );
 idCVar r_useInteractionTable( "r_useInteractionTable", "2", CVAR_RENDERER | CVAR_INTEGER, "which implementation to use for table of existing interactions: 0 = none, 1 = single full matrix, 2 = single hash table" );
+idCVar r_useInteractionCache( "r_useInteractionCache", "1", CVAR_RENDERER | CVAR_BOOL, "keep light and shadow geometry of freed static interactions and reuse it when the same entity / light pair is created again" );
+idCVar r_interactionCacheSize( "r_interactionCacheSize", "64", CVAR_RENDERER | CVAR_INTEGER | CVAR_ARCHIVE, "memory budget of the interaction geometry cache in MB", 0, 1024 );
 idCVar r_useTurboShadow( "r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "use the infinite projection with W technique for dynamic shadows" );
 idCVar r_useDeferredTangents( "r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform" );
 idCVar r_useCachedDynamicModels( "r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models" );
@@ -92,6 +94,7 @@ idCVar r_skipDynamicTextures( "r_skipDynamicTextures", "0", CVAR_RENDERER | CVAR
 idCVar r_skipEntities( "r_skipEntities", "0", CVAR_RENDERER | CVAR_BOOL, "draw only world geometry, skip all entity models rendering" );
 idCVar r_skipCopyTexture( "r_skipCopyTexture", "0", CVAR_RENDERER | CVAR_BOOL, "do all rendering, but don't actually copyTexSubImage2D" );
 idCVar r_skipBackEnd( "r_skipBackEnd", "0", CVAR_RENDERER | CVAR_BOOL, "don't draw anything" );
+idCVar r_headless( "r_headless", "0", CVAR_RENDERER | CVAR_BOOL | CVAR_INIT, "run the frontend without a window or GL context, nothing is drawn (e.g. for benchmarkDemo on machines without a GPU)" );
 idCVar r_skipRender( "r_skipRender", "0", CVAR_RENDERER | CVAR_INTEGER, "skip 3D rendering, but pass 2D" );
 idCVar r_skipRenderContext( "r_skipRenderContext", "0", CVAR_RENDERER | CVAR_BOOL, "NULL the rendering context during backend 3D rendering" );
 idCVar r_skipTranslucent( "r_skipTranslucent", "0", CVAR_RENDERER | CVAR_BOOL, "skip the translucent interaction rendering" );
@@ -454,6 +457,29 @@ void R_InitOpenGL( void ) {
 #endif
 }
 
+/*
+==================
+R_InitHeadless
+
+Null backend for r_headless: no window or GL context is created, so glConfig.isInitialized
+stays false and everything that needs GL (images, programs, the backend) is left alone.
+The frontend still runs every frame, its vertex cache writes go to system memory and
+the command lists are discarded.
+==================
+*/
+static void R_InitHeadless( void ) {
+	common->Printf( "----- Initializing headless renderer -----\n" );
+
+	glConfig.vidWidth = r_customWidth.GetInteger() > 0 ? r_customWidth.GetInteger() : 800;
+	glConfig.vidHeight = r_customHeight.GetInteger() > 0 ? r_customHeight.GetInteger() : 600;
+	tr.viewportOffset[0] = 0;
+	tr.viewportOffset[1] = 0;
+	tr.headless = true;
+
+	vertexCache.Init();
+	R_InitFrameData();
+}
+
 /*
 ==================
 GL_CheckErrors
@@ -1749,6 +1775,9 @@ void idRenderSystemLocal::Clear( void ) {
 	memset( gammaTable, 0, sizeof( gammaTable ) );
 	takingScreenshot = false;
 	frontEndJobList = NULL;
+	headless = false;
+	frontEndBenchmark = false;
+	frontEndBenchmarkFrames.Clear();
 }
 
 /*
@@ -1886,6 +1915,13 @@ idRenderSystemLocal::InitOpenGL
 ========================
 */
 void idRenderSystemLocal::InitOpenGL( void ) {
+	if ( r_headless.GetBool() ) {
+		if ( !headless ) {
+			R_InitHeadless();
+		}
+		return;
+	}
+
 	// if OpenGL isn't started, start it now
 	if ( !glConfig.isInitialized ) {
 		R_InitOpenGL();
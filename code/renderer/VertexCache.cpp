@@ -57,6 +57,12 @@ static void SwitchFrameGeoBufferSet( geoBufferSet_t &gbs ) {
 }
 
 static void AllocGeoBufferSet( geoBufferSet_t &gbs, const int vertexBytes, const int indexBytes ) {
+	if ( tr.headless ) {
+		gbs.vertexBuffer.InitWriteFrameAhead( GL_ARRAY_BUFFER, vertexBytes, VERTEX_CACHE_ALIGN, true );
+		gbs.indexBuffer.InitWriteFrameAhead( GL_ELEMENT_ARRAY_BUFFER, indexBytes, INDEX_CACHE_ALIGN, true );
+		ClearGeoBufferSet( gbs );
+		return;
+	}
 	gbs.vertexBuffer.InitWriteFrameAhead( GL_ARRAY_BUFFER, vertexBytes, VERTEX_CACHE_ALIGN );
 	gbs.indexBuffer.InitWriteFrameAhead( GL_ELEMENT_ARRAY_BUFFER, indexBytes, INDEX_CACHE_ALIGN );
 	GL_SetDebugLabel( GL_BUFFER, gbs.vertexBuffer.GetAPIObject(), "DynamicVertexCache" );
@@ -184,9 +190,11 @@ void idVertexCache::Init() {
 	}
 
 	// 2.08 core context https://stackoverflow.com/questions/13403807/glvertexattribpointer-raising-gl-invalid-operation
-	GLuint vao;
-	qglGenVertexArrays( 1, &vao );
-	qglBindVertexArray( vao ); 
+	if ( !tr.headless ) {
+		GLuint vao;
+		qglGenVertexArrays( 1, &vao );
+		qglBindVertexArray( vao ); 
+	}
 
 	staticVertexBuffer = 0;
 	staticIndexBuffer = 0;
@@ -270,8 +278,11 @@ void idVertexCache::EndFrame() {
 		AllocGeoBufferSet( dynamicData, currentVertexCacheSize, currentIndexCacheSize );
 	}
 
-	qglBindBuffer( GL_ARRAY_BUFFER, currentVertexBuffer = 0 );
-	qglBindBuffer( GL_ELEMENT_ARRAY_BUFFER, currentIndexBuffer = 0 );
+	currentVertexBuffer = currentIndexBuffer = 0;
+	if ( !tr.headless ) {
+		qglBindBuffer( GL_ARRAY_BUFFER, 0 );
+		qglBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+	}
 
 	// 2.08 temp helper for RB_DrawFullScreenQuad on core contexts
 	screenRectSurf.ambientCache = AllocVertex( screenRectVerts, sizeof( screenRectVerts ) );
@@ -377,6 +388,19 @@ void idVertexCache::PrepareStaticCacheForUpload() {
 		staticList.ClearFree();
 	};
 
+	if ( tr.headless ) {
+		// nothing draws from the static cache, just release the data it took over
+		for ( StaticList *staticList : { &staticVertexList, &staticIndexList, &staticShadowList } ) {
+			for ( auto &entry : *staticList ) {
+				if ( entry.owned ) {
+					Mem_Free( (void*)entry.ptr );
+				}
+			}
+			staticList->ClearFree();
+		}
+		return;
+	}
+
 	if ( staticVertexBuffer != 0 ) {
 		qglDeleteBuffers( 1, &staticVertexBuffer );
 	}
@@ -25,14 +25,25 @@ idCVar r_gpuBufferNonpersistentUpdateMode(
 
 const int GpuBuffer::NUM_FRAMES;
 
-void GpuBuffer::Init( GLenum type, GLuint size, GLuint alignment ) {
-	if( bufferObject ) {
+void GpuBuffer::Init( GLenum type, GLuint size, GLuint alignment, bool cpuOnly ) {
+	if( bufferObject || this->cpuOnly ) {
 		Destroy();
 	}
 
 	frameSize = ALIGN( size, alignment );
 	this->alignment = alignment;
 	this->type = type;
+	this->cpuOnly = cpuOnly;
+
+	if ( cpuOnly ) {
+		usesPersistentMapping = false;
+		totalSize = NUM_FRAMES * frameSize;
+		bufferContents = ( byte* )Mem_Alloc16( totalSize );
+		currentWritingFrame = 0;
+		currentDrawingFrame = 0;
+		bytesCommittedInCurrentFrame = 0;
+		return;
+	}
 
 	qglGenBuffers( 1, &bufferObject );
 	qglBindBuffer( type, bufferObject );
@@ -53,13 +64,19 @@ void GpuBuffer::Init( GLenum type, GLuint size, GLuint alignment ) {
 	bytesCommittedInCurrentFrame = 0;
 }
 
-void GpuBuffer::InitWriteFrameAhead( GLenum type, GLuint size, GLuint alignment ) {
-	Init( type, size, alignment );
+void GpuBuffer::InitWriteFrameAhead( GLenum type, GLuint size, GLuint alignment, bool cpuOnly ) {
+	Init( type, size, alignment, cpuOnly );
 	currentWritingFrame = 1;
 }
 
 
 void GpuBuffer::Destroy() {
+	if ( cpuOnly ) {
+		Mem_Free16( bufferContents );
+		bufferContents = nullptr;
+		cpuOnly = false;
+		return;
+	}
 	if ( bufferObject == 0 ) {
 		return;
 	}
@@ -96,7 +113,7 @@ void GpuBuffer::Commit( GLuint numBytes ) {
 	assert( alignedSize + bytesCommittedInCurrentFrame <= frameSize );
 
 	// for persistent mapping, nothing to do. Otherwise, we need to upload the committed data
-	if( !usesPersistentMapping ) {
+	if( !usesPersistentMapping && !cpuOnly ) {
 		GLuint currentOffset = CurrentOffset();
 		qglBindBuffer( type, bufferObject );
 		if (r_gpuBufferNonpersistentUpdateMode.GetInteger() == 0)
@@ -129,6 +146,14 @@ const void * GpuBuffer::BufferOffset( const void *pointer ) {
 }
 
 void GpuBuffer::SwitchFrame() {
+	if ( cpuOnly ) {
+		// nothing reads the contents, no fences needed
+		currentDrawingFrame = ( currentDrawingFrame + 1 ) % NUM_FRAMES;
+		currentWritingFrame = ( currentWritingFrame + 1 ) % NUM_FRAMES;
+		bytesCommittedInCurrentFrame = 0;
+		return;
+	}
+
 	// lock current frame contents in buffer
 	assert( frameFences[currentDrawingFrame] == nullptr );
 	frameFences[currentDrawingFrame] = qglFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
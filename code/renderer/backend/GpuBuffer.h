@@ -32,16 +32,19 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
  * After a frame is completed, you need to call `SwitchFrame` to switch to the next
  * frame region and issue sync fences and waits to make sure no buffer region is
  * written to that is still in use by the GPU.
+ *
+ * With `cpuOnly` no GL object is created and the contents stay in system memory,
+ * which lets the frontend run without a GL context (r_headless).
  */
 class GpuBuffer {
 public:
-	void Init( GLenum type, GLuint size, GLuint alignment );
+	void Init( GLenum type, GLuint size, GLuint alignment, bool cpuOnly = false );
 
 	/// Use this variant when the CPU prepares data one frame ahead (e.g. VertexCache)
 	/// Otherwise, it is assumed that GPU draw calls are issued from the same region
 	/// that was written to in this frame. That's the default for buffers filled and used
 	/// in the backend.
-	void InitWriteFrameAhead( GLenum type, GLuint size, GLuint alignment );
+	void InitWriteFrameAhead( GLenum type, GLuint size, GLuint alignment, bool cpuOnly = false );
 	void Destroy();
 
 	byte *CurrentWriteLocation() const;
@@ -66,6 +69,7 @@ private:
 	GLuint totalSize = 0;
 	GLuint alignment = 0;
 	bool usesPersistentMapping = false;
+	bool cpuOnly = false;
 	GLuint bufferObject = 0;
 	byte *bufferContents = nullptr;
 	int currentDrawingFrame = 0;
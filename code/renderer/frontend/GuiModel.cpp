@@ -365,6 +365,8 @@ void idGuiModel::DrawStretchPic( const idDrawVert *dverts, const glIndex_t *dind
 		return;
 	}
 
+	const int firstIndex = indexes.Num();
+
 	// break the current surface if we are changing to a new material
 	if ( hShader != surf->material ) {
 		if ( surf->numVerts ) {
@@ -447,6 +449,8 @@ void idGuiModel::DrawStretchPic( const idDrawVert *dverts, const glIndex_t *dind
 
 		memcpy( &verts[numVerts], dverts, vertCount * sizeof( verts[0] ) );
 	}
+
+	tr.pc.c_guiIndexes += indexes.Num() - firstIndex;
 }
 
 /*
@@ -648,5 +652,115 @@ void idGuiModel::DrawStretchTri( idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idV
 	}
 
 	memcpy( &verts[numVerts], tempVerts, vertCount * sizeof( verts[0] ) );
+
+	tr.pc.c_guiIndexes += indexCount;
+}
+
+/*
+=============
+GetMark
+=============
+*/
+void idGuiModel::GetMark( guiModelMark_t &mark ) const {
+	mark.surface = surfaces.Num() - 1;
+	mark.firstVert = verts.Num();
+	mark.firstIndex = indexes.Num();
+	memcpy( mark.color, surf->color, sizeof( mark.color ) );
+	mark.material = surf->material;
+}
+
+/*
+=============
+Capture
+
+Copies everything drawn since the mark.
+Indexes of the surface which was current at the mark are rebased to the first captured vertex.
+=============
+*/
+void idGuiModel::Capture( const guiModelMark_t &mark, guiModelCapture_t &capture ) const {
+	capture.surfaces.SetNum( 0, false );
+	capture.verts.SetNum( verts.Num() - mark.firstVert, false );
+	capture.indexes.SetNum( indexes.Num() - mark.firstIndex, false );
+
+	if ( capture.verts.Num() ) {
+		memcpy( capture.verts.Ptr(), &verts[mark.firstVert], capture.verts.Num() * sizeof( verts[0] ) );
+	}
+
+	for ( int i = mark.surface; i < surfaces.Num(); i++ ) {
+		const guiModelSurface_t &src = surfaces[i];
+		const int firstVert = Max( src.firstVert, mark.firstVert );
+		const int firstIndex = Max( src.firstIndex, mark.firstIndex );
+
+		guiModelSurface_t &dst = capture.surfaces.Alloc();
+		dst = src;
+		dst.firstVert = firstVert - mark.firstVert;
+		dst.numVerts = src.firstVert + src.numVerts - firstVert;
+		dst.firstIndex = firstIndex - mark.firstIndex;
+		dst.numIndexes = src.firstIndex + src.numIndexes - firstIndex;
+
+		const int rebase = firstVert - src.firstVert;
+		for ( int j = 0; j < dst.numIndexes; j++ ) {
+			capture.indexes[dst.firstIndex + j] = indexes[firstIndex + j] - rebase;
+		}
+	}
+
+	memcpy( capture.endColor, surf->color, sizeof( capture.endColor ) );
+	capture.endMaterial = surf->material;
+	capture.changesState = memcmp( mark.color, capture.endColor, sizeof( mark.color ) ) != 0 || mark.material != capture.endMaterial;
+}
+
+/*
+=============
+DrawCapture
+
+Appends captured geometry, breaking surfaces exactly as the original draw calls did.
+=============
+*/
+void idGuiModel::DrawCapture( const guiModelCapture_t &capture ) {
+	if ( !glConfig.isInitialized ) {
+		return;
+	}
+
+	for ( int i = 0; i < capture.surfaces.Num(); i++ ) {
+		const guiModelSurface_t &src = capture.surfaces[i];
+		if ( src.numVerts == 0 ) {
+			continue;
+		}
+
+		SetColor( src.color[0], src.color[1], src.color[2], src.color[3] );
+		if ( src.material != surf->material ) {
+			if ( surf->numVerts ) {
+				AdvanceSurf();
+			}
+			const_cast<idMaterial *>(src.material)->EnsureNotPurged();
+			surf->material = src.material;
+		}
+
+		const int numVerts = verts.Num();
+		const int numIndexes = indexes.Num();
+		verts.AssureSize( numVerts + src.numVerts );
+		indexes.AssureSize( numIndexes + src.numIndexes );
+
+		memcpy( &verts[numVerts], &capture.verts[src.firstVert], src.numVerts * sizeof( verts[0] ) );
+		const int rebase = numVerts - surf->firstVert;
+		for ( int j = 0; j < src.numIndexes; j++ ) {
+			indexes[numIndexes + j] = capture.indexes[src.firstIndex + j] + rebase;
+		}
+
+		surf->numVerts += src.numVerts;
+		surf->numIndexes += src.numIndexes;
+	}
+
+	if ( capture.changesState || capture.verts.Num() ) {
+		SetColor( capture.endColor[0], capture.endColor[1], capture.endColor[2], capture.endColor[3] );
+		if ( capture.endMaterial != surf->material ) {
+			if ( surf->numVerts ) {
+				AdvanceSurf();
+			}
+			surf->material = capture.endMaterial;
+		}
+	}
+
+	tr.pc.c_guiCachedIndexes += capture.indexes.Num();
 }
 
@@ -24,6 +24,25 @@ typedef struct {
 	int					numIndexes;
 } guiModelSurface_t;
 
+// position in the model where recording of drawn geometry starts
+typedef struct {
+	int					surface;
+	int					firstVert;
+	int					firstIndex;
+	float				color[4];
+	const idMaterial	*material;
+} guiModelMark_t;
+
+// geometry drawn into the model after a mark, which can be drawn again without re-evaluating the gui
+typedef struct guiModelCapture_s {
+	idList<guiModelSurface_t>	surfaces;	// firstVert and firstIndex point into lists below
+	idList<idDrawVert>			verts;
+	idList<glIndex_t>			indexes;
+	bool						changesState;	// current color or material was changed while drawing
+	float						endColor[4];	// state of current surface after the geometry was drawn
+	const idMaterial			*endMaterial;
+} guiModelCapture_t;
+
 class idGuiModel {
 public:
 	const textureStage_t* hasXrayStage;
@@ -46,6 +65,11 @@ public:
 									float s1, float t1, float s2, float t2, const idMaterial *hShader);
 	void	DrawStretchTri ( idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idVec2 t2, idVec2 t3, const idMaterial *material );
 
+	// record geometry drawn since the mark and append it again later
+	void	GetMark( guiModelMark_t &mark ) const;
+	void	Capture( const guiModelMark_t &mark, guiModelCapture_t &capture ) const;
+	void	DrawCapture( const guiModelCapture_t &capture );
+
 	//---------------------------
 private:
 	void	AdvanceSurf();
@@ -650,6 +650,7 @@ idInteraction::idInteraction( void ) {
 	entityNext				= NULL;
 	entityPrev				= NULL;
 	dynamicModelFrameCount	= 0;
+	geometryKey				= 0;
 	frustumState			= FRUSTUM_UNINITIALIZED;
 	viewCountGenLightSurfs	= 0;
 	viewCountGenShadowSurfs	= 0;
@@ -676,6 +677,7 @@ idInteraction *idInteraction::AllocAndLink( idRenderEntityLocal *edef, idRenderL
 
 	interaction->numSurfaces = -1;		// not checked yet
 	interaction->surfaces = NULL;
+	interaction->geometryKey = 0;
 
 	interaction->frustumState = idInteraction::FRUSTUM_UNINITIALIZED;
 
@@ -710,6 +712,37 @@ idInteraction *idInteraction::AllocAndLink( idRenderEntityLocal *edef, idRenderL
 	return interaction;
 }
 
+/*
+===============
+R_FreeSurfaceInteractions
+===============
+*/
+void R_FreeSurfaceInteractions( surfaceInteraction_t *surfaces, int numSurfaces, bool freeShadowVolumes ) {
+	for ( int i = 0 ; i < numSurfaces ; i++ ) {
+		surfaceInteraction_t *sint = &surfaces[i];
+
+		if ( sint->shadowMapTris ) {
+			if ( sint->shadowMapTris != sint->lightTris )
+				R_FreeStaticTriSurf( sint->shadowMapTris );
+			sint->shadowMapTris = NULL;
+		}
+		if ( sint->lightTris ) {
+			if ( sint->lightTris != LIGHT_TRIS_DEFERRED ) {
+				R_FreeStaticTriSurf( sint->lightTris );
+			}
+			sint->lightTris = NULL;
+		}
+		if ( sint->shadowVolumeTris ) {
+			if ( freeShadowVolumes ) {
+				R_FreeStaticTriSurf( sint->shadowVolumeTris );
+				sint->shadowVolumeTris = NULL;
+			}
+		}
+		R_FreeInteractionCullInfo( sint->cullInfo );
+	}
+	R_StaticFree( surfaces );
+}
+
 /*
 ===============
 idInteraction::FreeSurfaces
@@ -718,36 +751,18 @@ Frees the surfaces, but leaves the interaction linked in, so it
 will be regenerated automatically
 ===============
 */
-void idInteraction::FreeSurfaces( void ) {
+void idInteraction::FreeSurfaces( bool cacheGeometry ) {
 	if ( this->surfaces ) {
-		for ( int i = 0 ; i < this->numSurfaces ; i++ ) {
-			surfaceInteraction_t *sint = &this->surfaces[i];
-
-			if ( sint->shadowMapTris ) {
-				if ( sint->shadowMapTris != sint->lightTris )
-					R_FreeStaticTriSurf( sint->shadowMapTris );
-				sint->shadowMapTris = NULL;
-			}
-			if ( sint->lightTris ) {
-				if ( sint->lightTris != LIGHT_TRIS_DEFERRED ) {
-					R_FreeStaticTriSurf( sint->lightTris );
-				}
-				sint->lightTris = NULL;
-			}
-			if ( sint->shadowVolumeTris ) {
-				// if it doesn't have an entityDef, it is part of a prelight
-				// model, not a generated interaction
-				if ( this->entityDef ) {
-					R_FreeStaticTriSurf( sint->shadowVolumeTris );
-					sint->shadowVolumeTris = NULL;
-				}
-			}
-			R_FreeInteractionCullInfo( sint->cullInfo );
+		// static geometry is handed over to the cache in case the same interaction is created again
+		if ( !geometryKey || !cacheGeometry || !entityDef->world->interactionGeometryCache.Store( geometryKey, entityDef->parms.hModel, this->surfaces, this->numSurfaces ) ) {
+			// if it doesn't have an entityDef, it is part of a prelight
+			// model, not a generated interaction
+			R_FreeSurfaceInteractions( this->surfaces, this->numSurfaces, this->entityDef != NULL );
 		}
-		R_StaticFree( this->surfaces );
 		this->surfaces = NULL;
 	}
 	this->numSurfaces = -1;
+	this->geometryKey = 0;
 }
 
 /*
@@ -793,7 +808,7 @@ idInteraction::UnlinkAndFree
 Removes links and puts it back on the free list.
 ===============
 */
-void idInteraction::UnlinkAndFree( void ) {
+void idInteraction::UnlinkAndFree( bool cacheGeometry ) {
 
 	// clear the table pointer
 	idRenderWorldLocal *renderWorld = this->lightDef->world;
@@ -804,7 +819,7 @@ void idInteraction::UnlinkAndFree( void ) {
 
 	Unlink();
 
-	FreeSurfaces();
+	FreeSurfaces( cacheGeometry );
 
 	// put it back on the free list
 	renderWorld->interactionAllocator.Free( this );
@@ -1054,6 +1069,18 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 		return;
 	}
 
+	// reuse geometry generated from the same inputs before
+	const uint64 key = idInteractionGeometryCache::GetKey( entityDef, lightDef, model );
+	if ( key ) {
+		surfaces = lightDef->world->interactionGeometryCache.Restore( key, model, numSurfaces );
+		if ( surfaces ) {
+			geometryKey = key;
+			tr.pc.c_interactionCacheHits++;
+			return;
+		}
+		tr.pc.c_interactionRebuilds++;
+	}
+
 	// use the turbo shadow path
 	shadowGen_t shadowGen = SG_DYNAMIC;
 
@@ -1194,7 +1221,256 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 	if ( !interactionGenerated ) {
 		//MakeEmpty();
 		flagMakeEmpty = true;
+	} else {
+		geometryKey = key;
+	}
+}
+
+/*
+===============================================================================
+
+	idInteractionGeometryCache
+
+===============================================================================
+*/
+
+#define HASH_FIELD( hash, field )	hash = FNV1a_64( hash, &( field ), sizeof( field ) )
+
+/*
+===============
+idInteractionGeometryCache::idInteractionGeometryCache
+===============
+*/
+idInteractionGeometryCache::idInteractionGeometryCache() {
+	oldest = newest = -1;
+	firstFree = -1;
+	numEntries = 0;
+	totalBytes = 0;
+}
+
+/*
+===============
+idInteractionGeometryCache::~idInteractionGeometryCache
+===============
+*/
+idInteractionGeometryCache::~idInteractionGeometryCache() {
+	Clear();
+}
+
+/*
+===============
+idInteractionGeometryCache::GetKey
+
+Hashes everything CreateInteraction, R_CreateLightTris and R_CreateShadowVolume
+read from the entity and the light.
+===============
+*/
+uint64 idInteractionGeometryCache::GetKey( const idRenderEntityLocal *edef, const idRenderLightLocal *ldef, const idRenderModel *model ) {
+	if ( !r_useInteractionCache.GetBool() || r_interactionCacheSize.GetInteger() <= 0 ) {
+		return 0;
+	}
+	if ( model != edef->parms.hModel || model->IsDynamicModel() != DM_STATIC || edef->parms.callback ) {
+		return 0;
+	}
+
+	const renderEntity_t &ent = edef->parms;
+	const renderLight_t &light = ldef->parms;
+	const bool suppressSurface = ent.suppressSurfaceInViewID != 0;
+	const bool optimizedShadows = r_useOptimizedShadows.GetBool();
+
+	uint64 hash = FNV1A_64_INIT;
+	HASH_FIELD( hash, model );
+	HASH_FIELD( hash, ent.origin );
+	HASH_FIELD( hash, ent.axis );
+	HASH_FIELD( hash, ent.customShader );
+	HASH_FIELD( hash, ent.customSkin );
+	HASH_FIELD( hash, ent.noShadow );
+	HASH_FIELD( hash, ent.noFog );
+	HASH_FIELD( hash, ent.spectrum );
+	HASH_FIELD( hash, ent.nospectrum );
+	HASH_FIELD( hash, ent.lightspectrum );
+	HASH_FIELD( hash, suppressSurface );
+
+	HASH_FIELD( hash, ldef->lightShader );
+	HASH_FIELD( hash, ldef->shadows );
+	HASH_FIELD( hash, light.origin );
+	HASH_FIELD( hash, light.axis );
+	HASH_FIELD( hash, light.lightRadius );
+	HASH_FIELD( hash, light.lightCenter );
+	HASH_FIELD( hash, light.target );
+	HASH_FIELD( hash, light.right );
+	HASH_FIELD( hash, light.up );
+	HASH_FIELD( hash, light.start );
+	HASH_FIELD( hash, light.end );
+	HASH_FIELD( hash, light.pointLight );
+	HASH_FIELD( hash, light.parallel );
+	HASH_FIELD( hash, light.parallelSky );
+	HASH_FIELD( hash, light.noShadows );
+	HASH_FIELD( hash, light.spectrum );
+	HASH_FIELD( hash, light.prelightModel );
+	HASH_FIELD( hash, optimizedShadows );
+
+	// zero means "not cacheable"
+	return hash ? hash : 1;
+}
+
+/*
+===============
+idInteractionGeometryCache::Store
+===============
+*/
+bool idInteractionGeometryCache::Store( uint64 key, const idRenderModel *model, surfaceInteraction_t *surfaces, int numSurfaces ) {
+	if ( !r_useInteractionCache.GetBool() || numSurfaces <= 0 ) {
+		return false;
+	}
+
+	int bytes = numSurfaces * sizeof( surfaces[0] );
+	for ( int i = 0; i < numSurfaces; i++ ) {
+		const surfaceInteraction_t &sint = surfaces[i];
+		bytes += R_TriSurfMemory( sint.lightTris );
+		bytes += R_TriSurfMemory( sint.shadowVolumeTris );
+		if ( sint.shadowMapTris != sint.lightTris ) {
+			bytes += R_TriSurfMemory( sint.shadowMapTris );
+		}
+	}
+	const int budget = r_interactionCacheSize.GetInteger() << 20;
+	if ( bytes > budget ) {
+		return false;
+	}
+
+	idScopedCriticalSection lock( mutex );
+
+	const int hashKey = (int)( key ^ ( key >> 32 ) );
+	for ( int i = hash.First( hashKey ); i != -1; i = hash.Next( i ) ) {
+		if ( entries[i].key == key ) {
+			// same pair generated twice (e.g. both copies alive at once), keep the older one
+			return false;
+		}
+	}
+
+	// evict least recently stored entries
+	while ( oldest != -1 && totalBytes + bytes > budget ) {
+		Remove( oldest );
+	}
+
+	int index = firstFree;
+	if ( index != -1 ) {
+		firstFree = entries[index].next;
+	} else {
+		index = entries.Num();
+		entries.Alloc();
+	}
+	entry_t &entry = entries[index];
+	entry.key = key;
+	entry.model = model;
+	entry.surfaces = surfaces;
+	entry.numSurfaces = numSurfaces;
+	entry.bytes = bytes;
+	entry.prev = newest;
+	entry.next = -1;
+	if ( newest != -1 ) {
+		entries[newest].next = index;
+	} else {
+		oldest = index;
+	}
+	newest = index;
+	hash.Add( hashKey, index );
+	numEntries++;
+	totalBytes += bytes;
+
+	return true;
+}
+
+/*
+===============
+idInteractionGeometryCache::Restore
+===============
+*/
+surfaceInteraction_t *idInteractionGeometryCache::Restore( uint64 key, const idRenderModel *model, int &numSurfaces ) {
+	idScopedCriticalSection lock( mutex );
+
+	const int hashKey = (int)( key ^ ( key >> 32 ) );
+	for ( int i = hash.First( hashKey ); i != -1; i = hash.Next( i ) ) {
+		entry_t &entry = entries[i];
+		if ( entry.key != key || entry.model != model || entry.numSurfaces != model->NumSurfaces() ) {
+			continue;
+		}
+		surfaceInteraction_t *surfaces = entry.surfaces;
+		numSurfaces = entry.numSurfaces;
+		entry.surfaces = NULL;
+		Remove( i );
+		return surfaces;
 	}
+	return NULL;
+}
+
+/*
+===============
+idInteractionGeometryCache::Remove
+
+Frees the surfaces unless they were restored.
+===============
+*/
+void idInteractionGeometryCache::Remove( int index ) {
+	entry_t &entry = entries[index];
+	if ( entry.surfaces ) {
+		R_FreeSurfaceInteractions( entry.surfaces, entry.numSurfaces, true );
+	}
+	totalBytes -= entry.bytes;
+	numEntries--;
+	hash.Remove( (int)( entry.key ^ ( entry.key >> 32 ) ), index );
+
+	if ( entry.prev != -1 ) {
+		entries[entry.prev].next = entry.next;
+	} else {
+		oldest = entry.next;
+	}
+	if ( entry.next != -1 ) {
+		entries[entry.next].prev = entry.prev;
+	} else {
+		newest = entry.prev;
+	}
+
+	entry.model = NULL;
+	entry.surfaces = NULL;
+	entry.next = firstFree;
+	firstFree = index;
+}
+
+/*
+===============
+idInteractionGeometryCache::PurgeModel
+===============
+*/
+void idInteractionGeometryCache::PurgeModel( const idRenderModel *model ) {
+	idScopedCriticalSection lock( mutex );
+
+	for ( int i = oldest; i != -1; ) {
+		const int next = entries[i].next;
+		if ( entries[i].model == model ) {
+			Remove( i );
+		}
+		i = next;
+	}
+}
+
+/*
+===============
+idInteractionGeometryCache::Clear
+===============
+*/
+void idInteractionGeometryCache::Clear() {
+	idScopedCriticalSection lock( mutex );
+
+	for ( int i = oldest; i != -1; i = entries[i].next ) {
+		R_FreeSurfaceInteractions( entries[i].surfaces, entries[i].numSurfaces, true );
+	}
+	entries.Clear();
+	hash.Clear();
+	oldest = newest = -1;
+	firstFree = -1;
+	numEntries = 0;
+	totalBytes = 0;
 }
 
 /*
@@ -91,6 +91,10 @@ public:
 	// possibly having a shader to specify the shadow sorting order
 	surfaceInteraction_t *	surfaces;
 	
+	// inputs the surfaces were generated from, see idInteractionGeometryCache
+	// 0 if the geometry must not outlive the interaction
+	uint64					geometryKey;
+
 	// get space from here, if NULL, it is a pre-generated shadow volume from dmap
 	idRenderEntityLocal *	entityDef;
 	idRenderLightLocal *	lightDef;
@@ -110,10 +114,11 @@ public:
 
 	// unlinks from the entity and light, frees all surfaceInteractions,
 	// and puts it back on the free list
-	void					UnlinkAndFree( void );
+	// cacheGeometry = false if the surfaces can't be reused (e.g. the entity moved)
+	void					UnlinkAndFree( bool cacheGeometry = true );
 
 	// free the interaction surfaces
-	void					FreeSurfaces( void );
+	void					FreeSurfaces( bool cacheGeometry = true );
 
 	bool flagMakeEmpty;
 	// makes the interaction empty for when the light and entity do not actually intersect
@@ -181,6 +186,67 @@ private:
 };
 
 
+/*
+===============================================================================
+
+	Geometry of freed interactions between static models and lights.
+
+	Entities are often updated with nothing but shader parms changed, and lights
+	are freed and created again with the same shape.  Both destroy interactions,
+	whose light tris and shadow volumes would then be generated again from the
+	same inputs.  Instead the surfaces are handed over to this cache, keyed by
+	everything they were generated from, and taken back when the same pair is
+	created again.  Surfaces are owned either by an interaction or by the cache.
+
+===============================================================================
+*/
+
+class idInteractionGeometryCache {
+public:
+							idInteractionGeometryCache();
+							~idInteractionGeometryCache();
+
+	// returns 0 if the geometry depends on something not included in the key (dynamic models)
+	static uint64			GetKey( const idRenderEntityLocal *edef, const idRenderLightLocal *ldef, const idRenderModel *model );
+
+	// takes ownership of the surfaces, returns false if they have to be freed by the caller
+	bool					Store( uint64 key, const idRenderModel *model, surfaceInteraction_t *surfaces, int numSurfaces );
+	// gives ownership of the surfaces stored with the key back, returns NULL if there are none
+	surfaceInteraction_t *	Restore( uint64 key, const idRenderModel *model, int &numSurfaces );
+
+	// must be called before a model's surfaces are freed or reloaded
+	void					PurgeModel( const idRenderModel *model );
+	void					Clear();
+
+	int						Memory() const { return totalBytes; }
+	int						NumEntries() const { return numEntries; }
+
+private:
+	struct entry_t {
+		uint64					key;
+		const idRenderModel *	model;			// NULL if the slot is free
+		surfaceInteraction_t *	surfaces;
+		int						numSurfaces;
+		int						bytes;
+		int						prev;			// slots in order of storing, or next free slot
+		int						next;
+	};
+
+	// slots never move, so removing an entry does not renumber the others
+	idList<entry_t>			entries;
+	idHashIndex				hash;
+	int						oldest;			// -1 if empty
+	int						newest;
+	int						firstFree;		// -1 if all slots are used
+	int						numEntries;
+	int						totalBytes;
+	idSysMutex				mutex;			// restored from frontend jobs
+
+	void					Remove( int index );
+};
+
+void R_FreeSurfaceInteractions( surfaceInteraction_t *surfaces, int numSurfaces, bool freeShadowVolumes );
+
 void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo );
 void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo );
 void R_FreeInteractionCullInfo( srfCullInfo_t &cullInfo );
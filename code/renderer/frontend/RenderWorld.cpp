@@ -258,6 +258,9 @@ idRenderWorldLocal::idRenderWorldLocal() {
 
 	areaNodes = NULL;
 	numAreaNodes = 0;
+	portalSoundVersion = 0;
+	portalViewVersion = 0;
+	viewFloodRecord = NULL;
 
 	//portalAreas = NULL;
 	//numPortalAreas = 0;
@@ -372,11 +375,14 @@ void idRenderWorldLocal::UpdateEntityDef( qhandle_t entityHandle, const renderEn
 			}
 		}
 
+		// interactions of an entity which moved won't be created from the same inputs again
+		const bool moved = !( re->origin == def->parms.origin ) || !( re->axis == def->parms.axis );
+
 		// save any decals if the model is the same, allowing marks to move with entities
 		if ( def->parms.hModel == re->hModel ) {
-			R_FreeEntityDefDerivedData( def, true, true );
+			R_FreeEntityDefDerivedData( def, true, true, !moved );
 		} else {
-			R_FreeEntityDefDerivedData( def, false, false );
+			R_FreeEntityDefDerivedData( def, false, false, !moved );
 		}
 	} else {
 		// creating a new one
@@ -429,7 +435,7 @@ void idRenderWorldLocal::FreeEntityDef( qhandle_t entityHandle ) {
 		return;
 	}
 
-	R_FreeEntityDefDerivedData( def, false, false );
+	R_FreeEntityDefDerivedData( def, false, false, true );
 
 	if ( session->writeDemo && def->archived ) {
 		WriteFreeEntity( entityHandle );
@@ -794,7 +800,7 @@ to handle mirrors,
 void idRenderWorldLocal::RenderScene( const renderView_t &renderView ) {
 	//renderView_t	copy;
 
-	if ( !glConfig.isInitialized ) {
+	if ( !glConfig.isInitialized && !tr.headless ) {
 		return;
 	}
 
@@ -973,7 +979,10 @@ void idRenderWorldLocal::SetPortalPlayerLoss( qhandle_t portal, float loss ) //
 	{
 		common->Error( "SetPortalPlayerLoss: bad portal number %i", portal );
 	}
-	doublePortals[portal-1].lossPlayer = loss; // grayman #3042
+	if ( doublePortals[portal-1].lossPlayer != loss ) {
+		doublePortals[portal-1].lossPlayer = loss; // grayman #3042
+		portalSoundVersion++;
+	}
 
 	if ( session->writeDemo )
 	{
@@ -1816,6 +1825,8 @@ void idRenderWorldLocal::AddEntityRefToArea( idRenderEntityLocal *def, portalAre
 	ref->idxInArea = area->entityRefs.Append(def->index);
 	area->entityBackRefs.Append(ref);
 	assert(area->entityRefs.Num() == area->entityBackRefs.Num());
+	GetEntityRefCorners( def, area->entityRefCorners.Alloc() );
+	assert(area->entityRefs.Num() == area->entityRefCorners.Num());
 
 	bool forceShadowsBehindOpaque = ( def->parms.hModel->IsStaticWorldModel() || def->parms.forceShadowBehindOpaque );
 	if ( forceShadowsBehindOpaque )
@@ -1842,6 +1853,8 @@ void idRenderWorldLocal::AddLightRefToArea( idRenderLightLocal *def, portalArea_
 	ref->idxInArea = area->lightRefs.Append(def->index);
 	area->lightBackRefs.Append(ref);
 	assert(area->lightRefs.Num() == area->lightBackRefs.Num());
+	GetLightRefCorners( def, area->lightRefCorners.Alloc() );
+	assert(area->lightRefs.Num() == area->lightRefCorners.Num());
 
 	ref->next = def->references;
 	def->references = ref;
@@ -385,6 +385,10 @@ public:
 	// grayman #3042 - set portal sound loss (in dB)
 	virtual void			SetPortalPlayerLoss( qhandle_t portal, float loss ) = 0;
 
+	// changes every time state or sound loss of some portal changes
+	// sound system uses it to know when cached propagation paths are no longer valid
+	virtual int				GetPortalSoundVersion( void ) const = 0;
+
 	// returns true only if a chain of portals without the given connection bits set
 	// exists between the two areas (a door doesn't separate them, etc)
 	virtual	bool			AreasAreConnected( int areaNum1, int areaNum2, portalConnection_t connection ) = 0;
@@ -29,6 +29,8 @@ void idRenderWorldLocal::FreeWorld() {
 
 	// this will free all the lightDefs and entityDefs
 	FreeDefs();
+	interactionGeometryCache.Clear();
+	ClearViewFloodCache();
 
 	// free all the portals and check light/model references
 	for ( auto &area: portalAreas ) {
@@ -240,6 +242,7 @@ void idRenderWorldLocal::SetupAreaRefs() {
 	int		i;
 
 	connectedAreaNum = 0;
+	portalSoundVersion++;
 	for ( i = 0; i < portalAreas.Num(); i++ ) {
 		portalAreas[i].areaNum = i;
 		assert(portalAreas[i].entityRefs.Num() == 0);
@@ -577,6 +580,7 @@ void idRenderWorldLocal::ClearPortalStates() {
 	for ( i = 0 ; i < doublePortals.Num() ; i++ ) {
 		doublePortals[i].blockingBits = PS_BLOCK_NONE;
 	}
+	portalViewVersion++;
 
 	// flood fill all area connections
 	for ( i = 0; i < portalAreas.Num(); i++ ) {
@@ -73,6 +73,10 @@ typedef struct portalArea_s {
 	// this is needed for O(1) additions/removals, is not very fast, and should not be used for iteration
 	idList<areaReference_t*> entityBackRefs;
 	idList<areaReference_t*> lightBackRefs;
+	// xxxRefCorners[k] are the corners which CullEntityByPortals / CullLightByPortals check for xxxRefs[k]
+	// they are stored contiguously, so that all refs of an area are culled against portal planes in one pass
+	idList<frustumCorners_t> entityRefCorners;
+	idList<frustumCorners_t> lightRefCorners;
 
 	idList<int>		forceShadowsBehindOpaqueEntityRefs;
 
@@ -163,6 +167,7 @@ public:
 	virtual	int				NumPortalsInArea( int areaNum ) override;
 	// grayman #3042 - set portal sound loss (in dB)
 	virtual void			SetPortalPlayerLoss( qhandle_t portal, float loss ) override;
+	virtual int				GetPortalSoundVersion( void ) const override { return portalSoundVersion; }
 
 	virtual exitPortal_t	GetPortal( int areaNum, int portalNum ) override;
 
@@ -204,6 +209,8 @@ public:
 	idList<portalArea_t> portalAreas;
 	//int						numPortalAreas;
 	int						connectedAreaNum;		// incremented every time a door portal state changes
+	int						portalSoundVersion;		// incremented every time portal state or sound loss changes
+	int						portalViewVersion;		// incremented every time view blocking or fog of a portal changes
 
 	idList<doublePortal_t>	doublePortals;
 	//int						numInterAreaPortals;
@@ -226,9 +233,17 @@ public:
 	// of entityDefs and lightDefs
 	idInteractionTable		interactionTable;
 
+	// light and shadow geometry of freed static interactions
+	idInteractionGeometryCache	interactionGeometryCache;
+
 
 	bool					generateAllInteractionsCalled;
 
+	// results of recent view floods through portals, most recently used last
+	struct ViewFloodCacheEntry;
+	idList<ViewFloodCacheEntry *>	viewFloodCache;
+	ViewFloodCacheEntry *	viewFloodRecord;		// entry being filled by FloodViewThroughArea_r, if any
+
 	typedef idFlexList<int, 128> AreaList;
 
 	//-----------------------
@@ -255,11 +270,16 @@ public:
 	bool					PortalIsFoggedOut( const portal_t *p );
 	void					FloodViewThroughArea_r( const idVec3 origin, int areaNum, const struct portalStack_s *ps );
 	void					FlowViewThroughPortals( const idVec3 origin, int numPlanes, const idPlane *planes );
+	ViewFloodCacheEntry *	FindViewFloodCacheEntry( const ViewFloodCacheEntry &key );
+	void					ReplayViewFlood( const ViewFloodCacheEntry *entry );
+	void					ClearViewFloodCache();
 	struct FlowLightThroughPortalsContext;
 	void					FloodLightThroughArea_r( FlowLightThroughPortalsContext &context, int areaNum, const struct portalStack_s *ps ) const;
 	void					FlowLightThroughPortals( const idRenderLightLocal *light, const AreaList &startingAreaIds, AreaList *areaIds, lightPortalFlow_t *portalFlow ) const;
 	bool					CullEntityByPortals( const idRenderEntityLocal *entity, const struct portalStack_s *ps );
 	void					AddAreaEntityRefs( int areaNum, const struct portalStack_s *ps );
+	static void				GetEntityRefCorners( const idRenderEntityLocal *entity, frustumCorners_t &corners );
+	static void				GetLightRefCorners( const idRenderLightLocal *light, frustumCorners_t &corners );
 	bool					CullLightByPortals( const idRenderLightLocal *light, const struct portalStack_s *ps );
 	void					AddAreaLightRefs( int areaNum, const struct portalStack_s *ps );
 	void					AddAreaRefs( int areaNum, const struct portalStack_s *ps );
@@ -20,6 +20,8 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 
 idCVar r_useLightAreaCulling( "r_useLightAreaCulling", "1", CVAR_RENDERER | CVAR_BOOL, "0 = off, 1 = on" );
 idCVar r_singleModelName( "r_singleModelName", "", CVAR_RENDERER, "filter entities by model name, e.g. 'models/darkmod/nature/flowers/flowers_patch_01.ase'" );
+idCVar r_useBatchPortalCulling( "r_useBatchPortalCulling", "1", CVAR_RENDERER | CVAR_BOOL, "cull all entity and light refs of an area against the portal planes at once (only with r_useEntityPortalCulling / r_useLightPortalCulling = 1)" );
+idCVar r_useViewFloodCache( "r_useViewFloodCache", "1", CVAR_RENDERER | CVAR_BOOL, "reuse the portal flood of a view if the same view was flooded recently and the portals it passed have not changed" );
 
 /*
 
@@ -50,6 +52,59 @@ typedef struct portalStack_s {
 	// positive side is outside the visible frustum
 } portalStack_t;
 
+// number of distinct views whose portal flood is remembered,
+// enough for the player view and a few subviews / lightgem renders
+const int VIEW_FLOOD_CACHE_SIZE = 8;
+
+// added to the view blocking bits of a portal if it is covered by a fog light
+const int PORTAL_VIEW_FOGGED = BIT( 30 );
+
+/*
+===================
+ViewFloodCacheEntry
+
+The areas entered by FloodViewThroughArea_r and the portal planes used there
+only depend on the view and on the state of the portals it checks.
+They are remembered, so that a view which does not move can simply add the area refs again.
+===================
+*/
+struct idRenderWorldLocal::ViewFloodCacheEntry {
+	struct key_t {
+		idVec3			origin;
+		int				areaNum;
+		int				numPlanes;
+		idPlane			planes[5];
+		idScreenRect	scissor;
+		idScreenRect	viewport;
+		float			modelViewMatrix[16];
+		float			projectionMatrix[16];
+	};
+	struct visit_t {
+		int				areaNum;
+		idScreenRect	rect;
+		int				firstPlane;
+		int				numPlanes;
+	};
+	struct portalCheck_t {
+		int				portal;			// index in doublePortals
+		int				state;			// PS_BLOCK_VIEW and PORTAL_VIEW_FOGGED bits
+
+		bool operator< ( const portalCheck_t &other ) const { return portal < other.portal; }
+		bool operator== ( const portalCheck_t &other ) const { return portal == other.portal; }
+	};
+
+	key_t					key;			// must be zeroed before filling, compared with memcmp
+	idList<visit_t>			visits;			// calls to AddAreaRefs in order
+	idList<idPlane>			planes;			// portal planes of all visits
+	idList<portalCheck_t>	portals;		// all portals the flood has looked at, sorted
+	int						portalViewVersion;	// portals were known to be unchanged at this version
+	bool					fogged;			// PortalIsFoggedOut was called, result depends on time
+};
+
+static ID_INLINE int R_PortalViewState( const doublePortal_t *dp ) {
+	return ( dp->blockingBits & PS_BLOCK_VIEW ) | ( dp->fogLight ? PORTAL_VIEW_FOGGED : 0 );
+}
+
 
 //====================================================================
 
@@ -151,6 +206,18 @@ void idRenderWorldLocal::FloodViewThroughArea_r( const idVec3 origin, int areaNu
 
 	// cull models and lights to the current collection of planes
 	AddAreaRefs( areaNum, ps );
+	tr.pc.c_viewFloodAreas++;
+
+	if ( viewFloodRecord ) {
+		ViewFloodCacheEntry::visit_t &visit = viewFloodRecord->visits.Alloc();
+		visit.areaNum = areaNum;
+		visit.rect = ps->rect;
+		visit.firstPlane = viewFloodRecord->planes.Num();
+		visit.numPlanes = ps->numPortalPlanes;
+		for ( j = 0; j < ps->numPortalPlanes; j++ ) {
+			viewFloodRecord->planes.Append( ps->portalPlanes[j] );
+		}
+	}
 
 	if ( portalAreas[areaNum].areaScreenRect.IsEmpty() ) {
 		portalAreas[areaNum].areaScreenRect = ps->rect;
@@ -165,6 +232,12 @@ void idRenderWorldLocal::FloodViewThroughArea_r( const idVec3 origin, int areaNu
 
 	// go through all the portals
 	for ( auto p : area.areaPortals ) {
+		if ( viewFloodRecord ) {
+			ViewFloodCacheEntry::portalCheck_t &check = viewFloodRecord->portals.Alloc();
+			check.portal = p->doublePortal - doublePortals.Ptr();
+			check.state = R_PortalViewState( p->doublePortal );
+		}
+
 		// an enclosing door may have sealed the portal off
 		if ( p->doublePortal->blockingBits & PS_BLOCK_VIEW ) {
 			continue;
@@ -213,6 +286,9 @@ void idRenderWorldLocal::FloodViewThroughArea_r( const idVec3 origin, int areaNu
 		}
 
 		// see if it is fogged out
+		if ( viewFloodRecord && p->doublePortal->fogLight ) {
+			viewFloodRecord->fogged = true;
+		}
 		if ( PortalIsFoggedOut( p ) ) {
 			continue;
 		}
@@ -306,11 +382,138 @@ void idRenderWorldLocal::FlowViewThroughPortals( const idVec3 origin, int numPla
 			a.areaScreenRect.Clear();
 		}
 
+		// r_showPortals needs to see the portals passed by the flood
+		ViewFloodCacheEntry *entry = nullptr;
+		if ( r_useViewFloodCache.GetBool() && !r_showPortals && numPlanes <= 5 ) {
+			ViewFloodCacheEntry query;
+			memset( &query.key, 0, sizeof( query.key ) );
+			query.key.origin = origin;
+			query.key.areaNum = tr.viewDef->areaNum;
+			query.key.numPlanes = numPlanes;
+			for ( i = 0; i < numPlanes; i++ ) {
+				query.key.planes[i] = planes[i];
+			}
+			query.key.scissor = tr.viewDef->scissor;
+			query.key.viewport = tr.viewDef->viewport;
+			memcpy( query.key.modelViewMatrix, tr.viewDef->worldSpace.modelViewMatrix, sizeof( query.key.modelViewMatrix ) );
+			memcpy( query.key.projectionMatrix, tr.viewDef->projectionMatrix, sizeof( query.key.projectionMatrix ) );
+
+			if ( const ViewFloodCacheEntry *cached = FindViewFloodCacheEntry( query ) ) {
+				ReplayViewFlood( cached );
+				tr.pc.c_viewFloodCacheHits++;
+				return;
+			}
+
+			// reuse the least recently used entry
+			if ( viewFloodCache.Num() >= VIEW_FLOOD_CACHE_SIZE ) {
+				entry = viewFloodCache[0];
+				viewFloodCache.RemoveIndex( 0 );
+			} else {
+				entry = new ViewFloodCacheEntry;
+			}
+			entry->key = query.key;
+			entry->visits.Clear();
+			entry->planes.Clear();
+			entry->portals.Clear();
+			entry->portalViewVersion = portalViewVersion;
+			entry->fogged = false;
+		}
+
 		// flood out through portals, setting area viewCount
+		viewFloodRecord = entry;
 		FloodViewThroughArea_r( origin, tr.viewDef->areaNum, &ps );
+		viewFloodRecord = nullptr;
+		tr.pc.c_viewFloods++;
+
+		if ( entry ) {
+			if ( entry->fogged ) {
+				delete entry;
+			} else {
+				std::sort( entry->portals.begin(), entry->portals.end() );
+				entry->portals.SetNum( std::unique( entry->portals.begin(), entry->portals.end() ) - entry->portals.begin(), false );
+				viewFloodCache.Append( entry );
+			}
+		}
+	}
+}
+
+/*
+=======================
+FindViewFloodCacheEntry
+
+Returns the remembered flood of the view described by query key, if it is still valid.
+Portal states are only verified when some portal has changed since the last check.
+=======================
+*/
+idRenderWorldLocal::ViewFloodCacheEntry *idRenderWorldLocal::FindViewFloodCacheEntry( const ViewFloodCacheEntry &query ) {
+	for ( int i = viewFloodCache.Num() - 1; i >= 0; i-- ) {
+		ViewFloodCacheEntry *entry = viewFloodCache[i];
+		if ( memcmp( &entry->key, &query.key, sizeof( entry->key ) ) != 0 ) {
+			continue;
+		}
+
+		viewFloodCache.RemoveIndex( i );
+
+		if ( entry->portalViewVersion != portalViewVersion ) {
+			for ( const auto &check : entry->portals ) {
+				if ( R_PortalViewState( &doublePortals[check.portal] ) != check.state ) {
+					// a portal on the way has been opened, closed or fogged
+					delete entry;
+					return nullptr;
+				}
+			}
+			entry->portalViewVersion = portalViewVersion;
+		}
+
+		// most recently used entries go last
+		viewFloodCache.Append( entry );
+		return entry;
+	}
+	return nullptr;
+}
+
+/*
+=======================
+ReplayViewFlood
+
+Does the same calls to AddAreaRefs as the flood which has filled the entry.
+The area refs themselves are not cached, since entities and lights move freely.
+=======================
+*/
+void idRenderWorldLocal::ReplayViewFlood( const ViewFloodCacheEntry *entry ) {
+	portalStack_t ps;
+	ps.p = nullptr;
+	ps.next = nullptr;
+
+	for ( const auto &visit : entry->visits ) {
+		ps.rect = visit.rect;
+		ps.numPortalPlanes = visit.numPlanes;
+		for ( int i = 0; i < visit.numPlanes; i++ ) {
+			ps.portalPlanes[i] = entry->planes[visit.firstPlane + i];
+		}
+
+		AddAreaRefs( visit.areaNum, &ps );
+		tr.pc.c_viewFloodAreas++;
+
+		idScreenRect &areaRect = portalAreas[visit.areaNum].areaScreenRect;
+		if ( areaRect.IsEmpty() ) {
+			areaRect = visit.rect;
+		} else {
+			areaRect.Union( visit.rect );
+		}
 	}
 }
 
+/*
+=======================
+ClearViewFloodCache
+=======================
+*/
+void idRenderWorldLocal::ClearViewFloodCache() {
+	viewFloodCache.DeleteContents( true );
+	viewFloodRecord = nullptr;
+}
+
 //==================================================================================================
 
 struct idRenderWorldLocal::FlowLightThroughPortalsContext {
@@ -617,6 +820,37 @@ R_FindViewLightsAndEntities
 =======================================================================
 */
 
+/*
+================
+GetEntityRefCorners
+
+Corners of the reference bounds of the entity in world space.
+================
+*/
+void idRenderWorldLocal::GetEntityRefCorners( const idRenderEntityLocal *entity, frustumCorners_t &corners ) {
+	ALIGNTYPE16 frustumCorners_t aligned;
+	idRenderMatrix::GetFrustumCorners( aligned, entity->inverseBaseModelProject, bounds_unitCube );
+	corners = aligned;
+}
+
+/*
+================
+GetLightRefCorners
+
+Corners of the light frustum.
+================
+*/
+void idRenderWorldLocal::GetLightRefCorners( const idRenderLightLocal *light, frustumCorners_t &corners ) {
+	// by construction, see R_PolytopeSurfaceFrustumLike
+	assert( light->frustumTris && light->frustumTris->numVerts == 8 );
+	for ( int v = 0; v < 8; v++ ) {
+		idVec3 pos = light->frustumTris->verts[v].xyz;
+		corners.x[v] = pos.x;
+		corners.y[v] = pos.y;
+		corners.z[v] = pos.z;
+	}
+}
+
 /*
 ================
 CullEntityByPortals
@@ -627,7 +861,7 @@ Return true if the entity reference bounds do not intersect the current portal c
 bool idRenderWorldLocal::CullEntityByPortals( const idRenderEntityLocal *entity, const portalStack_t *ps ) {
 	if ( r_useEntityPortalCulling.GetInteger() == 1 ) {
 		ALIGNTYPE16 frustumCorners_t corners;
-		idRenderMatrix::GetFrustumCorners( corners, entity->inverseBaseModelProject, bounds_unitCube );
+		GetEntityRefCorners( entity, corners );
 		for ( int i = 0; i < ps->numPortalPlanes; i++ ) {
 			if ( idRenderMatrix::CullFrustumCornersToPlane( corners, ps->portalPlanes[i] ) == FRUSTUM_CULL_FRONT ) {
 				return true;
@@ -705,8 +939,16 @@ void idRenderWorldLocal::AddAreaEntityRefs( int areaNum, const portalStack_t *ps
 
 	area = &portalAreas[ areaNum ];
 
-	for ( int entityIdx : area->entityRefs ) {
-		entity = entityDefs[entityIdx];
+	// cull all refs of the area at once, CullEntityByPortals is only needed for exact clipping
+	idFlexList<bool, 1024> culled;
+	bool batchCulled = r_useBatchPortalCulling.GetBool() && r_useEntityPortalCulling.GetInteger() == 1;
+	if ( batchCulled ) {
+		culled.SetNum( area->entityRefs.Num() );
+		idRenderMatrix::CullFrustumCornersToPlanes( area->entityRefCorners.Ptr(), area->entityRefs.Num(), ps->portalPlanes, ps->numPortalPlanes, culled.Ptr() );
+	}
+
+	for ( int k = 0; k < area->entityRefs.Num(); k++ ) {
+		entity = entityDefs[area->entityRefs[k]];
 
 		// debug tool to allow viewing of only one entity at a time
 		if ( r_singleEntity.GetInteger() >= 0 && r_singleEntity.GetInteger() != entity->index ) {
@@ -734,7 +976,7 @@ void idRenderWorldLocal::AddAreaEntityRefs( int areaNum, const portalStack_t *ps
 		}
 
 		// cull reference bounds
-		if ( CullEntityByPortals( entity, ps ) ) {
+		if ( batchCulled ? culled[k] : CullEntityByPortals( entity, ps ) ) {
 			// we are culled out through this portal chain, but it might
 			// still be visible through others
 			continue;
@@ -759,14 +1001,7 @@ bool idRenderWorldLocal::CullLightByPortals( const idRenderLightLocal *light, co
 
 		ALIGNTYPE16 frustumCorners_t corners;
 		//idRenderMatrix::GetFrustumCorners( corners, light->inverseBaseLightProject, bounds_zeroOneCube );
-		// by construction, see R_PolytopeSurfaceFrustumLike
-		assert( light->frustumTris && light->frustumTris->numVerts == 8 );
-		for ( int v = 0; v < 8; v++ ) {
-			idVec3 pos = light->frustumTris->verts[v].xyz;
-			corners.x[v] = pos.x;
-			corners.y[v] = pos.y;
-			corners.z[v] = pos.z;
-		}
+		GetLightRefCorners( light, corners );
 		for ( int i = 0; i < ps->numPortalPlanes; i++ ) {
 			if ( idRenderMatrix::CullFrustumCornersToPlane( corners, ps->portalPlanes[i] ) == FRUSTUM_CULL_FRONT ) {
 				return true;
@@ -839,8 +1074,16 @@ void idRenderWorldLocal::AddAreaLightRefs( int areaNum, const portalStack_t *ps
 
 	area = &portalAreas[ areaNum ];
 
-	for ( int lightIdx : area->lightRefs ) {
-		light = lightDefs[lightIdx];
+	// cull all refs of the area at once, CullLightByPortals is only needed for exact clipping
+	idFlexList<bool, 1024> culled;
+	bool batchCulled = r_useBatchPortalCulling.GetBool() && r_useLightPortalCulling.GetInteger() == 1;
+	if ( batchCulled ) {
+		culled.SetNum( area->lightRefs.Num() );
+		idRenderMatrix::CullFrustumCornersToPlanes( area->lightRefCorners.Ptr(), area->lightRefs.Num(), ps->portalPlanes, ps->numPortalPlanes, culled.Ptr() );
+	}
+
+	for ( int k = 0; k < area->lightRefs.Num(); k++ ) {
+		light = lightDefs[area->lightRefs[k]];
 
 
 		// debug tool to allow viewing of only one light at a time
@@ -865,7 +1108,7 @@ void idRenderWorldLocal::AddAreaLightRefs( int areaNum, const portalStack_t *ps
 		}
 
 		// cull frustum
-		if ( CullLightByPortals( light, ps ) ) {
+		if ( batchCulled ? culled[k] : CullLightByPortals( light, ps ) ) {
 			// we are culled out through this portal chain, but it might
 			// still be visible through others
 			continue;
@@ -1121,6 +1364,10 @@ void idRenderWorldLocal::SetPortalState( qhandle_t portal, int blockTypes ) {
 		return;
 	}
 	doublePortals[portal - 1].blockingBits = blockTypes;
+	portalSoundVersion++;
+	if ( ( old ^ blockTypes ) & PS_BLOCK_VIEW ) {
+		portalViewVersion++;
+	}
 
 	// leave the connectedAreaGroup the same on one side,
 	// then flood fill from the other side with a new number for each changed attribute
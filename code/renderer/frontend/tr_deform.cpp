@@ -18,6 +18,160 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 
 #include "renderer/tr_local.h"
 
+idCVar r_useDeformTopologyCache( "r_useDeformTopologyCache", "1", CVAR_RENDERER | CVAR_BOOL, "Cache the parts of deforms which depend only on the topology of the source surface" );
+
+/*
+===============================================================================
+
+  Deform topology cache
+
+  Some deforms spend most of their time on things which depend only on the
+  indexes of the source surface (eyeball islands, flare winding, autosprite
+  indexes) or on its static geometry (particle emission areas). These are
+  computed once per source surface and kept until the surface is freed.
+
+  Only surfaces of the entity's model are cached: frame-temporary surfaces
+  (decals, emitted particles, guis) are never passed to R_FreeStaticTriSurf.
+  Deforms run inside the model-add jobs, so the cache is guarded by a mutex,
+  and a cached topology is never modified once it has been built.
+
+===============================================================================
+*/
+
+typedef struct deformTopology_s {
+	deform_t			deform;
+	int					numVerts;
+	int					numIndexes;
+	idList<glIndex_t>	sourceIndexes;		// copy of the source indexes, if the topology depends on them
+	idList<glIndex_t>	indexes;			// indexes of the deformed surface
+	idList<glIndex_t>	winding;			// flare: boundary winding of the source surface
+	idList<int>			islandTris;			// eyeball: triangles of all islands, island after island
+	idList<int>			islandStart;		// eyeball: first triangle of each island, plus the total count
+	idList<float>		triAreas;			// particle: emission distribution over triangles
+	float				totalArea;
+} deformTopology_t;
+
+typedef void ( *deformTopologyBuild_t )( const srfTriangles_t *tri, deformTopology_t &topo );
+
+static idSysMutex deformTopologyMutex;
+static idHashMap<const srfTriangles_t *, deformTopology_t *> deformTopologies;
+
+/*
+=====================
+R_DeformSourceModel
+
+Returns the model of the entity which owns the source surface of the deform, or NULL.
+=====================
+*/
+static idRenderModel *R_DeformSourceModel( const drawSurf_t *surf ) {
+	const idRenderEntityLocal *def = surf->space->entityDef;
+	if ( !def ) {
+		return NULL;
+	}
+	idRenderModel *models[2] = { def->parms.hModel, def->dynamicModel };
+	for ( int m = 0 ; m < 2 ; m++ ) {
+		if ( !models[m] ) {
+			continue;
+		}
+		for ( int i = 0 ; i < models[m]->NumSurfaces() ; i++ ) {
+			if ( models[m]->Surface( i )->geometry == surf->frontendGeo ) {
+				return models[m];
+			}
+		}
+	}
+	return NULL;
+}
+
+/*
+=====================
+R_SaveDeformSourceIndexes
+=====================
+*/
+static void R_SaveDeformSourceIndexes( const srfTriangles_t *tri, deformTopology_t &topo ) {
+	topo.sourceIndexes.SetNum( tri->numIndexes );
+	memcpy( topo.sourceIndexes.Ptr(), tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+}
+
+/*
+=====================
+R_DeformTopologyMatches
+=====================
+*/
+static bool R_DeformTopologyMatches( const deformTopology_t &topo, const srfTriangles_t *tri, deform_t deform ) {
+	if ( topo.deform != deform || topo.numVerts != tri->numVerts || topo.numIndexes != tri->numIndexes ) {
+		return false;
+	}
+	if ( topo.sourceIndexes.Num() && memcmp( topo.sourceIndexes.Ptr(), tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) ) != 0 ) {
+		return false;
+	}
+	return true;
+}
+
+/*
+=====================
+R_BuildDeformTopology
+=====================
+*/
+static void R_BuildDeformTopology( const srfTriangles_t *tri, deform_t deform, deformTopologyBuild_t build, deformTopology_t &topo ) {
+	topo.deform = deform;
+	topo.numVerts = tri->numVerts;
+	topo.numIndexes = tri->numIndexes;
+	topo.sourceIndexes.Clear();
+	topo.indexes.Clear();
+	topo.winding.Clear();
+	topo.islandTris.Clear();
+	topo.islandStart.Clear();
+	topo.triAreas.Clear();
+	topo.totalArea = -1.0f;
+	build( tri, topo );
+}
+
+/*
+=====================
+R_GetDeformTopology
+
+Returns the topology of the source surface, building and caching it if needed.
+If it can't be cached, it is built into "scratch".
+=====================
+*/
+static const deformTopology_t *R_GetDeformTopology( const drawSurf_t *surf, bool cacheable, deformTopologyBuild_t build, deformTopology_t &scratch ) {
+	const srfTriangles_t *tri = surf->frontendGeo;
+	deform_t deform = surf->material->Deform();
+
+	if ( cacheable && r_useDeformTopologyCache.GetBool() ) {
+		idScopedCriticalSection lock( deformTopologyMutex );
+		deformTopology_t *&topo = deformTopologies[tri];
+		if ( !topo ) {
+			topo = new deformTopology_t;
+			R_BuildDeformTopology( tri, deform, build, *topo );
+			return topo;
+		}
+		if ( R_DeformTopologyMatches( *topo, tri, deform ) ) {
+			return topo;
+		}
+		// the surface is drawn with another deform, or its indexes were changed in place:
+		// other jobs may be using the cached topology, so leave it alone
+	}
+
+	R_BuildDeformTopology( tri, deform, build, scratch );
+	return &scratch;
+}
+
+/*
+=====================
+R_FreeDeformTopology
+
+Called when a static surface is freed, so that a new surface at the same address does not pick up its topology.
+=====================
+*/
+void R_FreeDeformTopology( const srfTriangles_t *tri ) {
+	idScopedCriticalSection lock( deformTopologyMutex );
+	if ( auto *elem = deformTopologies.Find( tri ) ) {
+		delete elem->value;
+		deformTopologies.Remove( tri );
+	}
+}
+
 /*
 =================
 R_FinishDeform
@@ -43,7 +197,12 @@ static void R_FinishDeform( drawSurf_t *drawSurf, srfTriangles_t *newTri, idDraw
 		newTri->verts = NULL;
 	}
 	newTri->ambientCache = vertexCache.AllocVertex( ac, newTri->numVerts * sizeof( idDrawVert ) );
-	newTri->indexCache = vertexCache.AllocIndex( newTri->indexes, newTri->numIndexes * sizeof( newTri->indexes[0] ) );
+	if ( newTri->indexes == drawSurf->frontendGeo->indexes && newTri->numIndexes == drawSurf->numIndexes && vertexCache.CacheIsCurrent( drawSurf->indexCache ) ) {
+		// the deform did not change the indexes, so the source surface's index buffer can be drawn as is
+		newTri->indexCache = drawSurf->indexCache;
+	} else {
+		newTri->indexCache = vertexCache.AllocIndex( newTri->indexes, newTri->numIndexes * sizeof( newTri->indexes[0] ) );
+	}
 
 	// if we are out of vertex cache, leave it the way it is
 	if ( newTri->ambientCache.IsValid() && newTri->indexCache.IsValid() ) {
@@ -52,6 +211,24 @@ static void R_FinishDeform( drawSurf_t *drawSurf, srfTriangles_t *newTri, idDraw
 	}
 }
 
+/*
+=====================
+R_BuildAutospriteTopology
+=====================
+*/
+static void R_BuildAutospriteTopology( const srfTriangles_t *tri, deformTopology_t &topo ) {
+	topo.indexes.SetNum( tri->numIndexes );
+	for ( int i = 0 ; i < tri->numVerts ; i+=4 ) {
+		topo.indexes[6*(i>>2)+0] = i;
+		topo.indexes[6*(i>>2)+1] = i+1;
+		topo.indexes[6*(i>>2)+2] = i+2;
+
+		topo.indexes[6*(i>>2)+3] = i;
+		topo.indexes[6*(i>>2)+4] = i+2;
+		topo.indexes[6*(i>>2)+5] = i+3;
+	}
+}
+
 /*
 =====================
 R_AutospriteDeform
@@ -88,12 +265,17 @@ static void R_AutospriteDeform( drawSurf_t *surf ) {
 		leftDir = vec3_origin - leftDir;
 	}
 
+	// the indexes depend only on the vertex count
+	deformTopology_t scratch;
+	const deformTopology_t *topo = R_GetDeformTopology( surf, R_DeformSourceModel( surf ) != NULL, R_BuildAutospriteTopology, scratch );
+
 	// this srfTriangles_t and all its indexes and caches are in frame
 	// memory, and will be automatically disposed of
 	newTri = (srfTriangles_t *)R_ClearedFrameAlloc( sizeof( *newTri ) );
 	newTri->numVerts = tri->numVerts;
 	newTri->numIndexes = tri->numIndexes;
 	newTri->indexes = (glIndex_t *)R_FrameAlloc( newTri->numIndexes * sizeof( newTri->indexes[0] ) );
+	memcpy( newTri->indexes, topo->indexes.Ptr(), newTri->numIndexes * sizeof( newTri->indexes[0] ) );
 
 	idDrawVert	*ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
 
@@ -123,14 +305,6 @@ static void R_AutospriteDeform( drawSurf_t *surf ) {
 		ac[i+3].xyz = mid + left - up;
 		ac[i+3].st[0] = 0;
 		ac[i+3].st[1] = 1;
-
-		newTri->indexes[6*(i>>2)+0] = i;
-		newTri->indexes[6*(i>>2)+1] = i+1;
-		newTri->indexes[6*(i>>2)+2] = i+2;
-
-		newTri->indexes[6*(i>>2)+3] = i;
-		newTri->indexes[6*(i>>2)+4] = i+2;
-		newTri->indexes[6*(i>>2)+5] = i+3;
 	}
 	R_FinishDeform( surf, newTri, ac );
 }
@@ -174,13 +348,13 @@ static void R_TubeDeform( drawSurf_t *surf ) {
 	idVec3	localView;
 	R_GlobalPointToLocal( surf->space->modelMatrix, tr.viewDef->renderView.vieworg, localView ); 
 
-	// this srfTriangles_t and all its indexes and caches are in frame
+	// this srfTriangles_t and all its caches are in frame
 	// memory, and will be automatically disposed of
+	// the indexes are not changed, so the source index buffer is reused
 	srfTriangles_t *newTri = (srfTriangles_t *)R_ClearedFrameAlloc( sizeof( *newTri ) );
 	newTri->numVerts = tri->numVerts;
 	newTri->numIndexes = tri->numIndexes;
-	newTri->indexes = (glIndex_t *)R_FrameAlloc( newTri->numIndexes * sizeof( newTri->indexes[0] ) );
-	memcpy( newTri->indexes, tri->indexes, newTri->numIndexes * sizeof( newTri->indexes[0] ) );
+	newTri->indexes = tri->indexes;
 
 	idDrawVert	*ac = (idDrawVert *)_alloca16( newTri->numVerts * sizeof( idDrawVert ) );
 	memset( ac, 0, sizeof( idDrawVert ) * newTri->numVerts );
@@ -347,6 +521,20 @@ int	R_WindingFromTriangles( const srfTriangles_t *tri, glIndex_t indexes[MAX_TRI
 	return numIndexes;
 }
 
+/*
+=====================
+R_BuildFlareTopology
+=====================
+*/
+static void R_BuildFlareTopology( const srfTriangles_t *tri, deformTopology_t &topo ) {
+	glIndex_t	indexes[MAX_TRI_WINDING_INDEXES];
+	int			numIndexes = R_WindingFromTriangles( tri, indexes );
+
+	topo.winding.SetNum( numIndexes );
+	memcpy( topo.winding.Ptr(), indexes, numIndexes * sizeof( indexes[0] ) );
+	R_SaveDeformSourceIndexes( tri, topo );
+}
+
 /*
 =====================
 R_FlareDeform
@@ -420,11 +608,12 @@ static void R_FlareDeform( drawSurf_t *surf ) {
 	}
 	float		spread = surf->shaderRegisters[ surf->material->GetDeformRegister(0) ] * r_flareSize.GetFloat();
 	idVec3		edgeDir[4][3];
-	glIndex_t	indexes[MAX_TRI_WINDING_INDEXES];
-	int			numIndexes = R_WindingFromTriangles( tri, indexes );
+	deformTopology_t scratch;
+	const deformTopology_t *topo = R_GetDeformTopology( surf, R_DeformSourceModel( surf ) != NULL, R_BuildFlareTopology, scratch );
+	const glIndex_t *indexes = topo->winding.Ptr();
 
 	// only deal with quads
-	if ( numIndexes != 4 ) {
+	if ( topo->winding.Num() != 4 ) {
 		return;
 	}
 	int i;
@@ -681,10 +870,6 @@ static void AddTriangleToIsland_r( const srfTriangles_t *tri, int triangleNum, b
 	b = tri->indexes[triangleNum*3+1];
 	c = tri->indexes[triangleNum*3+2];
 
-	island->bounds.AddPoint( tri->verts[a].xyz );
-	island->bounds.AddPoint( tri->verts[b].xyz );
-	island->bounds.AddPoint( tri->verts[c].xyz );
-
 	int	numTri = tri->numIndexes / 3;
 	for ( int i = 0 ; i < numTri ; i++ ) {
 		if ( usedList[i] ) {
@@ -706,33 +891,22 @@ static void AddTriangleToIsland_r( const srfTriangles_t *tri, int triangleNum, b
 
 /*
 =====================
-R_EyeballDeform
+R_BuildEyeballTopology
 
-Each eyeball surface should have an separate upright triangle behind it, long end
-pointing out the eye, and another single triangle in front of the eye for the focus point.
+Separates all the triangles into islands, which only depends on the indexes.
 =====================
 */
-static void R_EyeballDeform( drawSurf_t *surf ) {
-	int		i, j, k;
-	const srfTriangles_t	*tri;
-	srfTriangles_t	*newTri;
+static void R_BuildEyeballTopology( const srfTriangles_t *tri, deformTopology_t &topo ) {
+	int			i, j, k;
 	eyeIsland_t	islands[MAX_EYEBALL_ISLANDS];
 	int			numIslands;
 	bool		triUsed[MAX_EYEBALL_ISLANDS*MAX_EYEBALL_TRIS];
 
-	tri = surf->frontendGeo;
-
-	// separate all the triangles into islands
 	int		numTri = tri->numIndexes / 3;
-	if ( numTri > MAX_EYEBALL_ISLANDS*MAX_EYEBALL_TRIS ) {
-		common->Printf( "R_EyeballDeform: too many triangles in surface" );
-		return;
-	}
 	memset( triUsed, 0, sizeof( triUsed ) );
 
 	for ( numIslands = 0  ; numIslands < MAX_EYEBALL_ISLANDS ; numIslands++ ) {
 		islands[numIslands].numTris = 0;
-		islands[numIslands].bounds.Clear();
 		for ( i = 0 ; i < numTri ; i++ ) {
 			if ( !triUsed[i] ) {
 				AddTriangleToIsland_r( tri, i, triUsed, &islands[numIslands] );
@@ -744,12 +918,76 @@ static void R_EyeballDeform( drawSurf_t *surf ) {
 		}
 	}
 
+	for ( i = 0 ; i < numIslands ; i++ ) {
+		topo.islandStart.Append( topo.islandTris.Num() );
+		for ( j = 0 ; j < islands[i].numTris ; j++ ) {
+			topo.islandTris.Append( islands[i].tris[j] );
+		}
+	}
+	topo.islandStart.Append( topo.islandTris.Num() );
+
+	// the eyes are emitted in island order, the single triangle points are dropped
+	for ( i = 0 ; i < numIslands ; i++ ) {
+		if ( islands[i].numTris == 1 ) {
+			continue;
+		}
+		for ( j = 0 ; j < islands[i].numTris ; j++ ) {
+			for ( k = 0 ; k < 3 ; k++ ) {
+				topo.indexes.Append( tri->indexes[islands[i].tris[j] * 3 + k] );
+			}
+		}
+	}
+
+	R_SaveDeformSourceIndexes( tri, topo );
+}
+
+/*
+=====================
+R_EyeballDeform
+
+Each eyeball surface should have an separate upright triangle behind it, long end
+pointing out the eye, and another single triangle in front of the eye for the focus point.
+=====================
+*/
+static void R_EyeballDeform( drawSurf_t *surf ) {
+	int		i, j, k;
+	const srfTriangles_t	*tri;
+	srfTriangles_t	*newTri;
+	eyeIsland_t	islands[MAX_EYEBALL_ISLANDS];
+	int			numIslands;
+
+	tri = surf->frontendGeo;
+
+	int		numTri = tri->numIndexes / 3;
+	if ( numTri > MAX_EYEBALL_ISLANDS*MAX_EYEBALL_TRIS ) {
+		common->Printf( "R_EyeballDeform: too many triangles in surface" );
+		return;
+	}
+
+	// separate all the triangles into islands
+	deformTopology_t scratch;
+	const deformTopology_t *topo = R_GetDeformTopology( surf, R_DeformSourceModel( surf ) != NULL, R_BuildEyeballTopology, scratch );
+	numIslands = topo->islandStart.Num() - 1;
+
 	// assume we always have two eyes, two origins, and two targets
 	if ( numIslands != 3 ) {
 		common->Printf( "R_EyeballDeform: %i triangle islands\n", numIslands );
 		return;
 	}
 
+	// the island bounds depend on the current vertexes
+	for ( i = 0 ; i < numIslands ; i++ ) {
+		eyeIsland_t *island = &islands[i];
+		island->numTris = topo->islandStart[i+1] - topo->islandStart[i];
+		island->bounds.Clear();
+		for ( j = 0 ; j < island->numTris ; j++ ) {
+			island->tris[j] = topo->islandTris[topo->islandStart[i] + j];
+			for ( k = 0 ; k < 3 ; k++ ) {
+				island->bounds.AddPoint( tri->verts[tri->indexes[island->tris[j]*3+k]].xyz );
+			}
+		}
+	}
+
 	// this srfTriangles_t and all its indexes and caches are in frame
 	// memory, and will be automatically disposed of
 
@@ -757,12 +995,11 @@ static void R_EyeballDeform( drawSurf_t *surf ) {
 	newTri = (srfTriangles_t *)R_ClearedFrameAlloc( sizeof( *newTri ) );
 	memset( newTri, 0, sizeof( *newTri ) );
 	newTri->numVerts = tri->numVerts;
-	newTri->numIndexes = tri->numIndexes;
-	newTri->indexes = (glIndex_t *)R_FrameAlloc( tri->numIndexes * sizeof( newTri->indexes[0] ) );
+	newTri->numIndexes = topo->indexes.Num();
+	newTri->indexes = (glIndex_t *)R_FrameAlloc( newTri->numIndexes * sizeof( newTri->indexes[0] ) );
+	memcpy( newTri->indexes, topo->indexes.Ptr(), newTri->numIndexes * sizeof( newTri->indexes[0] ) );
 	idDrawVert *ac = (idDrawVert *)_alloca16( tri->numVerts * sizeof( idDrawVert ) );
 
-	newTri->numIndexes = 0;
-
 	// decide which islands are the eyes and points
 	for ( i = 0 ; i < numIslands ; i++ ) {
 		islands[i].mid = islands[i].bounds.GetCenter();
@@ -833,7 +1070,6 @@ static void R_EyeballDeform( drawSurf_t *surf ) {
 				int	index = islands[i].tris[j] * 3;
 
 				index = tri->indexes[index+k];
-				newTri->indexes[newTri->numIndexes++] = index;
 
 				ac[index].xyz = tri->verts[index].xyz;
 
@@ -850,6 +1086,17 @@ static void R_EyeballDeform( drawSurf_t *surf ) {
 //==========================================================================================
 
 
+/*
+=====================
+R_BuildParticleTopology
+=====================
+*/
+static void R_BuildParticleTopology( const srfTriangles_t *tri, deformTopology_t &topo ) {
+	int size = idParticle_PrepareDistributionOnSurface( tri );
+	topo.triAreas.SetNum( size );
+	idParticle_PrepareDistributionOnSurface( tri, topo.triAreas.Ptr(), &topo.totalArea );
+}
+
 /*
 =====================
 R_ParticleDeform
@@ -884,13 +1131,16 @@ static void R_ParticleDeform( drawSurf_t *surf, bool useArea ) {
 		if ( renderModel->Surface(surfIdx)->geometry == srcTri )
 			break;
 
-	float *triAreas = NULL;
+	const float *triAreas = NULL;
 	float totalArea = -1.0f;
+	deformTopology_t scratch;
 	if ( useArea ) {
 		// calculate the area of all the triangles
-		int size = idParticle_PrepareDistributionOnSurface(srcTri);
-		triAreas = (float *)alloca( sizeof(triAreas[0]) * size );
-		idParticle_PrepareDistributionOnSurface(srcTri, triAreas, &totalArea);
+		// it only stays the same if the surface belongs to a static model
+		bool cacheable = surfIdx >= 0 && renderModel->IsDynamicModel() == DM_STATIC;
+		const deformTopology_t *topo = R_GetDeformTopology( surf, cacheable, R_BuildParticleTopology, scratch );
+		triAreas = topo->triAreas.Ptr();
+		totalArea = topo->totalArea;
 	}
 
 	idPartSysData psys;
@@ -938,6 +1188,7 @@ static void R_ParticleDeform( drawSurf_t *surf, bool useArea ) {
 		tri->bounds = surf->frontendGeo->bounds;	// TODO: it seems this value has absolutely no effect
 		tri->numVerts = 0;
 
+		idFlexList<idParticleData, 128> parts;
 		for ( int index = 0 ; index < totalParticles ; index++ ) {
 			idParticleData part;
 			int cycIdx;
@@ -959,13 +1210,15 @@ static void R_ParticleDeform( drawSurf_t *surf, bool useArea ) {
 					continue;
 			}
 
-			// if the particle doesn't get drawn because it is faded out or beyond a kill region,
-			// don't increment the verts
-			idDrawVert *ptr = tri->verts + tri->numVerts;
-			idParticle_CreateParticle(*stage, psys, part, ptr);
-			tri->numVerts = ptr - tri->verts;
+			parts.AddGrow(part);
 		}
 
+		// if the particle doesn't get drawn because it is faded out or beyond a kill region,
+		// don't increment the verts
+		idDrawVert *ptr = tri->verts;
+		idParticle_CreateParticles(*stage, psys, parts.Ptr(), parts.Num(), ptr);
+		tri->numVerts = ptr - tri->verts;
+
 		if ( tri->numVerts > 0 ) {
 			// build the index list
 			int	indexes = 0;
@@ -24,6 +24,7 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 
 idCVar r_maxShadowMapLight( "r_maxShadowMapLight", "1000", CVAR_ARCHIVE | CVAR_RENDERER, "lights bigger than this will be force-sent to stencil" );
 idCVar r_useParallelAddModels( "r_useParallelAddModels", "1", CVAR_RENDERER | CVAR_BOOL | CVAR_ARCHIVE, "parallelize R_AddModelSurfaces in frontend using jobs" );
+idCVar r_useParallelAddLights( "r_useParallelAddLights", "1", CVAR_RENDERER | CVAR_BOOL | CVAR_ARCHIVE, "parallelize per-light work of R_AddLightSurfaces in frontend using jobs" );
 idCVarBool r_useClipPlaneCulling( "r_useClipPlaneCulling", "1", CVAR_RENDERER, "cull surfaces behind mirrors" );
 
 /*
@@ -946,6 +947,96 @@ idScreenRect R_CalcLightScissorRectangle( viewLight_t *vLight ) {
 	return r;
 }
 
+/*
+=================
+R_PrepareSingleLight
+
+Calc the light shader values and the scissor rectangle of one light.
+Does not touch anything shared with other lights, so it can run as a job.
+=================
+*/
+typedef struct {
+	viewLight_t *		vLight;
+	bool				visible;	// false if suppressed in this view or adds no light
+} preparedLight_t;
+
+static void R_PrepareSingleLight( preparedLight_t *prep ) {
+	viewLight_t *vLight = prep->vLight;
+	idRenderLightLocal *light = vLight->lightDef;
+	const idMaterial *lightShader = light->lightShader;
+
+	prep->visible = false;
+
+	// see if we are suppressing the light in this view
+	if ( !r_skipSuppress.GetBool() ) {
+		bool suppress = light->parms.suppressLightInViewID && light->parms.suppressLightInViewID == tr.viewDef->renderView.viewID;
+		suppress |= light->parms.allowLightInViewID && light->parms.allowLightInViewID != tr.viewDef->renderView.viewID;
+		suppress |= (bool) ( light->parms.suppressInSubview & ( 1 << ( tr.viewDef->isSubview ? 0 : 1 ) ) );
+		if ( suppress ) {
+			return;
+		}
+	}
+
+	// evaluate the light shader registers
+	float *lightRegs =(float *)R_FrameAlloc( lightShader->GetNumRegisters() * sizeof( float ) );
+	vLight->shaderRegisters = lightRegs;
+	lightShader->EvaluateRegisters( lightRegs, light->parms.shaderParms, tr.viewDef, light->parms.referenceSound );
+
+	// if this is a purely additive light and no stage in the light shader evaluates
+	// to a positive light value, we can completely skip the light
+	if ( !lightShader->IsFogLight() && !lightShader->IsBlendLight() ) {
+		int lightStageNum;
+		for ( lightStageNum = 0 ; lightStageNum < lightShader->GetNumStages() ; lightStageNum++ ) {
+			const shaderStage_t	*lightStage = lightShader->GetStage( lightStageNum );
+
+			// ignore stages that fail the condition
+			if ( !lightRegs[ lightStage->conditionRegister ] ) {
+				continue;
+			}
+			const int *registers = lightStage->color.registers;
+
+			// snap tiny values to zero to avoid lights showing up with the wrong color
+			if ( lightRegs[ registers[0] ] < 0.001f ) {
+				lightRegs[ registers[0] ] = 0.0f;
+			}
+			if ( lightRegs[ registers[1] ] < 0.001f ) {
+				lightRegs[ registers[1] ] = 0.0f;
+			}
+			if ( lightRegs[ registers[2] ] < 0.001f ) {
+				lightRegs[ registers[2] ] = 0.0f;
+			}
+
+			// FIXME:	when using the following values the light shows up bright red when using nvidia drivers/hardware
+			//			this seems to have been fixed ?
+			//lightRegs[ registers[0] ] = 1.5143074e-005f;
+			//lightRegs[ registers[1] ] = 1.5483369e-005f;
+			//lightRegs[ registers[2] ] = 1.7014690e-005f;
+
+			if (lightRegs[ registers[0] ] > 0.0f ||
+				lightRegs[ registers[1] ] > 0.0f ||
+				lightRegs[ registers[2] ] > 0.0f ) {
+				break;
+			}
+		}
+		if ( lightStageNum == lightShader->GetNumStages() ) {
+			// we went through all the stages and didn't find one that adds anything
+			return;
+		}
+	}
+
+	if ( r_useLightScissors.GetBool() ) {
+		// calculate the screen area covered by the light frustum
+		// which will be used to crop the stencil cull
+		idScreenRect scissorRect = R_CalcLightScissorRectangle( vLight );
+		// intersect with the portal crossing scissor rectangle
+		vLight->scissorRect.IntersectWithZ( scissorRect );
+	}
+
+	prep->visible = true;
+}
+
+REGISTER_PARALLEL_JOB( R_PrepareSingleLight, "R_PrepareSingleLight" );
+
 /*
 =================
 R_AddLightSurfaces
@@ -962,101 +1053,66 @@ turned off, or completely off screen.
 
 Create any new interactions needed between the viewLights
 and the viewEntitys due to game movement
+
+Per-light shader evaluation and scissor calculation run as jobs if useJobs is set,
+everything which touches the render world is merged serially in list order.
 =================
 */
-void R_AddLightSurfaces( void ) {
+void R_AddLightSurfaces( bool useJobs ) {
 	TRACE_CPU_SCOPE( "R_AddLightSurfaces" );
 	
 	viewLight_t			*vLight;
 	idRenderLightLocal	*light;
 	viewLight_t			**ptr;
 
-	// go through each visible light, possibly removing some from the list
-	ptr = &tr.viewDef->viewLights;
-	while ( *ptr ) {
-		vLight = *ptr;
-		light = vLight->lightDef;
-		const idMaterial *lightShader = light->lightShader;
-
-		if ( !lightShader ) {
+	int numLights = 0;
+	for ( vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next ) {
+		if ( !vLight->lightDef->lightShader ) {
 			common->Error( "R_AddLightSurfaces: NULL lightShader" );
 			return;
 		}
+		numLights++;
+	}
+	if ( numLights == 0 ) {
+		return;
+	}
 
-		// see if we are suppressing the light in this view
-		if ( !r_skipSuppress.GetBool() ) {
-			bool suppress = light->parms.suppressLightInViewID && light->parms.suppressLightInViewID == tr.viewDef->renderView.viewID;
-			suppress |= light->parms.allowLightInViewID && light->parms.allowLightInViewID != tr.viewDef->renderView.viewID;
-			suppress |= (bool) ( light->parms.suppressInSubview & ( 1 << ( tr.viewDef->isSubview ? 0 : 1 ) ) );
-			if ( suppress ) {
-				*ptr = vLight->next;
-				light->viewCount = -1;
-				continue;
-			}
-		}
-
-		// evaluate the light shader registers
-		float *lightRegs =(float *)R_FrameAlloc( lightShader->GetNumRegisters() * sizeof( float ) );
-		vLight->shaderRegisters = lightRegs;
-		lightShader->EvaluateRegisters( lightRegs, light->parms.shaderParms, tr.viewDef, light->parms.referenceSound );
-
-		// if this is a purely additive light and no stage in the light shader evaluates
-		// to a positive light value, we can completely skip the light
-		if ( !lightShader->IsFogLight() && !lightShader->IsBlendLight() ) {
-			int lightStageNum;
-			for ( lightStageNum = 0 ; lightStageNum < lightShader->GetNumStages() ; lightStageNum++ ) {
-				const shaderStage_t	*lightStage = lightShader->GetStage( lightStageNum );
-
-				// ignore stages that fail the condition
-				if ( !lightRegs[ lightStage->conditionRegister ] ) {
-					continue;
-				}
-				const int *registers = lightStage->color.registers;
+	preparedLight_t *prepared = (preparedLight_t *)R_FrameAlloc( numLights * sizeof( preparedLight_t ) );
+	int i = 0;
+	for ( vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next ) {
+		prepared[i++].vLight = vLight;
+	}
 
-				// snap tiny values to zero to avoid lights showing up with the wrong color
-				if ( lightRegs[ registers[0] ] < 0.001f ) {
-					lightRegs[ registers[0] ] = 0.0f;
-				}
-				if ( lightRegs[ registers[1] ] < 0.001f ) {
-					lightRegs[ registers[1] ] = 0.0f;
-				}
-				if ( lightRegs[ registers[2] ] < 0.001f ) {
-					lightRegs[ registers[2] ] = 0.0f;
-				}
+	if ( useJobs && numLights > 1 ) {
+		for ( i = 0; i < numLights; i++ ) {
+			tr.frontEndJobList->AddJob( (jobRun_t)R_PrepareSingleLight, &prepared[i] );
+		}
+		tr.frontEndJobList->Submit();
+		tr.frontEndJobList->Wait();
+	} else {
+		for ( i = 0; i < numLights; i++ ) {
+			R_PrepareSingleLight( &prepared[i] );
+		}
+	}
 
-				// FIXME:	when using the following values the light shows up bright red when using nvidia drivers/hardware
-				//			this seems to have been fixed ?
-				//lightRegs[ registers[0] ] = 1.5143074e-005f;
-				//lightRegs[ registers[1] ] = 1.5483369e-005f;
-				//lightRegs[ registers[2] ] = 1.7014690e-005f;
+	// go through each visible light, possibly removing some from the list
+	ptr = &tr.viewDef->viewLights;
+	for ( i = 0; i < numLights; i++ ) {
+		vLight = prepared[i].vLight;
+		light = vLight->lightDef;
+		const idMaterial *lightShader = light->lightShader;
 
-				if (lightRegs[ registers[0] ] > 0.0f ||
-					lightRegs[ registers[1] ] > 0.0f ||
-					lightRegs[ registers[2] ] > 0.0f ) {
-					break;
-				}
-			}
-			if ( lightStageNum == lightShader->GetNumStages() ) {
-				// we went through all the stages and didn't find one that adds anything
-				// remove the light from the viewLights list, and change its frame marker
-				// so interaction generation doesn't think the light is visible and
-				// create a shadow for it
-				*ptr = vLight->next;
-				light->viewCount = -1;
-				continue;
-			}
+		if ( !prepared[i].visible ) {
+			// remove the light from the viewLights list, and change its frame marker
+			// so interaction generation doesn't think the light is visible and
+			// create a shadow for it
+			*ptr = vLight->next;
+			light->viewCount = -1;
+			continue;
 		}
 
-		if ( r_useLightScissors.GetBool() ) {
-			// calculate the screen area covered by the light frustum
-			// which will be used to crop the stencil cull
-			idScreenRect scissorRect = R_CalcLightScissorRectangle( vLight );
-			// intersect with the portal crossing scissor rectangle
-			vLight->scissorRect.IntersectWithZ( scissorRect );
-
-			if ( r_showLightScissors.GetBool() ) {
-				R_ShowColoredScreenRect( vLight->scissorRect, light->index );
-			}
+		if ( r_useLightScissors.GetBool() && r_showLightScissors.GetBool() ) {
+			R_ShowColoredScreenRect( vLight->scissorRect, light->index );
 		}
 
 		// this one stays on the list
@@ -812,6 +812,7 @@ void R_CreateLightDefFogPortals( idRenderLightLocal *ldef ) {
 				dp->fogLight = ldef;
 				dp->nextFoggedPortal = ldef->foggedPortals;
 				ldef->foggedPortals = dp;
+				ldef->world->portalViewVersion++;
 			}
 		}
 	}
@@ -828,6 +829,9 @@ void R_FreeLightDefDerivedData( idRenderLightLocal *def ) {
 
 	// remove any portal fog references
 	doublePortal_t *dp = def->foggedPortals;
+	if ( dp ) {
+		def->world->portalViewVersion++;
+	}
 	while ( dp ) {
 		dp->fogLight = NULL;
 		dp = dp->nextFoggedPortal;
@@ -853,11 +857,13 @@ void R_FreeLightDefDerivedData( idRenderLightLocal *def ) {
 		assert(area->lightBackRefs[last]->idxInArea == last);
 		area->lightRefs[ref->idxInArea] = area->lightRefs[last];
 		area->lightBackRefs[ref->idxInArea] = area->lightBackRefs[last];
+		area->lightRefCorners[ref->idxInArea] = area->lightRefCorners[last];
 		area->lightBackRefs[ref->idxInArea]->idxInArea = ref->idxInArea;
 		assert(area->lightBackRefs[ref->idxInArea]->areaIdx == areaIdx);
 		// delete last ref
 		area->lightRefs.Pop();
 		area->lightBackRefs.Pop();
+		area->lightRefCorners.Pop();
 		
 		// put it back on the free list for reuse
 		def->world->areaReferenceAllocator.Free( ref );
@@ -876,9 +882,11 @@ R_FreeEntityDefDerivedData
 
 Used by both RE_FreeEntityDef and RE_UpdateEntityDef
 Does not actually free the entityDef.
+cacheInteractions = false if the interaction geometry can't be created
+again from the same inputs, e.g. because the entity moved.
 ===================
 */
-void R_FreeEntityDefDerivedData( idRenderEntityLocal *def, bool keepDecals, bool keepCachedDynamicModel ) {
+void R_FreeEntityDefDerivedData( idRenderEntityLocal *def, bool keepDecals, bool keepCachedDynamicModel, bool cacheInteractions ) {
 	// demo playback needs to free the joints, while normal play
 	// leaves them in the control of the game
 	if ( session->readDemo ) {
@@ -900,7 +908,7 @@ void R_FreeEntityDefDerivedData( idRenderEntityLocal *def, bool keepDecals, bool
 
 	// free all the interactions
 	while ( def->firstInteraction != NULL ) {
-		def->firstInteraction->UnlinkAndFree();
+		def->firstInteraction->UnlinkAndFree( cacheInteractions );
 	}
 
 	// clear the dynamic model if present
@@ -935,11 +943,13 @@ void R_FreeEntityDefDerivedData( idRenderEntityLocal *def, bool keepDecals, bool
 		assert(area->entityBackRefs[last]->idxInArea == last);
 		area->entityRefs[ref->idxInArea] = area->entityRefs[last];
 		area->entityBackRefs[ref->idxInArea] = area->entityBackRefs[last];
+		area->entityRefCorners[ref->idxInArea] = area->entityRefCorners[last];
 		area->entityBackRefs[ref->idxInArea]->idxInArea = ref->idxInArea;
 		assert(area->entityBackRefs[ref->idxInArea]->areaIdx == areaIdx);
 		// delete last ref
 		area->entityRefs.Pop();
 		area->entityBackRefs.Pop();
+		area->entityRefCorners.Pop();
 
 		// put it back on the free list for reuse
 		def->world->areaReferenceAllocator.Free( ref );
@@ -1038,7 +1048,7 @@ void R_FreeDerivedData( void ) {
 			if ( !def ) {
 				continue;
 			}
-			R_FreeEntityDefDerivedData( def, false, false );
+			R_FreeEntityDefDerivedData( def, false, false, false );
 		}
 
 		for ( i = 0; i < rw->lightDefs.Num(); i++ ) {
@@ -1048,6 +1058,9 @@ void R_FreeDerivedData( void ) {
 			}
 			R_FreeLightDefDerivedData( light );
 		}
+
+		// models are about to be reloaded, cached geometry points into them
+		rw->interactionGeometryCache.Clear();
 	}
 }
 
@@ -1068,9 +1081,11 @@ void R_CheckForEntityDefsUsingModel( idRenderModel *model ) {
 			if ( def && def->parms.hModel == model ) {
 				//assert( 0 );
 				// this should never happen but Radiant messes it up all the time so just free the derived data
-				R_FreeEntityDefDerivedData( def, false, false );
+				R_FreeEntityDefDerivedData( def, false, false, false );
 			}
 		}
+
+		rw->interactionGeometryCache.PurgeModel( model );
 	}
 }
 
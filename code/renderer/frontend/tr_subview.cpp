@@ -19,11 +19,24 @@ Project: The Dark Mod (http://www.thedarkmod.com/)
 #include "renderer/tr_local.h"
 #include "game/Grabber.h"
 
+idCVar r_useParallelSubviewCull( "r_useParallelSubviewCull", "1", CVAR_RENDERER | CVAR_BOOL | CVAR_ARCHIVE, "precisely cull the subview surfaces of a view in parallel before generating the subviews, if there are many of them" );
+
+// a precise cull of a typical mirror or portal surface is far cheaper than submitting
+// and waiting for a job list, so only views with many subview surfaces use jobs
+static const int MIN_PARALLEL_SUBVIEW_CULLS = 32;
+
 typedef struct {
 	idVec3		origin;
 	idMat3		axis;
 } orientation_t;
 
+// result of the precise cull of one subview surface, computed before any subview is generated
+typedef struct {
+	drawSurf_t *	drawSurf;
+	idBounds		ndcBounds;
+	bool			culled;
+} subviewCull_t;
+
 
 /*
 =================
@@ -546,20 +559,9 @@ bool R_Lightgem_Render() {
 		return false;
 	}
 
-	const idVec3& Cam = player->GetEyePosition();
-	idVec3 LGPos = player->GetPhysics()->GetOrigin();// Set the lightgem position to that of the player
-
-	// Move the lightgem out a fraction along the leaning vector
-	LGPos.x += (Cam.x - LGPos.x) * 0.3f + cv_lg_oxoffs.GetFloat(); 
-	LGPos.y += (Cam.y - LGPos.y) * 0.3f + cv_lg_oyoffs.GetFloat();
-
-	// Prevent lightgem from clipping into the floor while crouching
-	if ( player->GetPlayerPhysics()->IsCrouching() ) {
-		LGPos.z += 50.0f + cv_lg_ozoffs.GetFloat();
-	} else {
-		LGPos.z = Cam.z + cv_lg_ozoffs.GetFloat(); // Set the lightgem's Z-axis position to that of the player's eyes
-	}
+	const uint64_t renderStart = Sys_GetTimeMicroseconds();
 
+	idVec3 LGPos = gameLocal.m_lightGem.GetPosition( player );
 	lg->SetOrigin( LGPos ); // Move the lightgem testmodel to the players feet based on the eye position
 
 	gameRenderWorld->UpdateEntityDef( lg->GetModelDefHandle(), lgent ); // Make sure the lg is in the updated position
@@ -668,16 +670,30 @@ bool R_Lightgem_Render() {
 		}
 	}
 
+	gameLocal.m_lightGem.AddRenderTime( Sys_GetTimeMicroseconds() - renderStart );
+
 	return true;
 }
 
+/*
+==================
+R_CullSubviewSurface
+
+Only reads the current view and the surface, so it can run as a job
+==================
+*/
+static void R_CullSubviewSurface( subviewCull_t *cull ) {
+	cull->culled = R_PreciseCullSurface( cull->drawSurf, cull->ndcBounds );
+}
+
+REGISTER_PARALLEL_JOB( R_CullSubviewSurface, "R_CullSubviewSurface" );
+
 /*
 ==================
 R_GenerateSurfaceSubview
 ==================
 */
-bool	R_GenerateSurfaceSubview( drawSurf_t *drawSurf ) {
-	idBounds		ndcBounds;
+bool	R_GenerateSurfaceSubview( drawSurf_t *drawSurf, const idBounds &ndcBounds ) {
 	viewDef_t		*parms;
 	const idMaterial		*shader;
 
@@ -685,9 +701,6 @@ bool	R_GenerateSurfaceSubview( drawSurf_t *drawSurf ) {
 	if ( r_skipSubviews ) 
 		return false;
 
-	if ( R_PreciseCullSurface( drawSurf, ndcBounds ) ) 
-		return false;
-
 	shader = drawSurf->material;
 
 	// never recurse through a subview surface that we are
@@ -773,13 +786,14 @@ bool R_GenerateSubViews( void ) {
 	subviews = false;
 
 	extern idCVar cv_lg_interleave;								// FIXME a better way to check for RenderWindow views? (compass, etc)
-	if ( !tr.viewDef->isSubview && cv_lg_interleave.GetBool() && !tr.viewDef->renderWorld->mapName.IsEmpty() ) {
+	if ( !tr.viewDef->isSubview && cv_lg_interleave.GetBool() && !tr.viewDef->renderWorld->mapName.IsEmpty() && gameLocal.m_lightGem.NeedsRenderView() ) {
 		R_Lightgem_Render();
 		subviews = true;
 	}
 
-	// scan the surfaces until we either find a subview, or determine
-	// there are no more subview surfaces.
+	// collect the subview surfaces
+	subviewCull_t *culls = nullptr;
+	int numCulls = 0;
 	for ( i = 0; i < tr.viewDef->numDrawSurfs; i++ ) {
 		drawSurf = tr.viewDef->drawSurfs[i];
 		shader = drawSurf->material;
@@ -787,10 +801,37 @@ bool R_GenerateSubViews( void ) {
 		if ( !shader || !shader->HasSubview() )
 			continue;
 
-		if ( shader->GetSort() != SS_PORTAL_SKY ) // portal sky needs to be the last one, and only once
-			if ( R_GenerateSurfaceSubview( drawSurf ) ) {
-				subviews = true;
-			}
+		if ( shader->GetSort() == SS_PORTAL_SKY ) // portal sky needs to be the last one, and only once
+			continue;
+
+		if ( !culls ) {
+			culls = (subviewCull_t *)R_FrameAlloc( ( tr.viewDef->numDrawSurfs - i ) * sizeof( subviewCull_t ) );
+		}
+		culls[numCulls++].drawSurf = drawSurf;
+	}
+
+	// the precise cull of every surface only depends on the current view,
+	// while generating a subview changes the global renderer state
+	if ( r_useParallelSubviewCull.GetBool() && numCulls >= MIN_PARALLEL_SUBVIEW_CULLS ) {
+		for ( i = 0; i < numCulls; i++ ) {
+			tr.frontEndJobList->AddJob( (jobRun_t)R_CullSubviewSurface, &culls[i] );
+		}
+		tr.frontEndJobList->Submit();
+		tr.frontEndJobList->Wait();
+	} else {
+		for ( i = 0; i < numCulls; i++ ) {
+			R_CullSubviewSurface( &culls[i] );
+		}
+	}
+
+	// generate the subviews one by one in the order of the surfaces
+	for ( i = 0; i < numCulls; i++ ) {
+		if ( culls[i].culled )
+			continue;
+
+		if ( R_GenerateSurfaceSubview( culls[i].drawSurf, culls[i].ndcBounds ) ) {
+			subviews = true;
+		}
 	}
 
 	static bool dontReenter = false;
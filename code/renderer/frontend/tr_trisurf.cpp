@@ -391,6 +391,7 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 	}
 
 	R_FreeStaticTriSurfVertexCaches( tri );
+	R_FreeDeformTopology( tri );
 
 	if ( tri->verts != NULL ) {
 		// R_CreateLightTris points tri->verts at the verts of the ambient surface
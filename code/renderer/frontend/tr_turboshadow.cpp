@@ -37,7 +37,6 @@ srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLoca
 														srfCullInfo_t &cullInfo ) {
 	int		i, j;
 	srfTriangles_t	*newTri;
-	silEdge_t	*sil;
 	const glIndex_t *indexes;
 	const byte *facing;
 
@@ -100,30 +99,7 @@ srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLoca
 #endif
 
 	// create new triangles along sil planes
-	for ( sil = tri->silEdges, i = tri->numSilEdges; i > 0; i--, sil++ ) {
-
-		int f1 = facing[sil->p1];
-		int f2 = facing[sil->p2];
-
-		if ( !( f1 ^ f2 ) ) {
-			continue;
-		}
-
-		int v1 = sil->v1 << 1;
-		int v2 = sil->v2 << 1;
-
-		// set the two triangle winding orders based on facing
-		// without using a poorly-predictable branch
-
-		shadowIndexes[0] = v1;
-		shadowIndexes[1] = v2 ^ f1;
-		shadowIndexes[2] = v2 ^ f2;
-		shadowIndexes[3] = v1 ^ f2;
-		shadowIndexes[4] = v1 ^ f1;
-		shadowIndexes[5] = v2 ^ 1;
-
-		shadowIndexes += 6;
-	}
+	shadowIndexes += SIMDProcessor->ShadowVolume_CreateSilTriangles( shadowIndexes, facing, tri->silEdges, tri->numSilEdges );
 
 	int	numShadowIndexes = shadowIndexes - tempIndexes;
 
@@ -1783,6 +1783,34 @@ REGISTER_PARALLEL_JOB( R_LoadSingleImage, "R_LoadSingleImage" );
 
 idCVar image_levelLoadParallel( "image_levelLoadParallel", "1", CVAR_BOOL|CVAR_ARCHIVE, "Parallelize texture creation during level load by fetching images from disk in the background" );
 
+/*
+====================
+R_PrefetchImageFiles
+
+Starts reading precompressed files of the given images on I/O threads,
+so that load jobs find their data in memory.
+====================
+*/
+static void R_PrefetchImageFiles( idFileReadBatch &batch, idImageAsset **images, int num ) {
+	if ( !globalImages->image_usePrecompressedTextures.GetBool() || !glConfig.isInitialized ) {
+		return;
+	}
+	char filename[MAX_IMAGE_NAME];
+	for ( int i = 0; i < num; i++ ) {
+		const idImageAsset *image = images[i];
+		// same conditions as in R_LoadImageData and CheckPrecompressedImage
+		if ( image->source.generatorFunction || image->source.cubeFiles != CF_2D || ( image->residency & IR_CPU ) ) {
+			continue;
+		}
+		if ( image->imgName.Icmpn( "lights/", 7 ) == 0 ) {
+			continue;
+		}
+		image->ImageProgramStringToCompressedFileName( image->imgName, filename );
+		batch.Add( filename );
+	}
+	batch.Submit();
+}
+
 void idImageManager::EndLevelLoad() {
 	const int start = Sys_Milliseconds();
 	insideLevelLoad = false;
@@ -1826,10 +1854,22 @@ void idImageManager::EndLevelLoad() {
 	// a single background thread, since decompression and calculation of image functions do take some of the time. SSDs do see
 	// slight improvements with additional threads, but the difference is small. On HDDs, the additional thread does not offer
 	// any advantages, but it should also not overload the disk, so that 2 threads is an acceptable compromise for all disk types.
+	// Files of the batch after the one given to the job queue are read ahead by file system I/O threads.
 	const int BATCH_SIZE = 16;
 	idParallelJobList *imageLoadJobs = parallelJobManager->AllocJobList( JOBLIST_UTILITY, JOBLIST_PRIORITY_MEDIUM, BATCH_SIZE, 0, nullptr );
+	idFileReadBatch filePrefetch[3];
 
 	for ( int curBatch = -BATCH_SIZE; curBatch < imagesToLoad.Num(); curBatch += BATCH_SIZE ) {
+		const int batchIndex = curBatch / BATCH_SIZE + 1;	// batch given to job queue now
+		if ( curBatch < 0 ) {
+			R_PrefetchImageFiles( filePrefetch[0], imagesToLoad.Ptr(), idMath::Imin( BATCH_SIZE, imagesToLoad.Num() ) );
+		}
+		int nextStart = curBatch + 2 * BATCH_SIZE;
+		if ( nextStart < imagesToLoad.Num() ) {
+			int num = idMath::Imin( BATCH_SIZE, imagesToLoad.Num() - nextStart );
+			R_PrefetchImageFiles( filePrefetch[( batchIndex + 1 ) % 3], imagesToLoad.Ptr() + nextStart, num );
+		}
+
 		for ( int i = curBatch + BATCH_SIZE; i < imagesToLoad.Num() && i < curBatch + 2 * BATCH_SIZE; ++i ) {
 			idImageAsset *image = imagesToLoad[i];
 			imageLoadJobs->AddJob((jobRun_t)R_LoadSingleImage, image);
@@ -1852,6 +1892,7 @@ void idImageManager::EndLevelLoad() {
 		}
 
 		imageLoadJobs->Wait();
+		filePrefetch[batchIndex % 3].Release();
 	}
 
 	parallelJobManager->FreeJobList( imageLoadJobs );
@@ -172,9 +172,7 @@ idRenderModel *idRenderModelPrt::InstantiateDynamicModel( const struct renderEnt
 			R_AllocStaticTriSurfPlanes( surf->geometry, 6 * count );
 		}
 
-		int numVerts = 0;
-		idDrawVert *verts = surf->geometry->verts;
-
+		idFlexList<idParticleData, 128> parts;
 		for ( int index = 0; index < stage->totalParticles; index++ ) {
 			idParticleData part;
 			int cycIdx;
@@ -187,12 +185,15 @@ idRenderModel *idRenderModelPrt::InstantiateDynamicModel( const struct renderEnt
 					continue;
 			}
 
-			// if the particle doesn't get drawn because it is faded out or beyond a kill region, don't increment the verts
-			idDrawVert *ptr = verts + numVerts;
-			idParticle_CreateParticle(*stage, psys, part, ptr);
-			numVerts = ptr - verts;
+			parts.AddGrow(part);
 		}
 
+		// if the particle doesn't get drawn because it is faded out or beyond a kill region, don't increment the verts
+		idDrawVert *verts = surf->geometry->verts;
+		idDrawVert *ptr = verts;
+		idParticle_CreateParticles(*stage, psys, parts.Ptr(), parts.Num(), ptr);
+		int numVerts = ptr - verts;
+
 		// numVerts must be a multiple of 4
 		assert( ( numVerts & 3 ) == 0 && numVerts <= 4 * count );
 
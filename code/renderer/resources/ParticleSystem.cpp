@@ -237,7 +237,7 @@ int idParticle_GetParticleCountOnSurface(const idPartStageData &stg, const srfTr
 	}
 }
 
-void idParticle_EmitLocationOnSurface(const idPartStageData &stg, const srfTriangles_s *tri, idParticleData &part, idVec2 &texCoord, float *areas) {
+void idParticle_EmitLocationOnSurface(const idPartStageData &stg, const srfTriangles_s *tri, idParticleData &part, idVec2 &texCoord, const float *areas) {
 	//---------------
 	// locate the particle origin and axis somewhere on the surface
 	//---------------
@@ -434,3 +434,426 @@ float idParticle_FetchCutoffTimeLinear(const idImageAsset *image, int totalParti
 	float ratio = ((texel[0] * 256 + texel[1]) * 256 + texel[2]) * TWO_POWER_MINUS_24;
 	return ratio;
 }
+
+//===========================================================================
+
+idCVar r_useParticleBatch( "r_useParticleBatch", "1", CVAR_RENDERER | CVAR_BOOL, "evaluate particles of a stage in SIMD batches instead of one-by-one" );
+
+#ifdef __SSE2__
+
+//number of particles evaluated together (must be multiple of 4)
+static const int PARTICLE_BATCH = 64;
+
+//structure-of-arrays data of the particles in a batch
+//only particles which are not faded out are stored here, in their original order
+struct idParticleBatch {
+	int num;
+	ALIGN16( float frac[PARTICLE_BATCH] );
+	ALIGN16( float rotSign[PARTICLE_BATCH] );		//+1 if particle rotates forward (odd index), -1 otherwise
+	ALIGN16( float angle[PARTICLE_BATCH] );			//initial angle in degrees
+	ALIGN16( float originX[PARTICLE_BATCH] );
+	ALIGN16( float originY[PARTICLE_BATCH] );
+	ALIGN16( float originZ[PARTICLE_BATCH] );
+	ALIGN16( float colorR[PARTICLE_BATCH] );
+	ALIGN16( float colorG[PARTICLE_BATCH] );
+	ALIGN16( float colorB[PARTICLE_BATCH] );
+	ALIGN16( float colorA[PARTICLE_BATCH] );
+	//only filled for parameters defined by tables
+	ALIGN16( float size[PARTICLE_BATCH] );
+	ALIGN16( float aspect[PARTICLE_BATCH] );
+	ALIGN16( float angleMove[PARTICLE_BATCH] );
+};
+
+// mask ? a : b
+static ID_FORCE_INLINE __m128 idParticle_Select( __m128 mask, __m128 a, __m128 b ) {
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+//from + frac * (to - from), see idParticleParm_Eval
+static ID_FORCE_INLINE __m128 idParticle_EvalLinear( const idParticleParm &parm, __m128 frac ) {
+	return _mm_add_ps( _mm_set1_ps( parm.from ), _mm_mul_ps( frac, _mm_set1_ps( parm.to - parm.from ) ) );
+}
+
+//four-wide version of idMath::SinCos16, gives same results
+static void idParticle_SinCos16( __m128 a, __m128 &s, __m128 &c ) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 pi = _mm_set1_ps( PI );
+	const __m128 twoPi = _mm_set1_ps( idMath::TWO_PI );
+
+	// bring into [0, 2*PI) range, floor is exact for the angles we get here
+	__m128 outside = _mm_or_ps( _mm_cmplt_ps( a, zero ), _mm_cmpge_ps( a, twoPi ) );
+	__m128 turns = _mm_div_ps( a, twoPi );
+	__m128 turnsFloor = _mm_cvtepi32_ps( _mm_cvttps_epi32( turns ) );
+	turnsFloor = _mm_sub_ps( turnsFloor, _mm_and_ps( _mm_cmpgt_ps( turnsFloor, turns ), one ) );
+	a = idParticle_Select( outside, _mm_sub_ps( a, _mm_mul_ps( turnsFloor, twoPi ) ), a );
+
+	// first quadrant: keep as is, fourth quadrant: shift back by 2*PI, otherwise: reflect around PI/2
+	__m128 lower = _mm_cmplt_ps( a, pi );
+	__m128 keep = _mm_andnot_ps( _mm_cmpgt_ps( a, _mm_set1_ps( idMath::HALF_PI ) ), lower );
+	__m128 shift = _mm_andnot_ps( lower, _mm_cmpgt_ps( a, _mm_set1_ps( PI + idMath::HALF_PI ) ) );
+	__m128 positive = _mm_or_ps( keep, shift );
+	a = idParticle_Select( keep, a, idParticle_Select( shift, _mm_sub_ps( a, twoPi ), _mm_sub_ps( pi, a ) ) );
+	__m128 d = idParticle_Select( positive, one, _mm_set1_ps( -1.0f ) );
+
+	__m128 t = _mm_mul_ps( a, a );
+	#define POLY_STEP( p, coef ) p = _mm_add_ps( _mm_mul_ps( p, t ), _mm_set1_ps( coef ) );
+	__m128 ps = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( -2.39e-08f ), t ), _mm_set1_ps( 2.7526e-06f ) );
+	POLY_STEP( ps, -1.98409e-04f );
+	POLY_STEP( ps, 8.3333315e-03f );
+	POLY_STEP( ps, -1.666666664e-01f );
+	POLY_STEP( ps, 1.0f );
+	s = _mm_mul_ps( a, ps );
+	__m128 pc = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( -2.605e-07f ), t ), _mm_set1_ps( 2.47609e-05f ) );
+	POLY_STEP( pc, -1.3888397e-03f );
+	POLY_STEP( pc, 4.16666418e-02f );
+	POLY_STEP( pc, -4.999999963e-01f );
+	POLY_STEP( pc, 1.0f );
+	c = _mm_mul_ps( d, pc );
+	#undef POLY_STEP
+}
+
+//stage 1: compute colors of all particles, drop the faded out ones (see idParticle_ParticleColors)
+//stage 2: compute origin and initial angle of surviving particles one-by-one (random seed sequence)
+static void idParticle_PrepareBatch(
+	const idPartStageData &stg, const idPartSysData &psys,
+	const idParticleData *parts, int count, idParticleBatch &batch
+) {
+	ALIGN16( float frac[PARTICLE_BATCH] );
+	ALIGN16( int index[PARTICLE_BATCH] );
+	ALIGN16( float color[4][PARTICLE_BATCH] );
+	int padded = ( count + 3 ) & ~3;
+	for ( int i = 0; i < padded; i++ ) {
+		frac[i] = ( i < count ? parts[i].frac : 0.0f );
+		index[i] = ( i < count ? parts[i].index : 0 );
+	}
+
+	const idVec4 &baseColor = ( stg.entityColor ? psys.entityParmsColor : stg.color );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 fadeIn = _mm_set1_ps( stg.fadeInFraction );
+	const __m128 fadeOut = _mm_set1_ps( stg.fadeOutFraction );
+	const __m128 fadeIndex = _mm_set1_ps( stg.fadeIndexFraction );
+	const __m128i totalParticles = _mm_set1_epi32( psys.totalParticles );
+	const __m128 totalParticlesF = _mm_set1_ps( float( psys.totalParticles ) );
+	int alive[PARTICLE_BATCH / 4];
+	for ( int i = 0; i < padded; i += 4 ) {
+		__m128 f = _mm_load_ps( &frac[i] );
+		__m128 fade = one;
+
+		// fade in / fade out (divisor is replaced where the result is not used)
+		__m128 mask = _mm_cmplt_ps( f, fadeIn );
+		fade = idParticle_Select( mask, _mm_mul_ps( fade, _mm_div_ps( f, idParticle_Select( mask, fadeIn, one ) ) ), fade );
+		__m128 rest = _mm_sub_ps( one, f );
+		mask = _mm_cmplt_ps( rest, fadeOut );
+		fade = idParticle_Select( mask, _mm_mul_ps( fade, _mm_div_ps( rest, idParticle_Select( mask, fadeOut, one ) ) ), fade );
+
+		if ( stg.fadeIndexFraction ) {
+			__m128i idx = _mm_load_si128( (__m128i*)&index[i] );
+			__m128 indexFrac = _mm_div_ps( _mm_cvtepi32_ps( _mm_sub_epi32( totalParticles, idx ) ), totalParticlesF );
+			mask = _mm_cmplt_ps( indexFrac, fadeIndex );
+			fade = idParticle_Select( mask, _mm_mul_ps( fade, _mm_div_ps( indexFrac, fadeIndex ) ), fade );
+		}
+
+		__m128 invFade = _mm_sub_ps( one, fade );
+		__m128 allZero = _mm_cmpeq_ps( zero, zero );
+		for ( int k = 0; k < 4; k++ ) {
+			__m128 comp = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( baseColor[k] ), fade ), _mm_mul_ps( _mm_set1_ps( stg.fadeColor[k] ), invFade ) );
+			comp = _mm_min_ps( _mm_max_ps( comp, zero ), one );
+			_mm_store_ps( &color[k][i], comp );
+			allZero = _mm_and_ps( allZero, _mm_cmpeq_ps( comp, zero ) );
+		}
+		// if we are completely faded out, kill the particle
+		alive[i / 4] = ~_mm_movemask_ps( allZero ) & 15;
+	}
+
+	batch.num = 0;
+	for ( int i = 0; i < count; i++ ) {
+		if ( !( alive[i / 4] & ( 1 << ( i & 3 ) ) ) ) {
+			continue;
+		}
+		const idParticleData &part = parts[i];
+		int n = batch.num++;
+		batch.frac[n] = part.frac;
+		batch.rotSign[n] = ( part.index & 1 ? 1.0f : -1.0f );
+		batch.colorR[n] = color[0][i];
+		batch.colorG[n] = color[1][i];
+		batch.colorB[n] = color[2][i];
+		batch.colorA[n] = color[3][i];
+
+		int random = part.randomSeed;
+		idVec3 origin = idParticle_ParticleOrigin( stg, psys, part, random );
+		batch.originX[n] = origin.x;
+		batch.originY[n] = origin.y;
+		batch.originZ[n] = origin.z;
+		batch.angle[n] = ( stg.initialAngle ) ? stg.initialAngle : 360 * idRandom_RandomFloat( random );
+
+		if ( stg.size.table ) {
+			batch.size[n] = idParticleParm_Eval( stg.size, part.frac );
+		}
+		if ( stg.aspect.table ) {
+			batch.aspect[n] = idParticleParm_Eval( stg.aspect, part.frac );
+		}
+		if ( stg.rotationSpeed.table ) {
+			batch.angleMove[n] = idParticleParm_Integrate( stg.rotationSpeed, part.frac ) * stg.particleLife;
+		}
+	}
+
+	// pad the last group of four with harmless values
+	for ( int n = batch.num; n & 3; n++ ) {
+		batch.frac[n] = batch.rotSign[n] = batch.angle[n] = 0.0f;
+		batch.originX[n] = batch.originY[n] = batch.originZ[n] = 0.0f;
+		batch.colorR[n] = batch.colorG[n] = batch.colorB[n] = batch.colorA[n] = 0.0f;
+		batch.size[n] = batch.aspect[n] = batch.angleMove[n] = 0.0f;
+	}
+}
+
+//stage 3: compute texcoords, sizes, rotation and quad corners for four particles at once and emit them
+static void idParticle_EmitBatch( const idPartStageData &stg, const idPartSysData &psys, const idParticleBatch &batch, idDrawVert* &emitter ) {
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 byteScale = _mm_set1_ps( 255.0f );
+	const __m128 signBit = _mm_set1_ps( -0.0f );
+	const __m128 particleLife = _mm_set1_ps( stg.particleLife );
+	const bool animated = ( stg.animationFrames > 1 );
+	const float frameWidth = ( animated ? 1.0f / stg.animationFrames : 1.0f );
+
+	// axes of quad in entity space for unrotated particle (view orientation only)
+	idVec3 entityLeft = psys.viewAxis[1];
+	idVec3 entityUp = psys.viewAxis[2];
+	entityLeft *= psys.entityAxis.Transpose();
+	entityUp *= psys.entityAxis.Transpose();
+
+	for ( int i = 0; i < batch.num; i += 4 ) {
+		__m128 frac = _mm_load_ps( &batch.frac[i] );
+		__m128 age = _mm_mul_ps( frac, particleLife );
+
+		// texcoords, see idParticle_ParticleTexCoords
+		__m128 s0 = zero, width = one, animFrac = zero;
+		if ( animated ) {
+			width = _mm_set1_ps( frameWidth );
+			__m128 floatFrame = ( stg.animationRate ?
+				_mm_mul_ps( age, _mm_set1_ps( stg.animationRate ) ) :
+				_mm_mul_ps( frac, _mm_set1_ps( float( stg.animationFrames ) ) )
+			);
+			__m128 intFrame = _mm_cvtepi32_ps( _mm_cvttps_epi32( floatFrame ) );
+			animFrac = _mm_min_ps( _mm_max_ps( _mm_sub_ps( floatFrame, intFrame ), zero ), one );
+			s0 = _mm_mul_ps( width, intFrame );
+		}
+		__m128 s1 = _mm_add_ps( s0, width );
+
+		// size
+		__m128 psize = ( stg.size.table ? _mm_load_ps( &batch.size[i] ) : idParticle_EvalLinear( stg.size, frac ) );
+		__m128 paspect = ( stg.aspect.table ? _mm_load_ps( &batch.aspect[i] ) : idParticle_EvalLinear( stg.aspect, frac ) );
+		__m128 height = _mm_mul_ps( psize, paspect );
+
+		// constant rotation, half the particles rotate each way
+		__m128 angleMove;
+		if ( stg.rotationSpeed.table ) {
+			angleMove = _mm_load_ps( &batch.angleMove[i] );
+		} else {
+			// see idParticleParm_Integrate
+			const idParticleParm &rs = stg.rotationSpeed;
+			angleMove = _mm_mul_ps( _mm_add_ps( _mm_set1_ps( rs.from ), _mm_mul_ps( _mm_mul_ps( frac, _mm_set1_ps( rs.to - rs.from ) ), _mm_set1_ps( 0.5f ) ) ), frac );
+			angleMove = _mm_mul_ps( angleMove, particleLife );
+		}
+		__m128 angle = _mm_add_ps( _mm_load_ps( &batch.angle[i] ), _mm_mul_ps( _mm_load_ps( &batch.rotSign[i] ), angleMove ) );
+		angle = _mm_mul_ps( angle, _mm_set1_ps( PI / 180 ) );
+		__m128 s, c;
+		idParticle_SinCos16( angle, s, c );
+
+		__m128 left[3], up[3];
+		if ( stg.orientation == POR_Z ) {
+			left[0] = s; left[1] = c; left[2] = zero;
+			up[0] = c; up[1] = _mm_xor_ps( s, signBit ); up[2] = zero;
+		} else if ( stg.orientation == POR_X ) {
+			left[0] = zero; left[1] = c; left[2] = s;
+			up[0] = zero; up[1] = _mm_xor_ps( s, signBit ); up[2] = c;
+		} else if ( stg.orientation == POR_Y ) {
+			left[0] = c; left[1] = zero; left[2] = s;
+			up[0] = _mm_xor_ps( s, signBit ); up[1] = zero; up[2] = c;
+		} else {
+			// oriented in viewer space
+			for ( int k = 0; k < 3; k++ ) {
+				__m128 eLeft = _mm_set1_ps( entityLeft[k] );
+				__m128 eUp = _mm_set1_ps( entityUp[k] );
+				left[k] = _mm_add_ps( _mm_mul_ps( eLeft, c ), _mm_mul_ps( eUp, s ) );
+				up[k] = _mm_sub_ps( _mm_mul_ps( eUp, c ), _mm_mul_ps( eLeft, s ) );
+			}
+		}
+
+		// quad corners:
+		//  0 1
+		//  2 3
+		ALIGN16( float xyz[4][3][4] );
+		const float *originPtr[3] = { &batch.originX[i], &batch.originY[i], &batch.originZ[i] };
+		for ( int k = 0; k < 3; k++ ) {
+			__m128 origin = _mm_load_ps( originPtr[k] );
+			__m128 l = _mm_mul_ps( left[k], psize );
+			__m128 u = _mm_mul_ps( up[k], height );
+			__m128 minusLeft = _mm_sub_ps( origin, l );
+			__m128 plusLeft = _mm_add_ps( origin, l );
+			_mm_store_ps( xyz[0][k], _mm_add_ps( minusLeft, u ) );
+			_mm_store_ps( xyz[1][k], _mm_add_ps( plusLeft, u ) );
+			_mm_store_ps( xyz[2][k], _mm_sub_ps( minusLeft, u ) );
+			_mm_store_ps( xyz[3][k], _mm_sub_ps( plusLeft, u ) );
+		}
+
+		// colors, cross faded between two frames for strip animation
+		ALIGN16( int colors[2][4][4] );
+		const float *colorPtr[4] = { &batch.colorR[i], &batch.colorG[i], &batch.colorB[i], &batch.colorA[i] };
+		__m128 iFrac = _mm_sub_ps( one, animFrac );
+		for ( int k = 0; k < 4; k++ ) {
+			__m128 color = _mm_load_ps( colorPtr[k] );
+			if ( animated ) {
+				_mm_store_si128( (__m128i*)colors[0][k], _mm_cvttps_epi32( _mm_mul_ps( _mm_mul_ps( color, iFrac ), byteScale ) ) );
+				_mm_store_si128( (__m128i*)colors[1][k], _mm_cvttps_epi32( _mm_mul_ps( _mm_mul_ps( color, animFrac ), byteScale ) ) );
+			} else {
+				_mm_store_si128( (__m128i*)colors[0][k], _mm_cvttps_epi32( _mm_mul_ps( color, byteScale ) ) );
+			}
+		}
+
+		ALIGN16( float st[4][4] );
+		_mm_store_ps( st[0], s0 );
+		_mm_store_ps( st[1], s1 );
+		_mm_store_ps( st[2], _mm_add_ps( s0, width ) );
+		_mm_store_ps( st[3], _mm_add_ps( s1, width ) );
+
+		int lanes = idMath::Imin( batch.num - i, 4 );
+		for ( int j = 0; j < lanes; j++ ) {
+			for ( int q = 0; q < ( animated ? 2 : 1 ); q++ ) {
+				for ( int v = 0; v < 4; v++ ) {
+					emitter->xyz.Set( xyz[v][0][j], xyz[v][1][j], xyz[v][2][j] );
+					emitter->st.Set( st[2 * q + ( v & 1 )][j], float( v >> 1 ) );
+					emitter->color[0] = colors[q][0][j];
+					emitter->color[1] = colors[q][1][j];
+					emitter->color[2] = colors[q][2][j];
+					emitter->color[3] = colors[q][3][j];
+					emitter++;
+				}
+			}
+		}
+	}
+}
+
+#endif
+
+void idParticle_CreateParticles(
+	const idPartStageData &stg, const idPartSysData &psys,
+	const idParticleData *parts, int count, idDrawVert* &emitter
+) {
+#ifdef __SSE2__
+	if ( r_useParticleBatch.GetBool() && stg.orientation != POR_AIMED ) {
+		idParticleBatch batch;
+		for ( int beg = 0; beg < count; beg += PARTICLE_BATCH ) {
+			idParticle_PrepareBatch( stg, psys, parts + beg, idMath::Imin( count - beg, PARTICLE_BATCH ), batch );
+			idParticle_EmitBatch( stg, psys, batch, emitter );
+		}
+		return;
+	}
+#endif
+	for ( int i = 0; i < count; i++ ) {
+		idParticle_CreateParticle( stg, psys, parts[i], emitter );
+	}
+}
+
+
+#include "../tests/testing.h"
+
+TEST_CASE("ParticleSystem:BatchMatchesSingle") {
+	idRandom rnd( 1337 );
+	bool oldBatch = r_useParticleBatch.GetBool();
+
+	for ( int attempt = 0; attempt < 200; attempt++ ) {
+		CAPTURE( attempt );
+
+		// random stage without tables
+		idPartStageData stg;
+		memset( &stg, 0, sizeof( stg ) );
+		stg.totalParticles = 1 + rnd.RandomInt( 300 );
+		stg.particleLife = 0.5f + 3.0f * rnd.RandomFloat();
+		stg.cycleMsec = 1000;
+		stg.spawnBunching = rnd.RandomFloat();
+		stg.distributionType = prtDistribution_t( rnd.RandomInt( 3 ) );
+		for ( int k = 0; k < 3; k++ ) {
+			stg.distributionParms[k] = 20.0f * rnd.RandomFloat();
+		}
+		stg.distributionParms[3] = ( rnd.RandomInt( 2 ) ? rnd.RandomFloat() : 0.0f );
+		stg.directionType = prtDirection_t( rnd.RandomInt( 2 ) );
+		stg.directionParms[0] = ( rnd.RandomInt( 2 ) ? 90.0f * rnd.RandomFloat() : 0.0f );
+		stg.speed.from = 10.0f * rnd.CRandomFloat();
+		stg.speed.to = 10.0f * rnd.CRandomFloat();
+		stg.gravity = 5.0f * rnd.CRandomFloat();
+		stg.worldGravity = rnd.RandomInt( 2 ) != 0;
+		stg.randomDistribution = rnd.RandomInt( 2 ) != 0;
+		stg.entityColor = rnd.RandomInt( 2 ) != 0;
+		stg.customPathType = ( rnd.RandomInt( 3 ) == 0 ? prtCustomPth_t( 1 + rnd.RandomInt( 4 ) ) : PPATH_STANDARD );
+		for ( int k = 0; k < 5; k++ ) {
+			stg.customPathParms[k] = 10.0f * rnd.RandomFloat();
+		}
+		stg.offset = idVec3( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() );
+		stg.animationFrames = ( rnd.RandomInt( 3 ) == 0 ? 1 + rnd.RandomInt( 8 ) : 0 );
+		stg.animationRate = ( rnd.RandomInt( 2 ) ? 10.0f * rnd.RandomFloat() : 0.0f );
+		stg.initialAngle = ( rnd.RandomInt( 2 ) ? 360.0f * rnd.RandomFloat() : 0.0f );
+		stg.rotationSpeed.from = 500.0f * rnd.CRandomFloat();
+		stg.rotationSpeed.to = 500.0f * rnd.CRandomFloat();
+		static const prtOrientation_t ORIENTATIONS[4] = { POR_VIEW, POR_X, POR_Y, POR_Z };
+		stg.orientation = ORIENTATIONS[rnd.RandomInt( 4 )];
+		stg.size.from = 10.0f * rnd.RandomFloat();
+		stg.size.to = 10.0f * rnd.RandomFloat();
+		stg.aspect.from = 0.5f + rnd.RandomFloat();
+		stg.aspect.to = 0.5f + rnd.RandomFloat();
+		stg.color = idVec4( rnd.RandomFloat(), rnd.RandomFloat(), rnd.RandomFloat(), rnd.RandomFloat() );
+		stg.fadeColor = ( rnd.RandomInt( 2 ) ? idVec4( 0, 0, 0, 0 ) : idVec4( 1, 1, 1, 0 ) );
+		stg.fadeInFraction = ( rnd.RandomInt( 2 ) ? 0.5f * rnd.RandomFloat() : 0.0f );
+		stg.fadeOutFraction = ( rnd.RandomInt( 2 ) ? 0.5f * rnd.RandomFloat() : 0.0f );
+		stg.fadeIndexFraction = ( rnd.RandomInt( 2 ) ? rnd.RandomFloat() : 0.0f );
+
+		idPartSysData psys;
+		psys.entityAxis = idAngles( 360.0f * rnd.RandomFloat(), 360.0f * rnd.RandomFloat(), 0.0f ).ToMat3();
+		psys.viewAxis = idAngles( 360.0f * rnd.RandomFloat(), 360.0f * rnd.RandomFloat(), 90.0f * rnd.RandomFloat() ).ToMat3();
+		psys.entityParmsColor = idVec4( rnd.RandomFloat(), rnd.RandomFloat(), rnd.RandomFloat(), 1.0f );
+		psys.totalParticles = stg.totalParticles;
+
+		idPartSysEmit psEmit;
+		psEmit.viewTimeMs = rnd.RandomInt( 100000 );
+		psEmit.entityParmsTimeOffset = 0.0f;
+		psEmit.entityParmsStopTime = 0.0f;
+		psEmit.totalParticles = stg.totalParticles;
+		psEmit.randomizer = rnd.RandomFloat();
+
+		idList<idParticleData> parts;
+		for ( int index = 0; index < stg.totalParticles; index++ ) {
+			idParticleData part;
+			int cycIdx;
+			if ( idParticle_EmitParticle( stg, psEmit, index, part, cycIdx ) ) {
+				parts.Append( part );
+			}
+		}
+
+		int maxVerts = parts.Num() * 4 * ( stg.animationFrames > 1 ? 2 : 1 );
+		idList<idDrawVert> single, batch;
+		single.SetNum( maxVerts );
+		batch.SetNum( maxVerts );
+		memset( single.Ptr(), 0, maxVerts * sizeof( idDrawVert ) );
+		memset( batch.Ptr(), 0, maxVerts * sizeof( idDrawVert ) );
+
+		r_useParticleBatch.SetBool( false );
+		idDrawVert *singleEnd = single.Ptr();
+		idParticle_CreateParticles( stg, psys, parts.Ptr(), parts.Num(), singleEnd );
+		r_useParticleBatch.SetBool( true );
+		idDrawVert *batchEnd = batch.Ptr();
+		idParticle_CreateParticles( stg, psys, parts.Ptr(), parts.Num(), batchEnd );
+
+		int numVerts = singleEnd - single.Ptr();
+		REQUIRE( batchEnd - batch.Ptr() == numVerts );
+		for ( int v = 0; v < numVerts; v++ ) {
+			CAPTURE( v );
+			CHECK( single[v].xyz.Compare( batch[v].xyz, 1e-4f ) );
+			CHECK( single[v].st == batch[v].st );
+			CHECK( memcmp( single[v].color, batch[v].color, 4 ) == 0 );
+		}
+	}
+
+	r_useParticleBatch.SetBool( oldBatch );
+}
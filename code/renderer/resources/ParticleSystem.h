@@ -77,7 +77,7 @@ int idParticle_GetParticleCountOnSurface(const idPartStageData &stg, const srfTr
 void idParticle_EmitLocationOnSurface(
 	const idPartStageData &stg, const srfTriangles_t *tri,
 	idParticleData &part, idVec2 &texCoord,
-	float *areas = NULL
+	const float *areas = NULL
 );
 
 //identifies particle system (particle deform and particle model)
@@ -123,3 +123,13 @@ void idParticle_PrepareCutoffMap(
 float idParticle_FetchCutoffTimeTexture(const idImageAsset *image, const idPartSysCutoffTextureInfo &texinfo, idVec2 texcoord);
 //fetches cutoffTime from the image (with "mapLayout linear") using index of particle and its current cycle
 float idParticle_FetchCutoffTimeLinear(const idImageAsset *image, int totalParticles, int index, int cycIdx);
+
+//---------------------------------------------------------------------------
+
+//generates quads for many particles at once, same as calling idParticle_CreateParticle for each of them in order
+//particles are evaluated in structure-of-arrays batches with SIMD, except for the random-driven origin and initial angle
+//aimed particles (trails) are always created one-by-one
+void idParticle_CreateParticles(
+	const idPartStageData &stg, const idPartSysData &psys,
+	const idParticleData *parts, int count, idDrawVert* &emitter
+);
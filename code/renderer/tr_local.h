@@ -715,6 +715,17 @@ const idMaterial *R_RemapShaderBySkin( const idMaterial *shader, const idDeclSki
 //====================================================
 
 
+// stages of R_RenderView timed in performanceCounters_t
+typedef enum {
+	FES_SETUP_VIEW,				// view matrix, frustum and projection
+	FES_FIND_VIEW_LIGHTS_AND_ENTITIES,	// portal flood and culling of entities and lights
+	FES_ADD_LIGHT_SURFACES,		// interactions, light tris and shadow volumes
+	FES_ADD_MODEL_SURFACES,		// dynamic models, deforms and draw surfaces
+	FES_FINISH_LIGHTS,			// removing unused view lights, shadow map pages
+	FES_SORT_DRAW_SURFS,
+	FES_COUNT
+} frontEndStage_t;
+
 /*
 ** performanceCounters_t
 */
@@ -722,6 +733,8 @@ typedef struct {
 	int		c_sphere_cull_in, c_sphere_cull_clip, c_sphere_cull_out;
 	int		c_box_cull_in, c_box_cull_out;
 	int		c_createInteractions;	// number of calls to idInteraction::CreateInteraction
+	int		c_interactionRebuilds;	// static interactions whose geometry was generated
+	int		c_interactionCacheHits;	// static interactions whose geometry was taken from idInteractionGeometryCache
 	int		c_createLightTris;
 	int		c_createShadowVolumes;
 	int		c_generateMd5;
@@ -737,10 +750,34 @@ typedef struct {
 	int		c_tangentIndexes;		// R_DeriveTangents()
 	int		c_entityUpdates, c_lightUpdates, c_entityReferences, c_lightReferences;
 	int		c_guiSurfs, c_noshadowSurfs;
+	int		c_viewFloods;			// views which flooded through portals
+	int		c_viewFloodCacheHits;	// view floods replayed from the cache of the render world
+	int		c_viewFloodAreas;		// areas entered by view floods, including replayed ones
+	int		c_guiIndexes;			// gui geometry drawn by windows this frame
+	int		c_guiCachedIndexes;		// gui geometry reused from unchanged windows
+	int		c_drawSurfs;			// draw surfaces added to all views
 	int		frontEndMsec;			// sum of time in all RE_RenderScene's in a frame
 	int		frontEndMsecLast;		// time in last RE_RenderScene
+	uint64_t	frontEndStageUsec[FES_COUNT];	// time in each stage of R_RenderView, summed over all views
 } performanceCounters_t;
 
+// frontend statistics of one frame, recorded by the benchmarkDemo command
+typedef struct {
+	int			frontEndMsec;
+	uint64_t	stageUsec[FES_COUNT];
+	int			numViews;
+	int			numDrawSurfs;
+	int			viewEntities;
+	int			viewLights;
+	int			createInteractions;
+	int			createLightTris;
+	int			createShadowVolumes;
+	int			deformedSurfaces;
+	int			staticAllocs;
+	int			staticFrees;
+	int			frameMemory;			// bytes of frame memory used by the frontend
+} frontEndBenchmarkFrame_t;
+
 
 typedef struct {
 	int		current2DMap;
@@ -877,6 +914,11 @@ public:
 	void					Clear( void );
 	void					RenderViewToViewport( const renderView_t &renderView, idScreenRect &viewport );
 
+	// frontend statistics are recorded every frame between these calls
+	void					BeginFrontEndBenchmark( void );
+	bool					EndFrontEndBenchmark( const char *demoName, const char *fileName );
+	void					RecordFrontEndBenchmarkFrame( void );
+
 public:
 	// renderer globals
 	bool					takingScreenshot;
@@ -931,6 +973,11 @@ public:
 
 	unsigned short			gammaTable[256];	// brightness / gamma modify this
 	idParallelJobList*		frontEndJobList;
+
+	bool					headless;		// r_headless: frontend only, no GL context
+
+	bool					frontEndBenchmark;
+	idList<frontEndBenchmarkFrame_t> frontEndBenchmarkFrames;
 };
 
 extern backEndState_t		backEnd;
@@ -981,6 +1028,7 @@ extern idCVar r_useCulling;				// 0 = none, 1 = sphere, 2 = sphere + box
 extern idCVar r_useLightPortalCulling;	// 0 = none, 1 = box, 2 = exact clip of polyhedron faces
 extern idCVar r_useEntityPortalCulling;	// 0 = none, 1 = box
 extern idCVar r_useLightScissors;		// 1 = use custom scissor rectangle for each light
+extern idCVar r_useParallelAddLights;	// 1 = prepare view lights on frontend jobs
 extern idCVar r_useClippedLightScissors;// 0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always
 extern idCVar r_useEntityCulling;		// 0 = none, 1 = box
 extern idCVar r_useEntityScissors;		// 1 = use custom scissor rectangle for each entity
@@ -991,6 +1039,8 @@ extern idCVar r_useShadowCulling;		// try to cull shadows from partially visible
 extern idCVar r_usePreciseTriangleInteractions;	// 1 = do winding clipping to determine if each ambiguous tri should be lit
 extern idCVar r_useTurboShadow;			// 1 = use the infinite projection with W technique for dynamic shadows
 extern idCVar r_useInteractionTable;
+extern idCVar r_useInteractionCache;	// 1 = keep geometry of freed static interactions for reuse
+extern idCVar r_interactionCacheSize;	// memory budget of the interaction geometry cache in MB
 extern idCVar r_useExternalShadows;		// 1 = skip drawing caps when outside the light volume
 extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow volumes
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
@@ -1011,6 +1061,7 @@ extern idCVar r_skipInteractions;		// skip all light/surface interaction drawing
 extern idCVar r_skipEntities;			// skip non-world geometry
 extern idCVar r_skipFrontEnd;			// bypasses all front end work, but 2D gui rendering still draws
 extern idCVar r_skipBackEnd;			// don't draw anything
+extern idCVar r_headless;				// no GL context, only the frontend runs
 extern idCVar r_skipCopyTexture;		// do all rendering, but don't actually copyTexSubImage2D
 extern idCVar r_skipRender;				// skip 3D rendering, but pass 2D
 extern idCVar r_skipRenderContext;		// NULL the rendering context during backend 3D rendering
@@ -1421,7 +1472,7 @@ void R_ModulateLights_f( const idCmdArgs &args );
 void R_SetLightProject( idPlane lightProject[4], const idVec3 origin, const idVec3 targetPoint,
 						const idVec3 rightVector, const idVec3 upVector, const idVec3 start, const idVec3 stop );
 
-void R_AddLightSurfaces( void );
+void R_AddLightSurfaces( bool useJobs );
 void R_AddModelSurfaces( void );
 void R_RemoveUnecessaryViewLights( void );
 
@@ -1439,7 +1490,7 @@ void R_FreeLightDefDerivedData( idRenderLightLocal *light );
 void R_CheckForEntityDefsUsingModel( idRenderModel *model );
 
 void R_ClearEntityDefDynamicModel( idRenderEntityLocal *def );
-void R_FreeEntityDefDerivedData( idRenderEntityLocal *def, bool keepDecals, bool keepCachedDynamicModel );
+void R_FreeEntityDefDerivedData( idRenderEntityLocal *def, bool keepDecals, bool keepCachedDynamicModel, bool cacheInteractions );
 void R_FreeEntityDefDecals( idRenderEntityLocal *def );
 void R_FreeEntityDefOverlay( idRenderEntityLocal *def );
 void R_FreeEntityDefFadedDecals( idRenderEntityLocal *def, int time );
@@ -1790,6 +1841,7 @@ TR_DEFORM
 */
 
 void R_DeformDrawSurf( drawSurf_t *drawSurf );
+void R_FreeDeformTopology( const srfTriangles_t *tri );
 
 /*
 =============================================================
@@ -30,6 +30,8 @@ frameData_t 	*frameData;
 frameData_t		*backendFrameData;
 unsigned int	smpFrame;
 
+idCVarBool r_checkParallelAddLights( "r_checkParallelAddLights", "0", CVAR_RENDERER, "build lights and surfaces of every main view both serially and with light jobs, and warn if they differ" );
+
 /*
 ======================
 idScreenRect::Clear
@@ -1141,8 +1143,166 @@ static void R_SortDrawSurfs( void ) {
 	std::sort( tr.viewDef->drawSurfs, tr.viewDef->drawSurfs + tr.viewDef->numDrawSurfs, R_StdSortSurfaces );
 }
 
+/*
+=================
+R_EndFrontEndStage
+
+Adds the time since "start" to the given stage and returns the current time.
+=================
+*/
+static uint64_t R_EndFrontEndStage( frontEndStage_t stage, uint64_t start ) {
+	uint64_t now = Sys_GetTimeMicroseconds();
+	tr.pc.frontEndStageUsec[stage] += now - start;
+	return now;
+}
+
 //========================================================================
 
+/*
+================
+R_CheckParallelAddLights
+
+Builds the view lights and the draw surfaces of the view twice: with lights prepared serially
+and on jobs, and compares the results. Surfaces are compared as sets, since model jobs
+may add surfaces with equal sort keys in any order.
+================
+*/
+typedef struct {
+	int						list;		// -2 for the light itself, -1 for view surfaces, otherwise chain of the light
+	int						light;		// index of the lightDef, -1 for view surfaces
+	int						entity;		// index of the entityDef, -1 if none
+	const idMaterial *		material;
+	float					sort;
+	int						numIndexes;
+	int						numVerts;
+	int						flags;		// dsFlags of surfaces, shadow mode of lights
+	int						scissor[4];
+} checkedSurf_t;
+
+static int c_checkedViews = 0;
+static int c_checkedViewsDiffer = 0;
+
+static void R_AddCheckedChain( idList<checkedSurf_t> &list, int chain, int light, const drawSurf_t *surf ) {
+	for ( ; surf; surf = surf->nextOnLight ) {
+		checkedSurf_t cs;
+		cs.list = chain;
+		cs.light = light;
+		cs.entity = ( surf->space && surf->space->entityDef ? surf->space->entityDef->index : -1 );
+		cs.material = surf->material;
+		cs.sort = surf->sort;
+		cs.numIndexes = surf->numIndexes;
+		cs.numVerts = surf->numVerts;
+		cs.flags = surf->dsFlags;
+		cs.scissor[0] = surf->scissorRect.x1;
+		cs.scissor[1] = surf->scissorRect.y1;
+		cs.scissor[2] = surf->scissorRect.x2;
+		cs.scissor[3] = surf->scissorRect.y2;
+		list.Append( cs );
+	}
+}
+
+static bool R_CheckedSurfLess( const checkedSurf_t &a, const checkedSurf_t &b ) {
+	if ( a.list != b.list ) return a.list < b.list;
+	if ( a.light != b.light ) return a.light < b.light;
+	if ( a.entity != b.entity ) return a.entity < b.entity;
+	if ( a.material != b.material ) return a.material < b.material;
+	if ( a.sort != b.sort ) return a.sort < b.sort;
+	if ( a.numIndexes != b.numIndexes ) return a.numIndexes < b.numIndexes;
+	if ( a.numVerts != b.numVerts ) return a.numVerts < b.numVerts;
+	if ( a.flags != b.flags ) return a.flags < b.flags;
+	for ( int i = 0; i < 4; i++ ) {
+		if ( a.scissor[i] != b.scissor[i] ) return a.scissor[i] < b.scissor[i];
+	}
+	return false;
+}
+
+static void R_BuildCheckedView( const viewDef_t &parms, bool lightJobs, idList<checkedSurf_t> &list ) {
+	viewDef_t *view = (viewDef_t *)R_FrameAlloc( sizeof( *view ) );
+	*view = parms;
+
+	viewDef_t *oldView = tr.viewDef;
+	tr.viewCount++;
+	view->renderWorld->entityDefsInView.SetBitsSameAll( false );
+	tr.viewDef = view;
+	tr.sortOffset = 0;
+
+	// same stages as R_RenderView, up to sorting
+	R_SetViewMatrix( *view );
+	R_SetupViewFrustum();
+	R_SetupProjection();
+	view->renderWorld->FindViewLightsAndEntities();
+	R_ConstrainViewFrustum();
+	R_AddLightSurfaces( lightJobs );
+	R_AddModelSurfaces();
+	R_RemoveUnecessaryViewLights();
+	R_SortDrawSurfs();
+
+	list.SetNum( 0, false );
+	for ( const viewLight_t *vLight = view->viewLights; vLight; vLight = vLight->next ) {
+		const int light = vLight->lightDef->index;
+		checkedSurf_t cs;
+		memset( &cs, 0, sizeof( cs ) );
+		cs.list = -2;
+		cs.light = light;
+		cs.entity = -1;
+		cs.material = vLight->lightShader;
+		cs.flags = vLight->shadows;
+		cs.scissor[0] = vLight->scissorRect.x1;
+		cs.scissor[1] = vLight->scissorRect.y1;
+		cs.scissor[2] = vLight->scissorRect.x2;
+		cs.scissor[3] = vLight->scissorRect.y2;
+		list.Append( cs );
+		R_AddCheckedChain( list, 0, light, vLight->globalShadows );
+		R_AddCheckedChain( list, 1, light, vLight->localInteractions );
+		R_AddCheckedChain( list, 2, light, vLight->localShadows );
+		R_AddCheckedChain( list, 3, light, vLight->globalInteractions );
+		R_AddCheckedChain( list, 4, light, vLight->translucentInteractions );
+	}
+	for ( int i = 0; i < view->numDrawSurfs; i++ ) {
+		const drawSurf_t *surf = view->drawSurfs[i];
+		checkedSurf_t cs;
+		cs.list = -1;
+		cs.light = -1;
+		cs.entity = ( surf->space && surf->space->entityDef ? surf->space->entityDef->index : -1 );
+		cs.material = surf->material;
+		cs.sort = surf->sort;
+		cs.numIndexes = surf->numIndexes;
+		cs.numVerts = surf->numVerts;
+		cs.flags = surf->dsFlags;
+		cs.scissor[0] = surf->scissorRect.x1;
+		cs.scissor[1] = surf->scissorRect.y1;
+		cs.scissor[2] = surf->scissorRect.x2;
+		cs.scissor[3] = surf->scissorRect.y2;
+		list.Append( cs );
+	}
+	std::sort( list.Ptr(), list.Ptr() + list.Num(), R_CheckedSurfLess );
+
+	tr.viewDef = oldView;
+}
+
+static void R_CheckParallelAddLights( const viewDef_t &parms ) {
+	TRACE_CPU_SCOPE( "R_CheckParallelAddLights" )
+
+	idList<checkedSurf_t> serial, parallel;
+	R_BuildCheckedView( parms, false, serial );
+	R_BuildCheckedView( parms, true, parallel );
+
+	int firstDiff = -1;
+	for ( int i = 0; i < Max( serial.Num(), parallel.Num() ); i++ ) {
+		if ( i >= serial.Num() || i >= parallel.Num() || R_CheckedSurfLess( serial[i], parallel[i] ) || R_CheckedSurfLess( parallel[i], serial[i] ) ) {
+			firstDiff = i;
+			break;
+		}
+	}
+
+	c_checkedViews++;
+	if ( firstDiff >= 0 ) {
+		c_checkedViewsDiffer++;
+		common->Warning( "R_CheckParallelAddLights: %d serial and %d parallel lights and surfaces, first difference at %d",
+			serial.Num(), parallel.Num(), firstDiff );
+	}
+}
+
 /*
 ================
 R_RenderView
@@ -1161,6 +1321,9 @@ void R_RenderView( viewDef_t &parms ) {
 	if ( parms.renderView.width <= 0 || parms.renderView.height <= 0 ) {
 		return;
 	}
+	if ( r_checkParallelAddLights && !parms.isSubview ) {
+		R_CheckParallelAddLights( parms );
+	}
 	tr.viewCount++;
 	parms.renderWorld->entityDefsInView.SetBitsSameAll(false);
 
@@ -1171,6 +1334,9 @@ void R_RenderView( viewDef_t &parms ) {
 
 	tr.sortOffset = 0;
 
+	// subviews are rendered after the stages of this view, so they are not counted twice
+	uint64_t stageStart = Sys_GetTimeMicroseconds();
+
 	// set the matrix for world space to eye space
 	R_SetViewMatrix( *tr.viewDef );
 
@@ -1181,6 +1347,7 @@ void R_RenderView( viewDef_t &parms ) {
 	// we need to set the projection matrix before doing
 	// portal-to-screen scissor box calculations
 	R_SetupProjection();
+	stageStart = R_EndFrontEndStage( FES_SETUP_VIEW, stageStart );
 
 	// identify all the visible portalAreas, and the entityDefs and
 	// lightDefs that are in them and pass culling.
@@ -1188,24 +1355,29 @@ void R_RenderView( viewDef_t &parms ) {
 
 	// constrain the view frustum to the view lights and entities
 	R_ConstrainViewFrustum();
+	stageStart = R_EndFrontEndStage( FES_FIND_VIEW_LIGHTS_AND_ENTITIES, stageStart );
 
 	// make sure that interactions exist for all light / entity combinations
 	// that are visible
 	// add any pre-generated light shadows, and calculate the light shader values
-	R_AddLightSurfaces();
+	R_AddLightSurfaces( r_useParallelAddLights.GetBool() );
+	stageStart = R_EndFrontEndStage( FES_ADD_LIGHT_SURFACES, stageStart );
 
 	// adds ambient surfaces and create any necessary interaction surfaces to add to the light
 	// lists
 	R_AddModelSurfaces();
+	stageStart = R_EndFrontEndStage( FES_ADD_MODEL_SURFACES, stageStart );
 
 	// any viewLight that didn't have visible surfaces can have it's shadows removed
 	R_RemoveUnecessaryViewLights();
 
 	// assign pages of shadow map buffer to lights that use shadow maps
 	R_AssignShadowMapAtlasPages();
+	stageStart = R_EndFrontEndStage( FES_FINISH_LIGHTS, stageStart );
 
 	// sort all the ambient surfaces for translucency ordering
 	R_SortDrawSurfs();
+	R_EndFrontEndStage( FES_SORT_DRAW_SURFS, stageStart );
 
 	R_Tools();
 
@@ -1237,3 +1409,29 @@ void R_RenderView( viewDef_t &parms ) {
 	// restore view in case we are a subview
 	tr.viewDef = oldView;
 }
+
+
+#include "../tests/testing.h"
+
+TEST_CASE("ParallelAddLights:SameDrawSurfs") {
+	if ( !tr.primaryWorld || !tr.primaryWorld->mapName.Length() ) {
+		MESSAGE( "no map loaded, skipping" );
+		return;
+	}
+	session->WaitForFrontendCompletion();
+
+	const int oldChecks = c_checkedViews;
+	const int oldDiffers = c_checkedViewsDiffer;
+	const bool oldCheck = r_checkParallelAddLights;
+	r_checkParallelAddLights.SetBool( true );
+
+	renderSystem->BeginFrame( renderSystem->GetScreenWidth(), renderSystem->GetScreenHeight() );
+	tr.primaryWorld->RenderScene( tr.primaryRenderView );
+	renderSystem->EndFrame( NULL, NULL );
+	session->WaitForFrontendCompletion();
+
+	r_checkParallelAddLights.SetBool( oldCheck );
+
+	CHECK( c_checkedViews > oldChecks );
+	CHECK( c_checkedViewsDiffer == oldDiffers );
+}
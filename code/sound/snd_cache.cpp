@@ -204,6 +204,7 @@ idSoundCache::idSoundCache() {
 	cacheHash.ClearFree( 1024, 1024 );
 	cacheHash.SetGranularity( 256 );
 	insideLevelLoad = false;
+	deferLoads = false;
 }
 
 /*
@@ -255,7 +256,11 @@ idSoundSample *idSoundCache::FindSound( const idStr& filename, bool loadOnDemand
 		if ( def->name == fname ) {
 			def->levelLoadReferenced = true;
 			if ( def->purged && !loadOnDemandOnly ) {
-				def->Load();
+				if ( deferLoads ) {
+					deferredLoads.AddUnique( def );
+				} else {
+					def->Load();
+				}
 			}
 			return def;
 		}
@@ -283,7 +288,11 @@ idSoundSample *idSoundCache::FindSound( const idStr& filename, bool loadOnDemand
 
 	if ( !loadOnDemandOnly ) {
 		// this may make it a default sound if it can't be loaded
-		def->Load();
+		if ( deferLoads ) {
+			deferredLoads.Append( def );
+		} else {
+			def->Load();
+		}
 	}
 
 	return def;
@@ -388,6 +397,53 @@ void idSoundCache::EndLevelLoad() {
 	common->Printf( "----------------------------------------\n" );
 }
 
+/*
+===================
+idSoundCache::BeginDeferredLoads
+===================
+*/
+void idSoundCache::BeginDeferredLoads() {
+	deferLoads = true;
+}
+
+/*
+===================
+idSoundCache::LoadDeferredSounds
+===================
+*/
+void idSoundCache::LoadDeferredSounds() {
+	deferLoads = false;
+	if ( deferredLoads.Num() == 0 ) {
+		return;
+	}
+
+	// read all files on I/O threads, idWaveFile::Open gets them from memory
+	idFileReadBatch prefetch;
+	if ( deferredLoads.Num() > 1 ) {
+		for ( int i = 0; i < deferredLoads.Num(); i++ ) {
+			const idStr &name = deferredLoads[i]->name;
+			if ( name.IcmpPrefix( "fromVideo " ) == 0 ) {
+				continue;
+			}
+			// same order as in idWaveFile::Open
+			idStr oggName = name;
+			oggName.SetFileExtension( ".ogg" );
+			prefetch.Add( oggName );
+			if ( oggName.Icmp( name ) != 0 ) {
+				prefetch.Add( name );
+			}
+		}
+		prefetch.Submit();
+	}
+
+	for ( int i = 0; i < deferredLoads.Num(); i++ ) {
+		if ( deferredLoads[i]->purged ) {
+			deferredLoads[i]->Load();
+		}
+	}
+	deferredLoads.Clear();
+}
+
 /*
 ===================
 idSoundCache::PrintMemInfo
@@ -443,6 +499,13 @@ void idSoundCache::PrintMemInfo( MemInfo_t *mi ) {
 	mi->soundAssetsTotal = total;
 
 	f->Printf( "\nTotal sound bytes allocated: %s\n", idStr::FormatNumber( total ).c_str() );
+
+	decodedBlockStats_t stats;
+	idSampleDecoder::GetDecodedBlockStats( stats );
+	int reads = stats.hits + stats.misses;
+	f->Printf( "Decoded OGG blocks: %d using %s bytes, %d queued\n", stats.numBlocks, idStr::FormatNumber( stats.memory ).c_str(), stats.queued );
+	f->Printf( "Decoded OGG block reads: %d hits, %d misses (%.1f%% hit rate), %d decoded ahead\n",
+		stats.hits, stats.misses, reads > 0 ? 100.0f * stats.hits / reads : 0.0f, stats.prefetched );
 	fileSystem->CloseFile( f );
 	delete[] sortIndex;
 }
@@ -803,6 +866,9 @@ idSoundSample::PurgeSoundSample
 void idSoundSample::PurgeSoundSample() {
 	purged = true;
 
+	// decoder thread may still be reading nonCacheData
+	idSampleDecoder::ForgetSample( this );
+
 	alGetError();
 	alDeleteBuffers(1, &openalBuffer);
 	if (alGetError() != AL_NO_ERROR) {
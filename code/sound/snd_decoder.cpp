@@ -264,8 +264,11 @@ public:
 	virtual int				GetLastDecodeTime( void ) const override;
 
 	void					Clear( void );
+	void					ClearDecoderUnlocked( void );
 	int						DecodePCM( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
 	int						DecodeOGG( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
+	int						DecodeOGGBlocks( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
+	bool					HasFailed( void ) const { return failed; }
 	int						DecodeCinematics( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest );
 
 private:
@@ -282,6 +285,441 @@ private:
 
 idBlockAlloc<idSampleDecoderLocal, 64>		sampleDecoderAllocator;
 
+
+/*
+===================================================================================
+
+  Decoded block cache.
+
+  Streamed OGG samples are decoded in blocks of DECODED_BLOCK_SAMPLES44K samples,
+  which are kept in an LRU cache bounded by s_decodeCacheSize. Whenever a channel
+  reads from a block, the next s_decodeAheadBlocks blocks of the same sample are
+  queued to the decoder thread, so a streaming channel normally finds its data
+  already decoded and the mixer only runs Vorbis when it starts a new sample.
+
+===================================================================================
+*/
+
+const int DECODED_BLOCK_SAMPLES44K			= MIXBUFFER_SAMPLES * 8;
+
+typedef struct decodedBlock_s {
+	idSoundSample *				sample;			// NULL if the slot is free
+	int							block;			// index of block within sample
+	int							numSamples44k;	// less than block size for the last block of sample
+	float *						data;
+	idLinkList<decodedBlock_s>	lruNode;		// most recently used first, free slots last
+} decodedBlock_t;
+
+typedef struct decodeRequest_s {
+	idSoundSample *				sample;
+	int							block;
+} decodeRequest_t;
+
+class idDecoderThread : public idSysThread {
+protected:
+	virtual int					Run( void ) override;
+};
+
+class idDecodedBlockCache {
+public:
+								idDecodedBlockCache( void );
+
+	void						Init( void );
+	void						Shutdown( void );
+	bool						IsEnabled( void ) const;
+
+								// copies from cached block, returns number of samples copied or -1 if block is not cached
+	int							Read( idSoundSample *sample, int block, int offsetInBlock44k, int count44k, float *dest );
+	void						Store( idSoundSample *sample, int block, const float *data, int numSamples44k );
+	void						QueueAhead( idSoundSample *sample, int lastBlock );
+	void						Forget( idSoundSample *sample );
+	void						GetStats( decodedBlockStats_t &stats );
+
+	void						ProcessRequests( void );	// called on decoder thread
+
+private:
+	bool						initialized;
+	idDecoderThread *			thread;
+
+	idSysMutex					cacheMutex;
+	idList<decodedBlock_t *>	blocks;
+	idHashIndex					blockHash;
+	idLinkList<decodedBlock_t>	lru;
+	int							memory;
+	int							hits;
+	int							misses;
+	int							prefetched;
+
+	idSysMutex					queueMutex;
+	idList<decodeRequest_t>		queue;
+
+	idSysMutex					decodeMutex;	// held by decoder thread while it uses workerDecoder
+	idSampleDecoderLocal		workerDecoder;
+	float *						workerBuffer;
+
+	static int					BlockKey( const idSoundSample *sample, int block );
+	int							FindBlock( const idSoundSample *sample, int block ) const;
+	void						FreeBlock( int index );
+};
+
+static idDecodedBlockCache	decodedBlocks;
+ALIGN16( static float decodeMissBuffer[DECODED_BLOCK_SAMPLES44K] );	// protected by CRITICAL_SECTION_ONE
+
+/*
+====================
+idDecoderThread::Run
+====================
+*/
+int idDecoderThread::Run( void ) {
+	decodedBlocks.ProcessRequests();
+	return 0;
+}
+
+/*
+====================
+idDecodedBlockCache::idDecodedBlockCache
+====================
+*/
+idDecodedBlockCache::idDecodedBlockCache( void ) {
+	initialized = false;
+	thread = NULL;
+	memory = 0;
+	hits = 0;
+	misses = 0;
+	prefetched = 0;
+	workerBuffer = NULL;
+}
+
+/*
+====================
+idDecodedBlockCache::Init
+====================
+*/
+void idDecodedBlockCache::Init( void ) {
+	if ( initialized ) {
+		return;
+	}
+	workerDecoder.Clear();
+	workerBuffer = (float *)Mem_Alloc16( DECODED_BLOCK_SAMPLES44K * sizeof( float ) );
+	memory = 0;
+	hits = misses = prefetched = 0;
+
+	thread = new idDecoderThread();
+	thread->StartWorkerThread( "SoundDecoder", CORE_ANY );
+	initialized = true;
+}
+
+/*
+====================
+idDecodedBlockCache::Shutdown
+====================
+*/
+void idDecodedBlockCache::Shutdown( void ) {
+	if ( !initialized ) {
+		return;
+	}
+	{
+		idScopedCriticalSection lock( queueMutex );
+		queue.Clear();
+	}
+	thread->StopThread();
+	delete thread;
+	thread = NULL;
+
+	workerDecoder.ClearDecoderUnlocked();
+	Mem_Free16( workerBuffer );
+	workerBuffer = NULL;
+
+	for ( int i = 0; i < blocks.Num(); i++ ) {
+		blocks[i]->lruNode.Remove();
+		Mem_Free16( blocks[i]->data );
+		delete blocks[i];
+	}
+	blocks.Clear();
+	blockHash.Clear();
+	memory = 0;
+	initialized = false;
+}
+
+/*
+====================
+idDecodedBlockCache::IsEnabled
+====================
+*/
+bool idDecodedBlockCache::IsEnabled( void ) const {
+	return initialized && idSoundSystemLocal::s_decodeCacheSize.GetInteger() > 0;
+}
+
+/*
+====================
+idDecodedBlockCache::BlockKey
+====================
+*/
+int idDecodedBlockCache::BlockKey( const idSoundSample *sample, int block ) {
+	return (int)( ( (uintptr_t)sample >> 4 ) * 31 ) + block;
+}
+
+/*
+====================
+idDecodedBlockCache::FindBlock
+
+Must be called with cacheMutex locked.
+====================
+*/
+int idDecodedBlockCache::FindBlock( const idSoundSample *sample, int block ) const {
+	int key = BlockKey( sample, block );
+	for ( int i = blockHash.First( key ); i != -1; i = blockHash.Next( i ) ) {
+		if ( blocks[i]->sample == sample && blocks[i]->block == block ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+====================
+idDecodedBlockCache::FreeBlock
+
+Must be called with cacheMutex locked.
+====================
+*/
+void idDecodedBlockCache::FreeBlock( int index ) {
+	decodedBlock_t *b = blocks[index];
+	if ( b->sample != NULL ) {
+		blockHash.Remove( BlockKey( b->sample, b->block ), index );
+		b->sample = NULL;
+	}
+	b->lruNode.AddToEnd( lru );
+}
+
+/*
+====================
+idDecodedBlockCache::Read
+====================
+*/
+int idDecodedBlockCache::Read( idSoundSample *sample, int block, int offsetInBlock44k, int count44k, float *dest ) {
+	idScopedCriticalSection lock( cacheMutex );
+
+	int index = FindBlock( sample, block );
+	if ( index < 0 ) {
+		misses++;
+		return -1;
+	}
+	hits++;
+
+	decodedBlock_t *b = blocks[index];
+	b->lruNode.AddToFront( lru );
+
+	int num = Min( count44k, b->numSamples44k - offsetInBlock44k );
+	if ( num <= 0 ) {
+		return 0;
+	}
+	memcpy( dest, b->data + offsetInBlock44k, num * sizeof( dest[0] ) );
+	return num;
+}
+
+/*
+====================
+idDecodedBlockCache::Store
+====================
+*/
+void idDecodedBlockCache::Store( idSoundSample *sample, int block, const float *data, int numSamples44k ) {
+	idScopedCriticalSection lock( cacheMutex );
+
+	if ( FindBlock( sample, block ) >= 0 ) {
+		return;
+	}
+
+	const int blockBytes = DECODED_BLOCK_SAMPLES44K * sizeof( float );
+	const int maxBlocks = Max( 1, ( idSoundSystemLocal::s_decodeCacheSize.GetInteger() << 20 ) / blockBytes );
+
+	// drop least recently used blocks if the cache was made smaller
+	if ( blocks.Num() > maxBlocks ) {
+		while ( blocks.Num() > maxBlocks ) {
+			decodedBlock_t *b = lru.Prev();
+			b->lruNode.Remove();
+			blocks.Remove( b );
+			Mem_Free16( b->data );
+			delete b;
+			memory -= blockBytes;
+		}
+		blockHash.Clear();
+		for ( int i = 0; i < blocks.Num(); i++ ) {
+			if ( blocks[i]->sample != NULL ) {
+				blockHash.Add( BlockKey( blocks[i]->sample, blocks[i]->block ), i );
+			}
+		}
+	}
+
+	// take a free slot, allocate a new one or evict the least recently used block
+	int index;
+	decodedBlock_t *tail = lru.Prev();
+	if ( tail != NULL && tail->sample == NULL ) {
+		index = blocks.FindIndex( tail );
+	} else if ( blocks.Num() < maxBlocks ) {
+		decodedBlock_t *b = new decodedBlock_t;
+		b->sample = NULL;
+		b->data = (float *)Mem_Alloc16( blockBytes );
+		b->lruNode.SetOwner( b );
+		index = blocks.Append( b );
+		memory += blockBytes;
+	} else {
+		index = blocks.FindIndex( tail );
+		FreeBlock( index );
+	}
+
+	decodedBlock_t *b = blocks[index];
+	b->sample = sample;
+	b->block = block;
+	b->numSamples44k = numSamples44k;
+	memcpy( b->data, data, numSamples44k * sizeof( data[0] ) );
+	blockHash.Add( BlockKey( sample, block ), index );
+	b->lruNode.AddToFront( lru );
+}
+
+/*
+====================
+idDecodedBlockCache::QueueAhead
+====================
+*/
+void idDecodedBlockCache::QueueAhead( idSoundSample *sample, int lastBlock ) {
+	int numAhead = idSoundSystemLocal::s_decodeAheadBlocks.GetInteger();
+	int numBlocks = ( sample->LengthIn44kHzSamples() + DECODED_BLOCK_SAMPLES44K - 1 ) / DECODED_BLOCK_SAMPLES44K;
+	bool added = false;
+
+	for ( int block = lastBlock + 1; block <= lastBlock + numAhead && block < numBlocks; block++ ) {
+		{
+			idScopedCriticalSection lock( cacheMutex );
+			if ( FindBlock( sample, block ) >= 0 ) {
+				continue;
+			}
+		}
+		idScopedCriticalSection lock( queueMutex );
+		int i;
+		for ( i = 0; i < queue.Num(); i++ ) {
+			if ( queue[i].sample == sample && queue[i].block == block ) {
+				break;
+			}
+		}
+		if ( i == queue.Num() ) {
+			decodeRequest_t &req = queue.Alloc();
+			req.sample = sample;
+			req.block = block;
+			added = true;
+		}
+	}
+
+	if ( added ) {
+		thread->SignalWork();
+	}
+}
+
+/*
+====================
+idDecodedBlockCache::ProcessRequests
+====================
+*/
+void idDecodedBlockCache::ProcessRequests( void ) {
+	TRACE_CPU_SCOPE( "Sound:DecodeAhead" );
+
+	while ( true ) {
+		// sample can't be purged while we hold decodeMutex (see Forget)
+		idScopedCriticalSection lockDecode( decodeMutex );
+
+		decodeRequest_t req;
+		{
+			idScopedCriticalSection lock( queueMutex );
+			if ( queue.Num() == 0 ) {
+				break;
+			}
+			req = queue[0];
+			queue.RemoveIndex( 0 );
+		}
+		{
+			idScopedCriticalSection lock( cacheMutex );
+			if ( FindBlock( req.sample, req.block ) >= 0 ) {
+				continue;
+			}
+		}
+
+		if ( workerDecoder.GetSample() != req.sample || workerDecoder.HasFailed() ) {
+			workerDecoder.ClearDecoderUnlocked();
+		}
+
+		int start44k = req.block * DECODED_BLOCK_SAMPLES44K;
+		int count44k = Min( DECODED_BLOCK_SAMPLES44K, req.sample->LengthIn44kHzSamples() - start44k );
+		int read44k = workerDecoder.DecodeOGG( req.sample, start44k, count44k, workerBuffer );
+		if ( workerDecoder.HasFailed() || read44k <= 0 ) {
+			continue;
+		}
+
+		Store( req.sample, req.block, workerBuffer, read44k );
+
+		idScopedCriticalSection lock( cacheMutex );
+		prefetched++;
+	}
+}
+
+/*
+====================
+idDecodedBlockCache::Forget
+====================
+*/
+void idDecodedBlockCache::Forget( idSoundSample *sample ) {
+	if ( !initialized ) {
+		return;
+	}
+
+	// wait until decoder thread finishes the block it is working on
+	idScopedCriticalSection lockDecode( decodeMutex );
+
+	{
+		idScopedCriticalSection lock( queueMutex );
+		for ( int i = queue.Num() - 1; i >= 0; i-- ) {
+			if ( queue[i].sample == sample ) {
+				queue.RemoveIndex( i );
+			}
+		}
+	}
+
+	if ( workerDecoder.GetSample() == sample ) {
+		workerDecoder.ClearDecoderUnlocked();
+	}
+
+	idScopedCriticalSection lock( cacheMutex );
+	for ( int i = 0; i < blocks.Num(); i++ ) {
+		if ( blocks[i]->sample == sample ) {
+			FreeBlock( i );
+		}
+	}
+}
+
+/*
+====================
+idDecodedBlockCache::GetStats
+====================
+*/
+void idDecodedBlockCache::GetStats( decodedBlockStats_t &stats ) {
+	memset( &stats, 0, sizeof( stats ) );
+	if ( !initialized ) {
+		return;
+	}
+	{
+		idScopedCriticalSection lock( cacheMutex );
+		for ( int i = 0; i < blocks.Num(); i++ ) {
+			if ( blocks[i]->sample != NULL ) {
+				stats.numBlocks++;
+			}
+		}
+		stats.memory = memory;
+		stats.hits = hits;
+		stats.misses = misses;
+		stats.prefetched = prefetched;
+	}
+	idScopedCriticalSection lock( queueMutex );
+	stats.queued = queue.Num();
+}
+
 /*
 ====================
 idSampleDecoder::Init
@@ -295,6 +733,8 @@ void idSampleDecoder::Init( void ) {
 	decoderMemoryAllocator.Init();
 	decoderMemoryAllocator.SetLockMemory( true );
 	decoderMemoryAllocator.SetFixedBlocks( idSoundSystemLocal::s_realTimeDecoding.GetBool() ? 10 : 1 );
+
+	decodedBlocks.Init();
 }
 
 /*
@@ -303,6 +743,7 @@ idSampleDecoder::Shutdown
 ====================
 */
 void idSampleDecoder::Shutdown( void ) {
+	decodedBlocks.Shutdown();
 	decoderMemoryAllocator.Shutdown();
 	sampleDecoderAllocator.Shutdown();
 }
@@ -347,6 +788,24 @@ int idSampleDecoder::GetUsedBlockMemory( void ) {
 	return decoderMemoryAllocator.GetUsedBlockMemory();
 }
 
+/*
+====================
+idSampleDecoder::ForgetSample
+====================
+*/
+void idSampleDecoder::ForgetSample( idSoundSample *sample ) {
+	decodedBlocks.Forget( sample );
+}
+
+/*
+====================
+idSampleDecoder::GetDecodedBlockStats
+====================
+*/
+void idSampleDecoder::GetDecodedBlockStats( decodedBlockStats_t &stats ) {
+	decodedBlocks.GetStats( stats );
+}
+
 /*
 ====================
 idSampleDecoderLocal::Clear
@@ -367,7 +826,16 @@ idSampleDecoderLocal::ClearDecoder
 */
 void idSampleDecoderLocal::ClearDecoder( void ) {
 	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+	ClearDecoderUnlocked();
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+}
 
+/*
+====================
+idSampleDecoderLocal::ClearDecoderUnlocked
+====================
+*/
+void idSampleDecoderLocal::ClearDecoderUnlocked( void ) {
 	switch( lastFormat ) {
 		case WAVE_FORMAT_TAG_PCM: {
 			break;
@@ -381,8 +849,6 @@ void idSampleDecoderLocal::ClearDecoder( void ) {
 	}
 
 	Clear();
-
-	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
 }
 
 /*
@@ -431,7 +897,12 @@ void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, i
 			break;
 		}
 		case WAVE_FORMAT_TAG_OGG: {
-			readSamples44k = DecodeOGG( sample, sampleOffset44k, sampleCount44k, dest );
+			// whole samples decoded at load time bypass the block cache
+			if ( decodedBlocks.IsEnabled() && sampleCount44k <= DECODED_BLOCK_SAMPLES44K ) {
+				readSamples44k = DecodeOGGBlocks( sample, sampleOffset44k, sampleCount44k, dest );
+			} else {
+				readSamples44k = DecodeOGG( sample, sampleOffset44k, sampleCount44k, dest );
+			}
 			break;
 		}
 		case WAVE_FORMAT_TAG_STREAM_CINEMATICS: {
@@ -518,7 +989,7 @@ int idSampleDecoderLocal::DecodeOGG( idSoundSample *sample, int sampleOffset44k,
 	int sampleCount = sampleCount44k >> shift;
 
 	// open OGG file if not yet opened
-	if ( lastSample == NULL ) {
+	if ( lastFormat != WAVE_FORMAT_TAG_OGG ) {
 		// make sure there is enough space for another decoder
 		if ( decoderMemoryAllocator.GetFreeBlockMemory() < MIN_OGGVORBIS_MEMORY ) {
 			return 0;
@@ -573,3 +1044,49 @@ int idSampleDecoderLocal::DecodeOGG( idSoundSample *sample, int sampleOffset44k,
 
 	return ( readSamples << shift );
 }
+
+/*
+====================
+idSampleDecoderLocal::DecodeOGGBlocks
+
+Copies samples from the decoded block cache. Blocks which are not cached yet
+are decoded here and stored, then the following blocks are queued for the decoder thread.
+====================
+*/
+int idSampleDecoderLocal::DecodeOGGBlocks( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest ) {
+	const int length44k = sample->LengthIn44kHzSamples();
+	int readSamples44k = 0;
+	int block = sampleOffset44k / DECODED_BLOCK_SAMPLES44K;
+
+	while ( readSamples44k < sampleCount44k ) {
+		int offset44k = sampleOffset44k + readSamples44k;
+		block = offset44k / DECODED_BLOCK_SAMPLES44K;
+		int blockStart44k = block * DECODED_BLOCK_SAMPLES44K;
+		int count44k = sampleCount44k - readSamples44k;
+
+		int num = decodedBlocks.Read( sample, block, offset44k - blockStart44k, count44k, dest + readSamples44k );
+		if ( num < 0 ) {
+			// not decoded ahead: this happens when a sample starts playing or the cache is too small
+			int blockCount44k = Min( DECODED_BLOCK_SAMPLES44K, length44k - blockStart44k );
+			int decoded44k = DecodeOGG( sample, blockStart44k, blockCount44k, decodeMissBuffer );
+			if ( failed || decoded44k <= 0 ) {
+				break;
+			}
+			decodedBlocks.Store( sample, block, decodeMissBuffer, decoded44k );
+
+			num = Min( count44k, decoded44k - ( offset44k - blockStart44k ) );
+			if ( num > 0 ) {
+				memcpy( dest + readSamples44k, decodeMissBuffer + ( offset44k - blockStart44k ), num * sizeof( dest[0] ) );
+			}
+		}
+		if ( num <= 0 ) {
+			break;
+		}
+		readSamples44k += num;
+	}
+
+	lastSample = sample;
+	decodedBlocks.QueueAhead( sample, block );
+
+	return readSamples44k;
+}
@@ -140,6 +140,8 @@ idSoundChannel::idSoundChannel
 */
 idSoundChannel::idSoundChannel( void ) {
 	decoder = NULL;
+	emitter = NULL;
+	activeNode.SetOwner( this );
 	Clear();
 }
 
@@ -161,6 +163,8 @@ void idSoundChannel::Clear( void ) {
 	int j;
 
 	Stop();
+	activeNode.Remove();
+	virtualized = false;
 	soundShader = NULL;
 	lastVolume = 0.0f;
 	triggerChannel = SCHANNEL_ANY;
@@ -187,9 +191,14 @@ idSoundChannel::Start
 */
 void idSoundChannel::Start( void ) {
 	triggerState = true;
+	virtualized = false;
 	if ( decoder == NULL ) {
 		decoder = idSampleDecoder::Alloc();
 	}
+	// the mixer only walks started channels
+	if ( !activeNode.InList() && emitter && emitter->soundWorld ) {
+		activeNode.AddToEnd( emitter->soundWorld->activeChannels );
+	}
 }
 
 /*
@@ -198,6 +207,7 @@ idSoundChannel::Stop
 ===================
 */
 void idSoundChannel::Stop( void ) {
+	// stays in active list until mixer frees OpenAL resources
 	triggerState = false;
 	if ( decoder != NULL ) {
 		idSampleDecoder::Free( decoder );
@@ -372,6 +382,9 @@ idSoundEmitterLocal::idSoundEmitterLocal
 idSoundEmitterLocal::idSoundEmitterLocal( void ) {	
 	soundWorld = NULL;
 	index = -1;
+	for ( int i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
+		channels[i].emitter = this;
+	}
 	Clear();
 }
 
@@ -408,6 +421,8 @@ void idSoundEmitterLocal::Clear( void ) {
 	ampTime = 0;			// last time someone queried
 	amplitude = 0;
 	maxDistance = 10.0f;	// meters
+	propagationCache[0].valid = false;
+	propagationCache[1].valid = false;
 	minDistance = 0.0f;		// grayman #3042
 	volumeLoss = 0.0f;
 	spatializedOrigin.Zero();
@@ -663,7 +678,7 @@ void idSoundEmitterLocal::Spatialize( bool primary, idVec3 listenerPos, int list
 		volumeLoss = 0; // grayman #3042 - accumulates volume loss via ResolveOrigin() processing
 
 		SoundChainResults results;
-		if ( soundWorld->ResolveOrigin(primary, 0, NULL, soundInArea, 0.0f, 0.0f, origin, origin, this, &results ) ) // grayman #3042
+		if ( soundWorld->ResolveOriginCached(primary, soundInArea, this, &results ) ) // grayman #3042
 		{
 			// grayman #4882 - If the listener is a Listener entity, and it's targetted at another
 			// entity, treat that other entity as an emitter, and start a new waveform there with
@@ -779,7 +794,10 @@ void idSoundEmitterLocal::Free( bool immediate ) {
 	if ( !immediate ) {
 		removeStatus = REMOVE_STATUS_WAITSAMPLEFINISHED;
 	} else {
+		// channels are unlinked from the active list, which the mixer walks
+		Sys_EnterCriticalSection();
 		Clear();
+		Sys_LeaveCriticalSection();
 	}
 }
 
@@ -57,6 +57,7 @@ class idSoundSample;
 class idSampleDecoder;
 class idSoundChannel;
 class idSoundWorldLocal;
+class idSoundEmitterLocal;
 
 //stgatilov #2454: atomic piece of subtitle text data
 struct Subtitle {
@@ -398,8 +399,28 @@ public:
 	ALuint				lastopenalStreamingBuffer[3];
 
 	bool				disallowSlow;
+
+	idSoundEmitterLocal *emitter;				// the emitter which owns this channel
+	idLinkList<idSoundChannel> activeNode;		// in soundWorld->activeChannels since Start, removed by mixer after Stop
+	bool				virtualized;			// audible but not bound to OpenAL source, playback position is tracked by time only
 };
 
+// per-tick mixing parameters of a started channel, see idSoundWorldLocal::SetupChannelMix
+typedef struct {
+	idSoundEmitterLocal *sound;
+	idSoundChannel *	chan;
+	float				volume;
+	float				spatialize;
+	idVec3				spatializedOriginInMeters;
+	float				totalSoundDistance;
+	float				minDistance;
+	float				maxDistance;
+	bool				omni;
+	bool				looping;
+	bool				global;
+	bool				virtualVoice;			// should not be bound to OpenAL source this tick
+} channelMix_t;
+
 class SoundChainResults // grayman #3042
 {
 public:
@@ -410,6 +431,27 @@ public:
 	float				spatialDistance; // distance back to the spacializedOrigin
 };
 
+// portal chains from emitter to listener found by the last full search, stored as a tree
+typedef struct {
+	int					portal;					// index of portal in the parent node's area
+	int					firstChild;				// -1 if none
+	int					nextSibling;			// -1 if none
+	int					numChildren;
+	bool				frontier;				// search was cut here by distance or loss, which depend on positions
+} soundPathNode_t;
+
+// see idSoundWorldLocal::ResolveOriginCached
+typedef struct {
+	bool				valid;
+	bool				recording;				// full search is running and adds nodes
+	int					soundArea;				// the key: if anything changes, a full search is done
+	int					listenerArea;
+	int					portalVersion;
+	float				maxDistance;
+	float				volume;
+	idList<soundPathNode_t> nodes;				// node 0 is the sound area
+} soundPropagationCache_t;
+
 class idSoundEmitterLocal : public idSoundEmitter {
 public:
 
@@ -477,6 +519,7 @@ public:
 	float				distance;					// in meters, this may be the straight-line distance, or
 													// it may go through a chain of portals.  If there
 													// is not an open-portal path, distance will be > maxDistance
+	soundPropagationCache_t propagationCache[2];	// portal chains to primary and secondary listener
 
 	// a single soundEmitter can have many channels playing from the same point
 	idSoundChannel		channels[SOUND_MAX_CHANNELS];
@@ -597,13 +640,17 @@ public:
 
 	idSoundEmitterLocal *	AllocLocalSoundEmitter(idVec3 loc); // grayman #4882
 	void					CalcEars( int numSpeakers, idVec3 realOrigin, idVec3 listenerPos, idMat3 listenerAxis, float ears[6], float spatialize );
-	void					AddChannelContribution( idSoundEmitterLocal *sound, idSoundChannel *chan,
-												int current44kHz, int numSpeakers, float *finalMixBuffer );
+	bool					SetupChannelMix( idSoundEmitterLocal *sound, idSoundChannel *chan, int current44kHz, channelMix_t &mix );
+	void					AddChannelContribution( channelMix_t &mix, int current44kHz, int numSpeakers, float *finalMixBuffer );
+	void					AssignVoices( void );
+	ALuint					FindAreaEffect( const char **effectName );
 	void					MixLoop( int current44kHz, int numSpeakers, float *finalMixBuffer );
 	void					MixLoopInternal( int current44kHz, int numSpeakers, float *finalMixBuffer );
 	void					AVIUpdate( void );
 	float					GetDiffractionLoss(const idVec3 p1, const idVec3 p2, const idVec3 p3); // grayman #4219
-	bool					ResolveOrigin( bool primary, const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const float loss, const idVec3& soundOrigin, const idVec3& prevSoundOrigin, idSoundEmitterLocal *def , SoundChainResults *results); // grayman #3042 // grayman #4219 // grayman #4882
+	bool					ResolveOrigin( bool primary, const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const float loss, const idVec3& soundOrigin, const idVec3& prevSoundOrigin, idSoundEmitterLocal *def , SoundChainResults *results, soundPropagationCache_t *cache = NULL, int cacheNode = 0 ); // grayman #3042 // grayman #4219 // grayman #4882
+	bool					ResolveOriginCached( bool primary, const int soundArea, idSoundEmitterLocal *def, SoundChainResults *results );
+	void					BenchmarkPropagation( int numEmitters, int numFrames );
 	float					FindAmplitude( idSoundEmitterLocal *sound, const int localTime, const idVec3 *listenerPosition, const s_channelType channel, bool shakesOnly );
 	void					GetSubtitles( idList<SubtitleMatch> &dest ) override;	//stgatilov #2454
 
@@ -624,6 +671,15 @@ public:
 	// nbohr1more: #5587 Reverb volume control
 	float					listenerSlotReverbGain;
 
+	// EFX effect found for every area, so that database is not searched on every mix tick
+	typedef struct {
+		bool				valid;
+		idStr				areaName;			// listenerAreaName used for lookup
+		idStr				effectName;			// name of the found effect (for logging)
+		ALuint				effect;
+	} efxAreaCache_t;
+	idList<efxAreaCache_t>	efxAreaCache;
+
 	int						gameMsec;
 	int						game44kHz;
 	int						pause44kHz;
@@ -631,6 +687,15 @@ public:
 
 	idList<idSoundEmitterLocal *>emitters;
 
+	idLinkList<idSoundChannel>	activeChannels;	// all started channels of all emitters (owned by mixer)
+	idList<channelMix_t>	mixChannels;		// audible channels of the current mix tick (temporary)
+	int						numVirtualVoices;	// statistics of the last mix tick
+
+	// statistics of sound propagation in the last ForegroundUpdate
+	int						propagationNodes;	// number of ResolveOrigin calls
+	int						propagationSearches;	// full searches (cache misses)
+	int						propagationReplays;	// searches along cached paths
+
 	idSoundFade				soundClassFade[SOUND_MAX_CLASSES];	// for global sound fading
 
 	// avi stuff
@@ -812,6 +877,8 @@ public:
 	static idCVar			s_globalFraction;
 	static idCVar			s_doorDistanceAdd;
 	static idCVar			s_singleEmitter;
+	static idCVar			s_maxVoices;
+	static idCVar			s_cachePropagation;
 	static idCVar			s_numberOfSpeakers;
 	static idCVar			s_force22kHz;
 	static idCVar			s_clipVolumes;
@@ -819,6 +886,8 @@ public:
 	static idCVar			s_useEAXReverb;
 	static idCVar			s_useHRTF;
 	static idCVar			s_decompressionLimit;
+	static idCVar			s_decodeCacheSize;
+	static idCVar			s_decodeAheadBlocks;
 	// nbohr1more: #5587 Reverb volume control
 	static idCVar			s_alReverbGain;
 
@@ -899,6 +968,15 @@ public:
 ===================================================================================
 */
 
+typedef struct decodedBlockStats_s {
+	int						numBlocks;			// decoded blocks currently cached
+	int						memory;				// bytes allocated for decoded blocks
+	int						hits;				// block reads served from the cache
+	int						misses;				// block reads which had to be decoded synchronously
+	int						prefetched;			// blocks decoded ahead by the decoder thread
+	int						queued;				// blocks waiting for the decoder thread
+} decodedBlockStats_t;
+
 class idSampleDecoder {
 public:
 	static void				Init( void );
@@ -907,6 +985,8 @@ public:
 	static void				Free( idSampleDecoder *decoder );
 	static int				GetNumUsedBlocks( void );
 	static int				GetUsedBlockMemory( void );
+	static void				ForgetSample( idSoundSample *sample );	// drops decoded blocks and pending decodes of the sample
+	static void				GetDecodedBlockStats( decodedBlockStats_t &stats );
 
 	virtual					~idSampleDecoder( void ) {}
 	virtual void			Decode( idSoundSample *sample, int sampleOffset44k, int sampleCount44k, float *dest ) = 0;
@@ -940,10 +1020,17 @@ public:
 	void					BeginLevelLoad();
 	void					EndLevelLoad();
 
+							// samples found after this call are not loaded until LoadDeferredSounds,
+							// which reads their files in parallel
+	void					BeginDeferredLoads();
+	void					LoadDeferredSounds();
+
 	void					PrintMemInfo( MemInfo_t *mi );
 
 private:
 	bool					insideLevelLoad;
+	bool					deferLoads;
+	idList<idSoundSample*>	deferredLoads;
 	idList<idSoundSample*>	listCache;
 	idHashIndex				cacheHash;
 };
@@ -140,7 +140,16 @@ bool idSoundShader::Parse( const char *text, const int textLength ) {
 	// deeper functions can set this, which will cause MakeDefault() to be called at the end
 	errorDuringParse = false;
 
-	if ( !ParseShader( src ) || errorDuringParse ) {
+	// load all samples of the shader together
+	if ( soundSystemLocal.soundCache ) {
+		soundSystemLocal.soundCache->BeginDeferredLoads();
+	}
+	bool parsed = ParseShader( src );
+	if ( soundSystemLocal.soundCache ) {
+		soundSystemLocal.soundCache->LoadDeferredSounds();
+	}
+
+	if ( !parsed || errorDuringParse ) {
 		MakeDefault();
 		return false;
 	}
@@ -392,6 +401,9 @@ bool idSoundShader::ParseShader( idLexer &src ) {
 	}
 
 	if ( parms.shakes > 0.0f ) {
+		if ( soundSystemLocal.soundCache ) {
+			soundSystemLocal.soundCache->LoadDeferredSounds();
+		}
 		CheckShakesAndOgg();
 	}
 
@@ -43,6 +43,8 @@ idCVar idSoundSystemLocal::s_subFraction( "s_subFraction", "0.75", CVAR_SOUND |
 idCVar idSoundSystemLocal::s_globalFraction( "s_globalFraction", "0.8", CVAR_SOUND | CVAR_ARCHIVE | CVAR_FLOAT, "volume to all speakers when not spatialized" );
 idCVar idSoundSystemLocal::s_doorDistanceAdd( "s_doorDistanceAdd", "450", CVAR_SOUND | CVAR_ARCHIVE | CVAR_FLOAT, "reduce sound volume with this distance when going through a door" );
 idCVar idSoundSystemLocal::s_singleEmitter( "s_singleEmitter", "0", CVAR_SOUND | CVAR_INTEGER, "mute all sounds but this emitter" );
+idCVar idSoundSystemLocal::s_cachePropagation( "s_cachePropagation", "1", CVAR_SOUND | CVAR_BOOL, "reuse portal chains found for emitter until its area, listener area or portals change" );
+idCVar idSoundSystemLocal::s_maxVoices( "s_maxVoices", "0", CVAR_SOUND | CVAR_INTEGER | CVAR_ARCHIVE, "max number of loudest channels played through OpenAL sources, other audible channels are virtualized\n0 means all available hardware voices", 0, 256 );
 idCVar idSoundSystemLocal::s_numberOfSpeakers( "s_numberOfSpeakers", "2", CVAR_SOUND | CVAR_ARCHIVE, "No longer works! (number of speakers)" );
 idCVar idSoundSystemLocal::s_force22kHz( "s_force22kHz", "0", CVAR_SOUND | CVAR_BOOL, ""  );
 idCVar idSoundSystemLocal::s_clipVolumes( "s_clipVolumes", "1", CVAR_SOUND | CVAR_BOOL, ""  );
@@ -73,6 +75,9 @@ idCVar idSoundSystemLocal::s_useEAXReverb( "s_useEAXReverb", "0", CVAR_SOUND | C
 idCVar idSoundSystemLocal::s_decompressionLimit( "s_decompressionLimit", "6", CVAR_SOUND | CVAR_INTEGER | CVAR_ROM, "specifies maximum uncompressed sample length in seconds" );
 #endif
 
+idCVar idSoundSystemLocal::s_decodeCacheSize( "s_decodeCacheSize", "16", CVAR_SOUND | CVAR_INTEGER | CVAR_ARCHIVE, "megabytes of decoded OGG blocks kept for streaming channels\n0 means decode in the mixer as before", 0, 256 );
+idCVar idSoundSystemLocal::s_decodeAheadBlocks( "s_decodeAheadBlocks", "2", CVAR_SOUND | CVAR_INTEGER, "number of OGG blocks decoded ahead of playback by the decoder thread", 0, 16 );
+
 bool idSoundSystemLocal::useEFXReverb = false;
 int idSoundSystemLocal::EFXAvailable = -1;
 
@@ -258,6 +263,11 @@ void ListSoundDecoders_f( const idCmdArgs &args ) {
 	common->Printf( "%d waiting decoders\n", numWaitingDecoders );
 	common->Printf( "%d active decoders\n", numActiveDecoders );
 	common->Printf( "%d kB decoder memory in %d blocks\n", idSampleDecoder::GetUsedBlockMemory() >> 10, idSampleDecoder::GetNumUsedBlocks() );
+
+	decodedBlockStats_t stats;
+	idSampleDecoder::GetDecodedBlockStats( stats );
+	common->Printf( "%d kB decoded OGG memory in %d blocks, %d queued\n", stats.memory >> 10, stats.numBlocks, stats.queued );
+	common->Printf( "%d block hits, %d misses, %d decoded ahead\n", stats.hits, stats.misses, stats.prefetched );
 }
 
 /*
@@ -277,6 +287,21 @@ void TestSound_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+===============
+SoundBenchPropagation_f
+
+  this is called from the main thread
+===============
+*/
+void SoundBenchPropagation_f( const idCmdArgs &args ) {
+	int numEmitters = ( args.Argc() > 1 ? atoi( args.Argv( 1 ) ) : 300 );
+	int numFrames = ( args.Argc() > 2 ? atoi( args.Argv( 2 ) ) : 100 );
+	if ( soundSystemLocal.currentSoundWorld ) {
+		soundSystemLocal.currentSoundWorld->BenchmarkPropagation( numEmitters, numFrames );
+	}
+}
+
 /*
 ===============
 SoundSystemRestart_f
@@ -523,6 +548,7 @@ void idSoundSystemLocal::Init() {
 	cmdSystem->AddCommand( "reloadSounds", SoundReloadSounds_f, CMD_FL_SOUND|CMD_FL_CHEAT, "reloads all sounds" );
 	cmdSystem->AddCommand( "testSound", TestSound_f, CMD_FL_SOUND | CMD_FL_CHEAT, "tests a sound", idCmdSystem::ArgCompletion_SoundName );
 	cmdSystem->AddCommand( "s_restart", SoundSystemRestart_f, CMD_FL_SOUND, "restarts the sound system" );
+	cmdSystem->AddCommand( "s_benchPropagation", SoundBenchPropagation_f, CMD_FL_SOUND | CMD_FL_CHEAT, "spatializes temporary emitters around listener with and without propagation cache\nusage: s_benchPropagation [numEmitters] [numFrames]" );
 }
 
 /*
@@ -101,6 +101,10 @@ void idSoundWorldLocal::Init( idRenderWorld *renderWorld ) {
 	enviroSuitActive	= false;
 
 	activeSubtitlesFrame = 0;
+
+	efxAreaCache.Clear();
+	numVirtualVoices = 0;
+	propagationNodes = propagationSearches = propagationReplays = 0;
 }
 
 /*
@@ -163,6 +167,9 @@ void idSoundWorldLocal::Shutdown() {
 	activeSubtitles[0].ClearFree();
 	activeSubtitles[1].ClearFree();
 	activeSubtitlesFrame = -1;
+
+	efxAreaCache.ClearFree();
+	mixChannels.ClearFree();
 }
 
 /*
@@ -184,6 +191,9 @@ void idSoundWorldLocal::ClearAllSoundEmitters() {
 	localSound = NULL;
 	secondarySound = NULL; // grayman #4882
 
+	// areas will change with the next map
+	efxAreaCache.Clear();
+
 	Sys_LeaveCriticalSection();
 }
 
@@ -228,7 +238,10 @@ idSoundEmitterLocal *idSoundWorldLocal::AllocLocalSoundEmitter(idVec3 loc) // gr
 		}
 	}
 
+	// channels are unlinked from the active list, which the mixer walks
+	Sys_EnterCriticalSection();
 	def->Clear();
+	Sys_LeaveCriticalSection();
 	def->index = index;
 	def->removeStatus = REMOVE_STATUS_ALIVE;
 	def->soundWorld = this;
@@ -472,7 +485,7 @@ for AVIdemo writing
 ===================
 */
 void idSoundWorldLocal::MixLoopInternal( int current44kHz, int numSpeakers, float *finalMixBuffer ) {
-	int i, j;
+	int i;
 	idSoundEmitterLocal *sound;
 
 	// if noclip flying outside the world, leave silence
@@ -503,9 +516,6 @@ void idSoundWorldLocal::MixLoopInternal( int current44kHz, int numSpeakers, floa
 	alListenerfv(AL_ORIENTATION, listenerOrientation);
 
 	if (idSoundSystemLocal::useEFXReverb && soundSystemLocal.efxloaded) {
-		ALuint effect = AL_EFFECTSLOT_NULL;
-		idStr s(listenerArea);
-
 		//nbohr1more: #5587 Reverb volume control
 		float gain = soundSystemLocal.s_alReverbGain.GetFloat();
 		if (listenerSlotReverbGain != gain) {
@@ -513,71 +523,67 @@ void idSoundWorldLocal::MixLoopInternal( int current44kHz, int numSpeakers, floa
 			soundSystemLocal.alAuxiliaryEffectSlotf(listenerSlot, AL_EFFECTSLOT_GAIN, gain);
 		}
 
-		bool found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
-		if (!found) {
-			s = listenerAreaName;
-			found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
-		}
-		if (!found) {
-			s = "default";
-			found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
+		bool justReloaded = soundSystemLocal.EFXDatabase.IsAfterReload();
+		if (justReloaded) {
+			efxAreaCache.Clear();
 		}
+		const char *effectName;
+		ALuint effect = FindAreaEffect(&effectName);
 
-		bool justReloaded = soundSystemLocal.EFXDatabase.IsAfterReload();
 		// only update if change in settings
 		if (listenerEffect != effect || justReloaded) {
-			common->Printf("Switching to EFX '%s' (#%u)\n", s.c_str(), effect);
+			common->Printf("Switching to EFX '%s' (#%u)\n", effectName, effect);
 			listenerEffect = effect;
 			soundSystemLocal.alAuxiliaryEffectSloti(listenerSlot, AL_EFFECTSLOT_EFFECT, effect);
 		}
 	}
 
 	// debugging option to mute all but a single soundEmitter
+	idSoundEmitterLocal *singleEmitter = NULL;
 	if ( idSoundSystemLocal::s_singleEmitter.GetInteger() > 0 && idSoundSystemLocal::s_singleEmitter.GetInteger() < emitters.Num() ) {
-		sound = emitters[idSoundSystemLocal::s_singleEmitter.GetInteger()];
-
-		if ( sound && sound->playing ) {
-			// run through all the channels
-			for ( j = 0; j < SOUND_MAX_CHANNELS ; j++ ) {
-				idSoundChannel	*chan = &sound->channels[j];
-
-				// see if we have a sound triggered on this channel
-				if ( !chan->triggerState ) {
-					chan->ALStop();
-					continue;
-				}
-
-				AddChannelContribution( sound, chan, current44kHz, numSpeakers, finalMixBuffer );
-			}
+		singleEmitter = emitters[idSoundSystemLocal::s_singleEmitter.GetInteger()];
+		if ( !singleEmitter ) {
+			return;
 		}
-		return;
 	}
 
-	for ( i = 1; i < emitters.Num(); i++ ) {
-		sound = emitters[i];
+	// run through all started channels
+	mixChannels.SetNum( 0, false );
+	idLinkList<idSoundChannel> *next;
+	for ( idLinkList<idSoundChannel> *node = activeChannels.NextNode(); node; node = next ) {
+		next = node->NextNode();
+		idSoundChannel *chan = node->Owner();
+		sound = chan->emitter;
 
-		if ( !sound ) {
+		// see if we have a sound triggered on this channel
+		if ( !chan->triggerState ) {
+			chan->ALStop();
+			chan->activeNode.Remove();
 			continue;
 		}
-		const char *shaderName = "";
-		if (auto shader = sound->channels[0].soundShader)
-			shaderName = shader->GetName();
+
 		// if no channels are active, do nothing
 		if ( !sound->playing ) {
 			continue;
 		}
-		// run through all the channels
-		for ( j = 0; j < SOUND_MAX_CHANNELS ; j++ ) {
-			idSoundChannel	*chan = &sound->channels[j];
+		if ( singleEmitter && sound != singleEmitter ) {
+			continue;
+		}
 
-			// see if we have a sound triggered on this channel
-			if ( !chan->triggerState ) {
-				chan->ALStop();
-				continue;
-			}
+		channelMix_t mix;
+		if ( SetupChannelMix( sound, chan, current44kHz, mix ) ) {
+			mixChannels.Append( mix );
+		}
+	}
 
-			AddChannelContribution( sound, chan, current44kHz, numSpeakers, finalMixBuffer );
+	AssignVoices();
+
+	for ( i = 0; i < mixChannels.Num(); i++ ) {
+		// voice stealing in AllocOpenALSource could have stopped it
+		if ( !mixChannels[i].chan->triggerState ) {
+			continue;
 		}
+		AddChannelContribution( mixChannels[i], current44kHz, numSpeakers, finalMixBuffer );
 	}
 
 	// TODO port to OpenAL
@@ -586,6 +592,89 @@ void idSoundWorldLocal::MixLoopInternal( int current44kHz, int numSpeakers, floa
 	}
 }
 
+/*
+===================
+idSoundWorldLocal::FindAreaEffect
+
+Returns EFX effect for current listener area: by area number, by area name or the default one.
+Results are cached per area until EFX file is reloaded.
+===================
+*/
+ALuint idSoundWorldLocal::FindAreaEffect( const char **effectName ) {
+	if ( listenerArea >= efxAreaCache.Num() ) {
+		efxAreaCache_t empty;
+		empty.valid = false;
+		empty.effect = AL_EFFECTSLOT_NULL;
+		efxAreaCache.AssureSize( listenerArea + 1, empty );
+	}
+
+	efxAreaCache_t &cache = efxAreaCache[listenerArea];
+	if ( !cache.valid || cache.areaName != listenerAreaName ) {
+		ALuint effect = AL_EFFECTSLOT_NULL;
+		idStr s(listenerArea);
+
+		bool found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
+		if (!found) {
+			s = listenerAreaName;
+			found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
+		}
+		if (!found) {
+			s = "default";
+			found = soundSystemLocal.EFXDatabase.FindEffect(s, &effect);
+		}
+
+		cache.valid = true;
+		cache.areaName = listenerAreaName;
+		cache.effectName = s;
+		cache.effect = effect;
+	}
+
+	*effectName = cache.effectName.c_str();
+	return cache.effect;
+}
+
+/*
+===================
+idSoundWorldLocal::AssignVoices
+
+Only the loudest of audible channels are played through OpenAL sources.
+The rest are virtualized: they keep their playback time and subtitles,
+but don't hold hardware voices until they get loud enough again.
+===================
+*/
+void idSoundWorldLocal::AssignVoices( void ) {
+	// virtualized channel must be this much louder to take voice from a playing one
+	static const float VOICE_SWITCH_FACTOR = 1.25f;
+
+	int maxVoices = soundSystemLocal.openalSourceCount;
+	if ( idSoundSystemLocal::s_maxVoices.GetInteger() > 0 ) {
+		maxVoices = idMath::Imin( maxVoices, idSoundSystemLocal::s_maxVoices.GetInteger() );
+	}
+
+	numVirtualVoices = 0;
+	if ( mixChannels.Num() <= maxVoices ) {
+		return;
+	}
+
+	std::stable_sort( mixChannels.begin(), mixChannels.end(), []( const channelMix_t &a, const channelMix_t &b ) -> bool {
+		float va = a.chan->virtualized ? a.volume : a.volume * VOICE_SWITCH_FACTOR;
+		float vb = b.chan->virtualized ? b.volume : b.volume * VOICE_SWITCH_FACTOR;
+		return va > vb;
+	});
+
+	for ( int i = maxVoices; i < mixChannels.Num(); i++ ) {
+		channelMix_t &mix = mixChannels[i];
+		idSoundChannel *chan = mix.chan;
+
+		mix.virtualVoice = true;
+		chan->ALStop();
+		// recreate buffers and restore position when voice is assigned again
+		chan->triggered = true;
+		chan->virtualized = true;
+		numVirtualVoices++;
+	}
+}
+
 /*
 ===================
 idSoundWorldLocal::MixLoop
@@ -594,10 +683,17 @@ stgatilov #2454: Simple wrapper which makes sure activeSubtitles are filled on e
 ===================
 */
 void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *finalMixBuffer ) {
+	TRACE_CPU_SCOPE( "Sound:MixLoop" )
+	uint64_t startUsec = Sys_GetTimeMicroseconds();
+
 	activeSubtitles[!activeSubtitlesFrame].Clear();
 
 	MixLoopInternal( current44kHz, numSpeakers, finalMixBuffer );
 
+	TRACE_PLOT_NUMBER( "Sound:mixUsec", (int64)( Sys_GetTimeMicroseconds() - startUsec ) );
+	TRACE_PLOT_NUMBER( "Sound:channels", (int64)mixChannels.Num() );
+	TRACE_PLOT_NUMBER( "Sound:virtualVoices", (int64)numVirtualVoices );
+
 	idScopedCriticalSection section(activeSubtitlesMutex);
 	activeSubtitlesFrame ^= 1;
 }
@@ -816,11 +912,27 @@ set at maxDistance
 */
 static const int MAX_PORTAL_TRACE_DEPTH = 10;
 
-bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const float loss, const idVec3& soundOrigin, const idVec3& prevSoundOrigin, idSoundEmitterLocal *def , SoundChainResults *results) // grayman #3042 // grayman #4219
+bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const float loss, const idVec3& soundOrigin, const idVec3& prevSoundOrigin, idSoundEmitterLocal *def , SoundChainResults *results, soundPropagationCache_t *cache, int cacheNode ) // grayman #3042 // grayman #4219
 {
+	propagationNodes++;
+
+	// Distance and loss checks below depend on the positions of the emitter and the listener.
+	// When filling the cache, the node where they stop the search is marked as frontier.
+	// When following the cache, the search continues without cache from a frontier node,
+	// since positions may have changed enough to get through it.
+	bool recording = ( cache && cache->recording );
+	if ( cache && !recording && cache->nodes[cacheNode].frontier )
+	{
+		cache = NULL;
+	}
+
 	if ( dist >= def->distance ) // compare meters to meters
 	{
 		// we can't possibly hear the sound through this chain of portals
+		if ( recording )
+		{
+			cache->nodes[cacheNode].frontier = true;
+		}
 		return false;
 	}
 
@@ -833,12 +945,20 @@ bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const
 	distToListener = (soundOrigin - listenerPosition).LengthFast(); // min distance remaining to reach listener (doom units)
 	if ( ( dist + (distToListener * DOOM_TO_METERS) ) >= def->distance )
 	{
+		if ( recording )
+		{
+			cache->nodes[cacheNode].frontier = true;
+		}
 		return false;
 	}
 
 	// SteveL #4148: Also quit if the sound loss through this chain is too great.
 	if ( soundSystemLocal.dB2Scale(def->parms.volume - loss) < SND_EPSILON )
 	{
+		if ( recording )
+		{
+			cache->nodes[cacheNode].frontier = true;
+		}
 		return false;
 	}
 
@@ -867,6 +987,10 @@ bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const
 
 		if ( soundSystemLocal.dB2Scale(def->parms.volume - loss - angularLoss) < SND_EPSILON )
 		{
+			if ( recording )
+			{
+				cache->nodes[cacheNode].frontier = true;
+			}
 			return false;
 		}
 		
@@ -891,10 +1015,28 @@ bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const
 
 	int numPortals = rw->NumPortalsInArea( soundArea );
 
+	// when using cache, only follow the chains which reached the listener or a frontier during the full search
+	int nextChild = -1;
+	int lastChild = -1;
+	if ( cache && !recording )
+	{
+		numPortals = cache->nodes[cacheNode].numChildren;
+		nextChild = cache->nodes[cacheNode].firstChild;
+	}
+
 	idList<SoundChainResults *> chainResults;
 	
-	for ( int p = 0 ; p < numPortals ; p++ )
+	for ( int i = 0 ; i < numPortals ; i++ )
 	{
+		int p = i;
+		int childNode = -1;
+		if ( cache && !recording )
+		{
+			childNode = nextChild;
+			nextChild = cache->nodes[childNode].nextSibling;
+			p = cache->nodes[childNode].portal;
+		}
+
 		exitPortal_t re = rw->GetPortal( soundArea, p );
 
 		// grayman #3042 - This section used to apply the default idSoundSystemLocal::s_doorDistanceAdd
@@ -1031,7 +1173,14 @@ bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const
 
 		idVec3 trailingSoundOrigin = soundOrigin; // doom units
 
-		if ( ResolveOrigin( primary, stackDepth+1, &newStack, otherArea, dist+(tlenLength*DOOM_TO_METERS), loss + re.lossPlayer + angularLoss/* + waterLoss*/, source, trailingSoundOrigin, def, res ) ) // grayman #3042
+		if ( recording )
+		{
+			soundPathNode_t node = { p, -1, -1, 0, false };
+			childNode = cache->nodes.Append( node );
+		}
+
+		bool reached = ResolveOrigin( primary, stackDepth+1, &newStack, otherArea, dist+(tlenLength*DOOM_TO_METERS), loss + re.lossPlayer + angularLoss/* + waterLoss*/, source, trailingSoundOrigin, def, res, cache, childNode ); // grayman #3042
+		if ( reached )
 		{
 			chainResults.Append(res);
 		} 
@@ -1039,6 +1188,30 @@ bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const
 		{
 			delete res; // SoundChainResults for this iteration no longer required, so free it
 		}
+
+		if ( recording )
+		{
+			if ( reached || cache->nodes[childNode].frontier || cache->nodes[childNode].numChildren > 0 )
+			{
+				// keep the chain in the same order as portals are enumerated
+				if ( lastChild < 0 )
+				{
+					cache->nodes[cacheNode].firstChild = childNode;
+				}
+				else
+				{
+					cache->nodes[lastChild].nextSibling = childNode;
+				}
+				cache->nodes[cacheNode].numChildren++;
+				lastChild = childNode;
+			}
+			else
+			{
+				// chains through this node failed regardless of positions (loops, depth limit), so there is nothing below it
+				assert( cache->nodes.Num() == childNode + 1 );
+				cache->nodes.SetNum( childNode, false );
+			}
+		}
 	}
 
 	if ( chainResults.Num() > 0 ) // were there any usable results?
@@ -1141,6 +1314,175 @@ bool idSoundWorldLocal::ResolveOrigin( bool primary, const int stackDepth, const
 	return false;
 }
 
+/*
+===================
+idSoundWorldLocal::ResolveOriginCached
+
+Same as ResolveOrigin called for the area of the emitter.
+
+The portal chains visited by the full search are remembered in the emitter,
+and while neither the emitter nor the listener change area and no portal changes,
+only these chains are traced again instead of flooding through all portals.
+Chains which failed only because of loops or depth limit are dropped.
+Chains cut by distance or loss keep the node where they were cut, and the search
+continues below it without cache if it is no longer cut for the current positions.
+So the results are the same as of the full search, wherever the emitter and the listener are.
+===================
+*/
+bool idSoundWorldLocal::ResolveOriginCached( bool primary, const int soundArea, idSoundEmitterLocal *def, SoundChainResults *results )
+{
+	if ( !idSoundSystemLocal::s_cachePropagation.GetBool() )
+	{
+		propagationSearches++;
+		return ResolveOrigin( primary, 0, NULL, soundArea, 0.0f, 0.0f, def->origin, def->origin, def, results );
+	}
+
+	idVec3 listenerPosition = (primary ? listenerQU : gameLocal.GetLocalPlayer()->GetSecondaryListenerLoc()); // doom units
+	int listenArea = rw->GetAreaAtPoint( listenerPosition );
+
+	soundPropagationCache_t &cache = def->propagationCache[primary ? 0 : 1];
+	if ( !cache.valid || cache.soundArea != soundArea || cache.listenerArea != listenArea || cache.portalVersion != rw->GetPortalSoundVersion() ||
+		cache.maxDistance != def->distance || cache.volume != def->parms.volume )
+	{
+		propagationSearches++;
+
+		cache.valid = true;
+		cache.soundArea = soundArea;
+		cache.listenerArea = listenArea;
+		cache.portalVersion = rw->GetPortalSoundVersion();
+		cache.maxDistance = def->distance;
+		cache.volume = def->parms.volume;
+
+		soundPathNode_t root = { -1, -1, -1, 0, false };
+		cache.nodes.SetNum( 0, false );
+		cache.nodes.Append( root );
+
+		SoundChainResults unused;
+		cache.recording = true;
+		ResolveOrigin( primary, 0, NULL, soundArea, 0.0f, 0.0f, def->origin, def->origin, def, &unused, &cache, 0 );
+		cache.recording = false;
+	}
+
+	propagationReplays++;
+	return ResolveOrigin( primary, 0, NULL, soundArea, 0.0f, 0.0f, def->origin, def->origin, def, results, &cache, 0 );
+}
+
+/*
+===================
+idSoundWorldLocal::BenchmarkPropagation
+
+Spatializes a number of temporary emitters around the listener for several frames,
+with and without the propagation cache, and reports the time and the amount of portal tracing.
+This is done with the listener standing still and with the listener walking around,
+and results with cache are checked to be exactly the same as without it.
+
+  this is called from the main thread
+===================
+*/
+void idSoundWorldLocal::BenchmarkPropagation( int numEmitters, int numFrames ) {
+	if ( !rw || listenerArea < 0 ) {
+		common->Printf( "Listener is not inside the world\n" );
+		return;
+	}
+
+	const float maxDistance = 30.0f;		// meters
+	idRandom rnd( 0 );
+	idList<idSoundEmitterLocal *> testEmitters;
+	for ( int attempt = 0; testEmitters.Num() < numEmitters && attempt < numEmitters * 100; attempt++ ) {
+		idVec3 dir( rnd.CRandomFloat(), rnd.CRandomFloat(), rnd.CRandomFloat() * 0.25f );
+		idVec3 pos = listenerQU + dir * ( maxDistance * METERS_TO_DOOM );
+		if ( rw->GetAreaAtPoint( pos ) < 0 ) {
+			continue;
+		}
+		idSoundEmitterLocal *def = new idSoundEmitterLocal;
+		def->soundWorld = this;
+		def->origin = pos;
+		// not started: the mixer never sees this channel
+		def->channels[0].triggerState = true;
+		def->channels[0].parms.minDistance = 1.0f;
+		def->channels[0].parms.maxDistance = maxDistance;
+		testEmitters.Append( def );
+	}
+
+	// the listener either stays in place, or walks around a circle (staying where it is if point is outside the world)
+	const idVec3 oldListenerQU = listenerQU;
+	const int oldListenerArea = listenerArea;
+	const float walkRadius = 128.0f;		// doom units
+	idList<idVec3> path[2];
+	for ( int frame = 0; frame < numFrames; frame++ ) {
+		path[0].Append( oldListenerQU );
+		float angle = idMath::TWO_PI * frame / idMath::Imax( numFrames, 1 );
+		idVec3 pos = oldListenerQU + idVec3( idMath::Cos( angle ), idMath::Sin( angle ), 0.0f ) * walkRadius;
+		if ( rw->GetAreaAtPoint( pos ) < 0 ) {
+			pos = ( frame > 0 ? path[1][frame - 1] : oldListenerQU );
+		}
+		path[1].Append( pos );
+	}
+
+	bool oldCache = idSoundSystemLocal::s_cachePropagation.GetBool();
+	for ( int moving = 0; moving < 2; moving++ ) {
+		// results of every emitter on every frame without cache
+		idList<idVec3> uncachedOrigins;
+		idList<float> uncachedDistances, uncachedLosses;
+
+		for ( int cached = 0; cached < 2; cached++ ) {
+			idSoundSystemLocal::s_cachePropagation.SetBool( cached != 0 );
+
+			int totalNodes = 0, totalSearches = 0, mismatches = 0;
+			uint64_t usec = 0;
+			for ( int frame = 0; frame < numFrames; frame++ ) {
+				listenerQU = path[moving][frame];
+				listenerPos = listenerQU * DOOM_TO_METERS;
+				listenerArea = rw->GetAreaAtPoint( listenerQU );
+				if ( listenerArea < 0 ) {
+					listenerArea = oldListenerArea;
+				}
+
+				propagationNodes = propagationSearches = propagationReplays = 0;
+				uint64_t startUsec = Sys_GetTimeMicroseconds();
+				for ( int i = 0; i < testEmitters.Num(); i++ ) {
+					testEmitters[i]->Spatialize( true, listenerPos, listenerArea, rw );
+				}
+				usec += Sys_GetTimeMicroseconds() - startUsec;
+				totalNodes += propagationNodes;
+				totalSearches += propagationSearches;
+
+				// the cache must give exactly the same results wherever the listener is
+				for ( int i = 0; i < testEmitters.Num(); i++ ) {
+					const idSoundEmitterLocal *def = testEmitters[i];
+					if ( !cached ) {
+						uncachedOrigins.Append( def->spatializedOrigin );
+						uncachedDistances.Append( def->distance );
+						uncachedLosses.Append( def->volumeLoss );
+						continue;
+					}
+					int k = frame * testEmitters.Num() + i;
+					if ( uncachedOrigins[k] != def->spatializedOrigin || uncachedDistances[k] != def->distance || uncachedLosses[k] != def->volumeLoss ) {
+						mismatches++;
+					}
+				}
+			}
+			double msecPerFrame = usec * 1e-3 / idMath::Imax( numFrames, 1 );
+
+			common->Printf(
+				"%s listener, %s: %d emitters, %.3f ms per frame, %d portal nodes per frame, %d full searches total",
+				moving ? "moving" : "stationary", cached ? "cached" : "uncached", testEmitters.Num(), msecPerFrame, totalNodes / idMath::Imax( numFrames, 1 ), totalSearches
+			);
+			if ( cached ) {
+				common->Printf( ", %d results differ", mismatches );
+			}
+			common->Printf( "\n" );
+		}
+	}
+	idSoundSystemLocal::s_cachePropagation.SetBool( oldCache );
+
+	listenerQU = oldListenerQU;
+	listenerPos = oldListenerQU * DOOM_TO_METERS;
+	listenerArea = oldListenerArea;
+
+	testEmitters.DeleteContents( true );
+}
+
 
 /*
 ===================
@@ -1227,6 +1569,8 @@ void idSoundWorldLocal::ForegroundUpdate( int current44kHzTime ) {
 
 	Sys_EnterCriticalSection();
 
+	propagationNodes = propagationSearches = propagationReplays = 0;
+
 	// if we are recording an AVI demo, don't use hardware time
 	if ( fpa[0] ) {
 		current44kHzTime = lastAVI44kHz;
@@ -1370,6 +1714,9 @@ void idSoundWorldLocal::ForegroundUpdate( int current44kHzTime ) {
 
 	Sys_LeaveCriticalSection();
 
+	TRACE_PLOT_NUMBER( "Sound:portalNodes", (int64)propagationNodes );
+	TRACE_PLOT_NUMBER( "Sound:portalSearches", (int64)propagationSearches );
+
 	//
 	// the sound meter
 	//
@@ -1603,8 +1950,14 @@ void idSoundWorldLocal::ReadFromSaveGame( idFile *savefile ) {
 		ReadFromSaveGameSoundShaderParams( savefile, &def->parms );
 		savefile->ReadFloat( def->amplitude );
 		savefile->ReadInt( def->ampTime );
-		for (int k = 0; k < SOUND_MAX_CHANNELS; k++) 
+		for (int k = 0; k < SOUND_MAX_CHANNELS; k++) {
 			ReadFromSaveGameSoundChannel( savefile, &def->channels[k] );
+			if ( def->channels[k].triggerState ) {
+				Sys_EnterCriticalSection();
+				def->channels[k].activeNode.AddToEnd( activeChannels );
+				Sys_LeaveCriticalSection();
+			}
+		}
 		savefile->ReadFloat( def->distance );
 		savefile->ReadBool( def->hasShakes );
 		savefile->ReadInt( def->lastValidPortalArea );
@@ -1922,19 +2275,15 @@ void idSoundWorldLocal::CalcEars( int numSpeakers, idVec3 spatializedOrigin, idV
 
 /*
 ===============
-idSoundWorldLocal::AddChannelContribution
+idSoundWorldLocal::SetupChannelMix
 
-Adds the contribution of a single sound channel to finalMixBuffer
+Computes volume and spatialization of a single started sound channel
 this is called from the async thread
 
-Mixes MIXBUFFER_SAMPLES samples starting at current44kHz sample time into
-finalMixBuffer
+Returns false if the channel has nothing to add
 ===============
 */
-
-void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSoundChannel *chan,
-				   int current44kHz, int numSpeakers, float *finalMixBuffer ) {
-	int j;
+bool idSoundWorldLocal::SetupChannelMix( idSoundEmitterLocal *sound, idSoundChannel *chan, int current44kHz, channelMix_t &mix ) {
 	float volume;
 
 	//
@@ -1948,26 +2297,25 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 	// fetch the actual wave file and see if it's valid
 	idSoundSample *sample = chan->leadinSample;
 	if ( sample == NULL ) {
-		return;
+		return false;
 	}
 
 	// if you don't want to hear all the beeps from missing sounds
 	if ( sample->defaultSound && !idSoundSystemLocal::s_playDefaultSound.GetBool() ) {
-		return;
+		return false;
 	}
 
 	// get the actual shader
 	const idSoundShader *shader = chan->soundShader;
 	// this might happen if the foreground thread just deleted the sound emitter
 	if ( !shader ) {
-		return;
+		return false;
 	}
 	const char *shaderName = shader->GetName();
 
 	float maxd = parms->maxDistance;
 	float mind = parms->minDistance;
 	
-	int  mask = shader->speakerMask;
 	bool omni = ( parms->soundShaderFlags & SSF_OMNIDIRECTIONAL) != 0;
 	bool looping = ( parms->soundShaderFlags & SSF_LOOPING ) != 0;
 	bool global = ( parms->soundShaderFlags & SSF_GLOBAL ) != 0;
@@ -2039,7 +2387,7 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 	// it's not affected by distance or occlusion
 	//
 	float	spatialize = 1;
-	idVec3 spatializedOriginInMeters;
+	idVec3 spatializedOriginInMeters = vec3_zero;
 	float totalSoundDistance = 0.0f;
 	if ( !global )
 	{
@@ -2100,8 +2448,55 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 	// do we have anything to add?
 	//
 	if ( volume < SND_EPSILON && chan->lastVolume < SND_EPSILON ) {
-		return;
+		return false;
 	}
+
+	mix.sound = sound;
+	mix.chan = chan;
+	mix.volume = volume;
+	mix.spatialize = spatialize;
+	mix.spatializedOriginInMeters = spatializedOriginInMeters;
+	mix.totalSoundDistance = totalSoundDistance;
+	mix.minDistance = mind;
+	mix.maxDistance = maxd;
+	mix.omni = omni;
+	mix.looping = looping;
+	mix.global = global;
+	mix.virtualVoice = false;
+	return true;
+}
+
+/*
+===============
+idSoundWorldLocal::AddChannelContribution
+
+Adds the contribution of a single sound channel to finalMixBuffer
+this is called from the async thread
+
+Mixes MIXBUFFER_SAMPLES samples starting at current44kHz sample time into
+finalMixBuffer
+===============
+*/
+void idSoundWorldLocal::AddChannelContribution( channelMix_t &mix, int current44kHz, int numSpeakers, float *finalMixBuffer ) {
+	int j;
+
+	idSoundEmitterLocal *sound = mix.sound;
+	idSoundChannel *chan = mix.chan;
+	soundShaderParms_t *parms = &chan->parms;
+	idSoundSample *sample = chan->leadinSample;
+	const idSoundShader *shader = chan->soundShader;
+
+	float volume = mix.volume;
+	float spatialize = mix.spatialize;
+	const idVec3 &spatializedOriginInMeters = mix.spatializedOriginInMeters;
+	float totalSoundDistance = mix.totalSoundDistance;
+	float mind = mix.minDistance;
+	float maxd = mix.maxDistance;
+	bool omni = mix.omni;
+	bool looping = mix.looping;
+	bool global = mix.global;
+	int mask = shader->speakerMask;
+
 	chan->lastVolume = volume;
 
 	//
@@ -2133,11 +2528,11 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 			destSubtitles[i].volume = idMath::ClampFloat( 0.1f, 1.0f, volume / 0.1f );
 		}
 
-		if ( !alIsSource( chan->openalSource ) ) {
+		if ( !alIsSource( chan->openalSource ) && !mix.virtualVoice ) {
 			chan->openalSource = soundSystemLocal.AllocOpenALSource( chan, !chan->leadinSample->hardwareBuffer || !chan->soundShader->entries[0]->hardwareBuffer || looping, chan->leadinSample->objectInfo.nChannels == 2 );
 		}
 
-		if ( alIsSource( chan->openalSource ) ) {
+		if ( !mix.virtualVoice && alIsSource( chan->openalSource ) ) {
 			
 			// stop source if needed..
 			if ( chan->triggered ) {
@@ -2248,8 +2643,18 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 			}
 			if ( restart ) {
 				alSourcePlay( chan->openalSource );
+				if ( chan->virtualized && !isStreaming && !( slowmoActive && !chan->disallowSlow ) ) {
+					// continue from where virtual voice is now (streaming sounds do this by openalStreamingOffset)
+					const idSoundSample *played = looping ? chan->soundShader->entries[0] : sample;
+					int length = played->DurationIn44kHzSamples();
+					int position = looping ? offset % idMath::Imax( length, 1 ) : offset;
+					if ( position > 0 && position < length ) {
+						alSourcef( chan->openalSource, AL_SEC_OFFSET, position / (float)PRIMARYFREQ );
+					}
+				}
 				chan->triggered = false;
 			}
+			chan->virtualized = false;
 		}
 	}
 	else
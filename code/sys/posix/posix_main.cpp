@@ -426,6 +426,30 @@ ID_TIME_T Sys_FileTimeStamp(FILE * fp) {
 	return st.st_mtime;
 }
 
+const void *Sys_MapFile(const char *path, size_t &size) {
+	size = 0;
+	int fd = open(path, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+	struct stat st;
+	if (fstat(fd, &st) == -1 || st.st_size <= 0) {
+		close(fd);
+		return NULL;
+	}
+	void *ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// mapping stays valid after the descriptor is closed
+	close(fd);
+	if (ptr == MAP_FAILED)
+		return NULL;
+	size = st.st_size;
+	return ptr;
+}
+
+void Sys_UnmapFile(const void *ptr, size_t size) {
+	if (ptr)
+		munmap((void*)ptr, size);
+}
+
 void Sys_Sleep(int msec) {
 	if ( msec < 20 ) {
 		static int last = 0;
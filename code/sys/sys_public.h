@@ -405,6 +405,9 @@ bool			Sys_GetCurrentMonitorResolution( int &width, int &height );
 
 void			Sys_Mkdir( const char *path );
 ID_TIME_T		Sys_FileTimeStamp( FILE *fp );
+// maps the whole file into memory for reading, returns NULL on failure
+const void *	Sys_MapFile( const char *path, size_t &size );
+void			Sys_UnmapFile( const void *ptr, size_t size );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 const char *	Sys_DefaultBasePath( void );
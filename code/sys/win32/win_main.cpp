@@ -447,6 +447,48 @@ ID_TIME_T Sys_FileTimeStamp( FILE *fp ) {
 	return ( long ) st.st_mtime;
 }
 
+/*
+=================
+Sys_MapFile
+=================
+*/
+const void *Sys_MapFile( const char *path, size_t &size ) {
+	size = 0;
+	HANDLE file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+	LARGE_INTEGER fileSize;
+	if ( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart <= 0 || fileSize.QuadPart > SIZE_MAX ) {
+		CloseHandle( file );
+		return NULL;
+	}
+	HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( file );
+	if ( mapping == NULL ) {
+		return NULL;
+	}
+	// the view keeps the mapping object alive
+	const void *ptr = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	CloseHandle( mapping );
+	if ( ptr == NULL ) {
+		return NULL;
+	}
+	size = ( size_t )fileSize.QuadPart;
+	return ptr;
+}
+
+/*
+=================
+Sys_UnmapFile
+=================
+*/
+void Sys_UnmapFile( const void *ptr, size_t size ) {
+	if ( ptr ) {
+		UnmapViewOfFile( ptr );
+	}
+}
+
 /*
 ==============
 Sys_Cwd
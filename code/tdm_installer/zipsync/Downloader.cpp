@@ -34,6 +34,11 @@ static const int LOW_SPEED_LIMIT = 1000;
 //overhead per download in bytes --- for progress callback only
 static const int ESTIMATED_DOWNLOAD_OVERHEAD = 100;
 
+//adaptive batching: try to make requests which take about X seconds on the measured speed
+static const double BATCH_TARGET_SECONDS = 5.0;
+//adaptive batching: never make requests smaller than this (unless speed profile says so)
+static const int BATCH_MIN_SIZE = 256<<10;
+
 namespace ZipSync {
 
 //note: HTTP header field names are case-insensitive
@@ -45,13 +50,17 @@ const char *CheckHttpPrefix(const std::string &line, const std::string &prefix)
     return rest;
 }
 
+static void CurlMultiCleanup(CURLM *multi) {
+    curl_multi_cleanup(multi);
+}
+
 DownloadSource::DownloadSource() { byterange[0] = byterange[1] = 0; }
 DownloadSource::DownloadSource(const std::string &url) : url(url) { byterange[0] = 0; byterange[1] = UINT32_MAX; }
 DownloadSource::DownloadSource(const std::string &url, uint32_t from, uint32_t to) : url(url) { byterange[0] = from; byterange[1] = to; }
 
 
 Downloader::~Downloader() {}
-Downloader::Downloader() : _curlHandle(nullptr, curl_easy_cleanup) {}
+Downloader::Downloader() : _curlMultiHandle(nullptr, CurlMultiCleanup) {}
 
 void Downloader::EnqueueDownload(const DownloadSource &source, const DownloadFinishedCallback &finishedCallback) {
     Download down;
@@ -85,145 +94,221 @@ void Downloader::SetMultipartBlocked(bool blocked) {
     _blockMultipart = blocked;
 }
 
+void Downloader::SetMaxConnections(int total, int perHost) {
+    _maxConnections = std::max(total, 1);
+    _maxConnectionsPerHost = std::max(std::min(perHost, _maxConnections), 1);
+}
+
+Downloader::Connection::Connection() : curlHandle(nullptr, curl_easy_cleanup) {}
+
+//extracts "host:port" part from URL
+static std::string GetUrlHost(const std::string &url) {
+    size_t start = url.find("://");
+    start = (start == std::string::npos ? 0 : start + 3);
+    size_t end = url.find('/', start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
 void Downloader::DownloadAll() {
     if (_progressCallback)
         _progressCallback(0.0, "Downloading started");
 
-    _curlHandle.reset(curl_easy_init());
-
     //distribute downloads across remote files / urls
-    for (int i = 0; i <  _downloads.size(); i++)
-        _urlStates[_downloads[i].src.url].downloadsIds.push_back(i);
+    for (int i = 0; i <  _downloads.size(); i++) {
+        const DownloadSource &src = _downloads[i].src;
+        UrlState &state = _urlStates[src.url];
+        SubTask st = {i, {src.byterange[0], src.byterange[1]}};
+        state.pending.push_back(st);
+        if (st.byterange[1] != UINT32_MAX)
+            state.pendingBytes += st.byterange[1] - st.byterange[0];
+    }
     for (auto &pKV : _urlStates) {
-        std::string url = pKV.first;
-        std::vector<int> &ids = pKV.second.downloadsIds;
-        std::sort(ids.begin(), ids.end(), [this](int a, int b) {
-           return _downloads[a].src.byterange[0] < _downloads[b].src.byterange[0];
-        });
+        UrlState &state = pKV.second;
+        std::stable_sort(state.pending.begin(), state.pending.end());
+        state.host = GetUrlHost(pKV.first);
+        state.speedLastFailedAt.assign(SPEED_PROFILES_NUM, -1);
     }
 
-    //go over remote files and process them one by one
-    for (const auto &pKV : _urlStates) {
-        std::string url = pKV.first;
-        try {
-            DownloadAllForUrl(url);
-        }
-        catch(const ErrorException &e) {
-            if (!_silentErrors)
-                throw e;    //rethrow further to caller
-            else
-                {}          //supress exception, continue with other urls
-        }
+    //prepare slots for concurrent requests
+    _curlMultiHandle = std::unique_ptr<CURLM, void (*)(CURLM*)>(curl_multi_init(), CurlMultiCleanup);
+    for (int i = 0; i < _maxConnections; i++) {
+        _connections.emplace_back(new Connection());
+        _connections.back()->owner = this;
+        _connections.back()->curlHandle.reset(curl_easy_init());
     }
 
-    ZipSyncAssert(_curlHandle.get_deleter() == curl_easy_cleanup);
-    _curlHandle.reset();
+    try {
+        while (1) {
+            //fill free slots with new requests
+            //note: don't start anything new after user has asked to stop
+            if (!_interrupted) {
+                for (auto &conn : _connections)
+                    if (!conn->response && !StartNextRequest(*conn))
+                        break;
+            }
+            int activeCnt = 0;
+            for (const auto &conn : _connections)
+                activeCnt += (conn->response != nullptr);
+            if (activeCnt == 0)
+                break;
+
+            //let CURL do the job for a while
+            int runningCnt = 0;
+            CURLMcode mres = curl_multi_perform(_curlMultiHandle.get(), &runningCnt);
+            ZipSyncAssertF(mres == CURLM_OK, "Unexpected CURL multi error %d", mres);
+
+            //handle finished requests
+            int msgsLeft = 0;
+            while (CURLMsg *msg = curl_multi_info_read(_curlMultiHandle.get(), &msgsLeft)) {
+                if (msg->msg != CURLMSG_DONE)
+                    continue;
+                CURL *curl = msg->easy_handle;
+                CURLcode ret = msg->data.result;
+                curl_multi_remove_handle(_curlMultiHandle.get(), curl);
+                for (auto &conn : _connections)
+                    if (conn->curlHandle.get() == curl)
+                        FinishRequest(*conn, ret);
+            }
+
+            if (runningCnt > 0)
+                curl_multi_wait(_curlMultiHandle.get(), nullptr, 0, 100, nullptr);
+        }
+    }
+    catch(...) {
+        CleanupConnections();
+        throw;
+    }
+    CleanupConnections();
 
     if (_progressCallback)
         _progressCallback(1.0, "Downloading finished");
 }
 
-void Downloader::DownloadAllForUrl(const std::string &url) {
-    UrlState &state = _urlStates.find(url)->second;
-    int n = state.downloadsIds.size();
-
-    //used to occasionally restore faster speed profiles
-    int64_t speedLastFailedAt[SPEED_PROFILES_NUM];
-    memset(speedLastFailedAt, -1, sizeof(speedLastFailedAt));
-
-    while (state.doneCnt < n) {
-        //select speed profile
-        ZipSyncAssertF(state.speedProfile < SPEED_PROFILES_NUM, "Repeated timeout on URL %s", url.c_str());
-        SpeedProfile profile = SPEED_PROFILES[state.speedProfile];
-        if (_blockMultipart)
-            profile.maxPartsPerRequest = 1;
-
-        std::vector<SubTask> subtasks;  //set of chunks scheduled as one request
-        uint64_t totalSize = 0;         //total number of bytes scheduled into request
-        int rangesCnt = 0;              //number of separate byteranges scheduled
-        uint32_t last = UINT32_MAX;     //end of the last byterange
-
-        int end = state.doneCnt;
-        //grab a few next downloads for the next HTTP request
-        while (end < n) {
-            //what if we add the whole next download? (or what remains of it)
-            int idx = state.downloadsIds[end];
-            const Download &down = _downloads[idx];
-            uint32_t downStart = down.src.byterange[0] + (subtasks.empty() ? state.doneBytesNext : 0);
-            uint32_t downEnd = down.src.byterange[1];
-
-            //estimate quantities if we add this download
-            uint64_t newTotalSize = totalSize + (downEnd - downStart);
-            int newRangesCnt = rangesCnt + (last != downStart);
-
-            //stop before this download if it exceeds ranges limit
-            if (newRangesCnt > profile.maxPartsPerRequest)
-                break;
-            //does it exceed size limit?
-            if (newTotalSize > profile.maxRequestSize) {
-                if (subtasks.size() > 0) {
-                    //we have added at least one download already,
-                    //don't take a new one with size limit overflow
-                    break;
-                }
-                if (downEnd != UINT32_MAX) {
-                    //this download is larger than limit: split it and download only a part of it
-                    SubTask st = {idx, {downStart, downStart + profile.maxRequestSize}};
-                    subtasks.push_back(st);
-                    break;
-                }
-                //single request with unknown size: never split...
-                //note that we will soon discover its size from HTTP headers
-                //so if timeout happens, then we will be able to split it on retry
-            }
-
-            //no limit exceeded -> add this full download to scheduled request
-            end++;
-            SubTask st = {idx, {downStart, downEnd}};
-            subtasks.push_back(st);
+void Downloader::CleanupConnections() {
+    for (auto &conn : _connections) {
+        if (conn->response)
+            curl_multi_remove_handle(_curlMultiHandle.get(), conn->curlHandle.get());
+    }
+    _connections.clear();
+    _curlMultiHandle.reset();
+}
 
-            //update stats for limit checks on next iterations
-            last = downEnd;
-            totalSize = newTotalSize;
-            rangesCnt = newRangesCnt;
+bool Downloader::StartNextRequest(Connection &conn) {
+    //find remote file to download from
+    //prefer the ones with less requests running: spread connections across files and mirrors
+    std::string url;
+    UrlState *best = nullptr;
+    for (auto &pKV : _urlStates) {
+        UrlState &state = pKV.second;
+        if (state.failed || state.pending.empty())
+            continue;
+        if (_hostStates[state.host].activeRequests >= _maxConnectionsPerHost)
+            continue;
+        if (!best || state.activeRequests < best->activeRequests) {
+            best = &state;
+            url = pKV.first;
         }
+    }
+    if (!best)
+        return false;
 
-        //perform the HTTP request
-        bool ok = DownloadOneRequest(url, subtasks, profile.lowSpeedTime, profile.connectTimeout);
+    conn.speedProfile = best->speedProfile;
+    ScheduleSubtasks(*best, conn.subtasks);
+    best->activeRequests++;
+    _hostStates[best->host].activeRequests++;
 
-        if (ok) {
-            //update number of fully finished downloads
-            state.doneCnt = end;
-            //update progress in the next download
-            if (end < state.downloadsIds.size() && subtasks.back().downloadIdx == state.downloadsIds[end]) {
-                //partly finished
-                int idx = subtasks.back().downloadIdx;
-                state.doneBytesNext = subtasks.back().byterange[1] - _downloads[idx].src.byterange[0];
+    const SpeedProfile &profile = SPEED_PROFILES[conn.speedProfile];
+    StartRequest(conn, url, profile.lowSpeedTime, profile.connectTimeout);
+    return true;
+}
+
+void Downloader::ScheduleSubtasks(UrlState &state, std::vector<SubTask> &subtasks) {
+    //select speed profile
+    SpeedProfile profile = SPEED_PROFILES[state.speedProfile];
+    if (_blockMultipart)
+        profile.maxPartsPerRequest = 1;
+
+    //adaptive batching: don't ask for much more than a connection to this host can receive in a few seconds,
+    //and split what remains of this file between the connections which can still be opened to its host
+    //(otherwise one huge request would download the whole file while other connections are idle)
+    const HostState &host = _hostStates[state.host];
+    int64_t batchSize = profile.maxRequestSize;
+    if (host.bytesPerSecond > 0.0)
+        batchSize = std::min(batchSize, int64_t(host.bytesPerSecond * BATCH_TARGET_SECONDS));
+    int freeSlots = std::max(_maxConnectionsPerHost - host.activeRequests, 1);
+    batchSize = std::min(batchSize, (state.pendingBytes + freeSlots - 1) / freeSlots);
+    batchSize = std::max(batchSize, int64_t(std::min(profile.maxRequestSize, BATCH_MIN_SIZE)));
+
+    subtasks.clear();
+    uint64_t totalSize = 0;         //total number of bytes scheduled into request
+    int rangesCnt = 0;              //number of separate byteranges scheduled
+    uint32_t last = UINT32_MAX;     //end of the last byterange
+
+    //grab a few next pieces for the next HTTP request
+    while (!state.pending.empty()) {
+        //what if we add the whole next piece?
+        SubTask &next = state.pending.front();
+        const Download &down = _downloads[next.downloadIdx];
+        uint32_t downStart = next.byterange[0];
+        uint32_t downEnd = std::min(next.byterange[1], down.src.byterange[1]);  //file size could be discovered on previous attempt
+
+        //estimate quantities if we add this piece
+        uint64_t newTotalSize = totalSize + (downEnd - downStart);
+        int newRangesCnt = rangesCnt + (last != downStart);
+
+        //stop before this piece if it exceeds ranges limit
+        if (newRangesCnt > profile.maxPartsPerRequest)
+            break;
+        //does it exceed size limit?
+        if (newTotalSize > uint64_t(batchSize)) {
+            if (subtasks.size() > 0) {
+                //we have added at least one piece already,
+                //don't take a new one with size limit overflow
+                break;
             }
-            else {
-                //fully finished
-                state.doneBytesNext = 0;
+            if (downEnd != UINT32_MAX) {
+                //this piece is larger than limit: split it and download only a part of it
+                SubTask st = {next.downloadIdx, {downStart, downStart + uint32_t(batchSize)}};
+                subtasks.push_back(st);
+                //the rest of it remains pending (keep pieces sorted by starting offset)
+                SubTask rest = {next.downloadIdx, {st.byterange[1], downEnd}};
+                state.pending.pop_front();
+                state.pending.insert(std::upper_bound(state.pending.begin(), state.pending.end(), rest), rest);
+                break;
             }
-            //reset speed profile
-            for (int i = 0; i < state.speedProfile; i++)
-                if (speedLastFailedAt[i] < 0 || _totalBytesDownloaded - speedLastFailedAt[i] > SPEED_PROFILES[i].maxRequestSize) {
-                    //last time when we failed with this profile was long time ago
-                    //so let's try this speed again, maybe it will work now
-                    state.speedProfile = i;
-                    break;
-                }
-        }
-        else {
-            //soft fail: retry with less strict limits
-            speedLastFailedAt[state.speedProfile] = _totalBytesDownloaded;
-            state.speedProfile++;
+            //single request with unknown size: never split...
+            //note that we will soon discover its size from HTTP headers
+            //so if timeout happens, then we will be able to split it on retry
         }
+
+        //no limit exceeded -> add this full piece to scheduled request
+        SubTask st = {next.downloadIdx, {downStart, downEnd}};
+        subtasks.push_back(st);
+        state.pending.pop_front();
+
+        //update stats for limit checks on next iterations
+        last = downEnd;
+        totalSize = newTotalSize;
+        rangesCnt = newRangesCnt;
     }
+
+    for (const SubTask &st : subtasks)
+        if (st.byterange[1] != UINT32_MAX)
+            state.pendingBytes -= st.byterange[1] - st.byterange[0];
 }
 
-bool Downloader::DownloadOneRequest(const std::string &url, const std::vector<SubTask> &subtasks, int lowSpeedTime, int connectTimeout) {
-    if (subtasks.empty())
-        return true;    //scheduling algorithm should never even create such requests...
+void Downloader::ReturnSubtasks(UrlState &state, const std::vector<SubTask> &subtasks) {
+    for (SubTask st : subtasks) {
+        //whole-file download: maybe we have discovered its size already
+        st.byterange[1] = std::min(st.byterange[1], _downloads[st.downloadIdx].src.byterange[1]);
+        if (st.byterange[1] != UINT32_MAX)
+            state.pendingBytes += st.byterange[1] - st.byterange[0];
+        state.pending.insert(std::upper_bound(state.pending.begin(), state.pending.end(), st), st);
+    }
+}
+
+void Downloader::StartRequest(Connection &conn, const std::string &url, int lowSpeedTime, int connectTimeout) {
+    const std::vector<SubTask> &subtasks = conn.subtasks;
 
     //generate byterange string with all adjacent chunks merged
     std::vector<std::pair<uint32_t, uint32_t>> coaslescedRanges;
@@ -262,7 +347,7 @@ bool Downloader::DownloadOneRequest(const std::string &url, const std::vector<Su
 //------------------- CURL callbacks: begin -------------------
     auto header_callback = [](char *buffer, size_t size, size_t nitems, void *userdata) {
         size *= nitems;
-        auto &resp = *((Downloader*)userdata)->_currResponse;
+        auto &resp = *((Connection*)userdata)->response;
         std::string str(buffer, buffer + size);
         size_t from, to, all;
         if (const char *tail = CheckHttpPrefix(str, "Content-Range: bytes ")) {
@@ -288,18 +373,19 @@ bool Downloader::DownloadOneRequest(const std::string &url, const std::vector<Su
     };
     auto write_callback = [](char *buffer, size_t size, size_t nitems, void *userdata) -> size_t {
         size *= nitems;
-        auto &resp = *((Downloader*)userdata)->_currResponse;
+        auto &resp = *((Connection*)userdata)->response;
         if (resp.onerange[0] == resp.onerange[1] && resp.boundary.empty())
             return 0;  //neither range nor multipart response -> stop
         resp.data.insert(resp.data.end(), buffer, buffer + size);
         return size;
     };
     auto xferinfo_callback = [](void *userdata, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
-        auto &resp = *((Downloader*)userdata)->_currResponse;
+        auto &conn = *(Connection*)userdata;
+        auto &resp = *conn.response;
         if (dltotal > 0 && dlnow > 0) {
             resp.progressRatio = double(dlnow) / std::max(dltotal, dlnow);
             resp.bytesDownloaded = dlnow;
-            if (int code = ((Downloader*)userdata)->UpdateProgress())
+            if (int code = conn.owner->UpdateProgress(&resp))
                 return code;   //interrupt!
         }
         return 0;
@@ -307,23 +393,24 @@ bool Downloader::DownloadOneRequest(const std::string &url, const std::vector<Su
 //-------------------- CURL callbacks: end --------------------
 
     //prepare temporary structure for response
-    _currResponse.reset(new CurlResponse());
-    _currResponse->url = url;
-    _currResponse->progressWeight = progressWeight;
+    conn.response.reset(new CurlResponse());
+    conn.response->url = url;
+    conn.response->progressWeight = progressWeight;
+    conn.response->sizeEstimate = thisEstimate;
 
     //set up CURL request
-    CURL *curl = _curlHandle.get();
+    CURL *curl = conn.curlHandle.get();
     std::string reprocmd = "curl";
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     reprocmd += formatMessage(" %s", url.c_str());
     curl_easy_setopt(curl, CURLOPT_RANGE, byterangeStr.c_str());
     reprocmd += formatMessage(" -r %s", byterangeStr.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (curl_write_callback)write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &conn);
     curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, (curl_write_callback)header_callback);
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &conn);
     curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, (curl_xferinfo_callback)xferinfo_callback);
-    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &conn);
     curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
     curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, LOW_SPEED_LIMIT);
     reprocmd += formatMessage(" -Y %d", LOW_SPEED_LIMIT);
@@ -341,17 +428,78 @@ bool Downloader::DownloadOneRequest(const std::string &url, const std::vector<Su
     reprocmd += formatMessage(" -o out%d.bin", reqIdx);
     g_logger->debugf("[curl-cmd] %s", reprocmd.c_str());
     //notify user that we start downloading from this URL
-    UpdateProgress();
+    UpdateProgress(conn.response.get());
+
+    //request will be performed by multi handle together with others
+    curl_multi_add_handle(_curlMultiHandle.get(), curl);
+}
+
+void Downloader::FinishRequest(Connection &conn, int curlCode) {
+    //free the slot: it will be reused by the next request
+    std::unique_ptr<CurlResponse> response = std::move(conn.response);
+    std::vector<SubTask> subtasks;
+    subtasks.swap(conn.subtasks);
+    std::string url = response->url;
+
+    UrlState &state = _urlStates.find(url)->second;
+    HostState &host = _hostStates[state.host];
+    state.activeRequests--;
+    host.activeRequests--;
+    if (state.failed)
+        return;     //error happened on another request to this URL: ignore everything
+
+    try {
+        bool ok = ProcessResponse(conn.curlHandle.get(), *response, subtasks, curlCode);
+
+        if (ok) {
+            //reset speed profile
+            for (int i = 0; i < state.speedProfile; i++)
+                if (state.speedLastFailedAt[i] < 0 || _totalBytesDownloaded - state.speedLastFailedAt[i] > SPEED_PROFILES[i].maxRequestSize) {
+                    //last time when we failed with this profile was long time ago
+                    //so let's try this speed again, maybe it will work now
+                    state.speedProfile = i;
+                    break;
+                }
+            //measure speed of connection for adaptive batching
+            //note: small requests mostly measure latency, so they are ignored
+            double seconds = 0.0;
+            curl_easy_getinfo(conn.curlHandle.get(), CURLINFO_TOTAL_TIME, &seconds);
+            if (seconds > 0.0 && response->bytesDownloaded >= BATCH_MIN_SIZE) {
+                double speed = response->bytesDownloaded / seconds;
+                host.bytesPerSecond = (host.bytesPerSecond > 0.0 ? 0.7 * host.bytesPerSecond + 0.3 * speed : speed);
+            }
+        }
+        else {
+            //soft fail: retry with less strict limits
+            ReturnSubtasks(state, subtasks);
+            //note: if several concurrent requests timed out, then switch profile only once
+            if (conn.speedProfile == state.speedProfile) {
+                state.speedLastFailedAt[state.speedProfile] = _totalBytesDownloaded;
+                state.speedProfile++;
+            }
+            ZipSyncAssertF(state.speedProfile < SPEED_PROFILES_NUM, "Repeated timeout on URL %s", url.c_str());
+        }
+    }
+    catch(const ErrorException &e) {
+        if (!_silentErrors)
+            throw;          //rethrow further to caller
+        //supress exception, drop this url and continue with other urls
+        state.failed = true;
+        state.pending.clear();
+        state.pendingBytes = 0;
+    }
+}
 
-    //perform the request
-    CURLcode ret = curl_easy_perform(curl);
+bool Downloader::ProcessResponse(CURL *curl, CurlResponse &response, const std::vector<SubTask> &subtasks, int curlCode) {
+    std::string url = response.url;
+    CURLcode ret = (CURLcode)curlCode;
     long httpRes = 0;
     curl_easy_getinfo(curl, CURLINFO_HTTP_CODE, &httpRes);
 
     //handle return/error codes
-    if (_currResponse->totalSize != UINT_MAX && _downloads[subtasks.front().downloadIdx].src.byterange[1] == UINT_MAX) {
+    if (response.totalSize != UINT_MAX && _downloads[subtasks.front().downloadIdx].src.byterange[1] == UINT_MAX) {
         //even if we have failed, now we know the size of this file (thanks to HTTP header)
-        _downloads[subtasks.front().downloadIdx].src.byterange[1] = _currResponse->totalSize;
+        _downloads[subtasks.front().downloadIdx].src.byterange[1] = response.totalSize;
     }
     if (ret != 0 || (httpRes != 200 && httpRes != 206)) {
         //log down atypical error codes
@@ -367,7 +515,7 @@ bool Downloader::DownloadOneRequest(const std::string &url, const std::vector<Su
         //so we should retry this request again (or maybe a smaller piece of it)
         g_logger->warningf(lcDownloadTooSlow,
             "Timeout for request with %d segments of total size %lld on URL %s",
-            int(subtasks.size()), thisEstimate, url.c_str()
+            int(subtasks.size()), (long long)response.sizeEstimate, url.c_str()
         );
         return false;   //soft fail: retry is welcome
     }
@@ -379,55 +527,60 @@ bool Downloader::DownloadOneRequest(const std::string &url, const std::vector<Su
     ZipSyncAssertF(httpRes == 200 || httpRes == 206, "Unexpected HTTP return code %d for URL %s", httpRes, url.c_str());
 
     //update progress indicator given that whole request is done
-    _currResponse->progressRatio = 1.0;
-    UpdateProgress();
-    _totalBytesDownloaded += _currResponse->bytesDownloaded;
-    _totalProgress += _currResponse->progressWeight;
+    _totalBytesDownloaded += response.bytesDownloaded;
+    _totalProgress += response.progressWeight;
+    UpdateProgress(&response);
 
     //parse multipart response, producing many single-range responses instead
     std::vector<CurlResponse> results;
-    if (_currResponse->boundary.empty())
-        results.push_back(std::move(*_currResponse));
+    if (response.boundary.empty())
+        results.push_back(std::move(response));
     else
-        BreakMultipartResponse(*_currResponse, results);
-
-    //we have already pulled out all we need from this structure, break it down
-    _currResponse.reset();
+        BreakMultipartResponse(response, results);
 
     std::sort(results.begin(), results.end(), [](const CurlResponse &a, const CurlResponse &b) {
         return a.onerange[0] < b.onerange[0];
     });
 
-    //handle downloaded data: fire download callbacks, append data for partial subtasks
+    //handle downloaded data: put it into download buffers, fire callbacks for completed downloads
     for (const SubTask &st : subtasks) {
         int idx = st.downloadIdx;
         const auto &downSrc = _downloads[idx].src;
         std::vector<uint8_t> &answer = _downloads[idx].resultData;
+        uint32_t &doneBytes = _downloads[idx].doneBytes;
+
+        //note: st.byterange[1] may be UINT_MAX for whole-file downloads
+        //but we must know the file size by now (thanks to HTTP header)
+        ZipSyncAssertF(downSrc.byterange[1] != UINT32_MAX, "Unknown size of file at URL %s", url.c_str());
+        uint32_t stEnd = std::min(st.byterange[1], downSrc.byterange[1]);
+        uint32_t totalSize = downSrc.byterange[1] - downSrc.byterange[0];
+        //pieces of split download can arrive in any order, so allocate whole buffer at once
+        if (doneBytes == 0)
+            answer.resize(totalSize);
 
         //find all pieces in the downloaded results which are about this subtask
+        uint32_t currPos = st.byterange[0];
         for (const auto &resp : results) {
             //intersect byterange intervals of the subtask and response (remaining part of it)
-            uint32_t currPos = downSrc.byterange[0] + (uint32_t)answer.size();
             uint32_t left = std::max(currPos, resp.onerange[0]);
-            uint32_t right = std::min(downSrc.byterange[1], resp.onerange[1]);
+            uint32_t right = std::min(stEnd, resp.onerange[1]);
             if (right <= left)
                 continue;   //no intersection
 
             ZipSyncAssertF(left == currPos, "Missing chunk %u..%u (%u bytes) after downloading URL %s", left, currPos, currPos - left, url.c_str());
             //take data from response in the intersection range
-            answer.insert(answer.end(),
+            memcpy(
+                answer.data() + (left - downSrc.byterange[0]),
                 resp.data.data() + (left - resp.onerange[0]),
-                resp.data.data() + (right - resp.onerange[0])
+                right - left
             );
+            currPos = right;
         }
+        ZipSyncAssertF(currPos == stEnd, "Missing end chunk %u..%u (%u bytes) after downloading URL %s", currPos, stEnd, stEnd - currPos, url.c_str());
+        doneBytes += stEnd - st.byterange[0];
 
-        //note: st.byterange[1] may be UINT_MAX for whole-file downloads
-        if (st.byterange[1] >= downSrc.byterange[1]) {
-            //we have just appended the very last bits of this download
-            if (downSrc.byterange[1] != UINT32_MAX) {
-                uint32_t totalSize = downSrc.byterange[1] - downSrc.byterange[0];
-                ZipSyncAssertF(answer.size() == totalSize, "Missing end chunk %zu..%u (%u bytes) after downloading URL %s", answer.size(), totalSize, totalSize - (uint32_t)answer.size(), url.c_str());
-            }
+        if (doneBytes == totalSize) {
+            //we have just received the very last bits of this download
             //pass full data to user via callback
             _downloads[idx].finishedCallback(answer.data(), answer.size());
             //drop the data from memory (to avoid using gigabytes of virtual memory)
@@ -484,15 +637,25 @@ void Downloader::BreakMultipartResponse(const CurlResponse &response, std::vecto
     }
 }
 
-int Downloader::UpdateProgress() {
+int Downloader::UpdateProgress(const CurlResponse *current) {
+    if (_interrupted)
+        return 1;   //user has already asked to stop: don't bother him anymore
     char buffer[256] = "Downloading...";
     double progress = _totalProgress;
-    if (_currResponse) {
-        sprintf(buffer, "Downloading \"%s\"...", _currResponse->url.c_str());
-        progress += _currResponse->progressWeight * _currResponse->progressRatio;
+    for (const auto &conn : _connections) {
+        if (conn->response)
+            progress += conn->response->progressWeight * conn->response->progressRatio;
     }
+    if (current)
+        snprintf(buffer, sizeof(buffer), "Downloading \"%s\"...", current->url.c_str());
+    //requests finish in arbitrary order, and a request can fail after partial download
+    //but progress reported to user should never go back
+    progress = std::min(std::max(progress, _lastReportedProgress), 1.0);
+    _lastReportedProgress = progress;
     if (_progressCallback) {
         int code = _progressCallback(progress, buffer);
+        if (code)
+            _interrupted = true;
         return code;
     }
     return 0;
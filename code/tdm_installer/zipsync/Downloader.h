@@ -3,12 +3,14 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <limits.h>
 
 
 typedef void CURL;
+typedef void CURLM;
 
 namespace ZipSync {
 
@@ -37,11 +39,15 @@ typedef std::function<int(double, const char*)> GlobalProgressCallback;
  * Smart downloader over HTTP protocol.
  * Utilizes byteranges and multipart byteranges requests to download many chunks quickly.
  * On a problematic network, can split download into many small pieces to cope with occasional timeouts.
+ * Several HTTP requests are performed concurrently (over CURL multi interface),
+ * possibly to different mirrors and/or to different parts of the same remote file.
  */
 class Downloader {
     bool _silentErrors = false;
     std::unique_ptr<std::string> _useragent;
     bool _blockMultipart = false;
+    int _maxConnections = 6;                //max number of HTTP requests running simultaneously
+    int _maxConnectionsPerHost = 3;         //same limit, but for one host (i.e. one mirror)
     GlobalProgressCallback _progressCallback;
 
     //user-specified chunk of data to be downloaded
@@ -49,26 +55,40 @@ class Downloader {
         DownloadSource src;
         DownloadFinishedCallback finishedCallback;
         std::vector<uint8_t> resultData;    //temporary storage (used in case download is split)
+        uint32_t doneBytes = 0;             //how many bytes are already stored in resultData
         int64_t progressSize = 0;           //estimated size in bytes (for progress indicator)
     };
     std::vector<Download> _downloads;
 
+    //designates user-specified "Download" or a piece of it
+    //every HTTP request contains one or several SubTasks
+    struct SubTask {
+        int downloadIdx;                    //index in _downloads
+        uint32_t byterange[2];              //can be part of download's byterange
+        bool operator< (const SubTask &other) const {
+            return byterange[0] < other.byterange[0];
+        }
+    };
+
     //state of one remote file processed
     //usually contains several user-specified "Download"-s
     struct UrlState {
-        std::vector<int> downloadsIds;      //indices in _downloads (sorted by starting offset)
-        int doneCnt = 0;                    //how many FULL downloads done
-        uint32_t doneBytesNext = 0;         //how many bytes done in the current download
+        std::string host;                   //server part of URL (connections are limited per host)
+        std::deque<SubTask> pending;        //pieces not yet downloaded and not being downloaded (sorted by starting offset)
+        int64_t pendingBytes = 0;           //total size of pending pieces (whole-file downloads of unknown size excluded)
+        int activeRequests = 0;             //how many HTTP requests to this URL are running now
         int speedProfile = 0;               //index in SPEED_PROFILES
+        std::vector<int64_t> speedLastFailedAt; //value of _totalBytesDownloaded when timeout happened with each speed profile
+        bool failed = false;                //error happened in silent mode: URL is dropped
     };
     std::map<std::string, UrlState> _urlStates;
 
-    //designates user-specified "Download" or a piece of it
-    //every HTTP request contains one or several SubTasks
-    struct SubTask {
-        int downloadIdx;                    //index in _downloads
-        uint32_t byterange[2];              //can be part of download's byterange
+    //state of one server (mirror)
+    struct HostState {
+        int activeRequests = 0;             //how many HTTP requests to this host are running now
+        double bytesPerSecond = 0.0;        //smoothed download speed of one connection (0 = not measured yet)
     };
+    std::map<std::string, HostState> _hostStates;
     //state of the HTTP request currently active
     struct CurlResponse {
         std::string url;
@@ -81,13 +101,27 @@ class Downloader {
         double progressRatio = 0.0;         //which portion of this CURL request is done
         int64_t bytesDownloaded = 0;        //how many bytes actually downloaded (as reported by CURL)
         double progressWeight = 0.0;        //this request size / total size of all downloads
+        int64_t sizeEstimate = 0;           //estimated size of this request in bytes (for logging)
+    };
+
+    //one slot for concurrent HTTP request
+    struct Connection {
+        Downloader *owner = nullptr;
+        std::unique_ptr<CURL, void (*)(CURL*)> curlHandle; //CURL handle reused between request in order to exploit connection pool
+        std::unique_ptr<CurlResponse> response; //state of the HTTP request currently active (null if slot is free)
+        std::vector<SubTask> subtasks;      //pieces being downloaded by the active request
+        int speedProfile = 0;               //speed profile which the active request was started with
+
+        Connection();
     };
-    std::unique_ptr<CurlResponse> _currResponse;
+    std::vector<std::unique_ptr<Connection>> _connections;
+    std::unique_ptr<CURLM, void (*)(CURLM*)> _curlMultiHandle;   //all concurrent requests are driven by it
 
-    double _totalProgress = 0.0;            //which portion of DownloadAll is complete (without current request)
-    int64_t _totalBytesDownloaded = 0;      //how many bytes downloaded in total (without current request)
+    double _totalProgress = 0.0;            //which portion of DownloadAll is complete (without active requests)
+    double _lastReportedProgress = 0.0;     //progress passed to callback last time (it must never decrease)
+    int64_t _totalBytesDownloaded = 0;      //how many bytes downloaded in total (without active requests)
+    bool _interrupted = false;              //progress callback has asked to stop
 
-    std::unique_ptr<CURL, void (*)(CURL*)> _curlHandle; //CURL handle reused between request in order to exploit connection pool
     int _curlRequestIdx = 0;                //sequental number of HTTP request (used for logging curl commands)
 
 public:
@@ -109,6 +143,9 @@ public:
     void SetUserAgent(const char *useragent);
     //blocked = true: only use ordinary byterange requests, never use multipart ones
     void SetMultipartBlocked(bool blocked);
+    //set how many HTTP requests can run simultaneously: in total and to one host
+    //note: set both to 1 in order to download everything sequentally
+    void SetMaxConnections(int total, int perHost);
 
     //when everything is set up, call this method to actually perform all downloads
     //it blocks until the job is done (progress callback is the only way to interrupt it)
@@ -119,10 +156,15 @@ public:
     int64_t TotalBytesDownloaded() const { return _totalBytesDownloaded; }
 
 private:
-    void DownloadAllForUrl(const std::string &url);
-    bool DownloadOneRequest(const std::string &url, const std::vector<SubTask> &subtasks, int lowSpeedTime, int connectTimeout);
+    bool StartNextRequest(Connection &conn);
+    void ScheduleSubtasks(UrlState &state, std::vector<SubTask> &subtasks);
+    void StartRequest(Connection &conn, const std::string &url, int lowSpeedTime, int connectTimeout);
+    void FinishRequest(Connection &conn, int curlCode);
+    bool ProcessResponse(CURL *curl, CurlResponse &response, const std::vector<SubTask> &subtasks, int curlCode);
+    void ReturnSubtasks(UrlState &state, const std::vector<SubTask> &subtasks);
+    void CleanupConnections();
     void BreakMultipartResponse(const CurlResponse &response, std::vector<CurlResponse> &parts);
-    int UpdateProgress();
+    int UpdateProgress(const CurlResponse *current = nullptr);
 };
 
 }
@@ -17,11 +17,12 @@ typedef unsigned long long uint64;
 HttpServer::~HttpServer() {
     Stop();
 }
-HttpServer::HttpServer() {
+HttpServer::HttpServer() : _activeRequests(0), _maxActiveRequests(0) {
     SetBlockSize();
     SetPortNumber();
     SetPauseModel();
     SetDropMultipart();
+    SetLatency();
 }
 
 void HttpServer::SetRootDir(const std::string &root) {
@@ -47,6 +48,14 @@ void HttpServer::SetDropMultipart(bool drop) {
     _dropMultipart = drop;
 }
 
+void HttpServer::SetLatency(int milliseconds) {
+    _latencyMs = milliseconds;
+}
+
+int HttpServer::GetMaxActiveRequests() const {
+    return _maxActiveRequests;
+}
+
 void HttpServer::CloseSuspendedSocket() {
     if (_suspendedSocket) {
         MHD_socket socket = *(MHD_socket*)_suspendedSocket;
@@ -71,6 +80,8 @@ void HttpServer::Stop() {
 void HttpServer::Start() {
     if (_daemon)
         return;
+    _activeRequests = 0;
+    _maxActiveRequests = 0;
     _daemon = MHD_start_daemon(
         MHD_USE_THREAD_PER_CONNECTION,
         _port,
@@ -294,6 +305,14 @@ int HttpServer::AcceptCallback(
     const char *version
 ) const {
 
+    //note: request is counted as active only while it waits for latency
+    int active = ++_activeRequests;
+    int maxActive = _maxActiveRequests;
+    while (active > maxActive && !_maxActiveRequests.compare_exchange_weak(maxActive, active)) {}
+    if (_latencyMs > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(_latencyMs));
+    --_activeRequests;
+
     std::string filepath = _rootDir + url;
 
     StdioFileHolder file(fopen(filepath.c_str(), "rb"));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <stdint.h>
 
 struct MHD_Daemon;
@@ -36,6 +37,9 @@ private:
     int _blockSize = -1;
     bool _dropMultipart = false;
     PauseModel _pauseModel;
+    int _latencyMs = 0;
+    mutable std::atomic<int> _activeRequests;
+    mutable std::atomic<int> _maxActiveRequests;
 
 public:
     static const int PORT_DEFAULT = 8090;
@@ -51,7 +55,11 @@ public:
     void SetBlockSize(int blockSize = 128*1024);
     void SetDropMultipart(bool drop = false);
     void SetPauseModel(const PauseModel &model = PauseModel());
+    //delay every response by this number of milliseconds
+    void SetLatency(int milliseconds = 0);
     std::string GetRootUrl() const;
+    //max number of requests processed simultaneously since server start
+    int GetMaxActiveRequests() const;
 
     void Start();
     void Stop();
@@ -986,6 +986,79 @@ TEST_CASE("DownloaderSubtasks") {
     RemoveFile((GetTempDir() / "subtasks.bin").string());
 }
 
+TEST_CASE("DownloaderConcurrent") {
+    PrepareFilesForHttpServer();
+    std::string DataIdentityBin = ReadWholeFileAsStr((GetTempDir() / "identity.bin").string());
+    std::string DataSquaresTxt = ReadWholeFileAsStr((GetTempDir() / "subdir" / "squares.txt").string());
+    auto CreateDownloadCallback = [](std::string &buffer) -> DownloadFinishedCallback {
+        return [&buffer](const void *ptr, uint32_t bytes) -> void {
+            buffer.assign((char*)ptr, (char*)ptr + bytes);
+        };
+    };
+
+    //note: every response is delayed, so total time mostly depends on how many requests are done simultaneously
+    static const int LATENCY_MS = 200;
+    double elapsed[2] = {0.0, 0.0};
+    for (int concurrent = 0; concurrent < 2; concurrent++) {
+        //two servers on different ports act as two mirrors
+        HttpServer servers[2];
+        for (int s = 0; s < 2; s++) {
+            servers[s].SetRootDir(GetTempDir().string());
+            servers[s].SetPortNumber(HttpServer::PORT_DEFAULT + s);
+            servers[s].SetLatency(LATENCY_MS);
+            servers[s].Start();
+        }
+
+        Downloader down;
+        if (concurrent)
+            down.SetMaxConnections(6, 3);
+        else
+            down.SetMaxConnections(1, 1);
+        down.SetMultipartBlocked(true);     //every range needs separate request
+
+        static const int RANGES = 32;
+        std::vector<std::string> data(RANGES + 1), expected(RANGES + 1);
+        for (int i = 0; i < RANGES; i++) {
+            const HttpServer &server = servers[i % 2];
+            bool identity = (i / 2 % 2 != 0);
+            uint32_t from = 20000 * i + 13 * i;
+            uint32_t to = from + 1000 + 100 * i;
+            const char *filename = identity ? "identity.bin" : "subdir/squares.txt";
+            down.EnqueueDownload(DownloadSource(server.GetRootUrl() + filename, from, to), CreateDownloadCallback(data[i]));
+            expected[i] = (identity ? DataIdentityBin : DataSquaresTxt).substr(from, to - from);
+        }
+        //large download: split into pieces which are downloaded simultaneously
+        down.EnqueueDownload(DownloadSource(servers[0].GetRootUrl() + "subdir/squares.txt", 0, DataSquaresTxt.size()), CreateDownloadCallback(data[RANGES]));
+        expected[RANGES] = DataSquaresTxt;
+
+        double progressRatio = -1.0;
+        GlobalProgressCallback progressCallback = [&](double ratio, const char *message) -> int {
+            CHECK(ratio >= progressRatio);
+            progressRatio = ratio;
+            return 0;
+        };
+        down.SetProgressCallback(progressCallback);
+
+        auto startTime = std::chrono::steady_clock::now();
+        down.DownloadAll();
+        elapsed[concurrent] = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        CHECK(progressRatio == 1.0);
+        for (int i = 0; i <= RANGES; i++)
+            CHECK(data[i] == expected[i]);
+        //concurrent: three connections to each of two servers, every response is delayed long enough for all of them to overlap
+        for (int s = 0; s < 2; s++) {
+            if (concurrent)
+                CHECK(servers[s].GetMaxActiveRequests() == 3);
+            else
+                CHECK(servers[s].GetMaxActiveRequests() == 1);
+        }
+    }
+
+    //wall-clock time depends on the machine, so it is only reported
+    MESSAGE(formatMessage("Download time: %0.3lf s with one connection, %0.3lf s with concurrent connections", elapsed[0], elapsed[1]));
+}
+
 TEST_CASE("DownloaderTimeout"
     * doctest::skip()   //takes hours due to repeated pauses
 ) {
@@ -1159,6 +1232,69 @@ TEST_CASE("CleanInstall") {
     }
 }
 
+TEST_CASE("RepackParallel") {
+    //every file must be recompressed: provided zips have the same files, but stored and in reverse order
+    TestCreator tc;
+    DirState target = tc.GenTargetState(3000, 12);
+    int zipIdx = 0;
+    for (auto &pZS : target) {
+        if (zipIdx++ % 3 != 0)
+            continue;
+        //large file: recompressed as a separate job
+        std::string text;
+        for (int i = 0; text.size() < (6<<20); i++)
+            text += std::to_string(i) + "-th number is " + std::to_string(i * 7919 % 10007) + "\n";
+        InZipFile large{tc.GenInZipParams(), std::vector<uint8_t>(text.begin(), text.end())};
+        large.params.method = 8;
+        large.params.level = Z_BEST_COMPRESSION;
+        pZS.second.emplace_back("large" + std::to_string(zipIdx) + ".txt", std::move(large));
+    }
+    DirState provided = target;
+    for (auto &pZS : provided) {
+        std::reverse(pZS.second.begin(), pZS.second.end());
+        for (auto &pF : pZS.second) {
+            pF.second.params.method = 0;
+            pF.second.params.level = 0;
+        }
+    }
+
+    double elapsed[2] = {0.0, 0.0};
+    for (int parallel = 0; parallel < 2; parallel++) {
+        auto tempDir = GetTempDir() / ("rp" + std::to_string(parallel));
+        Manifest targetMani, providedMani;
+        TestCreator::WriteState((tempDir / "target").string(), "", target, &targetMani);
+        TestCreator::WriteState((tempDir / "current").string(), "", provided, &providedMani);
+
+        UpdateProcess updater;
+        updater.Init(targetMani, providedMani, (tempDir / "current").string());
+        bool ok = updater.DevelopPlan(UpdateType::SameContents);
+        REQUIRE(ok);
+        g_testLogger->clear();
+        auto startTime = std::chrono::steady_clock::now();
+        updater.RepackZips(GlobalProgressCallback(), parallel ? 4 : 1);
+        elapsed[parallel] = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        CHECK(g_testLogger->counts[lcRepackZip] == target.size());
+
+        Manifest resMani = updater.GetProvidedManifest().Filter([](const FileMetainfo &f) {
+            return f.location == FileLocation::Inplace;
+        });
+        CHECK(resMani.size() == targetMani.size());
+    }
+
+    //result must not depend on number of threads
+    for (const auto &pZS : target) {
+        auto serialZip = ReadWholeFile((GetTempDir() / "rp0" / "current" / pZS.first).string());
+        auto parallelZip = ReadWholeFile((GetTempDir() / "rp1" / "current" / pZS.first).string());
+        CHECK(serialZip == parallelZip);
+    }
+    for (int z = 0; z < 2; z++)
+        for (const stdext::path &filePath : stdext::recursive_directory_enumerate(GetTempDir() / ("rp" + std::to_string(z)) / "current"))
+            CHECK(filePath.filename().string().find("__recompressed") != 0);
+
+    //timings are only reported: wall-clock speedup is not reliable on loaded machines
+    MESSAGE(formatMessage("Repacking time: %0.3lf s in one thread, %0.3lf s in four threads", elapsed[0], elapsed[1]));
+}
+
 TEST_CASE("ChecksummedZip") {
     static const int NUM = 10;
     auto tempDir = GetTempDir() / "chkZip";
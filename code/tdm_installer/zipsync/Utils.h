@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <functional>
 
 
 namespace ZipSync {
@@ -35,4 +36,8 @@ public:
 std::vector<uint8_t> ReadWholeFile(const std::string &filename);
 int GetFileSize(const std::string &filename);
 
+//calls body for every index in [from, to) using thrNum threads (nonpositive = all cores)
+//exception thrown from body is rethrown to the caller
+void ParallelFor(int from, int to, const std::function<void(int)> &body, int thrNum = -1, int blockSize = 1);
+
 }
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <map>
 #include <set>
+#include <thread>
 #include "Logging.h"
 #include "Utils.h"
 #include "ZipUtils.h"
@@ -127,14 +128,6 @@ public:
         //for progress indicator
         uint64_t _totalTargetSize = 0;
 
-        //cached during repacking to avoid reopening
-        mutable UnzFileIndexed zfCache;
-
-        UnzFileIndexed &UnzFileCached() const {
-            if (!zfCache)
-                zfCache.Open(_zipPath.c_str());
-            return zfCache;
-        }
         bool operator< (const ZipInfo &b) const {
             return _zipPath < b._zipPath;
         }
@@ -148,7 +141,10 @@ public:
     }
 
     //indexed as matches: false if provided file was copied in "raw" mode, true if in recompressing mode
-    std::vector<bool> _recompressed;
+    //note: not vector<bool>, since parallel jobs write to it
+    std::vector<uint8_t> _recompressed;
+    //large files recompressed in separate jobs before repacking: match index -> temporary zip path
+    std::map<int, std::string> _recompressedTemp;
     //how many (local) provided files have specified compressed hash
     //note: includes files from repacked and reduced zips
     std::map<HashDigest, int> _hashProvidedCnt;
@@ -160,6 +156,13 @@ public:
 
     //calling back to report current progress
     GlobalProgressCallback _progress;
+    //how many threads to use for repacking (each job holds only a few buffers, so memory usage is bounded)
+    int _threadsNum = 1;
+
+    //files larger than this are recompressed as separate jobs (when running in parallel)
+    static const uint32_t SIZE_LARGE_FILE = 4<<20;
+    //repacked zip is analyzed by parallel jobs, each of them hashes about this number of bytes
+    static const uint32_t SIZE_ANALYZE_CHUNK = 16<<20;
 
     Repacker(UpdateProcess &owner) : _owner(owner) {}
 
@@ -212,6 +215,7 @@ public:
             FindZip(m.target->zipPath.abs)._matchIds.push_back(i);
             FindZip(m.provided->zipPath.abs)._usedCnt++;
         }
+        _recompressed.assign(_owner._matches.size(), false);
     }
 
     double ComputeProgressRatio() const {
@@ -313,7 +317,6 @@ public:
                 filesMap[pf->byterange[0]] = ManifestIter(_repackedMani, _repackedMani.size() - 1);
             }
             for (int midx : dstZip._matchIds) {
-                _recompressed.resize(midx + 1, false);
                 _recompressed[midx] = false;
                 ManifestIter &pf = _owner._matches[midx].provided;
                 ManifestIter newIter = filesMap.at(pf->byterange[0]);
@@ -326,32 +329,68 @@ public:
         }
     }
 
-    void RepackZip(ZipInfo &zip) {
-        g_logger->infof(lcRepackZip, "Repacking %s...", zip._zipPathRepacked.c_str());
-        if (_progress)
-            _progress(ComputeProgressRatio(), formatMessage("Repacking %s...", zip._zipPathRepacked.c_str()).c_str());
+    bool CanCopyRaw(const Match &m, int compressionMethod, int flags) const {
+        if (m.provided->compressedHash == m.target->compressedHash)
+            return true;  //bitwise same
+        if (_owner._updateType == UpdateType::SameContents && m.target->props.compressionMethod == compressionMethod && m.target->props.generalPurposeBitFlag == flags)
+            return true;  //same compression level
+        return false;
+    }
 
-        //ensure all directories are created if missing
-        CreateDirectoriesForFile(zip._zipPath, _owner._rootDir);
+    //note: called in parallel for different files
+    void RecompressLargeFile(int midx, const std::string &tempZipPath) const {
+        const Match &m = _owner._matches[midx];
+
+        UnzFileIndexed zf;
+        zf.Open(m.provided->zipPath.abs.c_str());
+        zf.LocateByByterange(m.provided->byterange[0], m.provided->byterange[1]);
+
+        //put the file alone into temporary zip, exactly as it should be in repacked zip
+        ZipFileHolder zfOut(tempZipPath.c_str());
+        minizipCopyFile(zf, zfOut,
+            m.target->filename.c_str(),
+            m.target->props.compressionMethod, m.target->props.generalPurposeBitFlag,
+            m.target->props.internalAttribs, m.target->props.externalAttribs, m.target->props.lastModTime,
+            false, m.target->props.crc32, m.target->props.contentsSize
+        );
+    }
+
+    //note: called in parallel for different zips
+    void RepackZip(ZipInfo &zip) {
         //create new zip archive (it will contain results of repacking)
         ZipFileHolder zfOut(zip._zipPathRepacked.c_str());
+        //source zips are opened separately by every job: minizip handles cannot be shared between threads
+        std::map<std::string, UnzFileIndexed> sourceZips;
 
         //copy all target files one-by-one
         for (int midx : zip._matchIds) {
             const Match &m = _owner._matches[midx];
 
+            auto tempIter = _recompressedTemp.find(midx);
+            if (tempIter != _recompressedTemp.end()) {
+                //large file has already been recompressed by separate job: copy it as is
+                UnzFileHolder zf(tempIter->second.c_str());
+                SAFE_CALL(unzGoToFirstFile(zf));
+                minizipCopyFile(zf, zfOut,
+                    m.target->filename.c_str(),
+                    m.target->props.compressionMethod, m.target->props.generalPurposeBitFlag,
+                    m.target->props.internalAttribs, m.target->props.externalAttribs, m.target->props.lastModTime,
+                    true, m.target->props.crc32, m.target->props.contentsSize
+                );
+                _recompressed[midx] = true;
+                continue;
+            }
+
             //find provided file
-            UnzFileIndexed &zf = FindZip(m.provided->zipPath.abs).UnzFileCached();
+            UnzFileIndexed &zf = sourceZips[m.provided->zipPath.abs];
+            if (!zf)
+                zf.Open(m.provided->zipPath.abs.c_str());
             zf.LocateByByterange(m.provided->byterange[0], m.provided->byterange[1]);
 
             //can we avoid recompressing the file?
             unz_file_info info;
             SAFE_CALL(unzGetCurrentFileInfo(zf, &info, NULL, 0, NULL, 0, NULL, 0));
-            bool copyRaw = false;
-            if (m.provided->compressedHash == m.target->compressedHash)
-                copyRaw = true;  //bitwise same
-            if (_owner._updateType == UpdateType::SameContents && m.target->props.compressionMethod == info.compression_method && m.target->props.generalPurposeBitFlag == info.flag)
-                copyRaw = true;  //same compression level
+            bool copyRaw = CanCopyRaw(m, info.compression_method, info.flag);
 
             //copy the file to the new zip
             minizipCopyFile(zf, zfOut,
@@ -360,17 +399,13 @@ public:
                 m.target->props.internalAttribs, m.target->props.externalAttribs, m.target->props.lastModTime,
                 copyRaw, m.target->props.crc32, m.target->props.contentsSize
             );
-            //remember whether we repacked or not --- to be used in AnalyzeRepackedZip
-            _recompressed.resize(midx+1, false);
+            //remember whether we repacked or not --- to be used in AnalyzeRepackedFiles
             _recompressed[midx] = !copyRaw;
         }
 
         //flush and close new zip
         zfOut.reset();
         zip._repacked = true;
-
-        if (_progress)
-            _progress(ComputeProgressRatio(), formatMessage("Repacking %s...", zip._zipPathRepacked.c_str()).c_str());
     }
 
     void ValidateFile(const FileMetainfo &want, const FileMetainfo &have) const {
@@ -392,18 +427,21 @@ public:
         ZipSyncAssertF(want.props.externalAttribs == have.props.externalAttribs, "Wrong external attribs of %s after repack", fullPath.c_str());
     }
 
-    void AnalyzeRepackedZip(const ZipInfo &zip) {
-        //analyze the repacked new zip
+    //analyzes files [first..last) of the repacked zip (in order of its _matchIds), and checks them
+    //note: called in parallel for different zips and different ranges of files in one zip
+    void AnalyzeRepackedFiles(const ZipInfo &zip, int first, int last, FileMetainfo *metas) const {
         UnzFileHolder zf(zip._zipPathRepacked.c_str());
         SAFE_CALL(unzGoToFirstFile(zf));
-        for (int i = 0; i < zip._matchIds.size(); i++) {
+        for (int i = 0; i < first; i++)
+            SAFE_CALL(unzGoToNextFile(zf));
+        for (int i = first; i < last; i++) {
             int midx = zip._matchIds[i];
-            Match &m = _owner._matches[midx];
-            if (i > 0) SAFE_CALL(unzGoToNextFile(zf));
+            const Match &m = _owner._matches[midx];
+            if (i > first) SAFE_CALL(unzGoToNextFile(zf));
 
             //analyze current file
             bool needsRehashCompressed = _recompressed[midx];
-            FileMetainfo metaNew;
+            FileMetainfo &metaNew = metas[i];
             metaNew.zipPath = PathAR::FromAbs(zip._zipPathRepacked, _owner._rootDir);
             metaNew.location = FileLocation::Repacked;
             metaNew.package = m.target->package;
@@ -412,20 +450,103 @@ public:
             AnalyzeCurrentFile(zf, metaNew, false, needsRehashCompressed);
             //check that it indeed matches the target
             ValidateFile(*m.target, metaNew);
+        }
+    }
+
+    void CommitRepackedZip(const ZipInfo &zip, std::vector<FileMetainfo> &metas) {
+        for (int i = 0; i < zip._matchIds.size(); i++) {
+            int midx = zip._matchIds[i];
+            Match &m = _owner._matches[midx];
 
             //decrement ref count on zip (which might allow to "reduce" it in ReduceOldZips)
             int &usedCnt = FindZip(m.provided->zipPath.abs)._usedCnt;
             ZipSyncAssert(usedCnt >= 0);
             usedCnt--;
             //increment ref count on compressed hash
-            _hashProvidedCnt[metaNew.compressedHash]++;
+            _hashProvidedCnt[metas[i].compressedHash]++;
 
             //add info about file to special manifest
-            _repackedMani.AppendFile(metaNew);
+            _repackedMani.AppendFile(std::move(metas[i]));
             //switch the match for the target file to this new file
             m.provided = ManifestIter(_repackedMani, _repackedMani.size() - 1);
         }
-        zf.reset();
+    }
+
+    //repack a few zips simultaneously
+    void RepackBatch(const std::vector<ZipInfo*> &batch) {
+        //logging and progress are done in this thread only
+        for (ZipInfo *zip : batch) {
+            g_logger->infof(lcRepackZip, "Repacking %s...", zip->_zipPathRepacked.c_str());
+            if (_progress)
+                _progress(ComputeProgressRatio(), formatMessage("Repacking %s...", zip->_zipPathRepacked.c_str()).c_str());
+            //ensure all directories are created if missing
+            CreateDirectoriesForFile(zip->_zipPath, _owner._rootDir);
+        }
+
+        //large files which need recompression would make their zip much longer than others:
+        //recompress them as separate jobs (into temporary zips) before repacking
+        std::vector<int> largeIds;
+        if (_threadsNum > 1) {
+            for (ZipInfo *zip : batch) {
+                for (int midx : zip->_matchIds) {
+                    const Match &m = _owner._matches[midx];
+                    if (m.target->props.contentsSize < SIZE_LARGE_FILE)
+                        continue;
+                    if (CanCopyRaw(m, m.provided->props.compressionMethod, m.provided->props.generalPurposeBitFlag))
+                        continue;
+                    _recompressedTemp[midx] = PrefixFile(zip->_zipPath, "__recompressed" + std::to_string(midx) + "__");
+                    largeIds.push_back(midx);
+                }
+            }
+        }
+        ParallelFor(0, largeIds.size(), [&](int i) {
+            RecompressLargeFile(largeIds[i], _recompressedTemp.at(largeIds[i]));
+        }, _threadsNum);
+
+        ParallelFor(0, batch.size(), [&](int i) {
+            RepackZip(*batch[i]);
+        }, _threadsNum);
+
+        for (const auto &pKV : _recompressedTemp)
+            RemoveFile(pKV.second);
+        _recompressedTemp.clear();
+
+        if (_progress)
+            _progress(ComputeProgressRatio(), formatMessage("Repacked %s", batch.back()->_zipPathRepacked.c_str()).c_str());
+
+        //split analysis into jobs of similar size
+        //note: only recompressed files need hashing, others are almost free
+        struct AnalyzeJob {
+            int zipIdx;
+            int first, last;
+        };
+        std::vector<AnalyzeJob> jobs;
+        std::vector<std::vector<FileMetainfo>> metas(batch.size());
+        for (int z = 0; z < batch.size(); z++) {
+            const ZipInfo &zip = *batch[z];
+            int n = zip._matchIds.size();
+            metas[z].resize(n);
+            uint64_t jobSize = 0;
+            int first = 0;
+            for (int i = 0; i < n; i++) {
+                int midx = zip._matchIds[i];
+                if (_recompressed[midx])
+                    jobSize += _owner._matches[midx].target->props.compressedSize;
+                if (jobSize >= SIZE_ANALYZE_CHUNK || i == n-1) {
+                    jobs.push_back(AnalyzeJob{z, first, i+1});
+                    first = i+1;
+                    jobSize = 0;
+                }
+            }
+        }
+        ParallelFor(0, jobs.size(), [&](int j) {
+            const AnalyzeJob &job = jobs[j];
+            AnalyzeRepackedFiles(*batch[job.zipIdx], job.first, job.last, metas[job.zipIdx].data());
+        }, _threadsNum);
+
+        //update all the data structures
+        for (int z = 0; z < batch.size(); z++)
+            CommitRepackedZip(*batch[z], metas[z]);
     }
 
     void ReduceOldZips() {
@@ -437,7 +558,6 @@ public:
                 continue;       //already reduced
             if (zip._usedCnt > 0)
                 continue;       //original zip still needed as source
-            zip.zfCache.Clear();
 
             if (IfFileExists(zip._zipPath)) {
                 UnzFileHolder zf(zip._zipPath.c_str());
@@ -587,7 +707,10 @@ public:
         ProcessZipsWithoutRepacking();
 
         //iterate over all zips and repack them
+        //note: zips are repacked in batches of parallel jobs,
+        //old zips are reduced after every batch to limit disk usage
         ReduceOldZips();
+        std::vector<ZipInfo*> queue;
         for (ZipInfo &zip : _zips) {
             if (!zip._managed)
                 continue;   //no targets, no need to remove
@@ -595,12 +718,13 @@ public:
                 continue;   //minizip doesn't support empty zip
             if (zip._repacked)
                 continue;   //renamed in ProcessZipsWithoutRepacking
-            RepackZip(zip);
-            AnalyzeRepackedZip(zip);
+            queue.push_back(&zip);
+        }
+        for (int start = 0; start < queue.size(); start += _threadsNum) {
+            int end = std::min(start + _threadsNum, (int)queue.size());
+            RepackBatch(std::vector<ZipInfo*>(queue.begin() + start, queue.begin() + end));
             ReduceOldZips();
         }
-        for (ZipInfo &zip : _zips)
-            zip.zfCache.Clear();
 
         RenameRepackedZips();
         RewriteProvidedManifest();
@@ -610,9 +734,10 @@ public:
     }
 };
 
-void UpdateProcess::RepackZips(const GlobalProgressCallback &progressCallback) {
+void UpdateProcess::RepackZips(const GlobalProgressCallback &progressCallback, int threadsNum) {
     Repacker impl(*this);
     impl._progress = progressCallback;
+    impl._threadsNum = (threadsNum > 0 ? threadsNum : std::max(int(std::thread::hardware_concurrency()), 1));
     impl.DoAll();
 }
 
@@ -71,7 +71,8 @@ public:
     );
 
     //having all matches available locally, perform the update
-    void RepackZips(const GlobalProgressCallback &progressCallback = GlobalProgressCallback());
+    //zips are repacked, hashed and validated in threadsNum parallel threads (0 = all cores)
+    void RepackZips(const GlobalProgressCallback &progressCallback = GlobalProgressCallback(), int threadsNum = 0);
 
     //TODO: local cache for reduced zips?
     void RemoveOldZips(const LocalCache *cache);
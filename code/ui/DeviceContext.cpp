@@ -154,6 +154,7 @@ void idDeviceContext::Clear() {
 	useFont = NULL;
 	activeFont = NULL;
 	mbcs = false;
+	skipDraw = false;
 }
 
 idDeviceContext::idDeviceContext() {
@@ -276,6 +277,10 @@ void idDeviceContext::AdjustCoords(float *x, float *y, float *w, float *h) {
 }
 
 void idDeviceContext::DrawStretchPic(float x, float y, float w, float h, float s1, float t1, float s2, float t2, const idMaterial *shader) {
+	if ( skipDraw ) {
+		return;
+	}
+
 	idDrawVert verts[4];
 	glIndex_t indexes[6];
 	indexes[0] = 3;
@@ -363,6 +368,9 @@ void idDeviceContext::DrawStretchPic(float x, float y, float w, float h, float s
 
 
 void idDeviceContext::DrawMaterial(float x, float y, float w, float h, const idMaterial *mat, const idVec4 &color, float scalex, float scaley) {
+	if ( skipDraw ) {
+		return;
+	}
 
 	renderSystem->SetColor(color);
 
@@ -410,6 +418,9 @@ void idDeviceContext::DrawMaterial(float x, float y, float w, float h, const idM
 }
 
 void idDeviceContext::DrawMaterialRotated(float x, float y, float w, float h, const idMaterial *mat, const idVec4 &color, float scalex, float scaley, float angle) {
+	if ( skipDraw ) {
+		return;
+	}
 	
 	renderSystem->SetColor(color);
 
@@ -457,6 +468,9 @@ void idDeviceContext::DrawMaterialRotated(float x, float y, float w, float h, co
 }
 
 void idDeviceContext::DrawStretchPicRotated(float x, float y, float w, float h, float s1, float t1, float s2, float t2, const idMaterial *shader, float angle) {
+	if ( skipDraw ) {
+		return;
+	}
 	
 	idDrawVert verts[4];
 	glIndex_t indexes[6];
@@ -571,6 +585,9 @@ void idDeviceContext::DrawStretchPicRotated(float x, float y, float w, float h,
 }
 
 void idDeviceContext::DrawFilledRect( float x, float y, float w, float h, const idVec4 &color) {
+	if ( skipDraw ) {
+		return;
+	}
 
 	if ( color.w == 0.0f ) {
 		return;
@@ -588,6 +605,9 @@ void idDeviceContext::DrawFilledRect( float x, float y, float w, float h, const
 
 
 void idDeviceContext::DrawRect( float x, float y, float w, float h, float size, const idVec4 &color) {
+	if ( skipDraw ) {
+		return;
+	}
 
 	if ( color.w == 0.0f ) {
 		return;
@@ -607,6 +627,9 @@ void idDeviceContext::DrawRect( float x, float y, float w, float h, float size,
 }
 
 void idDeviceContext::DrawMaterialRect( float x, float y, float w, float h, float size, const idMaterial *mat, const idVec4 &color) {
+	if ( skipDraw ) {
+		return;
+	}
 
 	if ( color.w == 0.0f ) {
 		return;
@@ -625,6 +648,10 @@ void idDeviceContext::SetCursor(int n) {
 }
 
 void idDeviceContext::DrawCursor(float *x, float *y, float size) {
+	if ( skipDraw ) {
+		return;
+	}
+
 	if (*x < 0) {
 		*x = 0;
 	}
@@ -749,6 +776,28 @@ int idDeviceContext::DrawText(float x, float y, float scale, idVec4 color, const
 	return count;
 }
 
+/*
+=============
+idDeviceContext::HashDrawState
+
+Everything besides window state which affects the geometry emitted by a window.
+=============
+*/
+uint64 idDeviceContext::HashDrawState( uint64 hash ) const {
+	hash = FNV1a_64( hash, &xScale, sizeof( xScale ) );
+	hash = FNV1a_64( hash, &yScale, sizeof( yScale ) );
+	hash = FNV1a_64( hash, &vidWidth, sizeof( vidWidth ) );
+	hash = FNV1a_64( hash, &vidHeight, sizeof( vidHeight ) );
+	hash = FNV1a_64( hash, &enableClipping, sizeof( enableClipping ) );
+	hash = FNV1a_64( hash, &activeFont, sizeof( activeFont ) );
+	hash = FNV1a_64( hash, mat.ToFloatPtr(), sizeof( mat ) );
+	hash = FNV1a_64( hash, origin.ToFloatPtr(), sizeof( origin ) );
+	if ( clipRects.Num() ) {
+		hash = FNV1a_64( hash, clipRects.Ptr(), clipRects.Num() * sizeof( clipRects[0] ) );
+	}
+	return hash;
+}
+
 void idDeviceContext::SetSize(float width, float height) {
 	vidWidth = VIRTUAL_WIDTH;
 	vidHeight = VIRTUAL_HEIGHT;
@@ -920,6 +969,10 @@ idRegion *idDeviceContext::GetTextRegion(const char *text, float textScale, idRe
 }
 
 void idDeviceContext::DrawEditCursor( float x, float y, float scale ) {
+	if ( skipDraw ) {
+		return;
+	}
+
 	if ( (int)( com_ticNumber >> 4 ) & 1 ) {
 		return;
 	}
@@ -931,6 +984,10 @@ void idDeviceContext::DrawEditCursor( float x, float y, float scale ) {
 }
 
 int idDeviceContext::DrawText( const char *text, float textScale, int textAlign, idVec4 color, idRectangle rectDraw, bool wrap, int cursor, bool calcOnly, idList<int> *breaks, int limit ) {
+	if ( skipDraw && !calcOnly ) {
+		return 0;
+	}
+
 	const char	*p, *textPtr, *newLinePtr;
 	char		buff[1024];
 	int			len, newLine, count;
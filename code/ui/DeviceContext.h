@@ -81,6 +81,11 @@ public:
 
 	void				DrawEditCursor(float x, float y, float scale);
 
+						// while set, draw calls emit nothing (geometry is replayed from a window draw cache)
+	void				SetSkipDraw(bool b) { skipDraw = b; }
+	bool				IsDrawSkipped() const { return skipDraw; }
+	uint64				HashDrawState( uint64 hash ) const;
+
 	enum {
 		CURSOR_ARROW,
 		CURSOR_HAND,
@@ -130,6 +135,8 @@ private:
 
 	bool				overStrikeMode;
 
+	bool				skipDraw;
+
 	idMat3				mat;
 	idVec3				origin;
 	bool				initialized;
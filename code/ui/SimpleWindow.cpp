@@ -245,6 +245,52 @@ void idSimpleWindow::Redraw(float x, float y) {
 	textRect.Offset(-x, -y);
 }
 
+/*
+================
+idSimpleWindow::DrawStateHash
+
+Appends all state which affects emitted geometry, see idWindow::DrawStateHash.
+================
+*/
+uint64 idSimpleWindow::DrawStateHash( uint64 hash ) const {
+	const bool vis = visible;
+	hash = FNV1a_64( hash, &vis, sizeof( vis ) );
+	if ( !vis ) {
+		return hash;
+	}
+
+	const idRectangle &r = rect;
+	const idVec4 &back = backColor;
+	const idVec4 &mat = matColor;
+	const idVec4 &fore = foreColor;
+	const idVec4 &border = borderColor;
+	const idVec2 &sh = shear;
+	const idStr &str = text;
+	const float scale = textScale;
+	const float rot = rotate;
+
+	hash = FNV1a_64( hash, &flags, sizeof( flags ) );
+	hash = FNV1a_64( hash, &r, sizeof( r ) );
+	hash = FNV1a_64( hash, back.ToFloatPtr(), sizeof( back ) );
+	hash = FNV1a_64( hash, mat.ToFloatPtr(), sizeof( mat ) );
+	hash = FNV1a_64( hash, fore.ToFloatPtr(), sizeof( fore ) );
+	hash = FNV1a_64( hash, border.ToFloatPtr(), sizeof( border ) );
+	hash = FNV1a_64( hash, sh.ToFloatPtr(), sizeof( sh ) );
+	hash = FNV1a_64( hash, &scale, sizeof( scale ) );
+	hash = FNV1a_64( hash, &rot, sizeof( rot ) );
+	hash = FNV1a_64( hash, str.c_str(), str.Length() + 1 );
+	hash = FNV1a_64( hash, &background, sizeof( background ) );
+	hash = FNV1a_64( hash, &fontNum, sizeof( fontNum ) );
+	hash = FNV1a_64( hash, &matScalex, sizeof( matScalex ) );
+	hash = FNV1a_64( hash, &matScaley, sizeof( matScaley ) );
+	hash = FNV1a_64( hash, &borderSize, sizeof( borderSize ) );
+	hash = FNV1a_64( hash, &textAlign, sizeof( textAlign ) );
+	hash = FNV1a_64( hash, &textAlignx, sizeof( textAlignx ) );
+	hash = FNV1a_64( hash, &textAligny, sizeof( textAligny ) );
+	hash = FNV1a_64( hash, &textShadow, sizeof( textShadow ) );
+	return hash;
+}
+
 intptr_t idSimpleWindow::GetWinVarOffset(idWinVar *wv, drawWin_t* owner) {
     intptr_t ret = -1;
 
@@ -35,6 +35,7 @@ public:
 	idWinVar *		GetThisWinVarByName(const char *varname);
     intptr_t		GetWinVarOffset(idWinVar *wv, drawWin_t* owner);
 	size_t			Size();
+	uint64			DrawStateHash( uint64 hash ) const;
 
 	idWindow*		GetParent ( void ) { return mParent; }
 
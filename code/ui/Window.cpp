@@ -43,6 +43,7 @@ bool idWindow::registerIsTemporary[MAX_EXPRESSION_REGISTERS];		// statics to ass
 
 idCVar idWindow::gui_debug( "gui_debug", "0", CVAR_GUI | CVAR_BOOL, "" );
 idCVar idWindow::gui_edit( "gui_edit", "0", CVAR_GUI | CVAR_BOOL, "" );
+idCVar idWindow::gui_drawCache( "gui_drawCache", "1", CVAR_GUI | CVAR_BOOL, "reuse geometry of window subtrees whose state did not change since the last frame" );
 
 extern idCVar r_skipGuiShaders;		// 1 = don't render any gui elements on surfaces
 
@@ -169,6 +170,11 @@ void idWindow::CommonInit() {
 	}
 
 	hideCursor = false;
+
+	drawCacheable = false;
+	subtreeDrawHash = 0;
+	drawCacheKey = 0;
+	drawCache = NULL;
 }
 
 /*
@@ -273,6 +279,7 @@ void idWindow::CleanUp() {
 	for (i = 0; i < SCRIPT_COUNT; i++) {
 		delete scripts[i];
 	}
+	ClearDrawCache();
 	CommonInit();
 }
 
@@ -1254,6 +1261,10 @@ void idWindow::Redraw(float x, float y) {
 		return;
 	}
 
+	if ( flags & WIN_DESKTOP ) {
+		UpdateDrawCacheState();
+	}
+
 	if ( flags & WIN_SHOWTIME ) {
 		dc->DrawText(va(" %0.1f seconds\n%s", (float)(time - timeLine) / 1000, gui->State().GetString("name")), 0.35f, 0, dc->colorWhite, idRectangle(100, 0, 80, 80), false);
 	}
@@ -1269,6 +1280,33 @@ void idWindow::Redraw(float x, float y) {
 		return;
 	}
 
+	// replay the subtree if neither it nor the device context changed since it was recorded,
+	// the rest of the drawing code still runs to leave the device context in the same state
+	bool replayDrawCache = false;
+	bool recordDrawCache = false;
+	guiModelMark_t drawCacheMark;
+	if ( drawCacheable && gui_drawCache.GetBool() && r_skipGuiShaders.GetInteger() == 0 && !gui_debug.GetInteger() && !gui_edit.GetBool() ) {
+		if ( !dc->IsDrawSkipped() ) {
+			uint64 key = FNV1a_64( subtreeDrawHash, &x, sizeof( x ) );
+			key = FNV1a_64( key, &y, sizeof( y ) );
+			key = dc->HashDrawState( key );
+			if ( key == drawCacheKey && drawCache ) {
+				tr.guiModel->DrawCapture( *drawCache );
+				dc->SetSkipDraw( true );
+				replayDrawCache = true;
+			} else if ( key == drawCacheKey ) {
+				// unchanged for two frames in a row, worth recording
+				tr.guiModel->GetMark( drawCacheMark );
+				recordDrawCache = true;
+			} else {
+				ClearDrawCache();
+			}
+			drawCacheKey = key;
+		}
+	} else {
+		ClearDrawCache();
+	}
+
 	CalcClientRect(0, 0);
 
 	SetFont();
@@ -1334,11 +1372,121 @@ void idWindow::Redraw(float x, float y) {
 		dc->EnableClipping(true);
 	}
 
+	if ( replayDrawCache ) {
+		dc->SetSkipDraw( false );
+	} else if ( recordDrawCache ) {
+		drawCache = new guiModelCapture_t;
+		tr.guiModel->Capture( drawCacheMark, *drawCache );
+	}
+
 	drawRect.Offset(-x, -y);
 	clientRect.Offset(-x, -y);
 	textRect.Offset(-x, -y);
 }
 
+/*
+================
+idWindow::DrawStateHash
+
+Hashes all state which affects geometry emitted by this window itself.
+================
+*/
+uint64 idWindow::DrawStateHash() const {
+	const idRectangle &r = rect;
+	const idVec4 &back = backColor;
+	const idVec4 &mat = matColor;
+	const idVec4 &fore = foreColor;
+	const idVec4 &hoverCol = hoverColor;
+	const idVec4 &border = borderColor;
+	const idStr &str = text;
+	const float scale = textScale;
+	const float rot = rotate;
+	const bool vis = visible;
+
+	uint64 hash = FNV1A_64_INIT;
+	hash = FNV1a_64( hash, &vis, sizeof( vis ) );
+	if ( !vis ) {
+		return hash;
+	}
+	hash = FNV1a_64( hash, &flags, sizeof( flags ) );
+	hash = FNV1a_64( hash, &r, sizeof( r ) );
+	hash = FNV1a_64( hash, back.ToFloatPtr(), sizeof( back ) );
+	hash = FNV1a_64( hash, mat.ToFloatPtr(), sizeof( mat ) );
+	hash = FNV1a_64( hash, fore.ToFloatPtr(), sizeof( fore ) );
+	hash = FNV1a_64( hash, hoverCol.ToFloatPtr(), sizeof( hoverCol ) );
+	hash = FNV1a_64( hash, border.ToFloatPtr(), sizeof( border ) );
+	hash = FNV1a_64( hash, &scale, sizeof( scale ) );
+	hash = FNV1a_64( hash, &rot, sizeof( rot ) );
+	hash = FNV1a_64( hash, str.c_str(), str.Length() + 1 );
+	hash = FNV1a_64( hash, &background, sizeof( background ) );
+	hash = FNV1a_64( hash, &matScalex, sizeof( matScalex ) );
+	hash = FNV1a_64( hash, &matScaley, sizeof( matScaley ) );
+	hash = FNV1a_64( hash, &borderSize, sizeof( borderSize ) );
+	hash = FNV1a_64( hash, &textAlignx, sizeof( textAlignx ) );
+	hash = FNV1a_64( hash, &textAligny, sizeof( textAligny ) );
+	hash = FNV1a_64( hash, &textAlign, sizeof( textAlign ) );
+	hash = FNV1a_64( hash, &textShadow, sizeof( textShadow ) );
+	hash = FNV1a_64( hash, &fontNum, sizeof( fontNum ) );
+	hash = FNV1a_64( hash, shear.ToFloatPtr(), sizeof( shear ) );
+	hash = FNV1a_64( hash, &xOffset, sizeof( xOffset ) );
+	hash = FNV1a_64( hash, &yOffset, sizeof( yOffset ) );
+	hash = FNV1a_64( hash, &forceAspectWidth, sizeof( forceAspectWidth ) );
+	hash = FNV1a_64( hash, &forceAspectHeight, sizeof( forceAspectHeight ) );
+	hash = FNV1a_64( hash, &hover, sizeof( hover ) );
+
+	if ( ( flags & ( WIN_HCENTER | WIN_VCENTER ) ) && parent ) {
+		const idRectangle &pr = parent->rect;
+		hash = FNV1a_64( hash, &pr, sizeof( pr ) );
+	}
+	if ( flags & WIN_SCREENASPECT ) {
+		const int screen[2] = { renderSystem->GetScreenWidth(), renderSystem->GetScreenHeight() };
+		hash = FNV1a_64( hash, screen, sizeof( screen ) );
+	}
+
+	return hash;
+}
+
+/*
+================
+idWindow::UpdateDrawCacheState
+
+Runs after time events and registers are evaluated, before anything is drawn.
+Only plain windows are cached: derived classes draw things which depend on
+input, time or the game and are not reflected in window state.
+================
+*/
+void idWindow::UpdateDrawCacheState() {
+	subtreeDrawHash = DrawStateHash();
+	drawCacheable = typeid( *this ) == typeid( idWindow ) && !( flags & ( WIN_DESKTOP | WIN_SHOWTIME | WIN_SHOWCOORDS ) );
+
+	if ( !visible ) {
+		// nothing below is drawn
+		return;
+	}
+
+	int c = drawWindows.Num();
+	for ( int i = 0; i < c; i++ ) {
+		if ( drawWindows[i].win ) {
+			idWindow *child = drawWindows[i].win;
+			child->UpdateDrawCacheState();
+			drawCacheable &= child->drawCacheable;
+			subtreeDrawHash = FNV1a_64( subtreeDrawHash, &child->subtreeDrawHash, sizeof( child->subtreeDrawHash ) );
+		} else {
+			subtreeDrawHash = drawWindows[i].simp->DrawStateHash( subtreeDrawHash );
+		}
+	}
+}
+
+/*
+================
+idWindow::ClearDrawCache
+================
+*/
+void idWindow::ClearDrawCache() {
+	delete drawCache;
+	drawCache = NULL;
+}
+
 /*
 ================
 idWindow::SetDC
@@ -148,6 +148,7 @@ struct idGuiSourceLocation {
 
 
 class idUserInterfaceLocal;
+struct guiModelCapture_s;
 class idWindow {
 public:
 	idWindow(idUserInterfaceLocal *gui);
@@ -244,6 +245,9 @@ public:
 	void	CalcRects(float x, float y);
 	virtual void Redraw(float x, float y);
 
+	// recompute which subtrees can reuse the geometry they emitted last frame
+	void	UpdateDrawCacheState();
+
 	virtual void ArchiveToDictionary(idDict *dict, bool useNames = true);
 	virtual void InitFromDictionary(idDict *dict, bool byName = true);
 	virtual void PostParse();
@@ -423,6 +427,7 @@ protected:
 
 	static idCVar gui_debug;
 	static idCVar gui_edit;
+	static idCVar gui_drawCache;
 
 	idGuiScriptList *scripts[SCRIPT_COUNT];
 	bool *saveTemps;
@@ -442,6 +447,15 @@ protected:
 
 	idWinBool	hideCursor;
 
+	// draw cache: geometry emitted by the whole subtree, replayed while nothing in it changes
+	bool		drawCacheable;		// plain window without animated decorations, and so are all children
+	uint64		subtreeDrawHash;	// state of this window and all its children
+	uint64		drawCacheKey;		// subtree hash and device context state the cache was recorded with
+	struct guiModelCapture_s *drawCache;
+
+	uint64		DrawStateHash() const;
+	void		ClearDrawCache();
+
 	//stgatilov: pool of source filename strings referenced in idGuiScript elements
 	idDict sourceFilenamePool;
 	//stgatilov: error reporting and debuggability